@@ -0,0 +1,50 @@
+#include "benchmark.hpp"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+    struct BenchmarkEntry {
+        char const* name;
+        BenchmarkFunction function;
+    };
+
+    // Function-local so registration does not depend on static initialization order.
+    std::vector<BenchmarkEntry>& get_registry() {
+        static std::vector<BenchmarkEntry> registry;
+        return registry;
+    }
+}
+
+BenchmarkRegistration::BenchmarkRegistration(char const* name, BenchmarkFunction function) {
+    get_registry().push_back({name, function});
+}
+
+int run_benchmarks(std::string const& filter) {
+    int count = 0;
+
+    for (auto const& entry : get_registry()) {
+        if (std::string{entry.name}.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        std::printf("%s\n", entry.name);
+        entry.function();
+        ++count;
+    }
+
+    if (count == 0) {
+        std::printf("No benchmark matches \"%s\"\n", filter.c_str());
+    }
+
+    return count;
+}
+
+void report(std::string const& label, f64 ns_per_call, f64 items) {
+    if (items > 0.0) {
+        f64 items_per_second = items * 1e9 / ns_per_call;
+        std::printf("  %-40s %12.1f ns  %10.2f M/s\n", label.c_str(), ns_per_call, items_per_second / 1e6);
+    } else {
+        std::printf("  %-40s %12.1f ns\n", label.c_str(), ns_per_call);
+    }
+}
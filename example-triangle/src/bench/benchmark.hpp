@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include <util/base.hpp>
+
+/*
+ * Minimal microbenchmark runner. Benchmarks register themselves with BENCHMARK(name) and
+ * are run with `<executable> --bench [filter]`, where filter selects benchmarks whose
+ * name contains it.
+ */
+
+using BenchmarkFunction = void (*)();
+
+struct BenchmarkRegistration {
+    BenchmarkRegistration(char const* name, BenchmarkFunction function);
+};
+
+#define BENCHMARK(name) \
+    static void name(); \
+    static BenchmarkRegistration const name ## _registration{#name, name}; \
+    static void name()
+
+int run_benchmarks(std::string const& filter);
+
+// Keeps the compiler from optimizing away a result that is never read.
+template<typename T>
+inline void do_not_optimize(T const& value) {
+    __asm__ volatile("" : : "r,m"(value) : "memory");
+}
+
+// Repeats body until at least min_seconds have passed and returns the mean time per call in nanoseconds.
+template<typename F>
+f64 measure(F&& body, f64 min_seconds = 0.25) {
+    using Clock = std::chrono::steady_clock;
+
+    body(); // warm up caches
+
+    u64 iterations = 0;
+    auto start = Clock::now();
+    std::chrono::duration<f64> elapsed{};
+
+    do {
+        body();
+        ++iterations;
+        elapsed = Clock::now() - start;
+    } while (elapsed.count() < min_seconds);
+
+    return elapsed.count() * 1e9 / static_cast<f64>(iterations);
+}
+
+// Prints one result line. items is the amount of work per call, used to derive a throughput.
+void report(std::string const& label, f64 ns_per_call, f64 items = 0.0);
@@ -0,0 +1,66 @@
+#include <random>
+#include <vector>
+
+#include <bench/benchmark.hpp>
+#include <scene/cullinggrid.hpp>
+
+namespace {
+    std::vector<Aabb> random_boxes(std::size_t count, u32 seed) {
+        std::mt19937 rng{seed};
+        std::uniform_real_distribution<f32> position{-500.0f, 500.0f};
+        std::uniform_real_distribution<f32> size{0.5f, 4.0f};
+
+        std::vector<Aabb> boxes(count);
+        for (auto& box : boxes) {
+            vec3 center{position(rng), position(rng), position(rng)};
+            vec3 extent{size(rng), size(rng), size(rng)};
+            box = {center - extent, center + extent};
+        }
+        return boxes;
+    }
+}
+
+BENCHMARK(scene_culling) {
+    constexpr std::size_t count = 1000000;
+    auto boxes = random_boxes(count, 99);
+
+    mat4 view_projection = perspective(1.2f, 16.0f / 9.0f, 0.1f, 600.0f);
+    Frustum frustum = Frustum::from_matrix(view_projection);
+
+    std::size_t brute_force_visible = 0;
+    report("brute force, scalar (1M boxes)", measure([&] {
+        brute_force_visible = 0;
+        for (auto const& box : boxes) {
+            brute_force_visible += frustum.classify(box) != Containment::Outside;
+        }
+        do_not_optimize(brute_force_visible);
+    }), count);
+
+    CullingGrid grid{32.0f};
+    std::vector<CullId> ids;
+    for (auto const& box : boxes) {
+        ids.push_back(grid.insert(box));
+    }
+
+    std::vector<CullId> visible;
+    report("culling grid (1M boxes)", measure([&] {
+        grid.cull(frustum, visible);
+        do_not_optimize(visible.size());
+    }), count);
+
+    CullStats const& stats = grid.get_stats();
+    std::printf("  visible %u (brute force %zu), culled %u, cells %u of %u visible, last cull %.3f ms\n",
+                stats.visible, brute_force_visible, stats.culled, stats.cells_visible, stats.cells_tested, stats.cull_ms);
+
+    // 1% of the objects move every frame.
+    auto moved = random_boxes(count / 100, 7);
+    std::size_t frame = 0;
+    report("update 1% + cull (1M boxes)", measure([&] {
+        std::size_t offset = (frame++ * 7919) % (count - moved.size());
+        for (std::size_t i = 0; i < moved.size(); ++i) {
+            grid.update(ids[offset + i], moved[i]);
+        }
+        grid.cull(frustum, visible);
+        do_not_optimize(visible.size());
+    }), count);
+}
@@ -0,0 +1,145 @@
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <bench/benchmark.hpp>
+#include <jobs/jobsystem.hpp>
+
+namespace {
+    bool check(bool condition, char const* what) {
+        std::printf("  %-48s %s\n", what, condition ? "ok" : "FAILED");
+        return condition;
+    }
+}
+
+// Not a timing benchmark: hammers the scheduler from several angles and verifies the results.
+BENCHMARK(jobs_stress) {
+    JobSystem& jobs = JobSystem::get_global();
+    std::printf("  %u threads\n", jobs.get_thread_count());
+
+    {
+        constexpr u32 count = 200000;
+        std::atomic<u32> executed{0};
+        JobCounter counter;
+
+        for (u32 i = 0; i < count; ++i) {
+            jobs.run([&executed] { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+        }
+        jobs.wait(counter);
+
+        check(executed == count, "200k independent jobs");
+    }
+
+    {
+        constexpr std::size_t outer = 64;
+        constexpr std::size_t inner = 10000;
+        std::atomic<u64> sum{0};
+
+        jobs.parallel_for(outer, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o) {
+                jobs.parallel_for(inner, 64, [&](std::size_t b, std::size_t e) {
+                    u64 local = 0;
+                    for (std::size_t i = b; i < e; ++i) {
+                        local += i;
+                    }
+                    sum.fetch_add(local, std::memory_order_relaxed);
+                });
+            }
+        });
+
+        check(sum == outer * (inner * (inner - 1) / 2), "nested parallel_for");
+    }
+
+    {
+        constexpr u32 chains = 2000;
+        std::vector<u32> stages(chains, 0);
+        std::vector<std::thread::id> threads(chains * 3);
+        std::atomic<u32> out_of_order{0};
+        std::vector<JobCounter> first(chains), second(chains), third(chains);
+
+        // In dependency order: a continuation only waits while its counter is above zero, and a counter
+        // counts a job from when the job is created. Each stage records its thread to see chains cross them.
+        for (u32 c = 0; c < chains; ++c) {
+            u32* stage = &stages[c];
+            std::thread::id* ran_on = &threads[c * 3];
+            jobs.run([stage, ran_on, &out_of_order] { out_of_order += *stage != 0; *stage = 1; ran_on[0] = std::this_thread::get_id(); }, &first[c]);
+            jobs.run_after(first[c], [stage, ran_on, &out_of_order] { out_of_order += *stage != 1; *stage = 2; ran_on[1] = std::this_thread::get_id(); }, &second[c]);
+            jobs.run_after(second[c], [stage, ran_on, &out_of_order] { out_of_order += *stage != 2; *stage = 3; ran_on[2] = std::this_thread::get_id(); }, &third[c]);
+        }
+        for (u32 c = 0; c < chains; ++c) {
+            jobs.wait(third[c]);
+        }
+
+        u32 unfinished = 0, crossed = 0;
+        for (u32 c = 0; c < chains; ++c) {
+            unfinished += stages[c] != 3;
+            crossed += threads[c * 3] != threads[c * 3 + 1] || threads[c * 3 + 1] != threads[c * 3 + 2];
+        }
+
+        check(out_of_order == 0 && unfinished == 0, "2000 three-stage dependency chains");
+        std::printf("  %u of them moved between threads\n", crossed);
+    }
+
+    {
+        std::atomic<u32> executed{0};
+
+        std::thread foreign{[&] {
+            JobCounter counter;
+            for (u32 i = 0; i < 10000; ++i) {
+                jobs.run([&executed] { ++executed; }, &counter);
+            }
+            jobs.wait(counter);
+        }};
+        foreign.join();
+
+        check(executed == 10000, "jobs submitted from a foreign thread");
+    }
+}
+
+BENCHMARK(jobs_scaling) {
+    u32 max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    constexpr std::size_t elements = 1 << 20;
+    std::vector<f32> data(elements, 2.0f);
+
+    f64 baseline_for = 0.0;
+    f64 baseline_jobs = 0.0;
+
+    for (u32 threads = 1; threads <= max_threads; threads = threads < 4 ? threads + 1 : threads * 2) {
+        JobSystem jobs{threads - 1};
+
+        // Fine-grained: 256 cheap elements per range.
+        f64 ns_for = measure([&] {
+            jobs.parallel_for(elements, 256, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    data[i] = std::sqrt(data[i] * data[i] + 1.0f);
+                }
+            });
+        });
+
+        // Tiny independent jobs, mostly measuring scheduling overhead.
+        f64 ns_jobs = measure([&] {
+            JobCounter counter;
+            std::atomic<u32> sink{0};
+            for (u32 i = 0; i < 10000; ++i) {
+                jobs.run([&sink] { sink.fetch_add(1, std::memory_order_relaxed); }, &counter);
+            }
+            jobs.wait(counter);
+        });
+
+        if (threads == 1) {
+            baseline_for = ns_for;
+            baseline_jobs = ns_jobs;
+        }
+
+        char label[64];
+        std::snprintf(label, sizeof(label), "%2u threads, parallel_for 1M", threads);
+        report(label, ns_for, elements);
+        std::printf("  %-40s %12.2fx\n", "", baseline_for / ns_for);
+
+        std::snprintf(label, sizeof(label), "%2u threads, 10k empty jobs", threads);
+        report(label, ns_jobs, 10000);
+        std::printf("  %-40s %12.2fx\n", "", baseline_jobs / ns_jobs);
+    }
+}
@@ -0,0 +1,90 @@
+#include <random>
+#include <vector>
+
+#include <bench/benchmark.hpp>
+#include <math/math.hpp>
+
+namespace {
+    std::vector<mat4> random_matrices(std::size_t count) {
+        std::mt19937 rng{42};
+        std::uniform_real_distribution<f32> dist{-1.0f, 1.0f};
+
+        std::vector<mat4> matrices(count);
+        for (auto& m : matrices) {
+            for (int i = 0; i < 16; ++i) {
+                m.data()[i] = dist(rng);
+            }
+            // Keep them comfortably invertible.
+            m.cols[0].x += 4.0f;
+            m.cols[1].y += 4.0f;
+            m.cols[2].z += 4.0f;
+            m.cols[3].w += 4.0f;
+        }
+        return matrices;
+    }
+}
+
+BENCHMARK(math_mat4_mul) {
+    constexpr std::size_t count = 4096;
+    auto a = random_matrices(count);
+    auto b = random_matrices(count);
+    std::vector<mat4> out(count);
+
+    std::printf("  simd level: %s\n", get_simd_level_name(get_simd_level()));
+
+    report("mat4_mul_batch_scalar (4096)", measure([&] {
+        mat4_mul_batch_scalar(a.data(), b.data(), out.data(), count);
+        do_not_optimize(out.front());
+    }), count);
+
+    report("mat4_mul_batch (4096)", measure([&] {
+        mat4_mul_batch(a.data(), b.data(), out.data(), count);
+        do_not_optimize(out.front());
+    }), count);
+}
+
+BENCHMARK(math_mat4_inverse) {
+    constexpr std::size_t count = 4096;
+    auto in = random_matrices(count);
+    std::vector<mat4> out(count);
+
+    report("mat4_inverse_scalar (4096)", measure([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            mat4_inverse_scalar(in[i], out[i]);
+        }
+        do_not_optimize(out.front());
+    }), count);
+
+    report("mat4_inverse (4096)", measure([&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            mat4_inverse(in[i], out[i]);
+        }
+        do_not_optimize(out.front());
+    }), count);
+}
+
+BENCHMARK(math_transform_points) {
+    constexpr std::size_t count = 1 << 16;
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<f32> dist{-100.0f, 100.0f};
+
+    std::vector<f32> x(count), y(count), z(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        x[i] = dist(rng);
+        y[i] = dist(rng);
+        z[i] = dist(rng);
+    }
+    std::vector<f32> ox(count), oy(count), oz(count);
+
+    mat4 m = perspective(1.0f, 4.0f / 3.0f, 0.1f, 100.0f) * translate({1.0f, 2.0f, -5.0f});
+
+    report("transform_points_scalar (65536)", measure([&] {
+        transform_points_scalar(m, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data(), count);
+        do_not_optimize(ox.front());
+    }), count);
+
+    report("transform_points (65536)", measure([&] {
+        transform_points(m, x.data(), y.data(), z.data(), ox.data(), oy.data(), oz.data(), count);
+        do_not_optimize(ox.front());
+    }), count);
+}
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <bench/benchmark.hpp>
+#include <mesh/meshfile.hpp>
+#include <mesh/meshimport.hpp>
+
+namespace {
+    // A wavy grid with texture coordinates and normals, written the way exporters write OBJ files.
+    void write_grid_obj(std::string const& path, u32 size) {
+        std::FILE* file = std::fopen(path.c_str(), "w");
+        if (!file) {
+            return;
+        }
+
+        for (u32 y = 0; y < size; ++y) {
+            for (u32 x = 0; x < size; ++x) {
+                f32 u = static_cast<f32>(x) / (size - 1), v = static_cast<f32>(y) / (size - 1);
+                std::fprintf(file, "v %.6f %.6f %.6f\n", u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.05f * ((x * 7 + y * 13) % 17) / 17.0f);
+                std::fprintf(file, "vt %.6f %.6f\n", u, v);
+                std::fprintf(file, "vn %.6f %.6f %.6f\n", 0.0f, 0.0f, 1.0f);
+            }
+        }
+
+        for (u32 y = 0; y + 1 < size; ++y) {
+            for (u32 x = 0; x + 1 < size; ++x) {
+                u32 a = y * size + x + 1, b = a + 1, c = a + size, d = c + 1;
+                std::fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, d, d, d);
+                std::fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, d, d, d, c, c, c);
+            }
+        }
+
+        std::fclose(file);
+    }
+
+    u64 file_size(std::string const& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return 0;
+        }
+        std::fseek(file, 0, SEEK_END);
+        long size = std::ftell(file);
+        std::fclose(file);
+        return size > 0 ? static_cast<u64>(size) : 0;
+    }
+
+    // Reads every word, like glBufferData() copying the blocks.
+    u64 checksum(u8 const* data, u64 bytes) {
+        u64 sum = 0;
+        for (u64 i = 0; i + 8 <= bytes; i += 8) {
+            u64 word;
+            std::memcpy(&word, data + i, 8);
+            sum += word;
+        }
+        return sum;
+    }
+}
+
+BENCHMARK(mesh_loading) {
+    // 512x512 vertices, about half a million triangles. The files go to the working directory.
+    constexpr u32 grid_size = 512;
+    std::string const obj_path = "bench_mesh.obj";
+    std::string const mesh_path = "bench_mesh.mesh";
+
+    write_grid_obj(obj_path, grid_size);
+    if (!convert_mesh(obj_path, mesh_path)) {
+        std::remove(obj_path.c_str());
+        return;
+    }
+
+    f64 vertices = static_cast<f64>(grid_size) * grid_size;
+    std::printf("  %.1f MiB as OBJ, %.1f MiB as mesh file\n", file_size(obj_path) / (1024.0 * 1024.0), file_size(mesh_path) / (1024.0 * 1024.0));
+
+    f64 parsed = measure([&] {
+        MeshData mesh;
+        bool ok = import_obj(obj_path, mesh);
+        do_not_optimize(ok);
+        do_not_optimize(mesh.vertices.data());
+    }, 1.0);
+    report("parse OBJ text", parsed, vertices);
+
+    // The page cache is warm after the first run, like for a level that is loaded again.
+    // Opening already reads the index block, every index is checked against the vertex count.
+    f64 opened = measure([&] {
+        MappedMesh mesh;
+        bool ok = mesh.open(mesh_path);
+        do_not_optimize(ok);
+    }, 1.0);
+    report("map mesh file and validate the indices", opened, vertices);
+
+    f64 mapped = measure([&] {
+        MappedMesh mesh;
+        bool ok = mesh.open(mesh_path);
+        u64 sum = ok ? checksum(mesh.get_vertices(), mesh.get_header().vertex_bytes) + checksum(mesh.get_indices(), mesh.get_header().index_bytes) : 0;
+        do_not_optimize(sum);
+    }, 1.0);
+    report("map mesh file and read the blocks", mapped, vertices);
+
+    std::printf("  %.0fx faster than parsing\n", parsed / mapped);
+
+    std::remove(obj_path.c_str());
+    std::remove(mesh_path.c_str());
+}
@@ -0,0 +1,65 @@
+#include <vector>
+
+#include <bench/benchmark.hpp>
+#include <jobs/jobsystem.hpp>
+#include <math/kernels.hpp>
+#include <particles/particlesystem.hpp>
+
+namespace {
+    constexpr f32 DT = 1.0f / 60.0f;
+
+    // Emits as fast as particles die, so the system sits at about its capacity.
+    void setup(ParticleSystem& particles) {
+        ParticleEmitter emitter{};
+        emitter.position = {640.0f, 600.0f};
+        emitter.direction = -1.5708f;
+        emitter.spread = 1.0f;
+        emitter.min_speed = 100.0f;
+        emitter.max_speed = 400.0f;
+        emitter.min_lifetime = 1.0f;
+        emitter.max_lifetime = 3.0f;
+        emitter.rate = static_cast<f32>(particles.get_capacity()) / 2.0f;
+        emitter.start_color = {255, 200, 80, 255};
+        emitter.end_color = {200, 40, 20, 0};
+        emitter.enabled = true;
+        particles.add_emitter(emitter);
+
+        ParticleForces& forces = particles.get_forces();
+        forces.gravity = {0.0f, 200.0f};
+        forces.drag = 0.2f;
+        forces.attractors.push_back({{640.0f, 300.0f}, 50000.0f, 40.0f});
+
+        // Three seconds, the longest lifetime.
+        for (int i = 0; i < 180; ++i) {
+            particles.update(DT);
+        }
+    }
+}
+
+BENCHMARK(particles) {
+    constexpr std::size_t capacity = 1000000;
+    std::printf("  %u threads, simd level: %s\n", JobSystem::get_global().get_thread_count(), get_simd_level_name(get_simd_level()));
+
+    ParticleSystem scalar{capacity};
+    setup(scalar);
+    report("update, scalar (1M particles)", measure([&] {
+        scalar.update_scalar(DT);
+        do_not_optimize(scalar.get_size());
+    }), static_cast<f64>(scalar.get_size()));
+
+    ParticleSystem particles{capacity};
+    setup(particles);
+    report("update, simd + jobs (1M particles)", measure([&] {
+        particles.update(DT);
+        do_not_optimize(particles.get_size());
+    }), static_cast<f64>(particles.get_size()));
+
+    ParticleStats const& stats = particles.get_stats();
+    std::printf("  alive %u, spawned %u, killed %u in the last update\n", stats.alive, stats.spawned, stats.killed);
+
+    std::vector<Vertex> vertices(capacity);
+    report("write vertices (1M particles)", measure([&] {
+        particles.write_vertices(vertices.data());
+        do_not_optimize(vertices.data());
+    }), static_cast<f64>(particles.get_size()));
+}
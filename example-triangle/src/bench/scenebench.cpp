@@ -0,0 +1,59 @@
+#include <random>
+#include <vector>
+
+#include <bench/benchmark.hpp>
+#include <jobs/jobsystem.hpp>
+#include <scene/transformhierarchy.hpp>
+
+namespace {
+    // A 4-ary tree, which is about 10 levels deep for a million nodes.
+    void build_tree(TransformHierarchy& hierarchy, std::size_t count) {
+        hierarchy.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            hierarchy.create(i == 0 ? INVALID_TRANSFORM : static_cast<TransformId>((i - 1) / 4));
+        }
+        hierarchy.update();
+    }
+}
+
+BENCHMARK(scene_transform_update) {
+    constexpr std::size_t node_count = 1000000;
+    constexpr std::size_t dirty_count = node_count / 100;
+    constexpr std::size_t dirty_sets = 16;
+
+    TransformHierarchy hierarchy;
+    build_tree(hierarchy, node_count);
+
+    std::printf("  %u threads\n", JobSystem::get_global().get_thread_count());
+
+    std::mt19937 rng{1234};
+    std::uniform_int_distribution<TransformId> pick{0, node_count - 1};
+
+    std::vector<std::vector<TransformId>> sets(dirty_sets);
+    for (auto& set : sets) {
+        for (std::size_t i = 0; i < dirty_count; ++i) {
+            set.push_back(pick(rng));
+        }
+    }
+
+    std::size_t frame = 0;
+    std::size_t recomputed = 0;
+    std::size_t frames = 0;
+
+    f64 ns = measure([&] {
+        for (TransformId id : sets[frame++ % dirty_sets]) {
+            hierarchy.set_translation(id, {static_cast<f32>(frame), 0.0f, 0.0f});
+        }
+        recomputed += hierarchy.update();
+        ++frames;
+    });
+
+    report("1M nodes, 1% dirty per frame", ns);
+    std::printf("  %zu of %zu nodes recomputed per frame on average\n", recomputed / frames, node_count);
+
+    ns = measure([&] {
+        hierarchy.set_translation(0, {static_cast<f32>(++frame), 0.0f, 0.0f});
+        hierarchy.update();
+    });
+    report("1M nodes, root dirty (full update)", ns, node_count);
+}
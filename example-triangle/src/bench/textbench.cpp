@@ -0,0 +1,58 @@
+#include <string>
+#include <vector>
+
+#include <bench/benchmark.hpp>
+#include <jobs/jobsystem.hpp>
+#include <text/sdfatlas.hpp>
+#include <text/textbatch.hpp>
+
+BENCHMARK(text_atlas) {
+    std::printf("  %u threads\n", JobSystem::get_global().get_thread_count());
+
+    SdfAtlas atlas;
+    f64 ns = measure([&] {
+        atlas.build();
+        do_not_optimize(atlas.get_pixels().data());
+    });
+
+    // Every texel gets a distance, the throughput is in texels.
+    report("build " + std::to_string(atlas.get_width()) + "x" + std::to_string(atlas.get_height()) + " atlas", ns,
+           static_cast<f64>(atlas.get_width()) * atlas.get_height());
+}
+
+BENCHMARK(text_batch) {
+    SdfAtlas atlas;
+    atlas.build();
+
+    // 2500 labels of 40 glyphs each (no spaces), 100k glyphs per frame.
+    constexpr u32 label_count = 2500;
+    std::vector<std::string> labels;
+    for (u32 i = 0; i < label_count; ++i) {
+        char label[64];
+        std::snprintf(label, sizeof(label), "Object#%05u:pos=%08.2f,%08.2f;ok!!!", i, i * 0.37f, i * 1.13f);
+        labels.emplace_back(label);
+    }
+
+    TextBatch batch{atlas};
+    auto frame = [&] {
+        batch.begin_frame();
+        for (u32 i = 0; i < label_count; ++i) {
+            batch.add(labels[i], (i % 50) * 300.0f, (i / 50) * 20.0f, 16.0f, {255, 255, 255, 255});
+        }
+        do_not_optimize(batch.get_vertices().data());
+    };
+
+    frame();
+    u32 glyphs = batch.get_glyph_count();
+
+    f64 cached = measure(frame);
+    report("100k glyphs, cached runs", cached, glyphs);
+
+    f64 uncached = measure([&] {
+        batch.clear_cache();
+        frame();
+    });
+    report("100k glyphs, laid out every frame", uncached, glyphs);
+
+    std::printf("  %u glyphs, %zu KiB of vertices per frame\n", glyphs, batch.get_vertices().size() * sizeof(Vertex) / 1024);
+}
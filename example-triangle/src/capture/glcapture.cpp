@@ -0,0 +1,684 @@
+#include "glcapture.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <GLFW/glfw3.h>
+
+#include <capture/glstream.hpp>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using gl_stream::Op;
+
+    constexpr std::size_t FLUSH_SIZE = std::size_t{1} << 20;
+
+    struct NameArray {
+        GLsizei count;
+        GLuint const* names;
+    };
+
+    struct Mapping {
+        void* pointer;
+        GLintptr offset;
+        GLsizeiptr length;
+        GLbitfield access;
+    };
+
+    struct Capture {
+        std::FILE* file = nullptr;
+        std::vector<u8> buffer;
+        Clock::time_point start;
+
+        // Hash of every payload written so far to its blob id. Hashes can collide, so a hit is only
+        // reused once the payload matches the copy kept in blob_data.
+        std::unordered_multimap<u64, u32> blobs;
+        // Every payload written so far, back to back, and where each blob starts in it. The replay
+        // keeps the whole stream in memory too.
+        std::vector<u8> blob_data;
+        std::vector<std::size_t> blob_offsets;
+        GLint unpack_alignment = 4;
+        // Ranges mapped by target, recorded when they are unmapped.
+        std::unordered_map<GLenum, Mapping> mappings;
+
+        u64 frames = 0;
+        u64 bytes_written = 0;
+        u64 payload_bytes = 0;
+        u64 deduplicated_bytes = 0;
+    };
+
+    Capture capture;
+
+    // 64 bit FNV-1a, byte by byte. Folding in whole words lets differences in the top bits cancel out.
+    u64 hash_bytes(void const* data, u64 size) {
+        constexpr u64 PRIME = 0x100000001b3;
+        auto const* bytes = static_cast<u8 const*>(data);
+
+        u64 hash = 0xcbf29ce484222325;
+        for (u64 i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * PRIME;
+        }
+
+        return hash;
+    }
+
+    bool same_blob(u32 id, void const* data, u64 size) {
+        std::size_t begin = capture.blob_offsets[id];
+        std::size_t end = id + 1 < capture.blob_offsets.size() ? capture.blob_offsets[id + 1] : capture.blob_data.size();
+        return end - begin == size && std::memcmp(capture.blob_data.data() + begin, data, static_cast<std::size_t>(size)) == 0;
+    }
+
+    void append(void const* data, std::size_t size) {
+        auto const* bytes = static_cast<u8 const*>(data);
+        capture.buffer.insert(capture.buffer.end(), bytes, bytes + size);
+    }
+
+    template<typename T>
+    void write(T value) {
+        static_assert(std::is_arithmetic_v<T>, "only plain values are written as they are");
+        append(&value, sizeof(value));
+    }
+
+    void write(NameArray array) {
+        write(static_cast<i32>(array.count));
+        append(array.names, sizeof(GLuint) * static_cast<std::size_t>(array.count));
+    }
+
+    void flush() {
+        if (capture.buffer.empty()) {
+            return;
+        }
+
+        if (std::fwrite(capture.buffer.data(), 1, capture.buffer.size(), capture.file) != capture.buffer.size()) {
+            printf("GL capture: writing failed, stopping.\n");
+            std::fclose(capture.file);
+            capture.file = nullptr;
+        }
+
+        capture.bytes_written += capture.buffer.size();
+        capture.buffer.clear();
+    }
+
+    template<typename... Args>
+    void record(Op op, Args... args) {
+        if (!capture.file) {
+            return;
+        }
+
+        write(static_cast<u16>(op));
+        (write(args), ...);
+
+        if (capture.buffer.size() >= FLUSH_SIZE) {
+            flush();
+        }
+    }
+
+    // Writes a Blob record unless the same contents were written before. Call before record(), records must not interleave.
+    u32 write_blob(void const* data, u64 size) {
+        if (!capture.file || !data) {
+            return gl_stream::NULL_BLOB;
+        }
+
+        capture.payload_bytes += size;
+
+        u64 hash = hash_bytes(data, size);
+        auto [first, last] = capture.blobs.equal_range(hash);
+        for (auto it = first; it != last; ++it) {
+            if (same_blob(it->second, data, size)) {
+                capture.deduplicated_bytes += size;
+                return it->second;
+            }
+        }
+
+        u32 id = static_cast<u32>(capture.blob_offsets.size());
+        capture.blobs.insert({hash, id});
+        capture.blob_offsets.push_back(capture.blob_data.size());
+        auto const* bytes = static_cast<u8 const*>(data);
+        capture.blob_data.insert(capture.blob_data.end(), bytes, bytes + size);
+
+        write(static_cast<u16>(Op::Blob));
+        write(id);
+        write(size);
+        append(data, static_cast<std::size_t>(size));
+        return id;
+    }
+
+    u64 to_offset(void const* pointer) {
+        return static_cast<u64>(reinterpret_cast<std::uintptr_t>(pointer));
+    }
+
+    u64 to_handle(GLsync sync) {
+        return static_cast<u64>(reinterpret_cast<std::uintptr_t>(sync));
+    }
+
+    f64 to_mib(u64 bytes) {
+        return static_cast<f64>(bytes) / (1024.0 * 1024.0);
+    }
+}
+
+namespace gl_capture {
+    bool start(std::string const& path, GLFWwindow* window) {
+        if (capture.file) {
+            return false;
+        }
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+
+        gl_stream::Header header{};
+        std::memcpy(header.magic, gl_stream::MAGIC, sizeof(header.magic));
+        header.version = gl_stream::VERSION;
+        glGetIntegerv(GL_MAJOR_VERSION, &header.context_major);
+        glGetIntegerv(GL_MINOR_VERSION, &header.context_minor);
+        if (header.context_major > 3 || (header.context_major == 3 && header.context_minor >= 2)) {
+            glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &header.context_profile_mask);
+        }
+        glfwGetFramebufferSize(window, &header.framebuffer_width, &header.framebuffer_height);
+
+        capture = {};
+        capture.file = file;
+        capture.start = Clock::now();
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &capture.unpack_alignment);
+
+        append(&header, sizeof(header));
+        flush();
+        return capture.file != nullptr;
+    }
+
+    void stop() {
+        if (!capture.file) {
+            return;
+        }
+
+        flush();
+        if (capture.file) {
+            std::fclose(capture.file);
+            capture.file = nullptr;
+        }
+
+        printf("GL capture: %llu frames, %.2f MiB written, %.2f of %.2f MiB of payloads deduplicated\n",
+            static_cast<unsigned long long>(capture.frames), to_mib(capture.bytes_written),
+            to_mib(capture.deduplicated_bytes), to_mib(capture.payload_bytes));
+        capture = {};
+    }
+
+    bool is_active() {
+        return capture.file != nullptr;
+    }
+
+    void ActiveTexture(GLenum texture) {
+        glActiveTexture(texture);
+        record(Op::ActiveTexture, texture);
+    }
+
+    void AttachShader(GLuint program, GLuint shader) {
+        glAttachShader(program, shader);
+        record(Op::AttachShader, program, shader);
+    }
+
+    void BeginQuery(GLenum target, GLuint id) {
+        glBeginQuery(target, id);
+        record(Op::BeginQuery, target, id);
+    }
+
+    void BindBuffer(GLenum target, GLuint buffer) {
+        glBindBuffer(target, buffer);
+        record(Op::BindBuffer, target, buffer);
+    }
+
+    void BindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+        glBindBufferBase(target, index, buffer);
+        record(Op::BindBufferBase, target, index, buffer);
+    }
+
+    void BindFramebuffer(GLenum target, GLuint framebuffer) {
+        glBindFramebuffer(target, framebuffer);
+        record(Op::BindFramebuffer, target, framebuffer);
+    }
+
+    void BindTexture(GLenum target, GLuint texture) {
+        glBindTexture(target, texture);
+        record(Op::BindTexture, target, texture);
+    }
+
+    void BindVertexArray(GLuint array) {
+        glBindVertexArray(array);
+        record(Op::BindVertexArray, array);
+    }
+
+    void BlendFunc(GLenum sfactor, GLenum dfactor) {
+        glBlendFunc(sfactor, dfactor);
+        record(Op::BlendFunc, sfactor, dfactor);
+    }
+
+    void BufferData(GLenum target, GLsizeiptr size, void const* data, GLenum usage) {
+        glBufferData(target, size, data, usage);
+        record(Op::BufferData, target, static_cast<i64>(size), write_blob(data, static_cast<u64>(size)), usage);
+    }
+
+    void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void const* data) {
+        glBufferSubData(target, offset, size, data);
+        record(Op::BufferSubData, target, static_cast<i64>(offset), static_cast<i64>(size), write_blob(data, static_cast<u64>(size)));
+    }
+
+    void Clear(GLbitfield mask) {
+        glClear(mask);
+        record(Op::Clear, mask);
+    }
+
+    void ClearBufferSubData(GLenum target, GLenum internal_format, GLintptr offset, GLsizeiptr size, GLenum format, GLenum type, void const* data) {
+        glClearBufferSubData(target, internal_format, offset, size, format, type, data);
+        u32 blob = write_blob(data, get_image_size(1, 1, format, type, 1));
+        record(Op::ClearBufferSubData, target, internal_format, static_cast<i64>(offset), static_cast<i64>(size), format, type, blob);
+    }
+
+    void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+        glClearColor(red, green, blue, alpha);
+        record(Op::ClearColor, red, green, blue, alpha);
+    }
+
+    GLenum ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+        GLenum status = glClientWaitSync(sync, flags, timeout);
+        record(Op::ClientWaitSync, to_handle(sync), flags, static_cast<u64>(timeout));
+        return status;
+    }
+
+    void CompileShader(GLuint shader) {
+        glCompileShader(shader);
+        record(Op::CompileShader, shader);
+    }
+
+    GLuint CreateProgram() {
+        GLuint program = glCreateProgram();
+        record(Op::CreateProgram, program);
+        return program;
+    }
+
+    GLuint CreateShader(GLenum type) {
+        GLuint shader = glCreateShader(type);
+        record(Op::CreateShader, type, shader);
+        return shader;
+    }
+
+    void DeleteBuffers(GLsizei n, GLuint const* buffers) {
+        glDeleteBuffers(n, buffers);
+        record(Op::DeleteBuffers, NameArray{n, buffers});
+    }
+
+    void DeleteFramebuffers(GLsizei n, GLuint const* framebuffers) {
+        glDeleteFramebuffers(n, framebuffers);
+        record(Op::DeleteFramebuffers, NameArray{n, framebuffers});
+    }
+
+    void DeleteProgram(GLuint program) {
+        glDeleteProgram(program);
+        record(Op::DeleteProgram, program);
+    }
+
+    void DeleteQueries(GLsizei n, GLuint const* ids) {
+        glDeleteQueries(n, ids);
+        record(Op::DeleteQueries, NameArray{n, ids});
+    }
+
+    void DeleteShader(GLuint shader) {
+        glDeleteShader(shader);
+        record(Op::DeleteShader, shader);
+    }
+
+    void DeleteSync(GLsync sync) {
+        glDeleteSync(sync);
+        record(Op::DeleteSync, to_handle(sync));
+    }
+
+    void DeleteTextures(GLsizei n, GLuint const* textures) {
+        glDeleteTextures(n, textures);
+        record(Op::DeleteTextures, NameArray{n, textures});
+    }
+
+    void DeleteVertexArrays(GLsizei n, GLuint const* arrays) {
+        glDeleteVertexArrays(n, arrays);
+        record(Op::DeleteVertexArrays, NameArray{n, arrays});
+    }
+
+    void Disable(GLenum cap) {
+        glDisable(cap);
+        record(Op::Disable, cap);
+    }
+
+    void DispatchCompute(GLuint x, GLuint y, GLuint z) {
+        glDispatchCompute(x, y, z);
+        record(Op::DispatchCompute, x, y, z);
+    }
+
+    void DrawArrays(GLenum mode, GLint first, GLsizei count) {
+        glDrawArrays(mode, first, count);
+        record(Op::DrawArrays, mode, first, count);
+    }
+
+    void DrawArraysIndirect(GLenum mode, void const* indirect) {
+        glDrawArraysIndirect(mode, indirect);
+        record(Op::DrawArraysIndirect, mode, to_offset(indirect));
+    }
+
+    // Only element buffers are supported, indices is an offset into the bound one.
+    void DrawElements(GLenum mode, GLsizei count, GLenum type, void const* indices) {
+        glDrawElements(mode, count, type, indices);
+        record(Op::DrawElements, mode, count, type, to_offset(indices));
+    }
+
+    void Enable(GLenum cap) {
+        glEnable(cap);
+        record(Op::Enable, cap);
+    }
+
+    void EnableVertexAttribArray(GLuint index) {
+        glEnableVertexAttribArray(index);
+        record(Op::EnableVertexAttribArray, index);
+    }
+
+    void EndQuery(GLenum target) {
+        glEndQuery(target);
+        record(Op::EndQuery, target);
+    }
+
+    GLsync FenceSync(GLenum condition, GLbitfield flags) {
+        GLsync sync = glFenceSync(condition, flags);
+        record(Op::FenceSync, condition, flags, to_handle(sync));
+        return sync;
+    }
+
+    void FramebufferTexture2D(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture, GLint level) {
+        glFramebufferTexture2D(target, attachment, texture_target, texture, level);
+        record(Op::FramebufferTexture2D, target, attachment, texture_target, texture, level);
+    }
+
+    void GenBuffers(GLsizei n, GLuint* buffers) {
+        glGenBuffers(n, buffers);
+        record(Op::GenBuffers, NameArray{n, buffers});
+    }
+
+    void GenFramebuffers(GLsizei n, GLuint* framebuffers) {
+        glGenFramebuffers(n, framebuffers);
+        record(Op::GenFramebuffers, NameArray{n, framebuffers});
+    }
+
+    void GenQueries(GLsizei n, GLuint* ids) {
+        glGenQueries(n, ids);
+        record(Op::GenQueries, NameArray{n, ids});
+    }
+
+    void GenTextures(GLsizei n, GLuint* textures) {
+        glGenTextures(n, textures);
+        record(Op::GenTextures, NameArray{n, textures});
+    }
+
+    void GenVertexArrays(GLsizei n, GLuint* arrays) {
+        glGenVertexArrays(n, arrays);
+        record(Op::GenVertexArrays, NameArray{n, arrays});
+    }
+
+    // Queries are recorded without their results, replaying them reproduces the stalls they cause.
+    void GetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data) {
+        glGetBufferSubData(target, offset, size, data);
+        record(Op::GetBufferSubData, target, static_cast<i64>(offset), static_cast<i64>(size));
+    }
+
+    void GetIntegerv(GLenum pname, GLint* data) {
+        glGetIntegerv(pname, data);
+        record(Op::GetIntegerv, pname);
+    }
+
+    void GetProgramInfoLog(GLuint program, GLsizei buffer_size, GLsizei* length, GLchar* info_log) {
+        glGetProgramInfoLog(program, buffer_size, length, info_log);
+        record(Op::GetProgramInfoLog, program, buffer_size);
+    }
+
+    void GetProgramiv(GLuint program, GLenum pname, GLint* params) {
+        glGetProgramiv(program, pname, params);
+        record(Op::GetProgramiv, program, pname);
+    }
+
+    void GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) {
+        glGetQueryObjectui64v(id, pname, params);
+        record(Op::GetQueryObjectui64v, id, pname);
+    }
+
+    void GetShaderInfoLog(GLuint shader, GLsizei buffer_size, GLsizei* length, GLchar* info_log) {
+        glGetShaderInfoLog(shader, buffer_size, length, info_log);
+        record(Op::GetShaderInfoLog, shader, buffer_size);
+    }
+
+    void GetShaderiv(GLuint shader, GLenum pname, GLint* params) {
+        glGetShaderiv(shader, pname, params);
+        record(Op::GetShaderiv, shader, pname);
+    }
+
+    // The location is recorded too, the replay maps it to the one its driver hands out.
+    GLint GetUniformLocation(GLuint program, GLchar const* name) {
+        GLint location = glGetUniformLocation(program, name);
+        record(Op::GetUniformLocation, program, write_blob(name, std::strlen(name)), location);
+        return location;
+    }
+
+    void LinkProgram(GLuint program) {
+        glLinkProgram(program);
+        record(Op::LinkProgram, program);
+    }
+
+    // Mapping itself is not recorded, see UnmapBuffer().
+    void* MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+        void* pointer = glMapBufferRange(target, offset, length, access);
+        if (capture.file && pointer) {
+            capture.mappings[target] = Mapping{pointer, offset, length, access};
+        }
+        return pointer;
+    }
+
+    void MaxShaderCompilerThreadsARB(GLuint count) {
+        glMaxShaderCompilerThreadsARB(count);
+        record(Op::MaxShaderCompilerThreads, count);
+    }
+
+    void MemoryBarrier(GLbitfield barriers) {
+        glMemoryBarrier(barriers);
+        record(Op::MemoryBarrier, barriers);
+    }
+
+    // Stands in for both the core and the ARB entry point, the replay picks whichever it has.
+    void MultiDrawElementsIndirectCount(GLenum mode, GLenum type, void const* indirect, GLintptr draw_count, GLsizei max_draw_count, GLsizei stride) {
+        if (GLEW_VERSION_4_6) {
+            glMultiDrawElementsIndirectCount(mode, type, indirect, draw_count, max_draw_count, stride);
+        } else {
+            glMultiDrawElementsIndirectCountARB(mode, type, indirect, draw_count, max_draw_count, stride);
+        }
+        record(Op::MultiDrawElementsIndirectCount, mode, type, to_offset(indirect), static_cast<i64>(draw_count), max_draw_count, stride);
+    }
+
+    void PixelStorei(GLenum pname, GLint param) {
+        glPixelStorei(pname, param);
+        if (pname == GL_UNPACK_ALIGNMENT) {
+            capture.unpack_alignment = param;
+        }
+        record(Op::PixelStorei, pname, param);
+    }
+
+    void PointSize(GLfloat size) {
+        glPointSize(size);
+        record(Op::PointSize, size);
+    }
+
+    void QueryCounter(GLuint id, GLenum target) {
+        glQueryCounter(id, target);
+        record(Op::QueryCounter, id, target);
+    }
+
+    // The strings are joined into one, which is what the replay passes.
+    void ShaderSource(GLuint shader, GLsizei count, GLchar const* const* strings, GLint const* lengths) {
+        glShaderSource(shader, count, strings, lengths);
+        if (!capture.file) {
+            return;
+        }
+
+        std::string source;
+        for (GLsizei i = 0; i < count; ++i) {
+            bool has_length = lengths && lengths[i] >= 0;
+            source.append(strings[i], has_length ? static_cast<std::size_t>(lengths[i]) : std::strlen(strings[i]));
+        }
+        record(Op::ShaderSource, shader, write_blob(source.data(), source.size()));
+    }
+
+    // Pixels have to come from client memory, pixel unpack buffers are not supported.
+    void TexImage2D(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, void const* pixels) {
+        glTexImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+        u32 blob = write_blob(pixels, get_image_size(width, height, format, type, capture.unpack_alignment));
+        record(Op::TexImage2D, target, level, internal_format, width, height, border, format, type, blob);
+    }
+
+    void TexParameteri(GLenum target, GLenum pname, GLint param) {
+        glTexParameteri(target, pname, param);
+        record(Op::TexParameteri, target, pname, param);
+    }
+
+    void TexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void const* pixels) {
+        glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+        u32 blob = write_blob(pixels, get_image_size(width, height, format, type, capture.unpack_alignment));
+        record(Op::TexSubImage2D, target, level, x, y, width, height, format, type, blob);
+    }
+
+    void Uniform1i(GLint location, GLint v0) {
+        glUniform1i(location, v0);
+        record(Op::Uniform1i, location, v0);
+    }
+
+    void Uniform1ui(GLint location, GLuint v0) {
+        glUniform1ui(location, v0);
+        record(Op::Uniform1ui, location, v0);
+    }
+
+    void Uniform4fv(GLint location, GLsizei count, GLfloat const* value) {
+        glUniform4fv(location, count, value);
+        record(Op::Uniform4fv, location, count, write_blob(value, sizeof(GLfloat) * 4 * static_cast<u64>(count)));
+    }
+
+    void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, GLfloat const* value) {
+        glUniformMatrix4fv(location, count, transpose, value);
+        record(Op::UniformMatrix4fv, location, count, transpose, write_blob(value, sizeof(GLfloat) * 16 * static_cast<u64>(count)));
+    }
+
+    // Records the written range as a BufferSubData while it is still mapped, so the replay ends up with the same contents.
+    GLboolean UnmapBuffer(GLenum target) {
+        auto it = capture.mappings.find(target);
+        if (it != capture.mappings.end()) {
+            Mapping mapping = it->second;
+            capture.mappings.erase(it);
+            if (mapping.access & GL_MAP_WRITE_BIT) {
+                u32 blob = write_blob(mapping.pointer, static_cast<u64>(mapping.length));
+                record(Op::BufferSubData, target, static_cast<i64>(mapping.offset), static_cast<i64>(mapping.length), blob);
+            }
+        }
+
+        return glUnmapBuffer(target);
+    }
+
+    void UseProgram(GLuint program) {
+        glUseProgram(program);
+        record(Op::UseProgram, program);
+    }
+
+    // Only vertex buffers are supported, pointer is an offset into the bound one.
+    void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, void const* pointer) {
+        glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+        record(Op::VertexAttribPointer, index, size, type, normalized, stride, to_offset(pointer));
+    }
+
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+        glViewport(x, y, width, height);
+        record(Op::Viewport, x, y, width, height);
+    }
+
+    void SwapBuffers(GLFWwindow* window) {
+        if (capture.file) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - capture.start);
+            record(Op::SwapBuffers, static_cast<u64>(elapsed.count()));
+            ++capture.frames;
+        }
+
+        glfwSwapBuffers(window);
+    }
+
+    u64 get_image_size(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint alignment) {
+        if (width <= 0 || height <= 0) {
+            return 0;
+        }
+
+        u64 components;
+        switch (format) {
+            case GL_RED:
+            case GL_RED_INTEGER:
+            case GL_DEPTH_COMPONENT:
+            case GL_STENCIL_INDEX:
+            case GL_DEPTH_STENCIL:
+                components = 1;
+                break;
+            case GL_RG:
+            case GL_RG_INTEGER:
+                components = 2;
+                break;
+            case GL_RGB:
+            case GL_BGR:
+            case GL_RGB_INTEGER:
+                components = 3;
+                break;
+            default:
+                components = 4;
+                break;
+        }
+
+        // Packed types hold a whole pixel.
+        u64 pixel_size;
+        switch (type) {
+            case GL_UNSIGNED_BYTE:
+            case GL_BYTE:
+                pixel_size = components;
+                break;
+            case GL_UNSIGNED_SHORT:
+            case GL_SHORT:
+            case GL_HALF_FLOAT:
+                pixel_size = components * 2;
+                break;
+            case GL_UNSIGNED_SHORT_5_6_5:
+            case GL_UNSIGNED_SHORT_4_4_4_4:
+            case GL_UNSIGNED_SHORT_5_5_5_1:
+                pixel_size = 2;
+                break;
+            case GL_UNSIGNED_INT_24_8:
+            case GL_UNSIGNED_INT_8_8_8_8:
+            case GL_UNSIGNED_INT_8_8_8_8_REV:
+            case GL_UNSIGNED_INT_2_10_10_10_REV:
+            case GL_UNSIGNED_INT_10F_11F_11F_REV:
+            case GL_UNSIGNED_INT_5_9_9_9_REV:
+                pixel_size = 4;
+                break;
+            case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+                pixel_size = 8;
+                break;
+            default:
+                pixel_size = components * 4;
+                break;
+        }
+
+        // Every row but the last is padded to the alignment.
+        u64 row = static_cast<u64>(width) * pixel_size;
+        u64 step = static_cast<u64>(std::max(alignment, 1));
+        u64 padded_row = (row + step - 1) / step * step;
+        return padded_row * static_cast<u64>(height - 1) + row;
+    }
+}
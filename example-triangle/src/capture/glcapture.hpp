@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+
+#include <GL/glew.h>
+
+#include <util/base.hpp>
+
+struct GLFWwindow;
+
+/*
+ * Records GL calls into a gl_stream capture for replaying them with --replay.
+ *
+ * Building with -DGL_CAPTURE=ON force includes capture/glhooks.hpp into every translation
+ * unit, which redirects the GL functions this application uses (and glfwSwapBuffers, which
+ * delimits frames) to the hooks below. A hook forwards the call and, while a capture is
+ * running, records it with its arguments and payloads. Identical payloads, like a projection
+ * matrix that did not change, are only stored once.
+ *
+ * A GL function without a hook is neither recorded nor replayed: using a new one means
+ * adding a hook, a gl_stream::Op and a case in the replay. Only the thread owning the
+ * context may make GL calls while capturing.
+ */
+namespace gl_capture {
+    // Needs a current context, start right after glewInit() so the capture sees every object being created.
+    NODISCARD bool start(std::string const& path, GLFWwindow* window);
+    // Writes out what is left. Captures that were not stopped are truncated but still replay up to the last record.
+    void stop();
+    NODISCARD bool is_active();
+
+    void ActiveTexture(GLenum texture);
+    void AttachShader(GLuint program, GLuint shader);
+    void BeginQuery(GLenum target, GLuint id);
+    void BindBuffer(GLenum target, GLuint buffer);
+    void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void BindFramebuffer(GLenum target, GLuint framebuffer);
+    void BindTexture(GLenum target, GLuint texture);
+    void BindVertexArray(GLuint array);
+    void BlendFunc(GLenum sfactor, GLenum dfactor);
+    void BufferData(GLenum target, GLsizeiptr size, void const* data, GLenum usage);
+    void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void const* data);
+    void Clear(GLbitfield mask);
+    void ClearBufferSubData(GLenum target, GLenum internal_format, GLintptr offset, GLsizeiptr size, GLenum format, GLenum type, void const* data);
+    void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+    GLenum ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+    void CompileShader(GLuint shader);
+    GLuint CreateProgram();
+    GLuint CreateShader(GLenum type);
+    void DeleteBuffers(GLsizei n, GLuint const* buffers);
+    void DeleteFramebuffers(GLsizei n, GLuint const* framebuffers);
+    void DeleteProgram(GLuint program);
+    void DeleteQueries(GLsizei n, GLuint const* ids);
+    void DeleteShader(GLuint shader);
+    void DeleteSync(GLsync sync);
+    void DeleteTextures(GLsizei n, GLuint const* textures);
+    void DeleteVertexArrays(GLsizei n, GLuint const* arrays);
+    void Disable(GLenum cap);
+    void DispatchCompute(GLuint x, GLuint y, GLuint z);
+    void DrawArrays(GLenum mode, GLint first, GLsizei count);
+    void DrawArraysIndirect(GLenum mode, void const* indirect);
+    void DrawElements(GLenum mode, GLsizei count, GLenum type, void const* indices);
+    void Enable(GLenum cap);
+    void EnableVertexAttribArray(GLuint index);
+    void EndQuery(GLenum target);
+    GLsync FenceSync(GLenum condition, GLbitfield flags);
+    void FramebufferTexture2D(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture, GLint level);
+    void GenBuffers(GLsizei n, GLuint* buffers);
+    void GenFramebuffers(GLsizei n, GLuint* framebuffers);
+    void GenQueries(GLsizei n, GLuint* ids);
+    void GenTextures(GLsizei n, GLuint* textures);
+    void GenVertexArrays(GLsizei n, GLuint* arrays);
+    void GetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data);
+    void GetIntegerv(GLenum pname, GLint* data);
+    void GetProgramInfoLog(GLuint program, GLsizei buffer_size, GLsizei* length, GLchar* info_log);
+    void GetProgramiv(GLuint program, GLenum pname, GLint* params);
+    void GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params);
+    void GetShaderInfoLog(GLuint shader, GLsizei buffer_size, GLsizei* length, GLchar* info_log);
+    void GetShaderiv(GLuint shader, GLenum pname, GLint* params);
+    GLint GetUniformLocation(GLuint program, GLchar const* name);
+    void LinkProgram(GLuint program);
+    void* MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+    void MaxShaderCompilerThreadsARB(GLuint count);
+    void MemoryBarrier(GLbitfield barriers);
+    void MultiDrawElementsIndirectCount(GLenum mode, GLenum type, void const* indirect, GLintptr draw_count, GLsizei max_draw_count, GLsizei stride);
+    void PixelStorei(GLenum pname, GLint param);
+    void PointSize(GLfloat size);
+    void QueryCounter(GLuint id, GLenum target);
+    void ShaderSource(GLuint shader, GLsizei count, GLchar const* const* strings, GLint const* lengths);
+    void TexImage2D(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, void const* pixels);
+    void TexParameteri(GLenum target, GLenum pname, GLint param);
+    void TexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void const* pixels);
+    void Uniform1i(GLint location, GLint v0);
+    void Uniform1ui(GLint location, GLuint v0);
+    void Uniform4fv(GLint location, GLsizei count, GLfloat const* value);
+    void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, GLfloat const* value);
+    GLboolean UnmapBuffer(GLenum target);
+    void UseProgram(GLuint program);
+    void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, void const* pointer);
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    void SwapBuffers(GLFWwindow* window);
+
+    // Bytes glTexImage2D and friends read for an image, given the current GL_UNPACK_ALIGNMENT.
+    NODISCARD u64 get_image_size(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint alignment);
+}
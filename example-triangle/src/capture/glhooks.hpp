@@ -0,0 +1,164 @@
+#pragma once
+
+/*
+ * Force included into every translation unit when building with GL_CAPTURE, see
+ * capture/glcapture.hpp. The capture sources themselves are compiled with
+ * GL_CAPTURE_IMPLEMENTATION, they need the real functions.
+ *
+ * GLEW and GLFW are included first so their declarations keep the real names, later
+ * includes of them do nothing.
+ */
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#if defined(GL_CAPTURE) && !defined(GL_CAPTURE_IMPLEMENTATION)
+
+#include <capture/glcapture.hpp>
+
+// Most of these are GLEW macros for function pointers, the GL 1.1 ones are plain functions.
+#undef glActiveTexture
+#undef glAttachShader
+#undef glBeginQuery
+#undef glBindBuffer
+#undef glBindBufferBase
+#undef glBindFramebuffer
+#undef glBindTexture
+#undef glBindVertexArray
+#undef glBlendFunc
+#undef glBufferData
+#undef glBufferSubData
+#undef glClear
+#undef glClearBufferSubData
+#undef glClearColor
+#undef glClientWaitSync
+#undef glCompileShader
+#undef glCreateProgram
+#undef glCreateShader
+#undef glDeleteBuffers
+#undef glDeleteFramebuffers
+#undef glDeleteProgram
+#undef glDeleteQueries
+#undef glDeleteShader
+#undef glDeleteSync
+#undef glDeleteTextures
+#undef glDeleteVertexArrays
+#undef glDisable
+#undef glDispatchCompute
+#undef glDrawArrays
+#undef glDrawArraysIndirect
+#undef glDrawElements
+#undef glEnable
+#undef glEnableVertexAttribArray
+#undef glEndQuery
+#undef glFenceSync
+#undef glFramebufferTexture2D
+#undef glGenBuffers
+#undef glGenFramebuffers
+#undef glGenQueries
+#undef glGenTextures
+#undef glGenVertexArrays
+#undef glGetBufferSubData
+#undef glGetIntegerv
+#undef glGetProgramInfoLog
+#undef glGetProgramiv
+#undef glGetQueryObjectui64v
+#undef glGetShaderInfoLog
+#undef glGetShaderiv
+#undef glGetUniformLocation
+#undef glLinkProgram
+#undef glMapBufferRange
+#undef glMaxShaderCompilerThreadsARB
+#undef glMemoryBarrier
+#undef glMultiDrawElementsIndirectCount
+#undef glMultiDrawElementsIndirectCountARB
+#undef glPixelStorei
+#undef glPointSize
+#undef glQueryCounter
+#undef glShaderSource
+#undef glTexImage2D
+#undef glTexParameteri
+#undef glTexSubImage2D
+#undef glUniform1i
+#undef glUniform1ui
+#undef glUniform4fv
+#undef glUniformMatrix4fv
+#undef glUnmapBuffer
+#undef glUseProgram
+#undef glVertexAttribPointer
+#undef glViewport
+
+#define glActiveTexture gl_capture::ActiveTexture
+#define glAttachShader gl_capture::AttachShader
+#define glBeginQuery gl_capture::BeginQuery
+#define glBindBuffer gl_capture::BindBuffer
+#define glBindBufferBase gl_capture::BindBufferBase
+#define glBindFramebuffer gl_capture::BindFramebuffer
+#define glBindTexture gl_capture::BindTexture
+#define glBindVertexArray gl_capture::BindVertexArray
+#define glBlendFunc gl_capture::BlendFunc
+#define glBufferData gl_capture::BufferData
+#define glBufferSubData gl_capture::BufferSubData
+#define glClear gl_capture::Clear
+#define glClearBufferSubData gl_capture::ClearBufferSubData
+#define glClearColor gl_capture::ClearColor
+#define glClientWaitSync gl_capture::ClientWaitSync
+#define glCompileShader gl_capture::CompileShader
+#define glCreateProgram gl_capture::CreateProgram
+#define glCreateShader gl_capture::CreateShader
+#define glDeleteBuffers gl_capture::DeleteBuffers
+#define glDeleteFramebuffers gl_capture::DeleteFramebuffers
+#define glDeleteProgram gl_capture::DeleteProgram
+#define glDeleteQueries gl_capture::DeleteQueries
+#define glDeleteShader gl_capture::DeleteShader
+#define glDeleteSync gl_capture::DeleteSync
+#define glDeleteTextures gl_capture::DeleteTextures
+#define glDeleteVertexArrays gl_capture::DeleteVertexArrays
+#define glDisable gl_capture::Disable
+#define glDispatchCompute gl_capture::DispatchCompute
+#define glDrawArrays gl_capture::DrawArrays
+#define glDrawArraysIndirect gl_capture::DrawArraysIndirect
+#define glDrawElements gl_capture::DrawElements
+#define glEnable gl_capture::Enable
+#define glEnableVertexAttribArray gl_capture::EnableVertexAttribArray
+#define glEndQuery gl_capture::EndQuery
+#define glFenceSync gl_capture::FenceSync
+#define glFramebufferTexture2D gl_capture::FramebufferTexture2D
+#define glGenBuffers gl_capture::GenBuffers
+#define glGenFramebuffers gl_capture::GenFramebuffers
+#define glGenQueries gl_capture::GenQueries
+#define glGenTextures gl_capture::GenTextures
+#define glGenVertexArrays gl_capture::GenVertexArrays
+#define glGetBufferSubData gl_capture::GetBufferSubData
+#define glGetIntegerv gl_capture::GetIntegerv
+#define glGetProgramInfoLog gl_capture::GetProgramInfoLog
+#define glGetProgramiv gl_capture::GetProgramiv
+#define glGetQueryObjectui64v gl_capture::GetQueryObjectui64v
+#define glGetShaderInfoLog gl_capture::GetShaderInfoLog
+#define glGetShaderiv gl_capture::GetShaderiv
+#define glGetUniformLocation gl_capture::GetUniformLocation
+#define glLinkProgram gl_capture::LinkProgram
+#define glMapBufferRange gl_capture::MapBufferRange
+#define glMaxShaderCompilerThreadsARB gl_capture::MaxShaderCompilerThreadsARB
+#define glMemoryBarrier gl_capture::MemoryBarrier
+#define glMultiDrawElementsIndirectCount gl_capture::MultiDrawElementsIndirectCount
+#define glMultiDrawElementsIndirectCountARB gl_capture::MultiDrawElementsIndirectCount
+#define glPixelStorei gl_capture::PixelStorei
+#define glPointSize gl_capture::PointSize
+#define glQueryCounter gl_capture::QueryCounter
+#define glShaderSource gl_capture::ShaderSource
+#define glTexImage2D gl_capture::TexImage2D
+#define glTexParameteri gl_capture::TexParameteri
+#define glTexSubImage2D gl_capture::TexSubImage2D
+#define glUniform1i gl_capture::Uniform1i
+#define glUniform1ui gl_capture::Uniform1ui
+#define glUniform4fv gl_capture::Uniform4fv
+#define glUniformMatrix4fv gl_capture::UniformMatrix4fv
+#define glUnmapBuffer gl_capture::UnmapBuffer
+#define glUseProgram gl_capture::UseProgram
+#define glVertexAttribPointer gl_capture::VertexAttribPointer
+#define glViewport gl_capture::Viewport
+
+#define glfwSwapBuffers gl_capture::SwapBuffers
+
+#endif
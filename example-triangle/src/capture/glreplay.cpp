@@ -0,0 +1,751 @@
+#include "glreplay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <capture/glstream.hpp>
+#include <util/base.hpp>
+#include <util/precisesleep.hpp>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using gl_stream::Op;
+
+    using NameMap = std::unordered_map<GLuint, GLuint>;
+
+    class GlReplay {
+    public:
+        GlReplay(std::vector<u8> data, GLFWwindow* window, bool original_timing) :
+            _data{std::move(data)},
+            _cursor{sizeof(gl_stream::Header)},
+            _failed{false},
+            _window{window},
+            _original_timing{original_timing},
+            _blobs{},
+            _buffers{},
+            _textures{},
+            _vertex_arrays{},
+            _framebuffers{},
+            _queries{},
+            _programs{},
+            _syncs{},
+            _locations{},
+            _current_program{0},
+            _scratch(1024),
+            _frame_ms{},
+            _calls{0},
+            _captured_ns{0} {
+
+        }
+
+        // Returns false if the stream is damaged, everything up to the damage has been replayed.
+        bool run() {
+            _start = Clock::now();
+            _last_frame = _start;
+
+            while (_cursor < _data.size()) {
+                auto op = static_cast<Op>(read<u16>());
+                if (_failed || !execute(op)) {
+                    printf("Replay: damaged stream at byte %zu.\n", _cursor);
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void print_results() const {
+            if (_frame_ms.empty()) {
+                printf("Replay: no frames.\n");
+                return;
+            }
+
+            std::vector<f64> sorted = _frame_ms;
+            std::sort(sorted.begin(), sorted.end());
+
+            f64 total = 0.0;
+            for (f64 ms : sorted) {
+                total += ms;
+            }
+
+            std::size_t count = sorted.size();
+            printf("Replay: %zu frames, %llu calls in %.3f s (captured in %.3f s)\n", count,
+                static_cast<unsigned long long>(_calls), total / 1000.0, static_cast<f64>(_captured_ns) / 1e9);
+            printf("Frame: mean %.3f ms, min %.3f ms, median %.3f ms, 99th %.3f ms, max %.3f ms\n",
+                total / static_cast<f64>(count), sorted.front(), sorted[count / 2], sorted[count * 99 / 100], sorted.back());
+        }
+
+    private:
+        template<typename T>
+        T read() {
+            T value{};
+            if (_cursor + sizeof(T) > _data.size()) {
+                _failed = true;
+                return value;
+            }
+
+            std::memcpy(&value, _data.data() + _cursor, sizeof(T));
+            _cursor += sizeof(T);
+            return value;
+        }
+
+        // Reads an inline name array and maps it, generate creates the replay's own names first.
+        std::vector<GLuint> read_names(NameMap& names, void (*generate)(GLsizei, GLuint*)) {
+            auto count = read<i32>();
+            std::vector<GLuint> recorded;
+            for (i32 i = 0; i < count && !_failed; ++i) {
+                recorded.push_back(read<GLuint>());
+            }
+
+            std::vector<GLuint> mapped(recorded.size());
+            if (generate) {
+                generate(static_cast<GLsizei>(mapped.size()), mapped.data());
+                for (std::size_t i = 0; i < recorded.size(); ++i) {
+                    names[recorded[i]] = mapped[i];
+                }
+            } else {
+                for (std::size_t i = 0; i < recorded.size(); ++i) {
+                    mapped[i] = map(names, recorded[i]);
+                    names.erase(recorded[i]);
+                }
+            }
+
+            return mapped;
+        }
+
+        void const* read_blob() {
+            auto id = read<u32>();
+            if (id == gl_stream::NULL_BLOB || _failed) {
+                return nullptr;
+            }
+
+            if (id >= _blobs.size()) {
+                _failed = true;
+                return nullptr;
+            }
+            return _data.data() + _blobs[id].first;
+        }
+
+        u64 blob_size(u32 id) const {
+            return id < _blobs.size() ? _blobs[id].second : 0;
+        }
+
+        // Names the capture never saw being created pass through unchanged, 0 stays 0.
+        static GLuint map(NameMap const& names, GLuint name) {
+            auto it = names.find(name);
+            return it != names.end() ? it->second : name;
+        }
+
+        GLsync map_sync(u64 handle) const {
+            auto it = _syncs.find(handle);
+            return it != _syncs.end() ? it->second : nullptr;
+        }
+
+        // Uniform locations belong to the program that is in use.
+        GLint map_location(GLint location) const {
+            auto it = _locations.find(location_key(_current_program, location));
+            return it != _locations.end() ? it->second : location;
+        }
+
+        static u64 location_key(GLuint program, GLint location) {
+            return (static_cast<u64>(program) << 32) | static_cast<u32>(location);
+        }
+
+        void* scratch(std::size_t size) {
+            if (_scratch.size() < size) {
+                _scratch.resize(size);
+            }
+            return _scratch.data();
+        }
+
+        bool execute(Op op) {
+            if (op != Op::Blob && op != Op::SwapBuffers) {
+                ++_calls;
+            }
+
+            switch (op) {
+                case Op::Blob: {
+                    auto id = read<u32>();
+                    auto size = read<u64>();
+                    if (_failed || id != _blobs.size() || _cursor + size > _data.size()) {
+                        return false;
+                    }
+                    _blobs.push_back({_cursor, size});
+                    _cursor += size;
+                    break;
+                }
+                case Op::SwapBuffers: {
+                    auto timestamp = read<u64>();
+                    if (_original_timing) {
+                        precise_sleep_until(_start + std::chrono::nanoseconds{timestamp});
+                    }
+                    glfwSwapBuffers(_window);
+
+                    auto now = Clock::now();
+                    _frame_ms.push_back(std::chrono::duration<f64, std::milli>(now - _last_frame).count());
+                    _last_frame = now;
+                    _captured_ns = timestamp;
+                    break;
+                }
+                case Op::ActiveTexture: {
+                    auto texture = read<GLenum>();
+                    glActiveTexture(texture);
+                    break;
+                }
+                case Op::AttachShader: {
+                    auto program = read<GLuint>();
+                    auto shader = read<GLuint>();
+                    glAttachShader(map(_programs, program), map(_programs, shader));
+                    break;
+                }
+                case Op::BeginQuery: {
+                    auto target = read<GLenum>();
+                    auto id = read<GLuint>();
+                    glBeginQuery(target, map(_queries, id));
+                    break;
+                }
+                case Op::BindBuffer: {
+                    auto target = read<GLenum>();
+                    auto buffer = read<GLuint>();
+                    glBindBuffer(target, map(_buffers, buffer));
+                    break;
+                }
+                case Op::BindBufferBase: {
+                    auto target = read<GLenum>();
+                    auto index = read<GLuint>();
+                    auto buffer = read<GLuint>();
+                    glBindBufferBase(target, index, map(_buffers, buffer));
+                    break;
+                }
+                case Op::BindFramebuffer: {
+                    auto target = read<GLenum>();
+                    auto framebuffer = read<GLuint>();
+                    glBindFramebuffer(target, map(_framebuffers, framebuffer));
+                    break;
+                }
+                case Op::BindTexture: {
+                    auto target = read<GLenum>();
+                    auto texture = read<GLuint>();
+                    glBindTexture(target, map(_textures, texture));
+                    break;
+                }
+                case Op::BindVertexArray: {
+                    auto array = read<GLuint>();
+                    glBindVertexArray(map(_vertex_arrays, array));
+                    break;
+                }
+                case Op::BlendFunc: {
+                    auto sfactor = read<GLenum>();
+                    auto dfactor = read<GLenum>();
+                    glBlendFunc(sfactor, dfactor);
+                    break;
+                }
+                case Op::BufferData: {
+                    auto target = read<GLenum>();
+                    auto size = read<i64>();
+                    void const* data = read_blob();
+                    auto usage = read<GLenum>();
+                    glBufferData(target, size, data, usage);
+                    break;
+                }
+                case Op::BufferSubData: {
+                    auto target = read<GLenum>();
+                    auto offset = read<i64>();
+                    auto size = read<i64>();
+                    void const* data = read_blob();
+                    glBufferSubData(target, offset, size, data);
+                    break;
+                }
+                case Op::Clear: {
+                    auto mask = read<GLbitfield>();
+                    glClear(mask);
+                    break;
+                }
+                case Op::ClearBufferSubData: {
+                    auto target = read<GLenum>();
+                    auto internal_format = read<GLenum>();
+                    auto offset = read<i64>();
+                    auto size = read<i64>();
+                    auto format = read<GLenum>();
+                    auto type = read<GLenum>();
+                    void const* data = read_blob();
+                    glClearBufferSubData(target, internal_format, offset, size, format, type, data);
+                    break;
+                }
+                case Op::ClearColor: {
+                    auto red = read<GLfloat>();
+                    auto green = read<GLfloat>();
+                    auto blue = read<GLfloat>();
+                    auto alpha = read<GLfloat>();
+                    glClearColor(red, green, blue, alpha);
+                    break;
+                }
+                case Op::ClientWaitSync: {
+                    auto sync = read<u64>();
+                    auto flags = read<GLbitfield>();
+                    auto timeout = read<u64>();
+                    if (GLsync mapped = map_sync(sync)) {
+                        glClientWaitSync(mapped, flags, timeout);
+                    }
+                    break;
+                }
+                case Op::CompileShader: {
+                    auto shader = read<GLuint>();
+                    glCompileShader(map(_programs, shader));
+                    break;
+                }
+                case Op::CreateProgram: {
+                    auto program = read<GLuint>();
+                    _programs[program] = glCreateProgram();
+                    break;
+                }
+                case Op::CreateShader: {
+                    auto type = read<GLenum>();
+                    auto shader = read<GLuint>();
+                    _programs[shader] = glCreateShader(type);
+                    break;
+                }
+                case Op::DeleteBuffers: {
+                    std::vector<GLuint> names = read_names(_buffers, nullptr);
+                    glDeleteBuffers(static_cast<GLsizei>(names.size()), names.data());
+                    break;
+                }
+                case Op::DeleteFramebuffers: {
+                    std::vector<GLuint> names = read_names(_framebuffers, nullptr);
+                    glDeleteFramebuffers(static_cast<GLsizei>(names.size()), names.data());
+                    break;
+                }
+                case Op::DeleteProgram: {
+                    auto program = read<GLuint>();
+                    glDeleteProgram(map(_programs, program));
+                    _programs.erase(program);
+                    break;
+                }
+                case Op::DeleteQueries: {
+                    std::vector<GLuint> names = read_names(_queries, nullptr);
+                    glDeleteQueries(static_cast<GLsizei>(names.size()), names.data());
+                    break;
+                }
+                case Op::DeleteShader: {
+                    auto shader = read<GLuint>();
+                    glDeleteShader(map(_programs, shader));
+                    _programs.erase(shader);
+                    break;
+                }
+                case Op::DeleteSync: {
+                    auto sync = read<u64>();
+                    glDeleteSync(map_sync(sync));
+                    _syncs.erase(sync);
+                    break;
+                }
+                case Op::DeleteTextures: {
+                    std::vector<GLuint> names = read_names(_textures, nullptr);
+                    glDeleteTextures(static_cast<GLsizei>(names.size()), names.data());
+                    break;
+                }
+                case Op::DeleteVertexArrays: {
+                    std::vector<GLuint> names = read_names(_vertex_arrays, nullptr);
+                    glDeleteVertexArrays(static_cast<GLsizei>(names.size()), names.data());
+                    break;
+                }
+                case Op::Disable: {
+                    auto cap = read<GLenum>();
+                    glDisable(cap);
+                    break;
+                }
+                case Op::DispatchCompute: {
+                    auto x = read<GLuint>();
+                    auto y = read<GLuint>();
+                    auto z = read<GLuint>();
+                    glDispatchCompute(x, y, z);
+                    break;
+                }
+                case Op::DrawArrays: {
+                    auto mode = read<GLenum>();
+                    auto first = read<GLint>();
+                    auto count = read<GLsizei>();
+                    glDrawArrays(mode, first, count);
+                    break;
+                }
+                case Op::DrawArraysIndirect: {
+                    auto mode = read<GLenum>();
+                    auto offset = read<u64>();
+                    glDrawArraysIndirect(mode, reinterpret_cast<void const*>(offset));
+                    break;
+                }
+                case Op::DrawElements: {
+                    auto mode = read<GLenum>();
+                    auto count = read<GLsizei>();
+                    auto type = read<GLenum>();
+                    auto offset = read<u64>();
+                    glDrawElements(mode, count, type, reinterpret_cast<void const*>(offset));
+                    break;
+                }
+                case Op::Enable: {
+                    auto cap = read<GLenum>();
+                    glEnable(cap);
+                    break;
+                }
+                case Op::EnableVertexAttribArray: {
+                    auto index = read<GLuint>();
+                    glEnableVertexAttribArray(index);
+                    break;
+                }
+                case Op::EndQuery: {
+                    auto target = read<GLenum>();
+                    glEndQuery(target);
+                    break;
+                }
+                case Op::FenceSync: {
+                    auto condition = read<GLenum>();
+                    auto flags = read<GLbitfield>();
+                    auto sync = read<u64>();
+                    _syncs[sync] = glFenceSync(condition, flags);
+                    break;
+                }
+                case Op::FramebufferTexture2D: {
+                    auto target = read<GLenum>();
+                    auto attachment = read<GLenum>();
+                    auto texture_target = read<GLenum>();
+                    auto texture = read<GLuint>();
+                    auto level = read<GLint>();
+                    glFramebufferTexture2D(target, attachment, texture_target, map(_textures, texture), level);
+                    break;
+                }
+                case Op::GenBuffers:
+                    (void)read_names(_buffers, [](GLsizei n, GLuint* names) { glGenBuffers(n, names); });
+                    break;
+                case Op::GenFramebuffers:
+                    (void)read_names(_framebuffers, [](GLsizei n, GLuint* names) { glGenFramebuffers(n, names); });
+                    break;
+                case Op::GenQueries:
+                    (void)read_names(_queries, [](GLsizei n, GLuint* names) { glGenQueries(n, names); });
+                    break;
+                case Op::GenTextures:
+                    (void)read_names(_textures, [](GLsizei n, GLuint* names) { glGenTextures(n, names); });
+                    break;
+                case Op::GenVertexArrays:
+                    (void)read_names(_vertex_arrays, [](GLsizei n, GLuint* names) { glGenVertexArrays(n, names); });
+                    break;
+                case Op::GetBufferSubData: {
+                    auto target = read<GLenum>();
+                    auto offset = read<i64>();
+                    auto size = read<i64>();
+                    glGetBufferSubData(target, offset, size, scratch(static_cast<std::size_t>(size)));
+                    break;
+                }
+                case Op::GetIntegerv: {
+                    auto pname = read<GLenum>();
+                    glGetIntegerv(pname, static_cast<GLint*>(scratch(64 * sizeof(GLint))));
+                    break;
+                }
+                case Op::GetProgramInfoLog: {
+                    auto program = read<GLuint>();
+                    auto buffer_size = read<GLsizei>();
+                    glGetProgramInfoLog(map(_programs, program), buffer_size, nullptr, static_cast<GLchar*>(scratch(static_cast<std::size_t>(buffer_size))));
+                    break;
+                }
+                case Op::GetProgramiv: {
+                    auto program = read<GLuint>();
+                    auto pname = read<GLenum>();
+                    glGetProgramiv(map(_programs, program), pname, static_cast<GLint*>(scratch(sizeof(GLint) * 4)));
+                    break;
+                }
+                case Op::GetQueryObjectui64v: {
+                    auto id = read<GLuint>();
+                    auto pname = read<GLenum>();
+                    glGetQueryObjectui64v(map(_queries, id), pname, static_cast<GLuint64*>(scratch(sizeof(GLuint64))));
+                    break;
+                }
+                case Op::GetShaderInfoLog: {
+                    auto shader = read<GLuint>();
+                    auto buffer_size = read<GLsizei>();
+                    glGetShaderInfoLog(map(_programs, shader), buffer_size, nullptr, static_cast<GLchar*>(scratch(static_cast<std::size_t>(buffer_size))));
+                    break;
+                }
+                case Op::GetShaderiv: {
+                    auto shader = read<GLuint>();
+                    auto pname = read<GLenum>();
+                    glGetShaderiv(map(_programs, shader), pname, static_cast<GLint*>(scratch(sizeof(GLint) * 4)));
+                    break;
+                }
+                case Op::GetUniformLocation: {
+                    auto program = read<GLuint>();
+                    auto id = read<u32>();
+                    auto location = read<GLint>();
+                    if (_failed || id >= _blobs.size()) {
+                        return false;
+                    }
+
+                    auto const* name = reinterpret_cast<char const*>(_data.data() + _blobs[id].first);
+                    std::string terminated{name, static_cast<std::size_t>(blob_size(id))};
+                    _locations[location_key(program, location)] = glGetUniformLocation(map(_programs, program), terminated.c_str());
+                    break;
+                }
+                case Op::LinkProgram: {
+                    auto program = read<GLuint>();
+                    glLinkProgram(map(_programs, program));
+                    break;
+                }
+                case Op::MaxShaderCompilerThreads: {
+                    auto count = read<GLuint>();
+                    if (GLEW_ARB_parallel_shader_compile) {
+                        glMaxShaderCompilerThreadsARB(count);
+                    }
+                    break;
+                }
+                case Op::MemoryBarrier: {
+                    auto barriers = read<GLbitfield>();
+                    glMemoryBarrier(barriers);
+                    break;
+                }
+                case Op::MultiDrawElementsIndirectCount: {
+                    auto mode = read<GLenum>();
+                    auto type = read<GLenum>();
+                    auto indirect = read<u64>();
+                    auto draw_count = read<i64>();
+                    auto max_draw_count = read<GLsizei>();
+                    auto stride = read<GLsizei>();
+                    if (GLEW_VERSION_4_6) {
+                        glMultiDrawElementsIndirectCount(mode, type, reinterpret_cast<void const*>(indirect), draw_count, max_draw_count, stride);
+                    } else {
+                        glMultiDrawElementsIndirectCountARB(mode, type, reinterpret_cast<void const*>(indirect), draw_count, max_draw_count, stride);
+                    }
+                    break;
+                }
+                case Op::PixelStorei: {
+                    auto pname = read<GLenum>();
+                    auto param = read<GLint>();
+                    glPixelStorei(pname, param);
+                    break;
+                }
+                case Op::PointSize: {
+                    auto size = read<GLfloat>();
+                    glPointSize(size);
+                    break;
+                }
+                case Op::QueryCounter: {
+                    auto id = read<GLuint>();
+                    auto target = read<GLenum>();
+                    glQueryCounter(map(_queries, id), target);
+                    break;
+                }
+                case Op::ShaderSource: {
+                    auto shader = read<GLuint>();
+                    auto id = read<u32>();
+                    if (_failed || id >= _blobs.size()) {
+                        return false;
+                    }
+
+                    auto const* source = reinterpret_cast<GLchar const*>(_data.data() + _blobs[id].first);
+                    auto length = static_cast<GLint>(blob_size(id));
+                    glShaderSource(map(_programs, shader), 1, &source, &length);
+                    break;
+                }
+                case Op::TexImage2D: {
+                    auto target = read<GLenum>();
+                    auto level = read<GLint>();
+                    auto internal_format = read<GLint>();
+                    auto width = read<GLsizei>();
+                    auto height = read<GLsizei>();
+                    auto border = read<GLint>();
+                    auto format = read<GLenum>();
+                    auto type = read<GLenum>();
+                    void const* pixels = read_blob();
+                    glTexImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+                    break;
+                }
+                case Op::TexParameteri: {
+                    auto target = read<GLenum>();
+                    auto pname = read<GLenum>();
+                    auto param = read<GLint>();
+                    glTexParameteri(target, pname, param);
+                    break;
+                }
+                case Op::TexSubImage2D: {
+                    auto target = read<GLenum>();
+                    auto level = read<GLint>();
+                    auto x = read<GLint>();
+                    auto y = read<GLint>();
+                    auto width = read<GLsizei>();
+                    auto height = read<GLsizei>();
+                    auto format = read<GLenum>();
+                    auto type = read<GLenum>();
+                    void const* pixels = read_blob();
+                    glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+                    break;
+                }
+                case Op::Uniform1i: {
+                    auto location = read<GLint>();
+                    auto v0 = read<GLint>();
+                    glUniform1i(map_location(location), v0);
+                    break;
+                }
+                case Op::Uniform1ui: {
+                    auto location = read<GLint>();
+                    auto v0 = read<GLuint>();
+                    glUniform1ui(map_location(location), v0);
+                    break;
+                }
+                case Op::Uniform4fv: {
+                    auto location = read<GLint>();
+                    auto count = read<GLsizei>();
+                    auto const* value = static_cast<GLfloat const*>(read_blob());
+                    glUniform4fv(map_location(location), count, value);
+                    break;
+                }
+                case Op::UniformMatrix4fv: {
+                    auto location = read<GLint>();
+                    auto count = read<GLsizei>();
+                    auto transpose = read<GLboolean>();
+                    auto const* value = static_cast<GLfloat const*>(read_blob());
+                    glUniformMatrix4fv(map_location(location), count, transpose, value);
+                    break;
+                }
+                case Op::UseProgram: {
+                    auto program = read<GLuint>();
+                    _current_program = program;
+                    glUseProgram(map(_programs, program));
+                    break;
+                }
+                case Op::VertexAttribPointer: {
+                    auto index = read<GLuint>();
+                    auto size = read<GLint>();
+                    auto type = read<GLenum>();
+                    auto normalized = read<GLboolean>();
+                    auto stride = read<GLsizei>();
+                    auto offset = read<u64>();
+                    glVertexAttribPointer(index, size, type, normalized, stride, reinterpret_cast<void const*>(offset));
+                    break;
+                }
+                case Op::Viewport: {
+                    auto x = read<GLint>();
+                    auto y = read<GLint>();
+                    auto width = read<GLsizei>();
+                    auto height = read<GLsizei>();
+                    glViewport(x, y, width, height);
+                    break;
+                }
+                default:
+                    return false;
+            }
+
+            return !_failed;
+        }
+
+    private:
+        std::vector<u8> _data;
+        std::size_t _cursor;
+        bool _failed;
+
+        GLFWwindow* _window;
+        bool _original_timing;
+
+        // Offset into _data and size of every blob, by id.
+        std::vector<std::pair<std::size_t, u64>> _blobs;
+
+        // Recorded names to the replay's, shaders and programs share theirs like in GL.
+        NameMap _buffers;
+        NameMap _textures;
+        NameMap _vertex_arrays;
+        NameMap _framebuffers;
+        NameMap _queries;
+        NameMap _programs;
+        std::unordered_map<u64, GLsync> _syncs;
+        std::unordered_map<u64, GLint> _locations;
+        GLuint _current_program;
+
+        // Destination of queries, their results are not needed.
+        std::vector<u8> _scratch;
+
+        std::vector<f64> _frame_ms;
+        u64 _calls;
+        u64 _captured_ns;
+        Clock::time_point _start;
+        Clock::time_point _last_frame;
+    };
+
+    bool read_file(std::string const& path, std::vector<u8>& data) {
+        std::ifstream file{path, std::ios::binary | std::ios::ate};
+        if (!file) {
+            return false;
+        }
+
+        data.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())));
+    }
+}
+
+int run_replay(std::string const& path, bool original_timing) {
+    std::vector<u8> data;
+    if (!read_file(path, data)) {
+        printf("Could not read %s!\n", path.c_str());
+        return 1;
+    }
+
+    gl_stream::Header header{};
+    if (data.size() < sizeof(header)) {
+        printf("%s is not a GL capture.\n", path.c_str());
+        return 1;
+    }
+
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, gl_stream::MAGIC, sizeof(header.magic)) != 0 || header.version != gl_stream::VERSION) {
+        printf("%s is not a GL capture of version %u.\n", path.c_str(), gl_stream::VERSION);
+        return 1;
+    }
+
+    if (!glfwInit()) {
+        printf("Could not init GLFW!\n");
+        return 1;
+    }
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, header.context_major);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, header.context_minor);
+    if (header.context_profile_mask & GL_CONTEXT_CORE_PROFILE_BIT) {
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    } else if (header.context_profile_mask & GL_CONTEXT_COMPATIBILITY_PROFILE_BIT) {
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
+    }
+
+    GLFWwindow* window = glfwCreateWindow(std::max(header.framebuffer_width, 1), std::max(header.framebuffer_height, 1), "GL replay", nullptr, nullptr);
+    if (!window) {
+        printf("Could not create an OpenGL %d.%d context!\n", header.context_major, header.context_minor);
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK) {
+        printf("Could not init GLEW!\n");
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // Frames are paced by the stream with original timing, and as fast as possible otherwise.
+    glfwSwapInterval(0);
+
+    bool intact;
+    {
+        GlReplay replay{std::move(data), window, original_timing};
+        intact = replay.run();
+        glFinish();
+        replay.print_results();
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return intact ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+/*
+ * Replays a capture written by gl_capture in a hidden window, with `<executable> --replay
+ * <file> [--original-timing]`, and prints frame time statistics.
+ *
+ * By default frames are replayed as fast as possible without vsync, to benchmark the driver
+ * on exactly the workload that was captured. With original timing every frame waits for the
+ * time it was presented at during the capture. Object names, syncs and uniform locations are
+ * mapped to the ones the replaying driver hands out. Queries are executed again but their
+ * results are discarded.
+ */
+int run_replay(std::string const& path, bool original_timing);
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <util/base.hpp>
+
+/*
+ * Binary format of GL captures, little endian and without padding.
+ *
+ * A GlStreamHeader is followed by records, each a GlOp followed by its arguments in call
+ * order, with pointer sized arguments widened to 64 bit. Object names and syncs are stored
+ * as the application saw them and mapped to the replay's own on the way back.
+ *
+ * Payloads (buffer and texture data, shader sources, uniform arrays) are stored once in a
+ * Blob record (u32 id, u64 size, bytes) the first time their contents are seen. Calls refer
+ * to them by id, NULL_BLOB standing for a null pointer. Arrays of object names are stored
+ * inline as a count followed by the names.
+ *
+ * Buffers are never mapped during a replay: what the application wrote into a mapped range is
+ * recorded as a BufferSubData of that range when it is unmapped.
+ */
+namespace gl_stream {
+    constexpr char MAGIC[8] = {'G', 'L', 'C', 'A', 'P', 'T', 'U', 'R'};
+    constexpr u32 VERSION = 4;
+    constexpr u32 NULL_BLOB = 0xFFFFFFFF;
+
+    struct Header {
+        char magic[8];
+        u32 version;
+        // The context the application used, so the replay can ask for the same one.
+        i32 context_major;
+        i32 context_minor;
+        i32 context_profile_mask;
+        i32 framebuffer_width;
+        i32 framebuffer_height;
+    };
+
+    enum class Op : u16 {
+        Blob,
+        // u64 nanoseconds since the capture started, taken before swapping.
+        SwapBuffers,
+
+        ActiveTexture,
+        AttachShader,
+        BeginQuery,
+        BindBuffer,
+        BindBufferBase,
+        BindFramebuffer,
+        BindTexture,
+        BindVertexArray,
+        BlendFunc,
+        BufferData,
+        BufferSubData,
+        Clear,
+        ClearBufferSubData,
+        ClearColor,
+        ClientWaitSync,
+        CompileShader,
+        CreateProgram,
+        CreateShader,
+        DeleteBuffers,
+        DeleteFramebuffers,
+        DeleteProgram,
+        DeleteQueries,
+        DeleteShader,
+        DeleteSync,
+        DeleteTextures,
+        DeleteVertexArrays,
+        Disable,
+        DispatchCompute,
+        DrawArrays,
+        DrawArraysIndirect,
+        DrawElements,
+        Enable,
+        EnableVertexAttribArray,
+        EndQuery,
+        FenceSync,
+        FramebufferTexture2D,
+        GenBuffers,
+        GenFramebuffers,
+        GenQueries,
+        GenTextures,
+        GenVertexArrays,
+        GetBufferSubData,
+        GetIntegerv,
+        GetProgramInfoLog,
+        GetProgramiv,
+        GetQueryObjectui64v,
+        GetShaderInfoLog,
+        GetShaderiv,
+        GetUniformLocation,
+        LinkProgram,
+        MaxShaderCompilerThreads,
+        MemoryBarrier,
+        MultiDrawElementsIndirectCount,
+        PixelStorei,
+        PointSize,
+        QueryCounter,
+        ShaderSource,
+        TexImage2D,
+        TexParameteri,
+        TexSubImage2D,
+        Uniform1i,
+        Uniform1ui,
+        Uniform4fv,
+        UniformMatrix4fv,
+        UseProgram,
+        VertexAttribPointer,
+        Viewport,
+        Count,
+    };
+}
@@ -0,0 +1,301 @@
+#include "jobsystem.hpp"
+
+#include <algorithm>
+
+namespace {
+    constexpr std::size_t DEQUE_CAPACITY = 1 << 13;
+    constexpr std::size_t JOB_BLOCK_SIZE = 256;
+    constexpr u32 FOREIGN_OWNER = ~0u;
+    constexpr int SPINS_BEFORE_SLEEP = 64;
+
+    thread_local JobSystem* t_system = nullptr;
+    thread_local u32 t_worker_index = 0;
+}
+
+struct JobSystem::Worker {
+    explicit Worker(u32 index) : deque{DEQUE_CAPACITY}, free_jobs{nullptr}, returned_jobs{nullptr}, random_state{index * 2654435761u + 1} { }
+
+    WorkStealingDeque<Job> deque;
+
+    // Jobs allocated by this worker. Only the worker itself touches free_jobs; other threads
+    // hand finished jobs back through returned_jobs, a lock-free stack that is only ever
+    // drained as a whole, which keeps it free of ABA problems.
+    Job* free_jobs;
+    std::atomic<Job*> returned_jobs;
+    std::vector<std::unique_ptr<Job[]>> blocks;
+
+    u32 random_state;
+};
+
+void JobCounter::lock() {
+    while (_lock.exchange(true, std::memory_order_acquire)) {
+        while (_lock.load(std::memory_order_relaxed)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobCounter::unlock() {
+    _lock.store(false, std::memory_order_release);
+}
+
+JobSystem::JobSystem(u32 worker_threads) :
+    _running{true},
+    _sleeping{0},
+    _queued_jobs{0},
+    _previous_system{nullptr},
+    _previous_worker_index{0} {
+    for (u32 i = 0; i <= worker_threads; ++i) {
+        _workers.push_back(std::make_unique<Worker>(i));
+    }
+
+    _previous_system = t_system;
+    _previous_worker_index = t_worker_index;
+    t_system = this;
+    t_worker_index = 0;
+
+    for (u32 i = 1; i <= worker_threads; ++i) {
+        _threads.emplace_back(&JobSystem::worker_main, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock{_sleep_mutex};
+        _running = false;
+    }
+    _sleep_condition.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+
+    for (Job* job : _shared_jobs) {
+        delete job;
+    }
+
+    if (t_system == this) {
+        t_system = _previous_system;
+        t_worker_index = _previous_worker_index;
+    }
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    while (!counter.is_done()) {
+        if (Job* job = find_job()) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    // The job that brought the counter to zero may still be handing out continuations.
+    // It holds the lock while doing so, and the counter must outlive that.
+    counter.lock();
+    counter.unlock();
+}
+
+u32 JobSystem::get_thread_count() const {
+    return static_cast<u32>(_workers.size());
+}
+
+JobSystem& JobSystem::get_global() {
+    static JobSystem system{std::max(1u, std::thread::hardware_concurrency()) - 1};
+    return system;
+}
+
+Job* JobSystem::allocate_job() {
+    if (t_system != this) {
+        Job* job = new Job;
+        job->owner = FOREIGN_OWNER;
+        return job;
+    }
+
+    Worker& worker = *_workers[t_worker_index];
+
+    if (!worker.free_jobs) {
+        worker.free_jobs = worker.returned_jobs.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    if (!worker.free_jobs) {
+        worker.blocks.emplace_back(new Job[JOB_BLOCK_SIZE]);
+        Job* block = worker.blocks.back().get();
+
+        for (std::size_t i = 0; i < JOB_BLOCK_SIZE; ++i) {
+            block[i].next = i + 1 < JOB_BLOCK_SIZE ? &block[i + 1] : nullptr;
+        }
+        worker.free_jobs = block;
+    }
+
+    Job* job = worker.free_jobs;
+    worker.free_jobs = job->next;
+    job->owner = t_worker_index;
+    return job;
+}
+
+void JobSystem::free_job(Job* job) {
+    if (job->owner == FOREIGN_OWNER) {
+        delete job;
+        return;
+    }
+
+    Worker& owner = *_workers[job->owner];
+
+    if (t_system == this && t_worker_index == job->owner) {
+        job->next = owner.free_jobs;
+        owner.free_jobs = job;
+        return;
+    }
+
+    Job* head = owner.returned_jobs.load(std::memory_order_relaxed);
+    do {
+        job->next = head;
+    } while (!owner.returned_jobs.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void JobSystem::submit(Job* job) {
+    if (t_system == this) {
+        if (!_workers[t_worker_index]->deque.push(job)) {
+            // Our deque is full, so there is plenty of work around already.
+            execute(job);
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock{_shared_mutex};
+        _shared_jobs.push_back(job);
+    }
+
+    _queued_jobs.fetch_add(1, std::memory_order_seq_cst);
+
+    if (_sleeping.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock{_sleep_mutex};
+        _sleep_condition.notify_one();
+    }
+}
+
+void JobSystem::submit_after(JobCounter& dependency, Job* job) {
+    dependency.lock();
+
+    if (dependency._value.load(std::memory_order_acquire) == 0) {
+        dependency.unlock();
+        submit(job);
+        return;
+    }
+
+    job->next = dependency._continuations;
+    dependency._continuations = job;
+    dependency.unlock();
+}
+
+void JobSystem::execute(Job* job) {
+    job->invoke(job->storage);
+
+    JobCounter* counter = job->counter;
+    free_job(job);
+
+    if (!counter) {
+        return;
+    }
+
+    // Decrements that cannot reach zero need no lock. Once the counter may be zero a waiter
+    // is free to destroy it, so nothing may touch the counter after the final unlock().
+    u32 value = counter->_value.load(std::memory_order_relaxed);
+    while (value > 1) {
+        if (counter->_value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+
+    counter->lock();
+    Job* continuations = nullptr;
+    if (counter->_value.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        continuations = counter->_continuations;
+        counter->_continuations = nullptr;
+    }
+    counter->unlock();
+
+    while (continuations) {
+        Job* next = continuations->next;
+        submit(continuations);
+        continuations = next;
+    }
+}
+
+Job* JobSystem::find_job() {
+    bool is_worker = t_system == this;
+
+    if (is_worker) {
+        if (Job* job = _workers[t_worker_index]->deque.pop()) {
+            _queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    if (_queued_jobs.load(std::memory_order_relaxed) <= 0) {
+        return nullptr;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock{_shared_mutex, std::try_to_lock};
+        if (lock.owns_lock() && !_shared_jobs.empty()) {
+            Job* job = _shared_jobs.back();
+            _shared_jobs.pop_back();
+            _queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    // Start at a random victim so thieves spread out instead of all hitting worker 0.
+    auto count = static_cast<u32>(_workers.size());
+    u32 start = 0;
+    if (is_worker) {
+        u32& state = _workers[t_worker_index]->random_state;
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        start = state % count;
+    }
+
+    for (u32 i = 0; i < count; ++i) {
+        u32 victim = (start + i) % count;
+        if (is_worker && victim == t_worker_index) {
+            continue;
+        }
+
+        if (Job* job = _workers[victim]->deque.steal()) {
+            _queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::worker_main(u32 index) {
+    t_system = this;
+    t_worker_index = index;
+
+    int idle_spins = 0;
+
+    while (_running.load(std::memory_order_relaxed)) {
+        if (Job* job = find_job()) {
+            execute(job);
+            idle_spins = 0;
+        } else if (++idle_spins < SPINS_BEFORE_SLEEP) {
+            std::this_thread::yield();
+        } else {
+            sleep_until_work();
+            idle_spins = 0;
+        }
+    }
+}
+
+void JobSystem::sleep_until_work() {
+    std::unique_lock<std::mutex> lock{_sleep_mutex};
+
+    _sleeping.fetch_add(1, std::memory_order_seq_cst);
+    _sleep_condition.wait(lock, [this] {
+        return !_running.load(std::memory_order_relaxed) || _queued_jobs.load(std::memory_order_seq_cst) > 0;
+    });
+    _sleeping.fetch_sub(1, std::memory_order_relaxed);
+}
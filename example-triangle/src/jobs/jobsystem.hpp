@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <jobs/workstealingdeque.hpp>
+#include <util/base.hpp>
+
+class JobSystem;
+
+struct Job {
+    static constexpr std::size_t STORAGE_SIZE = 64;
+
+    void (*invoke)(void* storage);
+    class JobCounter* counter;
+    Job* next;
+    u32 owner;
+    alignas(16) unsigned char storage[STORAGE_SIZE];
+};
+
+/*
+ * Counts outstanding jobs. Jobs submitted with a counter increment it and decrement it
+ * once they have run; JobSystem::wait() returns when it reaches zero. Jobs can also be
+ * scheduled to start only once a counter has reached zero, see JobSystem::run_after().
+ */
+class JobCounter {
+public:
+    JobCounter() : _value{0}, _lock{false}, _continuations{nullptr} { }
+
+    JobCounter(JobCounter const&) = delete;
+    JobCounter& operator=(JobCounter const&) = delete;
+
+public:
+    NODISCARD bool is_done() const { return _value.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    void lock();
+    void unlock();
+
+private:
+    std::atomic<u32> _value;
+    std::atomic<bool> _lock;
+    Job* _continuations;
+};
+
+/*
+ * Work-stealing job scheduler. Each worker owns a lock-free deque: it pushes and pops its
+ * own jobs at the bottom, idle workers steal the oldest jobs from the top of other deques.
+ *
+ * The thread that constructs the JobSystem becomes worker 0, and only gets to run jobs
+ * while it is inside wait() or parallel_for(). Usually this is the thread owning the GL
+ * context, which thus helps out instead of blocking. Threads that are not workers may still
+ * submit and wait; their jobs go through a shared queue.
+ *
+ * Job functions are stored inline, so captures are limited to Job::STORAGE_SIZE bytes.
+ */
+class JobSystem {
+public:
+    explicit JobSystem(u32 worker_threads);
+    ~JobSystem();
+
+    JobSystem(JobSystem const&) = delete;
+    JobSystem& operator=(JobSystem const&) = delete;
+
+public:
+    template<typename F>
+    void run(F&& function, JobCounter* counter = nullptr) {
+        submit(make_job(std::forward<F>(function), counter));
+    }
+
+    // Starts function once dependency has reached zero.
+    template<typename F>
+    void run_after(JobCounter& dependency, F&& function, JobCounter* counter = nullptr) {
+        submit_after(dependency, make_job(std::forward<F>(function), counter));
+    }
+
+    // Runs other jobs on the calling thread until counter reaches zero.
+    void wait(JobCounter& counter);
+
+    // Calls function(begin, end) over [0, count) in ranges of at most grain elements and waits for all of them.
+    template<typename F>
+    void parallel_for(std::size_t count, std::size_t grain, F const& function) {
+        if (count == 0) {
+            return;
+        }
+
+        JobCounter counter;
+        run_range(&function, &counter, 0, count, grain < 1 ? 1 : grain);
+        wait(counter);
+    }
+
+public:
+    // Number of threads executing jobs, including the one that created the system.
+    NODISCARD u32 get_thread_count() const;
+
+    // Created on first use with one worker per additional hardware thread.
+    NODISCARD static JobSystem& get_global();
+
+private:
+    struct Worker;
+
+    template<typename F>
+    Job* make_job(F&& function, JobCounter* counter) {
+        using Function = std::decay_t<F>;
+        static_assert(sizeof(Function) <= Job::STORAGE_SIZE, "job captures too much state, capture by reference instead");
+        static_assert(alignof(Function) <= 16, "job function is over-aligned");
+
+        Job* job = allocate_job();
+        job->invoke = [](void* storage) {
+            auto* f = std::launder(reinterpret_cast<Function*>(storage));
+            (*f)();
+            f->~Function();
+        };
+        job->counter = counter;
+        new (job->storage) Function(std::forward<F>(function));
+
+        if (counter) {
+            counter->_value.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return job;
+    }
+
+    // Splits the range in halves, handing the upper half to other workers, until it is small enough to run.
+    template<typename F>
+    void run_range(F const* function, JobCounter* counter, std::size_t begin, std::size_t end, std::size_t grain) {
+        while (end - begin > grain) {
+            std::size_t middle = begin + (end - begin) / 2;
+            run([this, function, counter, middle, end, grain] {
+                run_range(function, counter, middle, end, grain);
+            }, counter);
+            end = middle;
+        }
+
+        (*function)(begin, end);
+    }
+
+    Job* allocate_job();
+    void free_job(Job* job);
+
+    void submit(Job* job);
+    void submit_after(JobCounter& dependency, Job* job);
+    void execute(Job* job);
+    Job* find_job();
+
+    void worker_main(u32 index);
+    void sleep_until_work();
+
+private:
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<std::thread> _threads;
+    std::atomic<bool> _running;
+
+    // Jobs submitted from threads that are not workers.
+    std::mutex _shared_mutex;
+    std::vector<Job*> _shared_jobs;
+
+    // Idle workers sleep here. _queued_jobs is the number of jobs sitting in any queue.
+    std::mutex _sleep_mutex;
+    std::condition_variable _sleep_condition;
+    std::atomic<u32> _sleeping;
+    std::atomic<i64> _queued_jobs;
+
+    // The creating thread may already be a worker of another system, restored on destruction.
+    JobSystem* _previous_system;
+    u32 _previous_worker_index;
+};
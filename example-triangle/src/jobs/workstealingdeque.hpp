@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <util/base.hpp>
+
+/*
+ * Fixed-capacity Chase-Lev deque, with the memory orderings from Lê et al., "Correct and
+ * Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ *
+ * Only the owning thread may push() and pop(), which work on the bottom end in LIFO order.
+ * Any thread may steal() from the top end, taking the oldest element.
+ */
+template<typename T>
+class WorkStealingDeque {
+public:
+    // capacity must be a power of two.
+    explicit WorkStealingDeque(std::size_t capacity) : _top{0}, _bottom{0}, _mask{static_cast<i64>(capacity) - 1}, _buffer(capacity) { }
+
+public:
+    // Returns false if the deque is full.
+    bool push(T* item) {
+        i64 bottom = _bottom.load(std::memory_order_relaxed);
+        i64 top = _top.load(std::memory_order_acquire);
+
+        if (bottom - top > _mask) {
+            return false;
+        }
+
+        // A release store rather than the paper's release fence and relaxed store: the same on
+        // common hardware, and visible to ThreadSanitizer, which ignores fences.
+        _buffer[bottom & _mask].store(item, std::memory_order_relaxed);
+        _bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    T* pop() {
+        i64 bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        i64 top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* item = _buffer[bottom & _mask].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last element, race against thieves for it.
+            if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return item;
+    }
+
+    T* steal() {
+        i64 top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        i64 bottom = _bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        T* item = _buffer[top & _mask].load(std::memory_order_relaxed);
+        if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        return item;
+    }
+
+private:
+    alignas(64) std::atomic<i64> _top;
+    alignas(64) std::atomic<i64> _bottom;
+    i64 _mask;
+    std::vector<std::atomic<T*>> _buffer;
+};
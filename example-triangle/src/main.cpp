@@ -1,113 +1,824 @@
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <cstddef>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <bench/benchmark.hpp>
+#include <capture/glcapture.hpp>
+#include <capture/glreplay.hpp>
+#include <jobs/jobsystem.hpp>
+#include <math/math.hpp>
+#include <mesh/meshfile.hpp>
+#include <mesh/meshimport.hpp>
+#include <memory>
+#include <particles/particlesystem.hpp>
+#include <render/dynamicresolution.hpp>
+#include <render/framepacer.hpp>
+#include <render/glresources.hpp>
+#include <render/gpumemorybudget.hpp>
+#include <render/gpuculling.hpp>
+#include <render/gpuparticles.hpp>
+#include <render/particlerenderer.hpp>
+#include <render/postchain.hpp>
+#include <render/resourceloader.hpp>
+#include <render/textrenderer.hpp>
+#include <render/vertex.hpp>
+#include <scene/cullinggrid.hpp>
+#include <scene/transformhierarchy.hpp>
+#include <session/frame_times.hpp>
+#include <session/golden_images.hpp>
+#include <session/session.hpp>
 #include <shaders/defaultshaders.hpp>
 #include <shaders/shader.hpp>
 #include <shaders/shaderprogram.hpp>
+#include <text/textbatch.hpp>
+#ifdef SHADER_HOT_RELOAD
+#include <shaders/shaderreloader.hpp>
+#endif
 
-int main()
+/* Frames of a playback compared against golden images: every GOLDEN_FRAME_INTERVAL-th and the last one. */
+static const u64 GOLDEN_FRAME_INTERVAL = 60;
+
+int main(int argc, char **argv)
 {
-	GLFWwindow *window;
+	/* Created first so the main thread becomes worker 0 and helps out while waiting on jobs. */
+	(void)JobSystem::get_global();
+
+	if (argc > 1 && std::string{argv[1]} == "--bench")
+	{
+		run_benchmarks(argc > 2 ? argv[2] : "");
+		return 0;
+	}
+
+	if (argc > 2 && std::string{argv[1]} == "--replay")
+	{
+		return run_replay(argv[2], argc > 3 && std::string{argv[3]} == "--original-timing");
+	}
+
+	/* Converts an OBJ or glTF file into a mesh file that --mesh maps and uploads as is. */
+	if (argc > 3 && std::string{argv[1]} == "--convert-mesh")
+	{
+		return convert_mesh(argv[2], argv[3]) ? 0 : 1;
+	}
+
+	/*
+	 * Options: --gpu-culling, --fps <cap>, --frames-in-flight <1-4>, --late-latch, --memory-budget <MiB>
+	 * --capture <file>, --particles <count>, --gpu-particles, --post and --dynamic-resolution with --min-scale <0-1>,
+	 * --max-scale <0-1>, --target-ms <GPU ms> and --sharpen <0-1>. Fewer frames in flight and late latching trade
+	 * throughput for latency. --gpu-particles simulates the particles with compute shaders instead of on the CPU, --post
+	 * renders the scene in HDR and adds bloom. --dynamic-resolution renders the scene at a lower resolution whenever its
+	 * GPU time exceeds the target and upscales it, sharpened unless --sharpen is 0. --stress-loading <MiB> keeps loading
+	 * meshes of that size, textures and programs, on the render thread or with --loader-thread on a thread of its own.
+	 * --mesh <file> draws a mesh file made by --convert-mesh <in> <out>, fitted into the window.
+	 *
+	 * --playback <session> plays a session file back in a hidden window, without vsync: its frame clock steps the
+	 * particles and its first resize sets the window size. The statistics text depends on the timings and is left
+	 * out. As a regression test, --golden <directory> [--golden-tolerance <percent>] [--failure-dir <directory>]
+	 * compares frames against golden images and --baseline <file> [--max-regression <percent>] the frame times against
+	 * a baseline, see shared/session. --update stores both instead, --store-missing-baseline stores a baseline there
+	 * is none of yet and --frame-times <file> writes the time of every frame.
+	 */
+	bool use_gpu_culling = false;
+	bool use_gpu_particles = false;
+	bool use_post = false;
+	bool use_dynamic_resolution = false;
+	DynamicResolutionSettings resolution_settings;
+	f32 sharpening = 0.5f;
+	FramePacerSettings pacing;
+	u64 memory_budget = 0;
+	std::string capture_path;
+	std::size_t particle_count = 0;
+	std::size_t stress_loading_mib = 0;
+	bool use_loader_thread = false;
+	std::string mesh_path;
+	std::string playback_path;
+	std::string frame_times_path;
+	std::string golden_directory;
+	std::string failure_directory;
+	std::string baseline_path;
+	f64 golden_tolerance_percent = 0.1;
+	f64 max_regression_percent = 10.0;
+	bool update = false;
+	bool store_missing_baseline = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg{argv[i]};
+		if (arg == "--gpu-culling")
+			use_gpu_culling = true;
+		else if (arg == "--fps" && i + 1 < argc)
+			pacing.target_fps = std::stod(argv[++i]);
+		else if (arg == "--frames-in-flight" && i + 1 < argc)
+			pacing.max_frames_in_flight = std::stoul(argv[++i]);
+		else if (arg == "--late-latch")
+			pacing.late_latch = true;
+		else if (arg == "--memory-budget" && i + 1 < argc)
+			memory_budget = static_cast<u64>(std::stod(argv[++i]) * 1024.0 * 1024.0);
+		else if (arg == "--capture" && i + 1 < argc)
+			capture_path = argv[++i];
+		else if (arg == "--particles" && i + 1 < argc)
+			particle_count = std::stoul(argv[++i]);
+		else if (arg == "--gpu-particles")
+			use_gpu_particles = true;
+		else if (arg == "--post")
+			use_post = true;
+		else if (arg == "--dynamic-resolution")
+			use_dynamic_resolution = true;
+		else if (arg == "--min-scale" && i + 1 < argc)
+			resolution_settings.min_scale = std::stof(argv[++i]);
+		else if (arg == "--max-scale" && i + 1 < argc)
+			resolution_settings.max_scale = std::stof(argv[++i]);
+		else if (arg == "--target-ms" && i + 1 < argc)
+			resolution_settings.target_ms = std::stod(argv[++i]);
+		else if (arg == "--sharpen" && i + 1 < argc)
+			sharpening = std::stof(argv[++i]);
+		else if (arg == "--stress-loading" && i + 1 < argc)
+			stress_loading_mib = std::stoul(argv[++i]);
+		else if (arg == "--loader-thread")
+			use_loader_thread = true;
+		else if (arg == "--mesh" && i + 1 < argc)
+			mesh_path = argv[++i];
+		else if (arg == "--playback" && i + 1 < argc)
+			playback_path = argv[++i];
+		else if (arg == "--frame-times" && i + 1 < argc)
+			frame_times_path = argv[++i];
+		else if (arg == "--golden" && i + 1 < argc)
+			golden_directory = argv[++i];
+		else if (arg == "--golden-tolerance" && i + 1 < argc)
+			golden_tolerance_percent = std::stod(argv[++i]);
+		else if (arg == "--failure-dir" && i + 1 < argc)
+			failure_directory = argv[++i];
+		else if (arg == "--baseline" && i + 1 < argc)
+			baseline_path = argv[++i];
+		else if (arg == "--max-regression" && i + 1 < argc)
+			max_regression_percent = std::stod(argv[++i]);
+		else if (arg == "--update")
+			update = true;
+		else if (arg == "--store-missing-baseline")
+			store_missing_baseline = true;
+	}
+
+	SessionPlayer session;
+	int window_width = 640, window_height = 480;
+	if (!playback_path.empty())
+	{
+		if (!session.load(playback_path.c_str()))
+		{
+			printf("Could not load session %s!\n", playback_path.c_str());
+			return 1;
+		}
+
+		session.get_initial_size(window_width, window_height);
+		if (window_width <= 0 || window_height <= 0)
+		{
+			window_width = 640;
+			window_height = 480;
+		}
+	}
+
+	GoldenImages golden_images;
+	if (session.is_loaded() && !golden_directory.empty() &&
+		!golden_images.open(golden_directory.c_str(), golden_tolerance_percent, update, failure_directory.empty() ? nullptr : failure_directory.c_str()))
+	{
+		printf("Could not open the golden image directory %s!\n", golden_directory.c_str());
+		return 1;
+	}
+
+	GLFWwindow *window = nullptr;
 	if (!glfwInit())
 	{
 		printf("Could not init GLFW!\n");
 		return 1;
 	}
 
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	use_gpu_particles = use_gpu_particles && particle_count > 0;
+	if (use_gpu_culling || use_gpu_particles)
+	{
+		/* Compute shaders and indirect draws need at least a 4.3 core context. */
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+		/* Nobody watches a playback. */
+		glfwWindowHint(GLFW_VISIBLE, session.is_loaded() ? GLFW_FALSE : GLFW_TRUE);
+		window = glfwCreateWindow(window_width, window_height, "Learn OpenGL", nullptr, nullptr);
+		if (!window)
+		{
+			printf("Could not create an OpenGL 4.3 context, falling back to CPU culling and particles.\n");
+			use_gpu_culling = false;
+			use_gpu_particles = false;
+			glfwDefaultWindowHints();
+		}
+	}
 
-	window = glfwCreateWindow(640, 480, "Learn OpenGL", nullptr, nullptr);
+	if (!window)
+	{
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+		/* Again, in case the hints were reset above. */
+		glfwWindowHint(GLFW_VISIBLE, session.is_loaded() ? GLFW_FALSE : GLFW_TRUE);
+		window = glfwCreateWindow(window_width, window_height, "Learn OpenGL", nullptr, nullptr);
+	}
 	glfwMakeContextCurrent(window);
 
+	glewExperimental = GL_TRUE; // needed by older GLEW versions for core contexts
 	if (glewInit() != GLEW_OK)
 	{
 		printf("Could not init GLEW!\n");
 		return 1;
 	}
 
-	Shader default_vertex_shader{
-			ShaderType::VertexShader,
-			std::string{reinterpret_cast<char const *>(DEFAULT_VERTEX_SHADER_copy())},
-			"default_vertex_shader"};
+	/* Records every GL call from here on, so the capture sees all objects being created. */
+	if (!capture_path.empty())
+	{
+#ifdef GL_CAPTURE
+		if (!gl_capture::start(capture_path, window))
+			printf("Could not capture to %s!\n", capture_path.c_str());
+#else
+		printf("Capturing needs a build with -DGL_CAPTURE=ON.\n");
+#endif
+	}
+
+	if (use_gpu_culling && !GpuCulling::is_supported())
+	{
+		printf("GPU culling needs OpenGL 4.3 and ARB_indirect_parameters, falling back to CPU culling.\n");
+		use_gpu_culling = false;
+	}
+
+	if (use_gpu_particles && !GpuParticleSystem::is_supported())
+	{
+		printf("GPU particles need OpenGL 4.3, falling back to CPU particles.\n");
+		use_gpu_particles = false;
+	}
 
-	Shader default_fragment_shader{
-			ShaderType::FragmentShader,
-			std::string{reinterpret_cast<char const *>(DEFAULT_FRAGMENT_SHADER_copy())},
-			"default_fragment_shader"};
+	/*
+	 * Everything in this scope owns GL objects, so it is destroyed here while the context is still current.
+	 * Destroying the window first would leave their deletes without a context.
+	 */
+	int status = 0;
+	{
+		Shader default_vertex_shader{
+				ShaderType::VertexShader,
+				ASSET_SOURCE(DEFAULT_VERTEX_SHADER),
+				"default_vertex_shader"};
 
-	ShaderProgram default_program{"default_shader_program"};
-	default_vertex_shader.init();
-	default_fragment_shader.init();
-	default_program.init(default_vertex_shader.get_id(), default_fragment_shader.get_id());
+		Shader default_fragment_shader{
+				ShaderType::FragmentShader,
+				ASSET_SOURCE(DEFAULT_FRAGMENT_SHADER),
+				"default_fragment_shader"};
 
-	default_program.use();
+		ShaderProgram default_program{"default_shader_program"};
+		default_vertex_shader.init();
+		default_fragment_shader.init();
+		default_program.init(default_vertex_shader.get_id(), default_fragment_shader.get_id());
 
-	glfwSwapInterval(1); // vsync
-	glClearColor(0.66, 0.66, 0.33, 1.0);
+		default_program.use();
 
-	GLuint vbo; // vertex buffer object (essentially an array of vertices)
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+#ifdef SHADER_HOT_RELOAD
+		ShaderReloader default_reloader{default_program, SHADER_SOURCE_DIR, "defaultvertexshader.glsl", "defaultfragmentshader.glsl"};
+		default_reloader.start();
+#endif
 
-	/* Standard representation of a vertex */
-	struct Vertex
-	{
-		f32 pos_x, pos_y; // X- and Y-Position
-		f32 u, v;					// Texture coords
-		u8 r, g, b, a;		// Color in RGBA
-	};
-
-	GLuint vao; // Vertex array object
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-
-	/* Tell OpenGL the layout of our Vertex struct, since OpenGL does not know by default how we represent our Vertex. */
-	/* This is dependent on how the shader is implemented: layout (location = <index>) in <attribute_name> */
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, u));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void *)offsetof(Vertex, r));
-	glEnableVertexAttribArray(2);
-
-	std::vector<Vertex> triangle{
-		{ 50.0f, 50.0f, 0.0f, 0.0f, 0, 0, 255, 255 },
-		{ 50.0f, 100.0f, 0.0f, 0.0f, 0, 255, 0, 255 },
-		{ 100.0f, 100.0f, 0.0f, 0.0f, 255, 0, 0, 255 }
-	};
-
-	glBufferData(GL_ARRAY_BUFFER, triangle.size() * sizeof(Vertex), triangle.data(), GL_STREAM_DRAW);
-
-	while (!glfwWindowShouldClose(window))
-	{
-		int width, height;
-
-		glfwPollEvents();
-		glfwGetFramebufferSize(window, &width, &height);
-		glViewport(0, 0, width, height);
-		glClear(GL_COLOR_BUFFER_BIT);
-		
-		f32 left = 0.0f;
-		f32 right = width;
-		f32 top = 0.0;
-		f32 bottom = height;
-
-		f32 ortho[16] = {
-				2.0f / (right - left), 0.0f, 0.0f, 0.0f,
-				0.0f, 2.0f / (top - bottom), 0.0f, 0.0f,
-				0.0f, 0.0f, -1.0f, 0.0f,
-				-((right + left) / (right - left)), -((top + bottom) / (top - bottom)), 0.0f, 1.0f};
-
-		glUniformMatrix4fv(glGetUniformLocation(default_program.get_id(), "our_proj"), 1, GL_FALSE, ortho);
-		glDrawArrays(GL_TRIANGLES, 0, 3);
-
-		glfwSwapBuffers(window);
+		glfwSwapInterval(session.is_loaded() ? 0 : 1); // vsync, a playback runs as fast as it can
+
+		/* Bounds the frames queued up in the driver and caps the frame rate, see FramePacer. */
+		GLFWvidmode const *video_mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+		FramePacer pacer;
+		pacer.init(pacing, video_mode ? video_mode->refreshRate : 60.0);
+
+		glClearColor(0.66, 0.66, 0.33, 1.0);
+
+		/* Owns the buffers, textures and vertex arrays, and frees them once no frame in flight uses them anymore. */
+		GlResources resources;
+
+		std::vector<Vertex> triangle{
+			{ 50.0f, 50.0f, 0.0f, 0.0f, 0, 0, 255, 255 },
+			{ 50.0f, 100.0f, 0.0f, 0.0f, 0, 255, 0, 255 },
+			{ 100.0f, 100.0f, 0.0f, 0.0f, 255, 0, 0, 255 }
+		};
+
+		/* Evicts meshes and textures that were not drawn recently when over budget, they are uploaded again on their next use. */
+		GpuMemoryBudget budget;
+		budget.init(resources, memory_budget);
+
+		VertexArrayHandle vao = resources.create_vertex_array(); // Vertex array object
+		BufferHandle vbo; // vertex buffer object (essentially an array of vertices)
+
+		auto upload_triangle = [&]()
+		{
+			vbo = resources.create_buffer(triangle.size() * sizeof(Vertex), GL_STREAM_DRAW, triangle.data());
+			glBindVertexArray(resources.get(vao));
+			glBindBuffer(GL_ARRAY_BUFFER, resources.get(vbo));
+
+			/* Tell OpenGL the layout of our Vertex struct, since OpenGL does not know by default how we represent our Vertex. */
+			/* This is dependent on how the shader is implemented: layout (location = <index>) in <attribute_name> */
+			glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, u));
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void *)offsetof(Vertex, r));
+			glEnableVertexAttribArray(2);
+		};
+		upload_triangle();
+
+		ResidencyId triangle_residency = budget.add(GlMemoryCategory::Mesh, resources.get_buffer_size(vbo),
+			[&]() { resources.destroy(vbo); },
+			upload_triangle);
+
+		/* On-screen statistics, drawn on top of everything else in one call. */
+		TextRenderer text_renderer;
+		text_renderer.init(resources, budget);
+		TextBatch text{text_renderer.get_atlas()};
+		std::string stats_text;
+		f64 last_frame_time = glfwGetTime();
+
+		/* Moving the triangle only changes its transform, the vertex data stays as uploaded. */
+		TransformHierarchy transforms;
+		TransformId triangle_transform = transforms.create();
+
+		/* Objects are only drawn when the culling stage reports them as visible. */
+		CullingGrid culling{256.0f};
+		Aabb triangle_bounds{{50.0f, 50.0f, 0.0f}, {100.0f, 100.0f, 0.0f}};
+		CullId triangle_cull_id = culling.insert(triangle_bounds);
+		std::vector<CullId> visible;
+		f64 last_cull_report = glfwGetTime();
+		f64 last_memory_report = glfwGetTime();
+
+		/* The GPU path culls on the GPU and draws through an element buffer with indirect commands. */
+		std::unique_ptr<GpuCulling> gpu_culling;
+		BufferHandle ebo;
+		if (use_gpu_culling)
+		{
+			GLuint indices[] = {0, 1, 2};
+			ebo = resources.create_buffer(sizeof(indices), GL_STATIC_DRAW, indices);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, resources.get(ebo));
+
+			gpu_culling = std::make_unique<GpuCulling>();
+			gpu_culling->init(resources, {{triangle_bounds, 3, 0, 0}});
+		}
+
+		/* The file's blocks go to the buffers straight from the mapping, nothing is parsed. The mapping is not needed afterwards. */
+		GpuMesh mesh{};
+		Aabb mesh_bounds{};
+		if (!mesh_path.empty())
+		{
+			f64 load_start = glfwGetTime();
+			MappedMesh mapped;
+			if (mapped.open(mesh_path))
+			{
+				mesh = mapped.upload(resources);
+				mesh_bounds = mapped.get_bounds();
+				printf("Mesh: %s, %u vertices, %u triangles, mapped and uploaded in %.2f ms\n", mesh_path.c_str(),
+					mapped.get_header().vertex_count, mesh.index_count / 3, (glfwGetTime() - load_start) * 1000.0);
+			}
+		}
+
+		/* A fountain in the bottom half of the window, falling back down past an attractor. Moved along with resizes. */
+		auto add_fountain = [particle_count](auto &system)
+		{
+			ParticleEmitter fountain{};
+			fountain.direction = -1.5708f;
+			fountain.spread = 0.6f;
+			fountain.min_speed = 200.0f;
+			fountain.max_speed = 450.0f;
+			fountain.min_lifetime = 2.0f;
+			fountain.max_lifetime = 4.0f;
+			fountain.rate = static_cast<f32>(particle_count) / 3.0f;
+			fountain.start_color = {255, 210, 90, 200};
+			fountain.end_color = {220, 40, 20, 0};
+			fountain.enabled = true;
+			system.add_emitter(fountain);
+
+			ParticleForces &forces = system.get_forces();
+			forces.gravity = {0.0f, 150.0f};
+			forces.drag = 0.3f;
+			forces.attractors.push_back({{0.0f, 0.0f}, 4000000.0f, 60.0f});
+		};
+		auto move_fountain = [](auto &system, int width, int height)
+		{
+			system.get_emitter(0).position = {width * 0.5f, height * 0.8f};
+			system.get_forces().attractors[0].position = {width * 0.5f, height * 0.3f};
+		};
+
+		std::unique_ptr<ParticleSystem> particles;
+		std::unique_ptr<GpuParticleSystem> gpu_particles;
+		ParticleRenderer particle_renderer;
+		if (use_gpu_particles)
+		{
+			gpu_particles = std::make_unique<GpuParticleSystem>();
+			gpu_particles->init(resources, particle_count);
+			add_fountain(*gpu_particles);
+		}
+		else if (particle_count > 0)
+		{
+			particles = std::make_unique<ParticleSystem>(particle_count);
+			add_fountain(*particles);
+			particle_renderer.init(resources);
+		}
+
+		/*
+		 * The post chain renders the scene offscreen. With --post in HDR, with bloom from its brightest parts at half
+		 * resolution and tonemapped. With dynamic resolution at the render scale, upscaled into the window at the end.
+		 */
+		std::unique_ptr<PostChain> post_chain;
+		if (use_post || use_dynamic_resolution)
+		{
+			post_chain = std::make_unique<PostChain>();
+			post_chain->init(resources);
+
+			GLenum scene_format = use_post ? GL_RGBA16F : GL_RGBA8;
+			RenderTargetId scene = post_chain->add_target({"scene", scene_format, 1.0f, true});
+			post_chain->add_pass({"scene", {}, scene, "", {}, true});
+
+			RenderTargetId image = scene;
+			if (use_post)
+			{
+				RenderTargetId bright = post_chain->add_target({"bright", GL_RGBA16F, 0.5f, true});
+				RenderTargetId blurred_x = post_chain->add_target({"blurred_x", GL_RGBA16F, 0.5f, true});
+				RenderTargetId bloom = post_chain->add_target({"bloom", GL_RGBA16F, 0.5f, true});
+				image = use_dynamic_resolution ? post_chain->add_target({"tonemapped", GL_RGBA8, 1.0f, true}) : BACKBUFFER;
+
+				post_chain->add_pass({"threshold", {scene}, bright, ASSET_SOURCE(BLOOM_THRESHOLD_FRAGMENT_SHADER), {1.0f, 0.2f, 0.0f, 0.0f}, false});
+				post_chain->add_pass({"blur_x", {bright}, blurred_x, ASSET_SOURCE(BLOOM_BLUR_FRAGMENT_SHADER), {1.0f, 0.0f, 0.0f, 0.0f}, false});
+				post_chain->add_pass({"blur_y", {blurred_x}, bloom, ASSET_SOURCE(BLOOM_BLUR_FRAGMENT_SHADER), {0.0f, 1.0f, 0.0f, 0.0f}, false});
+				post_chain->add_pass({"tonemap", {scene, bloom}, image, ASSET_SOURCE(TONEMAP_FRAGMENT_SHADER), {0.8f, 2.5f, 0.0f, 0.0f}, false});
+			}
+
+			/* Sharpening works on the final colors, so it comes after tonemapping. */
+			if (use_dynamic_resolution)
+				post_chain->add_pass({"upscale", {image}, BACKBUFFER, ASSET_SOURCE(UPSCALE_FRAGMENT_SHADER), {sharpening, 0.0f, 0.0f, 0.0f}, false});
+		}
+
+		/* Fed with the post chain's GPU time, which is what the render scale changes. */
+		std::unique_ptr<DynamicResolution> dynamic_resolution;
+		u64 scale_change_frame = 0;
+		u64 last_timed_frame = 0;
+		if (use_dynamic_resolution)
+		{
+			dynamic_resolution = std::make_unique<DynamicResolution>(resolution_settings);
+			post_chain->set_render_scale(dynamic_resolution->get_scale());
+		}
+
+		/* Loads in the background, finished objects are picked up at the start of a frame. */
+		ResourceLoader loader;
+		if (use_loader_thread && !loader.start(window))
+			printf("Loading on the render thread, a capture is running or there is no shared context.\n");
+
+		/* What was loaded last is kept until the next load replaces it, like streamed in parts of a level. */
+		BufferHandle streamed_mesh;
+		TextureHandle streamed_texture;
+		ShaderProgram streamed_program{"streamed_program"};
+		u32 stress_round = 0;
+		f64 last_stress_load = glfwGetTime();
+		f64 worst_frame_ms = 0.0;
+
+		auto request_stress_loads = [&]()
+		{
+			std::size_t vertex_count = stress_loading_mib * 1024 * 1024 / sizeof(Vertex);
+			loader.load_buffer("stress_mesh", GL_STATIC_DRAW, [vertex_count, stress_round]()
+			{
+				std::vector<u8> data(vertex_count * sizeof(Vertex));
+				Vertex *vertices = reinterpret_cast<Vertex *>(data.data());
+				for (std::size_t i = 0; i < vertex_count; ++i)
+				{
+					u8 shade = static_cast<u8>(i + stress_round);
+					vertices[i] = {static_cast<f32>(i % 640), static_cast<f32>(i / 640 % 480), 0.0f, 0.0f, shade, shade, shade, 255};
+				}
+				return data;
+			});
+
+			loader.load_texture("stress_texture", 1024, 1024, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, [stress_round]()
+			{
+				std::vector<u8> pixels(1024 * 1024 * 4);
+				for (std::size_t i = 0; i < pixels.size(); ++i)
+					pixels[i] = static_cast<u8>(i * 7 + stress_round);
+				return pixels;
+			});
+
+			/* A define of its own every round, so no shader cache can skip the compile. */
+			std::string define = "#define STRESS_ROUND " + std::to_string(stress_round) + "\n";
+			std::string vertex_source = ASSET_SOURCE(DEFAULT_VERTEX_SHADER);
+			std::string fragment_source = ASSET_SOURCE(DEFAULT_FRAGMENT_SHADER);
+			vertex_source.insert(vertex_source.find('\n') + 1, define);
+			fragment_source.insert(fragment_source.find('\n') + 1, define);
+			loader.load_program("stress_program", vertex_source, fragment_source);
+
+			++stress_round;
+		};
+
+		/* Time every frame took from its start until it was presented, while playing back a session. */
+		FrameTimes frame_times;
+
+		while (!glfwWindowShouldClose(window))
+		{
+			int width, height;
+			f64 frame_start = glfwGetTime();
+
+			/* Input is sampled after waiting, so it is as fresh as the pacing allows. */
+			pacer.begin_frame();
+			glfwPollEvents();
+
+			/* A playback replaces the clock, so every frame steps the particles as far as it did in the recording. */
+			f64 frame_time = glfwGetTime();
+			if (session.is_loaded())
+			{
+				if (!session.next_frame())
+					break;
+
+				frame_time = session.get_frame().time;
+				if (session.get_frame_index() == 0)
+					last_frame_time = frame_time;
+			}
+
+			f64 frame_ms = (frame_time - last_frame_time) * 1000.0;
+			last_frame_time = frame_time;
+			worst_frame_ms = std::max(worst_frame_ms, frame_ms);
+
+			/* A new round twice a second, unless the last one is still loading. */
+			if (stress_loading_mib > 0 && frame_time - last_stress_load >= 0.5 && loader.get_queued_count() == 0)
+			{
+				request_stress_loads();
+				last_stress_load = frame_time;
+			}
+
+			for (LoadedResource &loaded : loader.poll())
+			{
+				if (!loaded.ok)
+					continue;
+
+				if (loaded.type == LoadType::Buffer)
+				{
+					resources.destroy(streamed_mesh);
+					streamed_mesh = resources.adopt_buffer(loaded.gl_id, loaded.size);
+				}
+				else if (loaded.type == LoadType::Texture)
+				{
+					resources.destroy(streamed_texture);
+					streamed_texture = resources.adopt_texture(loaded.gl_id, loaded.width, loaded.height, loaded.internal_format);
+				}
+				else
+				{
+					streamed_program.adopt(loaded.gl_id);
+				}
+			}
+
+#ifdef SHADER_HOT_RELOAD
+			if (default_reloader.update())
+				default_program.use();
+#endif
+
+			glfwGetFramebufferSize(window, &width, &height);
+			glViewport(0, 0, width, height);
+
+			// Pixel coordinates with the origin in the top left corner.
+			mat4 projection = ortho(0.0f, width, height, 0.0f, -1.0f, 1.0f);
+
+			transforms.update();
+
+			Aabb world_bounds = transform(triangle_bounds, transforms.get_world(triangle_transform));
+			Frustum frustum = Frustum::from_matrix(projection);
+
+			if (gpu_culling)
+			{
+				gpu_culling->update_instance(0, {world_bounds, 3, 0, 0});
+				gpu_culling->cull(frustum);
+			}
+			else
+			{
+				culling.update(triangle_cull_id, world_bounds);
+				culling.cull(frustum, visible);
+			}
+
+			/* Long stalls, like dragging the window, would otherwise shoot everything off screen. */
+			f32 particle_dt = static_cast<f32>(std::min(frame_ms / 1000.0, 0.1));
+			if (particles)
+			{
+				move_fountain(*particles, width, height);
+				particles->update(particle_dt);
+			}
+			else if (gpu_particles)
+			{
+				move_fountain(*gpu_particles, width, height);
+				gpu_particles->update(particle_dt);
+			}
+
+			if (glfwGetTime() - last_cull_report >= 1.0)
+			{
+				char line[128];
+				if (gpu_culling)
+				{
+					u32 visible_count = gpu_culling->read_visible_count();
+					snprintf(line, sizeof(line), "GPU culling: %u visible, %u culled", visible_count, gpu_culling->get_instance_count() - visible_count);
+				}
+				else
+				{
+					CullStats const &stats = culling.get_stats();
+					snprintf(line, sizeof(line), "Culling: %u visible, %u culled, %.3f ms", stats.visible, stats.culled, stats.cull_ms);
+				}
+				printf("%s\n", line);
+
+				/* GPU timings lag behind by the frames in flight, so these are averages over the last completed frames. */
+				FrameTimings timings = pacer.get_average();
+				char pacing_line[128];
+				snprintf(pacing_line, sizeof(pacing_line), "CPU %.2f ms, GPU %.2f ms, present %.2f ms, wait %.2f ms",
+					timings.cpu_ms, timings.gpu_ms, timings.present_ms, timings.wait_ms);
+				printf("Pacing: %s\n", pacing_line);
+
+				char frame_line[64];
+				snprintf(frame_line, sizeof(frame_line), "Frame: %.2f ms, worst %.2f ms", frame_ms, worst_frame_ms);
+				printf("%s\n", frame_line);
+				worst_frame_ms = 0.0;
+				GlResourceStats const &gl_stats = resources.get_stats();
+				auto buffers = static_cast<std::size_t>(GlResourceType::Buffer);
+				auto textures = static_cast<std::size_t>(GlResourceType::Texture);
+				char resources_line[128];
+				snprintf(resources_line, sizeof(resources_line), "GL: %u buffers %.1f KiB, %u textures %.1f KiB, %.1f KiB pooled",
+					gl_stats.live[buffers], gl_stats.live_bytes[buffers] / 1024.0,
+					gl_stats.live[textures], gl_stats.live_bytes[textures] / 1024.0,
+					(gl_stats.pooled_bytes[buffers] + gl_stats.pooled_bytes[textures]) / 1024.0);
+
+				std::string memory_line = budget.format_summary();
+				printf("%s\n", memory_line.c_str());
+
+				stats_text = std::string{frame_line} + "\n" + pacing_line + "\n" + resources_line + "\n" + memory_line + "\n" + line;
+				if (particles)
+				{
+					ParticleStats const &particle_stats = particles->get_stats();
+					char particles_line[128];
+					snprintf(particles_line, sizeof(particles_line), "Particles: %u alive, update %.3f ms, upload %.3f ms",
+						particle_stats.alive, particle_stats.update_ms, particle_renderer.get_upload_ms());
+					printf("%s\n", particles_line);
+					stats_text += std::string{"\n"} + particles_line;
+				}
+				else if (gpu_particles)
+				{
+					/* Reading the count back stalls until the GPU caught up, once a second is fine. */
+					char particles_line[128];
+					snprintf(particles_line, sizeof(particles_line), "GPU particles: %u alive, update %.3f ms on the GPU",
+						gpu_particles->read_alive_count(), gpu_particles->get_update_ms());
+					printf("%s\n", particles_line);
+					stats_text += std::string{"\n"} + particles_line;
+				}
+				if (stress_loading_mib > 0)
+				{
+					std::string loader_line = loader.format_summary();
+					printf("%s\n", loader_line.c_str());
+					stats_text += "\n" + loader_line;
+				}
+				if (post_chain)
+				{
+					std::string post_line = post_chain->format_summary();
+					printf("%s\n", post_line.c_str());
+					stats_text += "\n" + post_line;
+				}
+				last_cull_report = glfwGetTime();
+			}
+
+			if (glfwGetTime() - last_memory_report >= 10.0)
+			{
+				printf("%s", budget.format_report().c_str());
+				last_memory_report = glfwGetTime();
+			}
+
+			/* The text renderer binds its own program and vertex array. */
+			auto draw_scene = [&]()
+			{
+				default_program.use();
+				glBindVertexArray(resources.get(vao));
+
+				glUniformMatrix4fv(glGetUniformLocation(default_program.get_id(), "our_proj"), 1, GL_FALSE, projection.data());
+				glUniformMatrix4fv(glGetUniformLocation(default_program.get_id(), "our_model"), 1, GL_FALSE, transforms.get_world(triangle_transform).data());
+
+				/* Only drawn meshes count as used, a culled one may be evicted. Restoring it leaves the vertex array bound. */
+				if (gpu_culling)
+				{
+					budget.use(triangle_residency);
+					gpu_culling->draw(GL_TRIANGLES);
+				}
+				else if (!visible.empty())
+				{
+					budget.use(triangle_residency);
+					glDrawArrays(GL_TRIANGLES, 0, 3);
+				}
+
+				/* Centered and scaled to fit, y flipped to point up. Flattened, the projection only keeps depths from -1 to 1. */
+				if (mesh.index_count)
+				{
+					vec3 size = mesh_bounds.max - mesh_bounds.min;
+					f32 fit = 0.6f * std::min(width, height) / std::max(std::max(size.x, size.y), 1e-6f);
+					mat4 model = translate(vec3{width * 0.5f, height * 0.5f, 0.0f}) * scale(vec3{fit, -fit, 0.0f}) * translate(-mesh_bounds.center());
+
+					glUniformMatrix4fv(glGetUniformLocation(default_program.get_id(), "our_model"), 1, GL_FALSE, model.data());
+					glBindVertexArray(resources.get(mesh.vao));
+					glDrawElements(mesh.primitive, static_cast<GLsizei>(mesh.index_count), mesh.index_type, nullptr);
+				}
+
+				if (particles)
+					particle_renderer.draw(*particles, projection);
+				else if (gpu_particles)
+					gpu_particles->draw(projection);
+			};
+
+			/* Resizing only marks the post chain's targets as outdated, they are replaced right before drawing. */
+			if (post_chain)
+			{
+				post_chain->resize(width, height);
+				post_chain->execute([&](RenderPassId) { draw_scene(); });
+
+				/* Times of frames rendered before the last change say nothing about the current scale. */
+				u64 timed_frame = post_chain->get_timed_frame();
+				if (dynamic_resolution && timed_frame != last_timed_frame && timed_frame >= scale_change_frame)
+				{
+					last_timed_frame = timed_frame;
+					if (dynamic_resolution->add_sample(post_chain->get_gpu_ms()))
+					{
+						post_chain->set_render_scale(dynamic_resolution->get_scale());
+						scale_change_frame = post_chain->get_frame();
+						printf("Dynamic resolution: %.1f s, scale %.2f (%dx%d) after %.2f ms on the GPU, target %.2f ms\n",
+							glfwGetTime(), dynamic_resolution->get_scale(),
+							static_cast<int>(width * dynamic_resolution->get_scale()), static_cast<int>(height * dynamic_resolution->get_scale()),
+							dynamic_resolution->get_average_ms(), resolution_settings.target_ms);
+					}
+				}
+			}
+			else
+			{
+				glClear(GL_COLOR_BUFFER_BIT);
+				draw_scene();
+			}
+
+			if (!session.is_loaded())
+			{
+				text.begin_frame();
+				text.add(stats_text, 8.0f, 8.0f, 16.0f, {255, 255, 255, 255});
+				text_renderer.draw(text, projection);
+			}
+
+			/* Read back before presenting, the back buffer is undefined afterwards. This doesn't count towards the frame time. */
+			f64 golden_image_time = 0.0;
+			if (golden_images.is_open())
+			{
+				u64 frame_index = session.get_frame_index();
+				if (frame_index % GOLDEN_FRAME_INTERVAL == 0 || frame_index + 1 == session.get_frame_count())
+				{
+					f64 read_start = glfwGetTime();
+					Image image;
+					read_framebuffer(0, width, height, image);
+					golden_images.check(frame_index, image);
+					golden_image_time = glfwGetTime() - read_start;
+				}
+			}
+
+			pacer.present(window);
+			budget.end_frame();
+			resources.end_frame();
+
+			if (session.is_loaded())
+				frame_times.record(glfwGetTime() - frame_start - golden_image_time);
+		}
+
+		/* A playback fails on a frame that differs from its golden image or on frame times slower than the baseline. */
+		if (session.is_loaded())
+		{
+			frame_times.print("Playback");
+			if (!frame_times_path.empty() && !frame_times.write(frame_times_path.c_str()))
+				printf("Could not write frame times to %s!\n", frame_times_path.c_str());
+
+			if (golden_images.is_open())
+			{
+				golden_images.print_summary();
+				if (golden_images.failed())
+					status = 1;
+			}
+
+			if (!baseline_path.empty())
+			{
+				bool store_baseline = update || (store_missing_baseline && !FrameTimes::has_baseline(baseline_path.c_str()));
+				if (store_baseline ? !frame_times.write_baseline(baseline_path.c_str()) : !frame_times.check_baseline(baseline_path.c_str(), max_regression_percent))
+					status = 1;
+			}
+		}
+
+		printf("%s", budget.format_report().c_str());
+
+		budget.remove(triangle_residency);
+		gpu_culling.reset();
+		gpu_particles.reset();
+		post_chain.reset();
+		loader.stop();
+		resources.destroy(streamed_mesh);
+		resources.destroy(streamed_texture);
+		MappedMesh::destroy(resources, mesh);
+		resources.destroy(ebo);
+		resources.destroy(vbo);
+		resources.destroy(vao);
 	}
 
+	gl_capture::stop();
+
 	glfwDestroyWindow(window);
 	glfwTerminate();
+	return status;
 }
\ No newline at end of file
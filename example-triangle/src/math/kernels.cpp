@@ -0,0 +1,308 @@
+#include "kernels.hpp"
+
+#include <cmath>
+
+#include <math/simd.hpp>
+
+SimdLevel get_simd_level() {
+#if defined(MATH_USE_AVX)
+    return SimdLevel::AVX;
+#elif defined(MATH_USE_SSE)
+    return SimdLevel::SSE;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+char const* get_simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX:
+            return "AVX";
+        case SimdLevel::SSE:
+            return "SSE";
+        case SimdLevel::Scalar:
+        default:
+            return "scalar";
+    }
+}
+
+// region scalar
+void mat4_mul_scalar(mat4 const& a, mat4 const& b, mat4& out) {
+    mat4 result;
+    for (int c = 0; c < 4; ++c) {
+        result.cols[c] = a * b.cols[c];
+    }
+    out = result;
+}
+
+// Cofactor expansion as done by MESA's gluInvertMatrix(). The layout of the
+// input does not matter since inverse(transpose(m)) == transpose(inverse(m)).
+bool mat4_inverse_scalar(mat4 const& mat, mat4& out) {
+    f32 const* m = mat.data();
+    f32 inv[16];
+
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    f32 det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0.0f || !std::isfinite(det)) {
+        return false;
+    }
+
+    f32 inv_det = 1.0f / det;
+    f32* o = out.data();
+    for (int i = 0; i < 16; ++i) {
+        o[i] = inv[i] * inv_det;
+    }
+
+    return true;
+}
+
+void transform_points_scalar(mat4 const& m, f32 const* x, f32 const* y, f32 const* z, f32* out_x, f32* out_y, f32* out_z, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        f32 px = x[i], py = y[i], pz = z[i];
+        out_x[i] = m.cols[0].x * px + m.cols[1].x * py + m.cols[2].x * pz + m.cols[3].x;
+        out_y[i] = m.cols[0].y * px + m.cols[1].y * py + m.cols[2].y * pz + m.cols[3].y;
+        out_z[i] = m.cols[0].z * px + m.cols[1].z * py + m.cols[2].z * pz + m.cols[3].z;
+    }
+}
+
+void mat4_mul_batch_scalar(mat4 const* a, mat4 const* b, mat4* out, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        mat4_mul_scalar(a[i], b[i], out[i]);
+    }
+}
+// endregion
+// region simd
+#if defined(MATH_USE_SSE)
+namespace {
+    inline void mat4_mul_sse(mat4 const& a, mat4 const& b, mat4& out) {
+        __m128 a0 = _mm_load_ps(&a.cols[0].x);
+        __m128 a1 = _mm_load_ps(&a.cols[1].x);
+        __m128 a2 = _mm_load_ps(&a.cols[2].x);
+        __m128 a3 = _mm_load_ps(&a.cols[3].x);
+
+        __m128 result[4];
+        for (int c = 0; c < 4; ++c) {
+            __m128 col = _mm_load_ps(&b.cols[c].x);
+            __m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(col, col, 0x00));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(col, col, 0x55)));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(col, col, 0xAA)));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(col, col, 0xFF)));
+            result[c] = r;
+        }
+
+        // Stored last so that out may alias a or b.
+        for (int c = 0; c < 4; ++c) {
+            _mm_store_ps(&out.cols[c].x, result[c]);
+        }
+    }
+
+#if defined(MATH_USE_AVX)
+    // Computes two result columns per iteration by broadcasting each column of a into both lanes.
+    inline void mat4_mul_avx(mat4 const& a, mat4 const& b, mat4& out) {
+        __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(&a.cols[0].x));
+        __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(&a.cols[1].x));
+        __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(&a.cols[2].x));
+        __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(&a.cols[3].x));
+
+        __m256 b01 = _mm256_load_ps(&b.cols[0].x);
+        __m256 b23 = _mm256_load_ps(&b.cols[2].x);
+
+        __m256 r01 = _mm256_mul_ps(a0, _mm256_shuffle_ps(b01, b01, 0x00));
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(a1, _mm256_shuffle_ps(b01, b01, 0x55)));
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(a2, _mm256_shuffle_ps(b01, b01, 0xAA)));
+        r01 = _mm256_add_ps(r01, _mm256_mul_ps(a3, _mm256_shuffle_ps(b01, b01, 0xFF)));
+
+        __m256 r23 = _mm256_mul_ps(a0, _mm256_shuffle_ps(b23, b23, 0x00));
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(a1, _mm256_shuffle_ps(b23, b23, 0x55)));
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(a2, _mm256_shuffle_ps(b23, b23, 0xAA)));
+        r23 = _mm256_add_ps(r23, _mm256_mul_ps(a3, _mm256_shuffle_ps(b23, b23, 0xFF)));
+
+        _mm256_store_ps(&out.cols[0].x, r01);
+        _mm256_store_ps(&out.cols[2].x, r23);
+    }
+#endif
+
+    /*
+     * Cramer's rule as laid out in Intel's "Streaming SIMD Extensions - Inverse of 4x4 Matrix"
+     * (AP-928), with the reciprocal refined to full precision. Like the scalar version it does
+     * not care whether the input is row- or column-major.
+     */
+    inline bool mat4_inverse_sse(mat4 const& mat, mat4& out) {
+        f32 const* src = mat.data();
+        __m128 minor0, minor1, minor2, minor3;
+        __m128 row0, row1, row2, row3;
+        __m128 det, tmp;
+
+        tmp = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<__m64 const*>(src)), reinterpret_cast<__m64 const*>(src + 4));
+        row1 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<__m64 const*>(src + 8)), reinterpret_cast<__m64 const*>(src + 12));
+        row0 = _mm_shuffle_ps(tmp, row1, 0x88);
+        row1 = _mm_shuffle_ps(row1, tmp, 0xDD);
+        tmp = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<__m64 const*>(src + 2)), reinterpret_cast<__m64 const*>(src + 6));
+        row3 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<__m64 const*>(src + 10)), reinterpret_cast<__m64 const*>(src + 14));
+        row2 = _mm_shuffle_ps(tmp, row3, 0x88);
+        row3 = _mm_shuffle_ps(row3, tmp, 0xDD);
+
+        tmp = _mm_mul_ps(row2, row3);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+        minor0 = _mm_mul_ps(row1, tmp);
+        minor1 = _mm_mul_ps(row0, tmp);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+        minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp), minor0);
+        minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor1);
+        minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+        tmp = _mm_mul_ps(row1, row2);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+        minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor0);
+        minor3 = _mm_mul_ps(row0, tmp);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+        minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp));
+        minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor3);
+        minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+        tmp = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+        row2 = _mm_shuffle_ps(row2, row2, 0x4E);
+        minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor0);
+        minor2 = _mm_mul_ps(row0, tmp);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+        minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp));
+        minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor2);
+        minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+        tmp = _mm_mul_ps(row0, row1);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+        minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor2);
+        minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp), minor3);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+        minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp), minor2);
+        minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp));
+
+        tmp = _mm_mul_ps(row0, row3);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+        minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp));
+        minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor2);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+        minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor1);
+        minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp));
+
+        tmp = _mm_mul_ps(row0, row2);
+        tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+        minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor1);
+        minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp));
+        tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+        minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp));
+        minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor3);
+
+        det = _mm_mul_ps(row0, minor0);
+        det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+        det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
+
+        f32 det_value = _mm_cvtss_f32(det);
+        if (det_value == 0.0f || !std::isfinite(det_value)) {
+            return false;
+        }
+
+        det = _mm_set1_ps(1.0f / det_value);
+        _mm_store_ps(&out.cols[0].x, _mm_mul_ps(det, minor0));
+        _mm_store_ps(&out.cols[1].x, _mm_mul_ps(det, minor1));
+        _mm_store_ps(&out.cols[2].x, _mm_mul_ps(det, minor2));
+        _mm_store_ps(&out.cols[3].x, _mm_mul_ps(det, minor3));
+
+        return true;
+    }
+}
+#endif
+
+void mat4_mul(mat4 const& a, mat4 const& b, mat4& out) {
+#if defined(MATH_USE_AVX)
+    mat4_mul_avx(a, b, out);
+#elif defined(MATH_USE_SSE)
+    mat4_mul_sse(a, b, out);
+#else
+    mat4_mul_scalar(a, b, out);
+#endif
+}
+
+bool mat4_inverse(mat4 const& m, mat4& out) {
+#if defined(MATH_USE_SSE)
+    return mat4_inverse_sse(m, out);
+#else
+    return mat4_inverse_scalar(m, out);
+#endif
+}
+
+void mat4_mul_batch(mat4 const* a, mat4 const* b, mat4* out, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        mat4_mul(a[i], b[i], out[i]);
+    }
+}
+
+void transform_points(mat4 const& m, f32 const* x, f32 const* y, f32 const* z, f32* out_x, f32* out_y, f32* out_z, std::size_t count) {
+    std::size_t i = 0;
+
+#if defined(MATH_USE_AVX)
+    {
+        __m256 m00 = _mm256_set1_ps(m.cols[0].x), m01 = _mm256_set1_ps(m.cols[0].y), m02 = _mm256_set1_ps(m.cols[0].z);
+        __m256 m10 = _mm256_set1_ps(m.cols[1].x), m11 = _mm256_set1_ps(m.cols[1].y), m12 = _mm256_set1_ps(m.cols[1].z);
+        __m256 m20 = _mm256_set1_ps(m.cols[2].x), m21 = _mm256_set1_ps(m.cols[2].y), m22 = _mm256_set1_ps(m.cols[2].z);
+        __m256 m30 = _mm256_set1_ps(m.cols[3].x), m31 = _mm256_set1_ps(m.cols[3].y), m32 = _mm256_set1_ps(m.cols[3].z);
+
+        for (; i + 8 <= count; i += 8) {
+            __m256 px = _mm256_loadu_ps(x + i);
+            __m256 py = _mm256_loadu_ps(y + i);
+            __m256 pz = _mm256_loadu_ps(z + i);
+
+            __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, px), _mm256_mul_ps(m10, py)), _mm256_add_ps(_mm256_mul_ps(m20, pz), m30));
+            __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, px), _mm256_mul_ps(m11, py)), _mm256_add_ps(_mm256_mul_ps(m21, pz), m31));
+            __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, px), _mm256_mul_ps(m12, py)), _mm256_add_ps(_mm256_mul_ps(m22, pz), m32));
+
+            _mm256_storeu_ps(out_x + i, rx);
+            _mm256_storeu_ps(out_y + i, ry);
+            _mm256_storeu_ps(out_z + i, rz);
+        }
+    }
+#endif
+
+#if defined(MATH_USE_SSE)
+    {
+        __m128 m00 = _mm_set1_ps(m.cols[0].x), m01 = _mm_set1_ps(m.cols[0].y), m02 = _mm_set1_ps(m.cols[0].z);
+        __m128 m10 = _mm_set1_ps(m.cols[1].x), m11 = _mm_set1_ps(m.cols[1].y), m12 = _mm_set1_ps(m.cols[1].z);
+        __m128 m20 = _mm_set1_ps(m.cols[2].x), m21 = _mm_set1_ps(m.cols[2].y), m22 = _mm_set1_ps(m.cols[2].z);
+        __m128 m30 = _mm_set1_ps(m.cols[3].x), m31 = _mm_set1_ps(m.cols[3].y), m32 = _mm_set1_ps(m.cols[3].z);
+
+        for (; i + 4 <= count; i += 4) {
+            __m128 px = _mm_loadu_ps(x + i);
+            __m128 py = _mm_loadu_ps(y + i);
+            __m128 pz = _mm_loadu_ps(z + i);
+
+            __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, px), _mm_mul_ps(m10, py)), _mm_add_ps(_mm_mul_ps(m20, pz), m30));
+            __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, px), _mm_mul_ps(m11, py)), _mm_add_ps(_mm_mul_ps(m21, pz), m31));
+            __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, px), _mm_mul_ps(m12, py)), _mm_add_ps(_mm_mul_ps(m22, pz), m32));
+
+            _mm_storeu_ps(out_x + i, rx);
+            _mm_storeu_ps(out_y + i, ry);
+            _mm_storeu_ps(out_z + i, rz);
+        }
+    }
+#endif
+
+    transform_points_scalar(m, x + i, y + i, z + i, out_x + i, out_y + i, out_z + i, count - i);
+}
+// endregion
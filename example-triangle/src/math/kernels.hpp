@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+#include <math/matrix.hpp>
+#include <util/base.hpp>
+
+/*
+ * Hot math kernels. The unsuffixed functions dispatch to the widest instruction set the
+ * translation unit was compiled for (see MATH_NATIVE in CMakeLists.txt; MATH_NO_SIMD turns
+ * the intrinsics off). The _scalar variants are always available, both as the fallback
+ * and as a reference for benchmarks.
+ *
+ * Batch APIs take structure-of-arrays input, i.e. one array per component. Input and
+ * output arrays may alias.
+ */
+
+enum class SimdLevel {
+    Scalar,
+    SSE,
+    AVX,
+};
+
+NODISCARD SimdLevel get_simd_level();
+NODISCARD char const* get_simd_level_name(SimdLevel level);
+
+void mat4_mul_scalar(mat4 const& a, mat4 const& b, mat4& out);
+bool mat4_inverse_scalar(mat4 const& m, mat4& out);
+
+// Transforms count points (w = 1) by an affine matrix.
+void transform_points(mat4 const& m, f32 const* x, f32 const* y, f32 const* z, f32* out_x, f32* out_y, f32* out_z, std::size_t count);
+void transform_points_scalar(mat4 const& m, f32 const* x, f32 const* y, f32 const* z, f32* out_x, f32* out_y, f32* out_z, std::size_t count);
+
+// Multiplies count matrices pairwise: out[i] = a[i] * b[i].
+void mat4_mul_batch(mat4 const* a, mat4 const* b, mat4* out, std::size_t count);
+void mat4_mul_batch_scalar(mat4 const* a, mat4 const* b, mat4* out, std::size_t count);
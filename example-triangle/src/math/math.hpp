@@ -0,0 +1,6 @@
+#pragma once
+
+#include <math/vector.hpp>
+#include <math/matrix.hpp>
+#include <math/quaternion.hpp>
+#include <math/kernels.hpp>
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <math/vector.hpp>
+#include <util/base.hpp>
+
+/*
+ * Column-major 4x4 matrix, matching what glUniformMatrix4fv() expects with transpose = GL_FALSE.
+ * cols[c].x is the element in row 0 of column c. Aligned to 32 bytes so the AVX kernels can
+ * load two columns at once.
+ */
+struct alignas(32) mat4 {
+    vec4 cols[4];
+
+    constexpr mat4() : cols{} { }
+    constexpr mat4(vec4 c0, vec4 c1, vec4 c2, vec4 c3) : cols{c0, c1, c2, c3} { }
+
+    NODISCARD static constexpr mat4 identity() {
+        return {{1.0f, 0.0f, 0.0f, 0.0f},
+                {0.0f, 1.0f, 0.0f, 0.0f},
+                {0.0f, 0.0f, 1.0f, 0.0f},
+                {0.0f, 0.0f, 0.0f, 1.0f}};
+    }
+
+    NODISCARD f32 const* data() const { return &cols[0].x; }
+    NODISCARD f32* data() { return &cols[0].x; }
+
+    constexpr vec4& operator[](int col) { return cols[col]; }
+    constexpr vec4 const& operator[](int col) const { return cols[col]; }
+};
+
+static_assert(sizeof(mat4) == 16 * sizeof(f32), "mat4 must be tightly packed");
+
+// Implemented in math/kernels.cpp, see there for the SSE/AVX variants.
+void mat4_mul(mat4 const& a, mat4 const& b, mat4& out);
+bool mat4_inverse(mat4 const& m, mat4& out);
+
+inline mat4 operator*(mat4 const& a, mat4 const& b) {
+    mat4 out;
+    mat4_mul(a, b, out);
+    return out;
+}
+
+constexpr vec4 operator*(mat4 const& m, vec4 v) {
+    return m.cols[0] * v.x + m.cols[1] * v.y + m.cols[2] * v.z + m.cols[3] * v.w;
+}
+
+// Returns the identity matrix if m is singular.
+inline mat4 inverse(mat4 const& m) {
+    mat4 out;
+    if (!mat4_inverse(m, out)) {
+        return mat4::identity();
+    }
+    return out;
+}
+
+constexpr mat4 transpose(mat4 const& m) {
+    return {{m.cols[0].x, m.cols[1].x, m.cols[2].x, m.cols[3].x},
+            {m.cols[0].y, m.cols[1].y, m.cols[2].y, m.cols[3].y},
+            {m.cols[0].z, m.cols[1].z, m.cols[2].z, m.cols[3].z},
+            {m.cols[0].w, m.cols[1].w, m.cols[2].w, m.cols[3].w}};
+}
+
+constexpr mat4 translate(vec3 t) {
+    return {{1.0f, 0.0f, 0.0f, 0.0f},
+            {0.0f, 1.0f, 0.0f, 0.0f},
+            {0.0f, 0.0f, 1.0f, 0.0f},
+            {t.x, t.y, t.z, 1.0f}};
+}
+
+constexpr mat4 scale(vec3 s) {
+    return {{s.x, 0.0f, 0.0f, 0.0f},
+            {0.0f, s.y, 0.0f, 0.0f},
+            {0.0f, 0.0f, s.z, 0.0f},
+            {0.0f, 0.0f, 0.0f, 1.0f}};
+}
+
+// region projections
+namespace detail {
+    // tan() is not constexpr before C++26. Lambert's continued fraction converges to float
+    // precision within a handful of terms for |x| < pi / 2, which covers every sane half-FOV.
+    constexpr f32 tan(f32 x) {
+        f32 x2 = x * x;
+        f32 fraction = 0.0f;
+        for (int k = 19; k >= 3; k -= 2) {
+            fraction = x2 / (static_cast<f32>(k) - fraction);
+        }
+        return x / (1.0f - fraction);
+    }
+}
+
+/*
+ * Same convention as glOrtho(): maps [left, right] x [bottom, top] x [-near, -far] to clip space.
+ * Passing top < bottom gives a y-down projection, e.g. ortho(0, width, height, 0, -1, 1) for pixel coordinates.
+ */
+constexpr mat4 ortho(f32 left, f32 right, f32 bottom, f32 top, f32 near_plane, f32 far_plane) {
+    return {{2.0f / (right - left), 0.0f, 0.0f, 0.0f},
+            {0.0f, 2.0f / (top - bottom), 0.0f, 0.0f},
+            {0.0f, 0.0f, -2.0f / (far_plane - near_plane), 0.0f},
+            {-(right + left) / (right - left), -(top + bottom) / (top - bottom), -(far_plane + near_plane) / (far_plane - near_plane), 1.0f}};
+}
+
+// Same convention as gluPerspective(), fov_y is given in radians.
+constexpr mat4 perspective(f32 fov_y, f32 aspect, f32 near_plane, f32 far_plane) {
+    f32 focal = 1.0f / detail::tan(fov_y * 0.5f);
+    return {{focal / aspect, 0.0f, 0.0f, 0.0f},
+            {0.0f, focal, 0.0f, 0.0f},
+            {0.0f, 0.0f, (far_plane + near_plane) / (near_plane - far_plane), -1.0f},
+            {0.0f, 0.0f, 2.0f * far_plane * near_plane / (near_plane - far_plane), 0.0f}};
+}
+// endregion
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cmath>
+
+#include <math/matrix.hpp>
+#include <math/vector.hpp>
+#include <util/base.hpp>
+
+// Rotation quaternion, w is the scalar part.
+struct alignas(16) quat {
+    f32 x, y, z, w;
+
+    constexpr quat() : x{0.0f}, y{0.0f}, z{0.0f}, w{1.0f} { }
+    constexpr quat(f32 x, f32 y, f32 z, f32 w) : x{x}, y{y}, z{z}, w{w} { }
+
+    NODISCARD static constexpr quat identity() { return {}; }
+
+    // axis must be normalized, angle is given in radians.
+    NODISCARD static quat from_axis_angle(vec3 axis, f32 angle) {
+        f32 s = std::sin(angle * 0.5f);
+        return {axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f)};
+    }
+};
+
+constexpr quat operator*(quat a, quat b) {
+    return {a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+            a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+constexpr f32 dot(quat a, quat b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+constexpr quat conjugate(quat q) { return {-q.x, -q.y, -q.z, q.w}; }
+
+inline quat normalize(quat q) {
+    f32 inv = 1.0f / std::sqrt(dot(q, q));
+    return {q.x * inv, q.y * inv, q.z * inv, q.w * inv};
+}
+
+constexpr vec3 rotate(quat q, vec3 v) {
+    // v + 2w(u x v) + 2(u x (u x v)), with u being the vector part.
+    vec3 u{q.x, q.y, q.z};
+    vec3 t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+}
+
+constexpr mat4 to_mat4(quat q) {
+    f32 xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    f32 xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    f32 wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    return {{1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f},
+            {2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f},
+            {2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f},
+            {0.0f, 0.0f, 0.0f, 1.0f}};
+}
+
+// Spherical interpolation along the shorter arc, falls back to nlerp for nearly parallel inputs.
+inline quat slerp(quat a, quat b, f32 t) {
+    f32 cos_theta = dot(a, b);
+    if (cos_theta < 0.0f) {
+        b = {-b.x, -b.y, -b.z, -b.w};
+        cos_theta = -cos_theta;
+    }
+
+    f32 wa = 1.0f - t, wb = t;
+    if (cos_theta < 0.9995f) {
+        f32 theta = std::acos(cos_theta);
+        f32 inv_sin = 1.0f / std::sin(theta);
+        wa = std::sin(wa * theta) * inv_sin;
+        wb = std::sin(wb * theta) * inv_sin;
+    }
+
+    return normalize(quat{a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb, a.w * wa + b.w * wb});
+}
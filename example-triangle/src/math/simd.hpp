@@ -0,0 +1,18 @@
+#pragma once
+
+/*
+ * Selects the instruction set used by the SIMD kernels at compile time and pulls in the
+ * matching intrinsics header. Defines MATH_USE_AVX and/or MATH_USE_SSE accordingly;
+ * MATH_NO_SIMD forces the scalar paths.
+ */
+
+#if defined(MATH_NO_SIMD)
+// Scalar kernels only.
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define MATH_USE_AVX
+#define MATH_USE_SSE
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MATH_USE_SSE
+#endif
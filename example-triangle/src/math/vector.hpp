@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cmath>
+
+#include <util/base.hpp>
+
+/*
+ * Small vector types laid out like their GLSL counterparts, so they can be handed to
+ * glUniform*fv() and vertex buffers directly. vec3 is padded to 16 bytes to keep it
+ * SSE-friendly; use plain f32 arrays where tight packing matters.
+ */
+
+struct alignas(8) vec2 {
+    f32 x, y;
+
+    constexpr vec2() : x{0.0f}, y{0.0f} { }
+    constexpr vec2(f32 x, f32 y) : x{x}, y{y} { }
+    constexpr explicit vec2(f32 s) : x{s}, y{s} { }
+};
+
+struct alignas(16) vec3 {
+    f32 x, y, z;
+
+    constexpr vec3() : x{0.0f}, y{0.0f}, z{0.0f} { }
+    constexpr vec3(f32 x, f32 y, f32 z) : x{x}, y{y}, z{z} { }
+    constexpr explicit vec3(f32 s) : x{s}, y{s}, z{s} { }
+};
+
+struct alignas(16) vec4 {
+    f32 x, y, z, w;
+
+    constexpr vec4() : x{0.0f}, y{0.0f}, z{0.0f}, w{0.0f} { }
+    constexpr vec4(f32 x, f32 y, f32 z, f32 w) : x{x}, y{y}, z{z}, w{w} { }
+    constexpr vec4(vec3 v, f32 w) : x{v.x}, y{v.y}, z{v.z}, w{w} { }
+    constexpr explicit vec4(f32 s) : x{s}, y{s}, z{s}, w{s} { }
+
+    NODISCARD constexpr vec3 xyz() const { return {x, y, z}; }
+};
+
+static_assert(sizeof(vec2) == 8, "vec2 must match the GLSL layout");
+static_assert(sizeof(vec3) == 16, "vec3 is padded to a full SSE register");
+static_assert(sizeof(vec4) == 16, "vec4 must match the GLSL layout");
+
+// region vec2
+constexpr vec2 operator+(vec2 a, vec2 b) { return {a.x + b.x, a.y + b.y}; }
+constexpr vec2 operator-(vec2 a, vec2 b) { return {a.x - b.x, a.y - b.y}; }
+constexpr vec2 operator-(vec2 a) { return {-a.x, -a.y}; }
+constexpr vec2 operator*(vec2 a, f32 s) { return {a.x * s, a.y * s}; }
+constexpr vec2 operator*(f32 s, vec2 a) { return a * s; }
+constexpr vec2 operator*(vec2 a, vec2 b) { return {a.x * b.x, a.y * b.y}; }
+constexpr vec2 operator/(vec2 a, f32 s) { return {a.x / s, a.y / s}; }
+
+constexpr f32 dot(vec2 a, vec2 b) { return a.x * b.x + a.y * b.y; }
+inline f32 length(vec2 a) { return std::sqrt(dot(a, a)); }
+inline vec2 normalize(vec2 a) { return a / length(a); }
+// endregion
+// region vec3
+constexpr vec3 operator+(vec3 a, vec3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+constexpr vec3 operator-(vec3 a, vec3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+constexpr vec3 operator-(vec3 a) { return {-a.x, -a.y, -a.z}; }
+constexpr vec3 operator*(vec3 a, f32 s) { return {a.x * s, a.y * s, a.z * s}; }
+constexpr vec3 operator*(f32 s, vec3 a) { return a * s; }
+constexpr vec3 operator*(vec3 a, vec3 b) { return {a.x * b.x, a.y * b.y, a.z * b.z}; }
+constexpr vec3 operator/(vec3 a, f32 s) { return {a.x / s, a.y / s, a.z / s}; }
+
+constexpr f32 dot(vec3 a, vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+constexpr vec3 cross(vec3 a, vec3 b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+inline f32 length(vec3 a) { return std::sqrt(dot(a, a)); }
+inline vec3 normalize(vec3 a) { return a / length(a); }
+// endregion
+// region vec4
+constexpr vec4 operator+(vec4 a, vec4 b) { return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w}; }
+constexpr vec4 operator-(vec4 a, vec4 b) { return {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w}; }
+constexpr vec4 operator-(vec4 a) { return {-a.x, -a.y, -a.z, -a.w}; }
+constexpr vec4 operator*(vec4 a, f32 s) { return {a.x * s, a.y * s, a.z * s, a.w * s}; }
+constexpr vec4 operator*(f32 s, vec4 a) { return a * s; }
+constexpr vec4 operator*(vec4 a, vec4 b) { return {a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w}; }
+constexpr vec4 operator/(vec4 a, f32 s) { return {a.x / s, a.y / s, a.z / s, a.w / s}; }
+
+constexpr f32 dot(vec4 a, vec4 b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline f32 length(vec4 a) { return std::sqrt(dot(a, a)); }
+inline vec4 normalize(vec4 a) { return a / length(a); }
+// endregion
@@ -0,0 +1,317 @@
+#include "meshfile.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#ifdef OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    u64 align_up(u64 value) {
+        return (value + MESH_BLOCK_ALIGNMENT - 1) & ~u64{MESH_BLOCK_ALIGNMENT - 1};
+    }
+
+    bool is_draw_mode(u32 primitive) {
+        switch (primitive) {
+            case GL_POINTS:
+            case GL_LINES:
+            case GL_LINE_LOOP:
+            case GL_LINE_STRIP:
+            case GL_TRIANGLES:
+            case GL_TRIANGLE_STRIP:
+            case GL_TRIANGLE_FAN:
+            case GL_LINES_ADJACENCY:
+            case GL_LINE_STRIP_ADJACENCY:
+            case GL_TRIANGLES_ADJACENCY:
+            case GL_TRIANGLE_STRIP_ADJACENCY:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    template<typename INDEX>
+    bool indices_below(u8 const* data, u32 count, u32 limit) {
+        INDEX const* indices = reinterpret_cast<INDEX const*>(data);
+        INDEX largest = 0;
+        for (u32 i = 0; i < count; ++i) {
+            largest = std::max(largest, indices[i]);
+        }
+        return count == 0 || largest < limit;
+    }
+
+    u32 index_size(u32 index_type) {
+        return index_type == GL_UNSIGNED_SHORT ? 2 : 4;
+    }
+
+    u32 component_size(u32 type) {
+        switch (type) {
+            case GL_BYTE:
+            case GL_UNSIGNED_BYTE:
+                return 1;
+            case GL_SHORT:
+            case GL_UNSIGNED_SHORT:
+            case GL_HALF_FLOAT:
+                return 2;
+            case GL_INT:
+            case GL_UNSIGNED_INT:
+            case GL_FLOAT:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    void write_padding(std::ofstream& file, u64 position, u64 target) {
+        static char const zeros[MESH_BLOCK_ALIGNMENT] = {};
+        file.write(zeros, static_cast<std::streamsize>(target - position));
+    }
+}
+
+bool write_mesh_file(std::string const& path, MeshData const& mesh) {
+    if (mesh.attributes.empty() || mesh.attributes.size() > MESH_MAX_ATTRIBUTES || mesh.vertex_stride == 0) {
+        std::cerr << "Unable to write mesh " << path << ": bad vertex layout" << std::endl;
+        return false;
+    }
+
+    u32 vertex_count = mesh.get_vertex_count();
+    bool short_indices = vertex_count <= 0x10000;
+
+    MeshFileHeader header{};
+    header.magic = MESH_FILE_MAGIC;
+    header.version = MESH_FILE_VERSION;
+    header.primitive = GL_TRIANGLES;
+    header.index_type = short_indices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    header.vertex_count = vertex_count;
+    header.index_count = static_cast<u32>(mesh.indices.size());
+    header.vertex_stride = mesh.vertex_stride;
+    header.attribute_count = static_cast<u32>(mesh.attributes.size());
+    header.vertex_offset = align_up(sizeof(MeshFileHeader));
+    header.vertex_bytes = u64{vertex_count} * mesh.vertex_stride;
+    header.index_offset = align_up(header.vertex_offset + header.vertex_bytes);
+    header.index_bytes = u64{header.index_count} * index_size(header.index_type);
+    std::memcpy(header.bounds_min, &mesh.bounds.min, sizeof(header.bounds_min));
+    std::memcpy(header.bounds_max, &mesh.bounds.max, sizeof(header.bounds_max));
+    std::copy(mesh.attributes.begin(), mesh.attributes.end(), header.attributes);
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (!file) {
+        std::cerr << "Unable to write mesh " << path << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    write_padding(file, sizeof(header), header.vertex_offset);
+    file.write(reinterpret_cast<char const*>(mesh.vertices.data()), static_cast<std::streamsize>(header.vertex_bytes));
+    write_padding(file, header.vertex_offset + header.vertex_bytes, header.index_offset);
+
+    if (short_indices) {
+        std::vector<u16> indices(mesh.indices.begin(), mesh.indices.end());
+        file.write(reinterpret_cast<char const*>(indices.data()), static_cast<std::streamsize>(header.index_bytes));
+    } else {
+        file.write(reinterpret_cast<char const*>(mesh.indices.data()), static_cast<std::streamsize>(header.index_bytes));
+    }
+
+    if (!file) {
+        std::cerr << "Unable to write mesh " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+MappedMesh::MappedMesh() :
+    _data{nullptr},
+    _size{0},
+    _mapped{false},
+    _fallback{} {
+
+}
+
+MappedMesh::~MappedMesh() {
+    close();
+}
+
+bool MappedMesh::open(std::string const& path) {
+    close();
+
+#ifdef OS_UNIX
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Unable to open mesh " << path << std::endl;
+        return false;
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            _data = static_cast<u8 const*>(data);
+            _size = static_cast<std::size_t>(info.st_size);
+            _mapped = true;
+
+            // Uploads read the blocks front to back.
+            madvise(data, _size, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd);
+#endif
+
+    if (!_mapped) {
+        std::ifstream file{path, std::ios::binary};
+        if (!file) {
+            std::cerr << "Unable to open mesh " << path << std::endl;
+            return false;
+        }
+
+        _fallback.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        _data = _fallback.data();
+        _size = _fallback.size();
+    }
+
+    if (!validate(path)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedMesh::close() {
+#ifdef OS_UNIX
+    if (_mapped) {
+        munmap(const_cast<u8*>(_data), _size);
+    }
+#endif
+
+    _data = nullptr;
+    _size = 0;
+    _mapped = false;
+    _fallback.clear();
+    _fallback.shrink_to_fit();
+}
+
+GpuMesh MappedMesh::upload(GlResources& resources, GLenum usage) const {
+    MeshFileHeader const& header = get_header();
+
+    GpuMesh mesh{};
+    mesh.primitive = header.primitive;
+    mesh.index_type = header.index_type;
+    mesh.index_count = header.index_count;
+    mesh.vertices = resources.create_buffer(header.vertex_bytes, usage, get_vertices());
+    mesh.indices = resources.create_buffer(header.index_bytes, usage, get_indices());
+    mesh.vao = resources.create_vertex_array();
+
+    glBindVertexArray(resources.get(mesh.vao));
+    glBindBuffer(GL_ARRAY_BUFFER, resources.get(mesh.vertices));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, resources.get(mesh.indices));
+
+    for (u32 i = 0; i < header.attribute_count; ++i) {
+        MeshAttribute const& attribute = header.attributes[i];
+        glVertexAttribPointer(attribute.location, static_cast<GLint>(attribute.components), attribute.type,
+                              attribute.normalized ? GL_TRUE : GL_FALSE, static_cast<GLsizei>(header.vertex_stride),
+                              reinterpret_cast<void const*>(static_cast<std::uintptr_t>(attribute.offset)));
+        glEnableVertexAttribArray(attribute.location);
+    }
+
+    return mesh;
+}
+
+void MappedMesh::destroy(GlResources& resources, GpuMesh& mesh) {
+    resources.destroy(mesh.vao);
+    resources.destroy(mesh.vertices);
+    resources.destroy(mesh.indices);
+    mesh.index_count = 0;
+}
+
+MeshFileHeader const& MappedMesh::get_header() const {
+    return *reinterpret_cast<MeshFileHeader const*>(_data);
+}
+
+Aabb MappedMesh::get_bounds() const {
+    MeshFileHeader const& header = get_header();
+    return {
+        {header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]},
+        {header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]},
+    };
+}
+
+u8 const* MappedMesh::get_vertices() const {
+    return _data + get_header().vertex_offset;
+}
+
+u8 const* MappedMesh::get_indices() const {
+    return _data + get_header().index_offset;
+}
+
+std::size_t MappedMesh::get_file_size() const {
+    return _size;
+}
+
+bool MappedMesh::validate(std::string const& path) const {
+    auto fail = [&path](char const* reason) {
+        std::cerr << "Invalid mesh " << path << ": " << reason << std::endl;
+        return false;
+    };
+
+    if (_size < sizeof(MeshFileHeader)) {
+        return fail("too short");
+    }
+
+    MeshFileHeader const& header = get_header();
+    if (header.magic != MESH_FILE_MAGIC) {
+        return fail("not a mesh file");
+    }
+    if (header.version != MESH_FILE_VERSION) {
+        return fail("unsupported version");
+    }
+    if (!is_draw_mode(header.primitive)) {
+        return fail("bad primitive");
+    }
+    if (header.index_type != GL_UNSIGNED_SHORT && header.index_type != GL_UNSIGNED_INT) {
+        return fail("bad index type");
+    }
+    if (header.attribute_count == 0 || header.attribute_count > MESH_MAX_ATTRIBUTES || header.vertex_stride == 0) {
+        return fail("bad vertex layout");
+    }
+
+    u32 used_locations = 0;
+    for (u32 i = 0; i < header.attribute_count; ++i) {
+        MeshAttribute const& attribute = header.attributes[i];
+        u32 size = component_size(attribute.type) * attribute.components;
+        if (size == 0 || attribute.components > 4 || u64{attribute.offset} + size > header.vertex_stride) {
+            return fail("bad vertex attribute");
+        }
+        if (attribute.location >= MESH_MAX_ATTRIBUTE_LOCATIONS || (used_locations & (1u << attribute.location))) {
+            return fail("bad vertex attribute location");
+        }
+        used_locations |= 1u << attribute.location;
+    }
+
+    // Compared against the size without adding to the offsets, they could overflow.
+    if (header.vertex_bytes != u64{header.vertex_count} * header.vertex_stride ||
+        header.index_bytes != u64{header.index_count} * index_size(header.index_type)) {
+        return fail("block sizes don't match the counts");
+    }
+    if (header.vertex_offset % MESH_BLOCK_ALIGNMENT != 0 || header.index_offset % MESH_BLOCK_ALIGNMENT != 0 ||
+        header.vertex_offset > _size || header.vertex_bytes > _size - header.vertex_offset ||
+        header.index_offset > _size || header.index_bytes > _size - header.index_offset) {
+        return fail("blocks outside of the file");
+    }
+
+    // Draws would read vertices past the buffer otherwise. The index block is aligned, so it can be read in place.
+    bool in_range = header.index_type == GL_UNSIGNED_SHORT
+                        ? indices_below<u16>(_data + header.index_offset, header.index_count, header.vertex_count)
+                        : indices_below<u32>(_data + header.index_offset, header.index_count, header.vertex_count);
+    if (!in_range) {
+        return fail("index out of range");
+    }
+
+    return true;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <render/glresources.hpp>
+#include <scene/bounds.hpp>
+#include <util/base.hpp>
+
+/*
+ * A mesh file holds a header and two blocks, the vertices and the indices, each laid out
+ * exactly as it is uploaded. The header describes the vertex attributes the way
+ * glVertexAttribPointer() takes them, so loading is mapping the file, checking the header and
+ * handing the blocks to glBufferData().
+ *
+ * All fields are little endian, blocks start at multiples of MESH_BLOCK_ALIGNMENT.
+ */
+constexpr u32 MESH_FILE_MAGIC = 0x4853454d; // "MESH"
+constexpr u32 MESH_FILE_VERSION = 1;
+constexpr std::size_t MESH_MAX_ATTRIBUTES = 8;
+constexpr std::size_t MESH_BLOCK_ALIGNMENT = 64;
+// Every implementation has at least 16 vertex attributes, files stay below that so they work without asking the context.
+constexpr u32 MESH_MAX_ATTRIBUTE_LOCATIONS = 16;
+
+enum class MeshSemantic : u32 {
+    Position,
+    Texcoord,
+    Color,
+    Normal,
+};
+
+struct MeshAttribute {
+    MeshSemantic semantic;
+    u32 location;
+    u32 type; // GL_FLOAT, GL_UNSIGNED_BYTE...
+    u32 components;
+    u32 normalized;
+    u32 offset;
+};
+
+struct MeshFileHeader {
+    u32 magic;
+    u32 version;
+    u32 primitive; // GL_TRIANGLES...
+    u32 index_type; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    u32 vertex_count;
+    u32 index_count;
+    u32 vertex_stride;
+    u32 attribute_count;
+    u64 vertex_offset;
+    u64 vertex_bytes;
+    u64 index_offset;
+    u64 index_bytes;
+    f32 bounds_min[3];
+    f32 bounds_max[3];
+    MeshAttribute attributes[MESH_MAX_ATTRIBUTES];
+};
+
+static_assert(sizeof(MeshAttribute) == 24, "MeshAttribute is part of the file format");
+static_assert(sizeof(MeshFileHeader) == 280, "MeshFileHeader is part of the file format");
+
+// A mesh in memory, in the layout it is written in.
+struct MeshData {
+    std::vector<MeshAttribute> attributes;
+    u32 vertex_stride = 0;
+    std::vector<u8> vertices;
+    std::vector<u32> indices;
+    Aabb bounds{};
+
+    NODISCARD u32 get_vertex_count() const { return vertex_stride ? static_cast<u32>(vertices.size() / vertex_stride) : 0; }
+};
+
+// Indices are stored as 16 bits where they fit.
+NODISCARD bool write_mesh_file(std::string const& path, MeshData const& mesh);
+
+// Buffers and vertex array of an uploaded mesh, ready for glDrawElements().
+struct GpuMesh {
+    VertexArrayHandle vao;
+    BufferHandle vertices;
+    BufferHandle indices;
+    GLenum primitive;
+    GLenum index_type;
+    u32 index_count;
+};
+
+/*
+ * A mesh file mapped into memory. Opening reads the index block to check every index against
+ * the vertex count, the vertex block is only faulted in as the upload touches it. Nothing is
+ * copied. Platforms without mmap read the file instead.
+ */
+class MappedMesh {
+public:
+    MappedMesh();
+    ~MappedMesh();
+
+    MappedMesh(MappedMesh const&) = delete;
+    MappedMesh& operator=(MappedMesh const&) = delete;
+
+public:
+    // Checks the header, that the blocks lie within the file and that every index is below the vertex count. Errors are printed.
+    NODISCARD bool open(std::string const& path);
+    void close();
+
+    // Needs a current context. Leaves the new vertex array bound.
+    NODISCARD GpuMesh upload(GlResources& resources, GLenum usage = GL_STATIC_DRAW) const;
+    static void destroy(GlResources& resources, GpuMesh& mesh);
+
+public:
+    NODISCARD MeshFileHeader const& get_header() const;
+    NODISCARD Aabb get_bounds() const;
+    NODISCARD u8 const* get_vertices() const;
+    NODISCARD u8 const* get_indices() const;
+    NODISCARD std::size_t get_file_size() const;
+
+private:
+    NODISCARD bool validate(std::string const& path) const;
+
+private:
+    u8 const* _data;
+    std::size_t _size;
+    bool _mapped;
+    std::vector<u8> _fallback;
+};
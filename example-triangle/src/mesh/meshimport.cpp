@@ -0,0 +1,925 @@
+#include "meshimport.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <utility>
+
+#include <math/math.hpp>
+
+namespace {
+    // Attributes per vertex, before they are interleaved. The optional ones are empty when missing.
+    struct Geometry {
+        std::vector<f32> positions; // 3 per vertex
+        std::vector<f32> texcoords; // 2 per vertex
+        std::vector<f32> normals; // 3 per vertex
+        std::vector<f32> colors; // 4 per vertex
+        std::vector<u32> indices;
+    };
+
+    bool read_file(std::string const& path, std::string& data) {
+        std::ifstream file{path, std::ios::binary | std::ios::ate};
+        if (!file) {
+            return false;
+        }
+
+        data.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(&data[0], static_cast<std::streamsize>(data.size()));
+        return static_cast<bool>(file);
+    }
+
+    vec3 load_vec3(std::vector<f32> const& values, u32 index) {
+        return {values[index * 3 + 0], values[index * 3 + 1], values[index * 3 + 2]};
+    }
+
+    // Area weighted, faces with a larger share of the surface count for more.
+    void compute_normals(Geometry& geometry) {
+        std::size_t vertex_count = geometry.positions.size() / 3;
+        std::vector<vec3> sums(vertex_count, vec3{});
+
+        for (std::size_t i = 0; i + 2 < geometry.indices.size(); i += 3) {
+            u32 a = geometry.indices[i], b = geometry.indices[i + 1], c = geometry.indices[i + 2];
+            vec3 pa = load_vec3(geometry.positions, a);
+            vec3 face = cross(load_vec3(geometry.positions, b) - pa, load_vec3(geometry.positions, c) - pa);
+            sums[a] = sums[a] + face;
+            sums[b] = sums[b] + face;
+            sums[c] = sums[c] + face;
+        }
+
+        geometry.normals.resize(vertex_count * 3);
+        for (std::size_t i = 0; i < vertex_count; ++i) {
+            f32 sum_length = length(sums[i]);
+            vec3 normal = sum_length > 0.0f ? sums[i] / sum_length : vec3{0.0f, 0.0f, 1.0f};
+            geometry.normals[i * 3 + 0] = normal.x;
+            geometry.normals[i * 3 + 1] = normal.y;
+            geometry.normals[i * 3 + 2] = normal.z;
+        }
+    }
+
+    u8 to_unorm8(f32 value) {
+        return static_cast<u8>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    void pack(Geometry& geometry, MeshData& mesh) {
+        if (geometry.normals.empty()) {
+            compute_normals(geometry);
+        }
+
+        mesh.attributes = {
+            {MeshSemantic::Position, 0, GL_FLOAT, 3, GL_FALSE, 0},
+            {MeshSemantic::Texcoord, 1, GL_FLOAT, 2, GL_FALSE, 12},
+            {MeshSemantic::Color, 2, GL_UNSIGNED_BYTE, 4, GL_TRUE, 20},
+            {MeshSemantic::Normal, 3, GL_FLOAT, 3, GL_FALSE, 24},
+        };
+        mesh.vertex_stride = IMPORTED_VERTEX_STRIDE;
+
+        // Lit from the upper left front, for meshes that bring no colors of their own.
+        vec3 const light = normalize(vec3{-0.4f, 0.6f, 0.7f});
+
+        std::size_t vertex_count = geometry.positions.size() / 3;
+        mesh.vertices.resize(vertex_count * IMPORTED_VERTEX_STRIDE);
+        mesh.bounds = vertex_count ? Aabb{load_vec3(geometry.positions, 0), load_vec3(geometry.positions, 0)} : Aabb{};
+
+        for (std::size_t i = 0; i < vertex_count; ++i) {
+            u8* vertex = &mesh.vertices[i * IMPORTED_VERTEX_STRIDE];
+            f32 const* position = &geometry.positions[i * 3];
+            f32 const* normal = &geometry.normals[i * 3];
+            f32 const zero_texcoord[2] = {0.0f, 0.0f};
+            f32 const* texcoord = geometry.texcoords.empty() ? zero_texcoord : &geometry.texcoords[i * 2];
+
+            u8 color[4];
+            if (!geometry.colors.empty()) {
+                for (int c = 0; c < 4; ++c) {
+                    color[c] = to_unorm8(geometry.colors[i * 4 + c]);
+                }
+            } else {
+                f32 shade = 0.3f + 0.7f * std::max(0.0f, dot(vec3{normal[0], normal[1], normal[2]}, light));
+                color[0] = color[1] = color[2] = to_unorm8(shade);
+                color[3] = 255;
+            }
+
+            std::memcpy(vertex + 0, position, 12);
+            std::memcpy(vertex + 12, texcoord, 8);
+            std::memcpy(vertex + 20, color, 4);
+            std::memcpy(vertex + 24, normal, 12);
+
+            mesh.bounds.min = {std::min(mesh.bounds.min.x, position[0]), std::min(mesh.bounds.min.y, position[1]), std::min(mesh.bounds.min.z, position[2])};
+            mesh.bounds.max = {std::max(mesh.bounds.max.x, position[0]), std::max(mesh.bounds.max.y, position[1]), std::max(mesh.bounds.max.z, position[2])};
+        }
+
+        mesh.indices = std::move(geometry.indices);
+    }
+
+    // -- OBJ --
+
+    // Skips blanks, false at the end of the line.
+    bool next_on_line(char const*& p) {
+        while (*p == ' ' || *p == '\t') {
+            ++p;
+        }
+        return *p != '\n' && *p != '\r' && *p != '\0';
+    }
+
+    void skip_line(char const*& p, char const* end) {
+        p = static_cast<char const*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        p = p ? p + 1 : end;
+    }
+
+    bool parse_floats(char const*& p, f32* values, int count) {
+        for (int i = 0; i < count; ++i) {
+            char* next;
+            if (!next_on_line(p) || (values[i] = std::strtof(p, &next), next == p)) {
+                return false;
+            }
+            p = next;
+        }
+        return true;
+    }
+
+    // OBJ indices start at 1, negative ones count back from the last element so far. -1 if missing or out of range.
+    i64 parse_index(char const*& p, std::size_t count) {
+        char* next;
+        long index = std::strtol(p, &next, 10);
+        if (next == p) {
+            return -1;
+        }
+        p = next;
+
+        i64 resolved = index < 0 ? static_cast<i64>(count) + index : index - 1;
+        return resolved >= 0 && resolved < static_cast<i64>(count) ? resolved : -1;
+    }
+
+    struct ObjCorner {
+        i64 position, texcoord, normal;
+
+        bool operator==(ObjCorner const& other) const {
+            return position == other.position && texcoord == other.texcoord && normal == other.normal;
+        }
+    };
+
+    struct ObjCornerHash {
+        std::size_t operator()(ObjCorner const& corner) const {
+            u64 hash = static_cast<u64>(corner.position) * 0x9e3779b97f4a7c15ull;
+            hash ^= static_cast<u64>(corner.texcoord) * 0xc2b2ae3d27d4eb4full + (hash << 6) + (hash >> 2);
+            hash ^= static_cast<u64>(corner.normal) * 0x165667b19e3779f9ull + (hash << 6) + (hash >> 2);
+            return static_cast<std::size_t>(hash);
+        }
+    };
+
+    // -- glTF --
+
+    struct Json {
+        enum class Type : u8 {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object,
+        };
+
+        Type type = Type::Null;
+        f64 number = 0.0;
+        std::string string;
+        std::vector<Json> items;
+        std::vector<std::pair<std::string, Json>> members;
+
+        NODISCARD Json const* find(char const* key) const {
+            for (auto const& member : members) {
+                if (member.first == key) {
+                    return &member.second;
+                }
+            }
+            return nullptr;
+        }
+
+        NODISCARD Json const* at(std::size_t index) const {
+            return type == Type::Array && index < items.size() ? &items[index] : nullptr;
+        }
+    };
+
+    f64 number_or(Json const* value, f64 fallback) {
+        return value && value->type == Json::Type::Number ? value->number : fallback;
+    }
+
+    std::string string_or(Json const* value, std::string fallback) {
+        return value && value->type == Json::Type::String ? value->string : std::move(fallback);
+    }
+
+    // Just enough JSON for glTF: no validation of numbers beyond what strtod accepts.
+    class JsonParser {
+    public:
+        JsonParser(char const* begin, char const* end) : _p{begin}, _end{end} { }
+
+        bool parse(Json& value) {
+            return parse_value(value, 0) && (skip_whitespace(), _p == _end);
+        }
+
+    private:
+        static constexpr int MAX_DEPTH = 64;
+
+        void skip_whitespace() {
+            while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r')) {
+                ++_p;
+            }
+        }
+
+        bool consume(char c) {
+            skip_whitespace();
+            if (_p < _end && *_p == c) {
+                ++_p;
+                return true;
+            }
+            return false;
+        }
+
+        bool consume_word(char const* word) {
+            std::size_t length = std::strlen(word);
+            if (static_cast<std::size_t>(_end - _p) < length || std::memcmp(_p, word, length) != 0) {
+                return false;
+            }
+            _p += length;
+            return true;
+        }
+
+        bool parse_value(Json& value, int depth) {
+            skip_whitespace();
+            if (_p == _end || depth > MAX_DEPTH) {
+                return false;
+            }
+
+            switch (*_p) {
+                case '{':
+                    return parse_object(value, depth);
+                case '[':
+                    return parse_array(value, depth);
+                case '"':
+                    value.type = Json::Type::String;
+                    return parse_string(value.string);
+                case 't':
+                    value.type = Json::Type::Bool;
+                    value.number = 1.0;
+                    return consume_word("true");
+                case 'f':
+                    value.type = Json::Type::Bool;
+                    return consume_word("false");
+                case 'n':
+                    return consume_word("null");
+                default:
+                    return parse_number(value);
+            }
+        }
+
+        bool parse_number(Json& value) {
+            // The document is followed by something that can't be part of a number, see load_document().
+            char* next;
+            value.type = Json::Type::Number;
+            value.number = std::strtod(_p, &next);
+            if (next == _p || next > _end) {
+                return false;
+            }
+            _p = next;
+            return true;
+        }
+
+        bool parse_string(std::string& string) {
+            ++_p;
+            while (_p < _end && *_p != '"') {
+                char c = *_p++;
+                if (c != '\\') {
+                    string.push_back(c);
+                    continue;
+                }
+                if (_p == _end) {
+                    return false;
+                }
+
+                switch (*_p++) {
+                    case 'b': string.push_back('\b'); break;
+                    case 'f': string.push_back('\f'); break;
+                    case 'n': string.push_back('\n'); break;
+                    case 'r': string.push_back('\r'); break;
+                    case 't': string.push_back('\t'); break;
+                    case 'u': {
+                        if (_end - _p < 4) {
+                            return false;
+                        }
+                        u32 code = static_cast<u32>(std::strtoul(std::string{_p, 4}.c_str(), nullptr, 16));
+                        _p += 4;
+
+                        // Surrogate pairs are kept as two code points, names and URIs don't need them.
+                        if (code < 0x80) {
+                            string.push_back(static_cast<char>(code));
+                        } else if (code < 0x800) {
+                            string.push_back(static_cast<char>(0xc0 | (code >> 6)));
+                            string.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+                        } else {
+                            string.push_back(static_cast<char>(0xe0 | (code >> 12)));
+                            string.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                            string.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+                        }
+                        break;
+                    }
+                    default: string.push_back(_p[-1]); break;
+                }
+            }
+            return _p < _end && *_p++ == '"';
+        }
+
+        bool parse_array(Json& value, int depth) {
+            ++_p;
+            value.type = Json::Type::Array;
+            if (consume(']')) {
+                return true;
+            }
+
+            do {
+                value.items.emplace_back();
+                if (!parse_value(value.items.back(), depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(']');
+        }
+
+        bool parse_object(Json& value, int depth) {
+            ++_p;
+            value.type = Json::Type::Object;
+            if (consume('}')) {
+                return true;
+            }
+
+            do {
+                value.members.emplace_back();
+                if (!consume('"') || (--_p, !parse_string(value.members.back().first)) || !consume(':') ||
+                    !parse_value(value.members.back().second, depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume('}');
+        }
+
+    private:
+        char const* _p;
+        char const* _end;
+    };
+
+    constexpr u32 GLB_MAGIC = 0x46546c67; // "glTF"
+    constexpr u32 GLB_CHUNK_JSON = 0x4e4f534a;
+    constexpr u32 GLB_CHUNK_BIN = 0x004e4942;
+
+    constexpr u32 GLTF_BYTE = 5120;
+    constexpr u32 GLTF_UNSIGNED_BYTE = 5121;
+    constexpr u32 GLTF_SHORT = 5122;
+    constexpr u32 GLTF_UNSIGNED_SHORT = 5123;
+    constexpr u32 GLTF_UNSIGNED_INT = 5125;
+    constexpr u32 GLTF_FLOAT = 5126;
+    constexpr u32 GLTF_TRIANGLES = 4;
+
+    struct GltfDocument {
+        Json root;
+        std::vector<std::string> buffers;
+    };
+
+    bool decode_base64(char const* begin, char const* end, std::string& data) {
+        auto value_of = [](char c) -> int {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+' || c == '-') return 62;
+            if (c == '/' || c == '_') return 63;
+            return -1;
+        };
+
+        u32 bits = 0;
+        int bit_count = 0;
+        for (char const* p = begin; p < end && *p != '='; ++p) {
+            int value = value_of(*p);
+            if (value < 0) {
+                return false;
+            }
+
+            bits = (bits << 6) | static_cast<u32>(value);
+            bit_count += 6;
+            if (bit_count >= 8) {
+                bit_count -= 8;
+                data.push_back(static_cast<char>((bits >> bit_count) & 0xff));
+            }
+        }
+        return true;
+    }
+
+    bool load_buffers(std::string const& path, GltfDocument& document, std::string* glb_binary) {
+        Json const* buffers = document.root.find("buffers");
+        std::size_t count = buffers && buffers->type == Json::Type::Array ? buffers->items.size() : 0;
+        document.buffers.resize(count);
+
+        std::size_t slash = path.find_last_of("/\\");
+        std::string directory = slash == std::string::npos ? std::string{} : path.substr(0, slash + 1);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            std::string uri = string_or(buffers->items[i].find("uri"), {});
+            std::string& data = document.buffers[i];
+
+            if (uri.empty()) {
+                // The first buffer of a .glb without a URI is its binary chunk.
+                if (i != 0 || !glb_binary) {
+                    std::cerr << "Unable to import " << path << ": buffer " << i << " has no data" << std::endl;
+                    return false;
+                }
+                data = std::move(*glb_binary);
+            } else if (uri.compare(0, 5, "data:") == 0) {
+                std::size_t comma = uri.find(',');
+                if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos ||
+                    !decode_base64(uri.data() + comma + 1, uri.data() + uri.size(), data)) {
+                    std::cerr << "Unable to import " << path << ": buffer " << i << " is not base64 encoded" << std::endl;
+                    return false;
+                }
+            } else if (!read_file(directory + uri, data)) {
+                std::cerr << "Unable to import " << path << ": unable to read " << directory + uri << std::endl;
+                return false;
+            }
+
+            if (data.size() < static_cast<std::size_t>(number_or(buffers->items[i].find("byteLength"), 0.0))) {
+                std::cerr << "Unable to import " << path << ": buffer " << i << " is too short" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool load_document(std::string const& path, GltfDocument& document) {
+        std::string file;
+        if (!read_file(path, file)) {
+            std::cerr << "Unable to read " << path << std::endl;
+            return false;
+        }
+
+        std::string json = std::move(file);
+        std::string binary;
+        bool is_glb = false;
+
+        u32 magic = 0;
+        if (json.size() >= 12 && (std::memcpy(&magic, json.data(), 4), magic == GLB_MAGIC)) {
+            is_glb = true;
+            std::string glb = std::move(json);
+            json.clear();
+
+            for (std::size_t offset = 12; offset + 8 <= glb.size();) {
+                u32 chunk_length, chunk_type;
+                std::memcpy(&chunk_length, glb.data() + offset, 4);
+                std::memcpy(&chunk_type, glb.data() + offset + 4, 4);
+                if (chunk_length > glb.size() - offset - 8) {
+                    break;
+                }
+
+                if (chunk_type == GLB_CHUNK_JSON && json.empty()) {
+                    json.assign(glb, offset + 8, chunk_length);
+                } else if (chunk_type == GLB_CHUNK_BIN && binary.empty()) {
+                    binary.assign(glb, offset + 8, chunk_length);
+                }
+                offset += 8 + ((chunk_length + 3) & ~3u);
+            }
+        }
+
+        // The terminator keeps strtod() from reading past the document.
+        JsonParser parser{json.c_str(), json.c_str() + json.size()};
+        if (json.empty() || !parser.parse(document.root) || document.root.type != Json::Type::Object) {
+            std::cerr << "Unable to import " << path << ": not a glTF document" << std::endl;
+            return false;
+        }
+
+        return load_buffers(path, document, is_glb ? &binary : nullptr);
+    }
+
+    u32 component_count(std::string const& type) {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    u32 component_size(u32 component_type) {
+        switch (component_type) {
+            case GLTF_BYTE:
+            case GLTF_UNSIGNED_BYTE:
+                return 1;
+            case GLTF_SHORT:
+            case GLTF_UNSIGNED_SHORT:
+                return 2;
+            case GLTF_UNSIGNED_INT:
+            case GLTF_FLOAT:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    f32 read_component(u8 const* data, u32 component_type, bool normalized) {
+        switch (component_type) {
+            case GLTF_BYTE: {
+                i8 value;
+                std::memcpy(&value, data, 1);
+                return normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            case GLTF_UNSIGNED_BYTE:
+                return normalized ? data[0] / 255.0f : data[0];
+            case GLTF_SHORT: {
+                i16 value;
+                std::memcpy(&value, data, 2);
+                return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+            }
+            case GLTF_UNSIGNED_SHORT: {
+                u16 value;
+                std::memcpy(&value, data, 2);
+                return normalized ? value / 65535.0f : value;
+            }
+            case GLTF_UNSIGNED_INT: {
+                u32 value;
+                std::memcpy(&value, data, 4);
+                return static_cast<f32>(value);
+            }
+            default: {
+                f32 value;
+                std::memcpy(&value, data, 4);
+                return value;
+            }
+        }
+    }
+
+    // Where an accessor's elements are, with the bounds checked. Accessors without a buffer view are all zeros, data is null for them.
+    struct AccessorData {
+        u8 const* data;
+        std::size_t count;
+        std::size_t stride;
+        u32 component_type;
+        u32 component_size;
+        u32 components;
+        bool normalized;
+    };
+
+    bool resolve_accessor(std::string const& path, GltfDocument const& document, Json const* index, AccessorData& accessor_data) {
+        Json const* accessors = document.root.find("accessors");
+        Json const* accessor = accessors ? accessors->at(static_cast<std::size_t>(number_or(index, -1.0))) : nullptr;
+        auto fail = [&path](char const* reason) {
+            std::cerr << "Unable to import " << path << ": " << reason << std::endl;
+            return false;
+        };
+
+        if (!accessor) {
+            return fail("missing accessor");
+        }
+        if (accessor->find("sparse")) {
+            return fail("sparse accessors are not supported");
+        }
+
+        Json const* normalized = accessor->find("normalized");
+        accessor_data.data = nullptr;
+        accessor_data.count = static_cast<std::size_t>(number_or(accessor->find("count"), 0.0));
+        accessor_data.component_type = static_cast<u32>(number_or(accessor->find("componentType"), 0.0));
+        accessor_data.component_size = component_size(accessor_data.component_type);
+        accessor_data.components = component_count(string_or(accessor->find("type"), {}));
+        accessor_data.normalized = normalized && normalized->type == Json::Type::Bool && normalized->number != 0.0;
+        if (accessor_data.component_size == 0 || accessor_data.components == 0) {
+            return fail("unsupported accessor type");
+        }
+
+        Json const* views = document.root.find("bufferViews");
+        Json const* view = views ? views->at(static_cast<std::size_t>(number_or(accessor->find("bufferView"), -1.0))) : nullptr;
+        std::size_t element_size = accessor_data.component_size * accessor_data.components;
+        accessor_data.stride = element_size;
+        if (!view) {
+            return true;
+        }
+
+        std::size_t buffer_index = static_cast<std::size_t>(number_or(view->find("buffer"), -1.0));
+        if (buffer_index >= document.buffers.size()) {
+            return fail("missing buffer");
+        }
+
+        std::string const& buffer = document.buffers[buffer_index];
+        std::size_t view_offset = static_cast<std::size_t>(number_or(view->find("byteOffset"), 0.0));
+        std::size_t view_length = static_cast<std::size_t>(number_or(view->find("byteLength"), 0.0));
+        std::size_t offset = static_cast<std::size_t>(number_or(accessor->find("byteOffset"), 0.0));
+        accessor_data.stride = static_cast<std::size_t>(number_or(view->find("byteStride"), static_cast<f64>(element_size)));
+
+        std::size_t count = accessor_data.count;
+        if (view_offset > buffer.size() || view_length > buffer.size() - view_offset ||
+            (count && (offset > view_length || (count - 1) * accessor_data.stride + element_size > view_length - offset))) {
+            return fail("accessor outside of its buffer");
+        }
+
+        accessor_data.data = reinterpret_cast<u8 const*>(buffer.data()) + view_offset + offset;
+        return true;
+    }
+
+    // Appends the accessor's elements as floats, components is set to the ones per element. Errors are printed.
+    bool read_accessor(std::string const& path, GltfDocument const& document, Json const* index, std::vector<f32>& values, u32& components) {
+        AccessorData accessor;
+        if (!resolve_accessor(path, document, index, accessor)) {
+            return false;
+        }
+
+        components = accessor.components;
+        if (!accessor.data) {
+            values.resize(values.size() + accessor.count * components, 0.0f);
+            return true;
+        }
+
+        values.reserve(values.size() + accessor.count * components);
+        for (std::size_t i = 0; i < accessor.count; ++i) {
+            for (u32 c = 0; c < components; ++c) {
+                values.push_back(read_component(accessor.data + i * accessor.stride + c * accessor.component_size, accessor.component_type, accessor.normalized));
+            }
+        }
+        return true;
+    }
+
+    // Appends the indices offset by base. Read as integers, floats can't hold all 32 bit indices. Errors are printed.
+    bool read_indices(std::string const& path, GltfDocument const& document, Json const* index, u32 base, u32 vertex_count, std::vector<u32>& indices) {
+        AccessorData accessor;
+        if (!resolve_accessor(path, document, index, accessor)) {
+            return false;
+        }
+
+        if (accessor.components != 1 || (accessor.component_type != GLTF_UNSIGNED_BYTE && accessor.component_type != GLTF_UNSIGNED_SHORT &&
+                                         accessor.component_type != GLTF_UNSIGNED_INT)) {
+            std::cerr << "Unable to import " << path << ": indices must be unsigned integers" << std::endl;
+            return false;
+        }
+
+        indices.reserve(indices.size() + accessor.count);
+        for (std::size_t i = 0; i < accessor.count; ++i) {
+            u32 value = 0;
+            if (accessor.data) {
+                std::memcpy(&value, accessor.data + i * accessor.stride, accessor.component_size); // little endian
+            }
+
+            if (value >= vertex_count) {
+                std::cerr << "Unable to import " << path << ": index out of range" << std::endl;
+                return false;
+            }
+            indices.push_back(base + value);
+        }
+        return true;
+    }
+
+    // Appends one primitive, filling the attributes it lacks with defaults. Returns false on errors, skipped is set for other modes than triangles.
+    bool import_primitive(std::string const& path, GltfDocument const& document, Json const& primitive, Geometry& geometry, bool& has_colors, bool& has_normals, bool& skipped) {
+        skipped = static_cast<u32>(number_or(primitive.find("mode"), GLTF_TRIANGLES)) != GLTF_TRIANGLES;
+        Json const* attributes = primitive.find("attributes");
+        if (skipped || !attributes) {
+            skipped = true;
+            return true;
+        }
+
+        u32 base = static_cast<u32>(geometry.positions.size() / 3);
+        u32 components;
+
+        if (!read_accessor(path, document, attributes->find("POSITION"), geometry.positions, components) || components != 3) {
+            std::cerr << "Unable to import " << path << ": primitives need 3D positions" << std::endl;
+            return false;
+        }
+        u32 count = static_cast<u32>(geometry.positions.size() / 3) - base;
+
+        auto read_optional = [&](char const* name, std::vector<f32>& values, u32 expected, f32 const* defaults, bool* present) {
+            std::vector<f32> read;
+            Json const* index = attributes->find(name);
+            if (index && read_accessor(path, document, index, read, components) && read.size() == std::size_t{count} * components &&
+                (components == expected || (expected == 4 && components == 3))) {
+                for (u32 i = 0; i < count; ++i) {
+                    for (u32 c = 0; c < expected; ++c) {
+                        values.push_back(c < components ? read[i * components + c] : defaults[c]);
+                    }
+                }
+                if (present) {
+                    *present = true;
+                }
+                return;
+            }
+
+            for (u32 i = 0; i < count; ++i) {
+                values.insert(values.end(), defaults, defaults + expected);
+            }
+        };
+
+        f32 const zero_texcoord[2] = {0.0f, 0.0f};
+        f32 const white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        f32 const facing[3] = {0.0f, 0.0f, 1.0f};
+        read_optional("TEXCOORD_0", geometry.texcoords, 2, zero_texcoord, nullptr);
+        read_optional("COLOR_0", geometry.colors, 4, white, &has_colors);
+        read_optional("NORMAL", geometry.normals, 3, facing, &has_normals);
+
+        Json const* indices = primitive.find("indices");
+        if (!indices) {
+            for (u32 i = 0; i < count; ++i) {
+                geometry.indices.push_back(base + i);
+            }
+            return true;
+        }
+
+        return read_indices(path, document, indices, base, count, geometry.indices);
+    }
+
+    std::string extension_of(std::string const& path) {
+        std::size_t dot = path.find_last_of('.');
+        std::string extension = dot == std::string::npos ? std::string{} : path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension;
+    }
+}
+
+bool import_obj(std::string const& path, MeshData& mesh) {
+    std::string file;
+    if (!read_file(path, file)) {
+        std::cerr << "Unable to read " << path << std::endl;
+        return false;
+    }
+
+    std::vector<f32> positions, texcoords, normals, colors;
+    bool has_colors = false;
+
+    Geometry geometry;
+    std::unordered_map<ObjCorner, u32, ObjCornerHash> corners;
+    std::vector<u32> face;
+
+    char const* p = file.c_str();
+    char const* end = p + file.size();
+    std::size_t line = 0;
+
+    for (; p < end; skip_line(p, end)) {
+        ++line;
+        if (!next_on_line(p)) {
+            continue;
+        }
+
+        bool ok = true;
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            p += 1;
+            f32 values[6] = {0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+            ok = parse_floats(p, values, 3);
+
+            // A common extension puts the vertex color after the position.
+            f32 color[3];
+            if (ok && next_on_line(p) && parse_floats(p, color, 3)) {
+                std::copy(color, color + 3, values + 3);
+                has_colors = true;
+            }
+            positions.insert(positions.end(), values, values + 3);
+            colors.insert(colors.end(), values + 3, values + 6);
+        } else if (p[0] == 'v' && p[1] == 't') {
+            p += 2;
+            f32 values[2];
+            ok = parse_floats(p, values, 2);
+            texcoords.insert(texcoords.end(), values, values + 2);
+        } else if (p[0] == 'v' && p[1] == 'n') {
+            p += 2;
+            f32 values[3];
+            ok = parse_floats(p, values, 3);
+            normals.insert(normals.end(), values, values + 3);
+        } else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            p += 1;
+            face.clear();
+
+            while (ok && next_on_line(p)) {
+                ObjCorner corner{parse_index(p, positions.size() / 3), -1, -1};
+                if (*p == '/') {
+                    ++p;
+                    if (*p != '/') {
+                        corner.texcoord = parse_index(p, texcoords.size() / 2);
+                        ok = corner.texcoord >= 0;
+                    }
+                    if (*p == '/') {
+                        ++p;
+                        corner.normal = parse_index(p, normals.size() / 3);
+                        ok = ok && corner.normal >= 0;
+                    }
+                }
+                ok = ok && corner.position >= 0;
+                if (!ok) {
+                    break;
+                }
+
+                auto inserted = corners.emplace(corner, static_cast<u32>(corners.size()));
+                if (inserted.second) {
+                    u32 v = static_cast<u32>(corner.position);
+                    geometry.positions.insert(geometry.positions.end(), &positions[v * 3], &positions[v * 3] + 3);
+                    geometry.colors.insert(geometry.colors.end(), &colors[v * 3], &colors[v * 3] + 3);
+                    geometry.colors.push_back(1.0f);
+
+                    f32 const zero[3] = {0.0f, 0.0f, 0.0f};
+                    f32 const* texcoord = corner.texcoord >= 0 ? &texcoords[static_cast<std::size_t>(corner.texcoord) * 2] : zero;
+                    f32 const* normal = corner.normal >= 0 ? &normals[static_cast<std::size_t>(corner.normal) * 3] : zero;
+                    geometry.texcoords.insert(geometry.texcoords.end(), texcoord, texcoord + 2);
+                    geometry.normals.insert(geometry.normals.end(), normal, normal + 3);
+                }
+                face.push_back(inserted.first->second);
+            }
+
+            ok = ok && face.size() >= 3;
+            for (std::size_t i = 2; ok && i < face.size(); ++i) {
+                geometry.indices.insert(geometry.indices.end(), {face[0], face[i - 1], face[i]});
+            }
+        }
+
+        if (!ok) {
+            std::cerr << "Unable to import " << path << ": bad line " << line << std::endl;
+            return false;
+        }
+    }
+
+    if (geometry.indices.empty()) {
+        std::cerr << "Unable to import " << path << ": no faces" << std::endl;
+        return false;
+    }
+
+    if (!has_colors) {
+        geometry.colors.clear();
+    }
+    if (texcoords.empty()) {
+        geometry.texcoords.clear();
+    }
+    if (normals.empty()) {
+        geometry.normals.clear();
+    }
+
+    pack(geometry, mesh);
+    return true;
+}
+
+bool import_gltf(std::string const& path, MeshData& mesh) {
+    GltfDocument document;
+    if (!load_document(path, document)) {
+        return false;
+    }
+
+    Json const* meshes = document.root.find("meshes");
+    Json const* first = meshes ? meshes->at(0) : nullptr;
+    Json const* primitives = first ? first->find("primitives") : nullptr;
+    if (!primitives || primitives->type != Json::Type::Array) {
+        std::cerr << "Unable to import " << path << ": no meshes" << std::endl;
+        return false;
+    }
+
+    Geometry geometry;
+    bool has_colors = false, has_normals = false;
+    std::size_t skipped_count = 0;
+
+    for (Json const& primitive : primitives->items) {
+        bool skipped;
+        if (!import_primitive(path, document, primitive, geometry, has_colors, has_normals, skipped)) {
+            return false;
+        }
+        skipped_count += skipped ? 1 : 0;
+    }
+
+    if (skipped_count) {
+        std::cerr << "Skipped " << skipped_count << " primitives of " << path << " that are not triangle lists" << std::endl;
+    }
+    if (geometry.indices.empty()) {
+        std::cerr << "Unable to import " << path << ": no triangles" << std::endl;
+        return false;
+    }
+
+    if (!has_colors) {
+        geometry.colors.clear();
+    }
+    if (!has_normals) {
+        geometry.normals.clear();
+    }
+
+    pack(geometry, mesh);
+    return true;
+}
+
+bool convert_mesh(std::string const& input, std::string const& output) {
+    std::string extension = extension_of(input);
+
+    MeshData mesh;
+    if (extension == "obj") {
+        if (!import_obj(input, mesh)) {
+            return false;
+        }
+    } else if (extension == "gltf" || extension == "glb") {
+        if (!import_gltf(input, mesh)) {
+            return false;
+        }
+    } else {
+        std::cerr << "Unable to convert " << input << ": expected an .obj, .gltf or .glb file" << std::endl;
+        return false;
+    }
+
+    if (!write_mesh_file(output, mesh)) {
+        return false;
+    }
+
+    std::cout << "Converted " << input << " to " << output << ": " << mesh.get_vertex_count() << " vertices, "
+              << mesh.indices.size() / 3 << " triangles" << std::endl;
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include <mesh/meshfile.hpp>
+#include <util/base.hpp>
+
+/*
+ * Turns OBJ and glTF 2.0 files into the layout of mesh files. Every vertex gets
+ *
+ *   location 0: position, 3 floats
+ *   location 1: texture coordinates, 2 floats
+ *   location 2: color, 4 normalized bytes
+ *   location 3: normal, 3 floats
+ *
+ * matching the default shaders in their first three. Missing normals are averaged from the
+ * faces, missing colors are shaded from the normals, so a mesh can be drawn as is.
+ *
+ * OBJ faces with more than three corners are triangulated as fans, materials are ignored. Of a
+ * glTF file (.gltf with external or embedded buffers, or .glb) the triangles of the first mesh
+ * are imported, without node transforms, sparse accessors or extensions.
+ */
+constexpr u32 IMPORTED_VERTEX_STRIDE = 36;
+
+// Errors are printed.
+NODISCARD bool import_obj(std::string const& path, MeshData& mesh);
+NODISCARD bool import_gltf(std::string const& path, MeshData& mesh);
+
+// Picks the importer by the input's extension (.obj, .gltf, .glb) and writes a mesh file.
+NODISCARD bool convert_mesh(std::string const& input, std::string const& output);
@@ -0,0 +1,325 @@
+#include "particlesystem.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <jobs/jobsystem.hpp>
+#include <math/simd.hpp>
+
+ParticleSystem::ParticleSystem(std::size_t capacity) :
+    _capacity{capacity},
+    _size{0},
+    _pos_x(capacity),
+    _pos_y(capacity),
+    _vel_x(capacity),
+    _vel_y(capacity),
+    _age(capacity),
+    _lifetime(capacity),
+    _emitter(capacity),
+    _forces{{0.0f, 0.0f}, 0.0f, {}},
+    _random_state{0x9e3779b9u},
+    _stats{} {
+
+}
+
+EmitterId ParticleSystem::add_emitter(ParticleEmitter const& emitter) {
+    _emitters.push_back(emitter);
+    _emit_remainder.push_back(0.0f);
+    return static_cast<EmitterId>(_emitters.size() - 1);
+}
+
+ParticleEmitter& ParticleSystem::get_emitter(EmitterId id) {
+    return _emitters[id];
+}
+
+ParticleForces& ParticleSystem::get_forces() {
+    return _forces;
+}
+
+void ParticleSystem::update(f32 dt) {
+    auto start = std::chrono::steady_clock::now();
+    _stats = {};
+
+    emit(dt);
+
+    // Chunks are the unit of work, so every chunk's dead list is filled by exactly one job.
+    std::size_t chunk_count = (_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    if (_dead.size() < chunk_count) {
+        _dead.resize(chunk_count);
+    }
+
+    JobSystem::get_global().parallel_for(chunk_count, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            _dead[c].clear();
+            integrate(c * CHUNK_SIZE, std::min(_size, (c + 1) * CHUNK_SIZE), dt, _dead[c]);
+        }
+    });
+
+    remove_dead(chunk_count);
+
+    _stats.alive = static_cast<u32>(_size);
+    _stats.update_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParticleSystem::update_scalar(f32 dt) {
+    auto start = std::chrono::steady_clock::now();
+    _stats = {};
+
+    emit(dt);
+
+    std::size_t chunk_count = (_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    if (_dead.size() < chunk_count) {
+        _dead.resize(chunk_count);
+    }
+
+    for (std::size_t c = 0; c < chunk_count; ++c) {
+        _dead[c].clear();
+        integrate_scalar(c * CHUNK_SIZE, std::min(_size, (c + 1) * CHUNK_SIZE), dt, _dead[c]);
+    }
+
+    remove_dead(chunk_count);
+
+    _stats.alive = static_cast<u32>(_size);
+    _stats.update_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParticleSystem::write_vertices(Vertex* out) const {
+    std::size_t chunk_count = (_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    JobSystem::get_global().parallel_for(chunk_count, 1, [&](std::size_t begin, std::size_t end) {
+        write_vertex_range(out, begin * CHUNK_SIZE, std::min(_size, end * CHUNK_SIZE));
+    });
+}
+
+void ParticleSystem::clear() {
+    _size = 0;
+    std::fill(_emit_remainder.begin(), _emit_remainder.end(), 0.0f);
+}
+
+std::size_t ParticleSystem::get_size() const {
+    return _size;
+}
+
+std::size_t ParticleSystem::get_capacity() const {
+    return _capacity;
+}
+
+ParticleStats const& ParticleSystem::get_stats() const {
+    return _stats;
+}
+
+void ParticleSystem::emit(f32 dt) {
+    for (EmitterId id = 0; id < _emitters.size(); ++id) {
+        ParticleEmitter const& emitter = _emitters[id];
+        if (!emitter.enabled) {
+            continue;
+        }
+
+        // Rates that don't add up to a whole particle per frame carry the fraction over to the next one.
+        f32 wanted = _emit_remainder[id] + emitter.rate * dt;
+        auto count = static_cast<std::size_t>(wanted);
+        _emit_remainder[id] = wanted - static_cast<f32>(count);
+        count = std::min(count, _capacity - _size);
+
+        for (std::size_t n = 0; n < count; ++n) {
+            f32 angle = emitter.direction + random_range(-0.5f, 0.5f) * emitter.spread;
+            f32 speed = random_range(emitter.min_speed, emitter.max_speed);
+
+            std::size_t i = _size++;
+            _pos_x[i] = emitter.position.x;
+            _pos_y[i] = emitter.position.y;
+            _vel_x[i] = std::cos(angle) * speed;
+            _vel_y[i] = std::sin(angle) * speed;
+            _age[i] = 0.0f;
+            _lifetime[i] = random_range(emitter.min_lifetime, emitter.max_lifetime);
+            _emitter[i] = id;
+        }
+
+        _stats.spawned += static_cast<u32>(count);
+    }
+}
+
+void ParticleSystem::integrate(std::size_t begin, std::size_t end, f32 dt, std::vector<u32>& dead) {
+    std::size_t i = begin;
+
+#if defined(MATH_USE_SSE)
+    f32 damping = std::exp(-_forces.drag * dt);
+    std::vector<ParticleAttractor> const& attractors = _forces.attractors;
+#endif
+
+#if defined(MATH_USE_AVX)
+    {
+        __m256 dt8 = _mm256_set1_ps(dt);
+        __m256 damping8 = _mm256_set1_ps(damping);
+        __m256 gravity_x = _mm256_set1_ps(_forces.gravity.x);
+        __m256 gravity_y = _mm256_set1_ps(_forces.gravity.y);
+        __m256 one = _mm256_set1_ps(1.0f);
+
+        for (; i + 8 <= end; i += 8) {
+            __m256 px = _mm256_loadu_ps(&_pos_x[i]);
+            __m256 py = _mm256_loadu_ps(&_pos_y[i]);
+            __m256 ax = gravity_x;
+            __m256 ay = gravity_y;
+
+            for (ParticleAttractor const& attractor : attractors) {
+                __m256 dx = _mm256_sub_ps(_mm256_set1_ps(attractor.position.x), px);
+                __m256 dy = _mm256_sub_ps(_mm256_set1_ps(attractor.position.y), py);
+                __m256 distance2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                                                 _mm256_set1_ps(attractor.radius * attractor.radius));
+                __m256 inverse = _mm256_div_ps(one, _mm256_sqrt_ps(distance2));
+                __m256 pull = _mm256_mul_ps(_mm256_set1_ps(attractor.strength), _mm256_mul_ps(inverse, _mm256_mul_ps(inverse, inverse)));
+                ax = _mm256_add_ps(ax, _mm256_mul_ps(dx, pull));
+                ay = _mm256_add_ps(ay, _mm256_mul_ps(dy, pull));
+            }
+
+            __m256 vx = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(&_vel_x[i]), _mm256_mul_ps(ax, dt8)), damping8);
+            __m256 vy = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(&_vel_y[i]), _mm256_mul_ps(ay, dt8)), damping8);
+            _mm256_storeu_ps(&_vel_x[i], vx);
+            _mm256_storeu_ps(&_vel_y[i], vy);
+            _mm256_storeu_ps(&_pos_x[i], _mm256_add_ps(px, _mm256_mul_ps(vx, dt8)));
+            _mm256_storeu_ps(&_pos_y[i], _mm256_add_ps(py, _mm256_mul_ps(vy, dt8)));
+
+            __m256 age = _mm256_add_ps(_mm256_loadu_ps(&_age[i]), dt8);
+            _mm256_storeu_ps(&_age[i], age);
+
+            u32 mask = static_cast<u32>(_mm256_movemask_ps(_mm256_cmp_ps(age, _mm256_loadu_ps(&_lifetime[i]), _CMP_GE_OQ)));
+            while (mask) {
+                dead.push_back(static_cast<u32>(i + __builtin_ctz(mask)));
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+
+#if defined(MATH_USE_SSE)
+    {
+        __m128 dt4 = _mm_set1_ps(dt);
+        __m128 damping4 = _mm_set1_ps(damping);
+        __m128 gravity_x = _mm_set1_ps(_forces.gravity.x);
+        __m128 gravity_y = _mm_set1_ps(_forces.gravity.y);
+        __m128 one = _mm_set1_ps(1.0f);
+
+        for (; i + 4 <= end; i += 4) {
+            __m128 px = _mm_loadu_ps(&_pos_x[i]);
+            __m128 py = _mm_loadu_ps(&_pos_y[i]);
+            __m128 ax = gravity_x;
+            __m128 ay = gravity_y;
+
+            for (ParticleAttractor const& attractor : attractors) {
+                __m128 dx = _mm_sub_ps(_mm_set1_ps(attractor.position.x), px);
+                __m128 dy = _mm_sub_ps(_mm_set1_ps(attractor.position.y), py);
+                __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                                              _mm_set1_ps(attractor.radius * attractor.radius));
+                __m128 inverse = _mm_div_ps(one, _mm_sqrt_ps(distance2));
+                __m128 pull = _mm_mul_ps(_mm_set1_ps(attractor.strength), _mm_mul_ps(inverse, _mm_mul_ps(inverse, inverse)));
+                ax = _mm_add_ps(ax, _mm_mul_ps(dx, pull));
+                ay = _mm_add_ps(ay, _mm_mul_ps(dy, pull));
+            }
+
+            __m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&_vel_x[i]), _mm_mul_ps(ax, dt4)), damping4);
+            __m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&_vel_y[i]), _mm_mul_ps(ay, dt4)), damping4);
+            _mm_storeu_ps(&_vel_x[i], vx);
+            _mm_storeu_ps(&_vel_y[i], vy);
+            _mm_storeu_ps(&_pos_x[i], _mm_add_ps(px, _mm_mul_ps(vx, dt4)));
+            _mm_storeu_ps(&_pos_y[i], _mm_add_ps(py, _mm_mul_ps(vy, dt4)));
+
+            __m128 age = _mm_add_ps(_mm_loadu_ps(&_age[i]), dt4);
+            _mm_storeu_ps(&_age[i], age);
+
+            u32 mask = static_cast<u32>(_mm_movemask_ps(_mm_cmpge_ps(age, _mm_loadu_ps(&_lifetime[i]))));
+            while (mask) {
+                dead.push_back(static_cast<u32>(i + __builtin_ctz(mask)));
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+
+    integrate_scalar(i, end, dt, dead);
+}
+
+void ParticleSystem::integrate_scalar(std::size_t begin, std::size_t end, f32 dt, std::vector<u32>& dead) {
+    f32 damping = std::exp(-_forces.drag * dt);
+
+    for (std::size_t i = begin; i < end; ++i) {
+        f32 ax = _forces.gravity.x;
+        f32 ay = _forces.gravity.y;
+
+        for (ParticleAttractor const& attractor : _forces.attractors) {
+            f32 dx = attractor.position.x - _pos_x[i];
+            f32 dy = attractor.position.y - _pos_y[i];
+            f32 inverse = 1.0f / std::sqrt(dx * dx + dy * dy + attractor.radius * attractor.radius);
+            f32 pull = attractor.strength * inverse * inverse * inverse;
+            ax += dx * pull;
+            ay += dy * pull;
+        }
+
+        _vel_x[i] = (_vel_x[i] + ax * dt) * damping;
+        _vel_y[i] = (_vel_y[i] + ay * dt) * damping;
+        _pos_x[i] += _vel_x[i] * dt;
+        _pos_y[i] += _vel_y[i] * dt;
+        _age[i] += dt;
+
+        if (_age[i] >= _lifetime[i]) {
+            dead.push_back(static_cast<u32>(i));
+        }
+    }
+}
+
+// Going from the highest index down, everything behind the current hole is alive: the holes above
+// it were filled with live particles from the end, or were at the end themselves.
+void ParticleSystem::remove_dead(std::size_t chunk_count) {
+    for (std::size_t c = chunk_count; c-- > 0;) {
+        std::vector<u32> const& dead = _dead[c];
+        for (auto it = dead.rbegin(); it != dead.rend(); ++it) {
+            std::size_t i = *it;
+            std::size_t last = --_size;
+            if (i != last) {
+                _pos_x[i] = _pos_x[last];
+                _pos_y[i] = _pos_y[last];
+                _vel_x[i] = _vel_x[last];
+                _vel_y[i] = _vel_y[last];
+                _age[i] = _age[last];
+                _lifetime[i] = _lifetime[last];
+                _emitter[i] = _emitter[last];
+            }
+        }
+
+        _stats.killed += static_cast<u32>(dead.size());
+    }
+}
+
+void ParticleSystem::write_vertex_range(Vertex* out, std::size_t begin, std::size_t end) const {
+    for (std::size_t i = begin; i < end; ++i) {
+        ParticleEmitter const& emitter = _emitters[_emitter[i]];
+        f32 t = std::min(_age[i] / _lifetime[i], 1.0f);
+
+        auto blend = [t](u8 from, u8 to) {
+            return static_cast<u8>(static_cast<f32>(from) + (static_cast<f32>(to) - static_cast<f32>(from)) * t + 0.5f);
+        };
+
+        // Built on the stack and stored as a whole, mapped memory is best written sequentially.
+        Vertex vertex{
+            _pos_x[i], _pos_y[i], 0.0f, 0.0f,
+            blend(emitter.start_color.r, emitter.end_color.r),
+            blend(emitter.start_color.g, emitter.end_color.g),
+            blend(emitter.start_color.b, emitter.end_color.b),
+            blend(emitter.start_color.a, emitter.end_color.a)};
+        out[i] = vertex;
+    }
+}
+
+// xorshift32, plenty for scattering particles.
+u32 ParticleSystem::next_random() {
+    u32 x = _random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _random_state = x;
+    return x;
+}
+
+f32 ParticleSystem::random_range(f32 min, f32 max) {
+    f32 unit = static_cast<f32>(next_random() >> 8) * (1.0f / 16777216.0f);
+    return min + (max - min) * unit;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <math/vector.hpp>
+#include <render/vertex.hpp>
+#include <util/base.hpp>
+
+using EmitterId = u32;
+
+// Spawns particles at a point, in a cone around a direction.
+struct ParticleEmitter {
+    vec2 position;
+    f32 rate;      // particles per second
+    f32 direction; // radians
+    f32 spread;    // full opening angle of the cone, radians
+    f32 min_speed, max_speed;
+    f32 min_lifetime, max_lifetime; // seconds
+    Rgba8 start_color, end_color;   // blended over a particle's lifetime
+    bool enabled;
+};
+
+// Pulls particles towards a point, or pushes them away with a negative strength. The pull falls
+// off with the squared distance and is softened inside the radius, so it never blows up.
+struct ParticleAttractor {
+    vec2 position;
+    f32 strength;
+    f32 radius;
+};
+
+struct ParticleForces {
+    vec2 gravity;
+    f32 drag; // the velocity decays by exp(-drag * dt)
+    std::vector<ParticleAttractor> attractors;
+};
+
+struct ParticleStats {
+    u32 alive;
+    u32 spawned;
+    u32 killed;
+    f64 update_ms;
+};
+
+/*
+ * Simulates up to a fixed number of particles on the CPU.
+ *
+ * The state is kept as one array per component, so update() integrates 4 (SSE) or 8 (AVX)
+ * particles per instruction, in chunks spread over the job system. Particles that reached
+ * their lifetime are collected per chunk and then swap-removed: the last particle moves into
+ * the hole, which keeps the arrays dense without shifting anything. Particle order is therefore
+ * not stable.
+ *
+ * write_vertices() converts the particles to one Vertex per particle (for GL_POINTS), in
+ * parallel as well, so it can write straight into a mapped vertex buffer.
+ */
+class ParticleSystem {
+public:
+    static constexpr std::size_t CHUNK_SIZE = 16384;
+
+    explicit ParticleSystem(std::size_t capacity);
+
+    ParticleSystem(ParticleSystem const&) = delete;
+    ParticleSystem& operator=(ParticleSystem const&) = delete;
+
+public:
+    // Emitters are never removed, disable them instead. Their particles keep referring to them for their colors.
+    EmitterId add_emitter(ParticleEmitter const& emitter);
+    NODISCARD ParticleEmitter& get_emitter(EmitterId id);
+
+    NODISCARD ParticleForces& get_forces();
+
+    // Spawns, moves and kills particles. Uses the job system.
+    void update(f32 dt);
+    // Same, on the calling thread and without intrinsics. The reference for benchmarks.
+    void update_scalar(f32 dt);
+
+    // Writes get_size() vertices, which may be write-only (mapped) memory. Uses the job system.
+    void write_vertices(Vertex* out) const;
+
+    void clear();
+
+public:
+    NODISCARD std::size_t get_size() const;
+    NODISCARD std::size_t get_capacity() const;
+    NODISCARD ParticleStats const& get_stats() const;
+
+private:
+    void emit(f32 dt);
+    void integrate(std::size_t begin, std::size_t end, f32 dt, std::vector<u32>& dead);
+    void integrate_scalar(std::size_t begin, std::size_t end, f32 dt, std::vector<u32>& dead);
+    void remove_dead(std::size_t chunk_count);
+    void write_vertex_range(Vertex* out, std::size_t begin, std::size_t end) const;
+
+    NODISCARD u32 next_random();
+    NODISCARD f32 random_range(f32 min, f32 max);
+
+private:
+    std::size_t _capacity;
+    std::size_t _size;
+
+    std::vector<f32> _pos_x, _pos_y;
+    std::vector<f32> _vel_x, _vel_y;
+    std::vector<f32> _age, _lifetime;
+    std::vector<u32> _emitter;
+
+    std::vector<ParticleEmitter> _emitters;
+    std::vector<f32> _emit_remainder; // fractional particles left over per emitter
+    ParticleForces _forces;
+
+    // Dead particle indices per chunk, ascending.
+    std::vector<std::vector<u32>> _dead;
+
+    u32 _random_state;
+    ParticleStats _stats;
+};
@@ -0,0 +1,64 @@
+#include "dynamicresolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Of the target, what a new scale aims for.
+    constexpr f64 AIM = 0.9;
+    // Weight of a new sample in the running average.
+    constexpr f64 AVERAGE_WEIGHT = 0.25;
+}
+
+DynamicResolution::DynamicResolution(DynamicResolutionSettings const& settings) :
+    _settings{settings},
+    _scale{0.0f},
+    _average_ms{0.0},
+    _samples{0} {
+
+    _settings.min_scale = std::clamp(_settings.min_scale, 0.1f, 1.0f);
+    _settings.max_scale = std::clamp(_settings.max_scale, _settings.min_scale, 1.0f);
+    _scale = quantize(_settings.max_scale);
+}
+
+bool DynamicResolution::add_sample(f64 gpu_ms) {
+    _average_ms = _samples == 0 ? gpu_ms : _average_ms + (gpu_ms - _average_ms) * AVERAGE_WEIGHT;
+    if (++_samples < MIN_SAMPLES || _average_ms <= 0.0) {
+        return false;
+    }
+
+    bool over = _average_ms > _settings.target_ms;
+    bool under = _average_ms < _settings.target_ms * HEADROOM;
+    if (!over && !under) {
+        return false;
+    }
+
+    f32 wanted = _scale * static_cast<f32>(std::sqrt(_settings.target_ms * AIM / _average_ms));
+    f32 scale = quantize(wanted);
+    if (scale == _scale) {
+        return false;
+    }
+
+    _scale = scale;
+    _samples = 0;
+    return true;
+}
+
+f32 DynamicResolution::get_scale() const {
+    return _scale;
+}
+
+f64 DynamicResolution::get_average_ms() const {
+    return _average_ms;
+}
+
+DynamicResolutionSettings const& DynamicResolution::get_settings() const {
+    return _settings;
+}
+
+// Rounds down, a scale slightly too small is better than one that misses the target.
+f32 DynamicResolution::quantize(f32 scale) const {
+    f32 step = std::max(_settings.step, 0.01f);
+    f32 quantized = std::floor(scale / step + 1e-3f) * step;
+    return std::clamp(quantized, _settings.min_scale, _settings.max_scale);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <util/base.hpp>
+
+struct DynamicResolutionSettings {
+    f32 min_scale = 0.5f;
+    f32 max_scale = 1.0f;
+    // GPU time the scaled work may take per frame.
+    f64 target_ms = 16.0;
+    // Scales are multiples of this, so the few sizes in use stay in the render target pool.
+    f32 step = 0.05f;
+};
+
+/*
+ * Picks the render scale from measured GPU times.
+ *
+ * GPU time of fill bound work grows with the pixel count, so with the square of the scale.
+ * Once enough frames were measured at the current scale, it is changed to the one expected
+ * to hit 90% of the target: down as soon as the average exceeds the target, up only when it
+ * is below HEADROOM of it, so the scale doesn't oscillate around the target.
+ *
+ * Samples have to come from frames rendered at the current scale. GPU timings lag a few
+ * frames behind, so after every change the caller has to skip those rendered before it.
+ */
+class DynamicResolution {
+public:
+    static constexpr u32 MIN_SAMPLES = 8;
+    static constexpr f64 HEADROOM = 0.75;
+
+    explicit DynamicResolution(DynamicResolutionSettings const& settings);
+
+public:
+    // Returns whether the scale changed.
+    bool add_sample(f64 gpu_ms);
+
+public:
+    NODISCARD f32 get_scale() const;
+    NODISCARD f64 get_average_ms() const;
+    NODISCARD DynamicResolutionSettings const& get_settings() const;
+
+private:
+    NODISCARD f32 quantize(f32 scale) const;
+
+private:
+    DynamicResolutionSettings _settings;
+    f32 _scale;
+    f64 _average_ms;
+    u32 _samples;
+};
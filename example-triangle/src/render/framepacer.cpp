@@ -0,0 +1,219 @@
+#include "framepacer.hpp"
+
+#include <algorithm>
+
+#include <GLFW/glfw3.h>
+
+#include <util/precisesleep.hpp>
+
+namespace {
+    // Late latched frames start this much earlier than the estimate says, to absorb jitter.
+    constexpr f64 LATE_LATCH_MARGIN = 0.002;
+
+    // Weight of the newest frame in the work estimate.
+    constexpr f64 ESTIMATE_WEIGHT = 0.1;
+
+    f64 to_ms(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<f64, std::milli>(duration).count();
+    }
+}
+
+FramePacer::FramePacer() :
+    _settings{},
+    _refresh_period{1.0 / 60.0},
+    _in_flight{},
+    _free_queries{},
+    _history{},
+    _work_estimate{0.0},
+    _frame{0},
+    _query{0},
+    _query_active{false},
+    _timings{},
+    _frame_start{},
+    _previous_frame_start{},
+    _next_frame_deadline{} {
+
+}
+
+FramePacer::~FramePacer() {
+    for (auto& frame : _in_flight) {
+        glDeleteSync(frame.fence);
+        _free_queries.push_back(frame.query);
+    }
+
+    if (_query_active) {
+        glEndQuery(GL_TIME_ELAPSED);
+        _free_queries.push_back(_query);
+    }
+
+    if (!_free_queries.empty()) {
+        glDeleteQueries(static_cast<GLsizei>(_free_queries.size()), _free_queries.data());
+    }
+}
+
+void FramePacer::init(FramePacerSettings const& settings, f64 refresh_rate) {
+    set_settings(settings);
+    _refresh_period = refresh_rate > 0.0 ? 1.0 / refresh_rate : 1.0 / 60.0;
+    _previous_frame_start = Clock::now();
+    _next_frame_deadline = _previous_frame_start;
+}
+
+void FramePacer::set_settings(FramePacerSettings const& settings) {
+    _settings = settings;
+    _settings.max_frames_in_flight = std::clamp<u32>(_settings.max_frames_in_flight, 1, MAX_FRAMES_IN_FLIGHT);
+}
+
+void FramePacer::begin_frame() {
+    auto wait_start = Clock::now();
+
+    wait_for_frames_in_flight(_settings.max_frames_in_flight - 1);
+
+    f64 period = get_frame_period();
+    if (_settings.target_fps > 0.0 || _settings.late_latch) {
+        auto deadline = _next_frame_deadline;
+
+        if (_settings.late_latch) {
+            f64 delay = std::max(0.0, period - _work_estimate - LATE_LATCH_MARGIN);
+            deadline += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(delay));
+        }
+
+        wait_until(deadline);
+    }
+
+    _frame_start = Clock::now();
+
+    // A frame that started more than a period late resets the schedule instead of rushing to catch up.
+    auto period_duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(period));
+    _next_frame_deadline = std::max(_next_frame_deadline + period_duration, _frame_start);
+
+    _timings = {};
+    _timings.frame = _frame;
+    _timings.wait_ms = to_ms(_frame_start - wait_start);
+    _timings.frame_ms = to_ms(_frame_start - _previous_frame_start);
+    _previous_frame_start = _frame_start;
+
+    _query = acquire_query();
+    glBeginQuery(GL_TIME_ELAPSED, _query);
+    _query_active = true;
+}
+
+void FramePacer::present(GLFWwindow* window) {
+    if (_query_active) {
+        glEndQuery(GL_TIME_ELAPSED);
+        _query_active = false;
+    }
+
+    auto present_start = Clock::now();
+    _timings.cpu_ms = to_ms(present_start - _frame_start);
+
+    glfwSwapBuffers(window);
+
+    _timings.present_ms = to_ms(Clock::now() - present_start);
+
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _in_flight.push_back({fence, _query, _timings});
+    ++_frame;
+
+    // Collect whatever already finished without waiting, so the timings stay current.
+    while (!_in_flight.empty()) {
+        GLenum status = glClientWaitSync(_in_flight.front().fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        retire(_in_flight.front());
+        _in_flight.pop_front();
+    }
+}
+
+FramePacerSettings const& FramePacer::get_settings() const {
+    return _settings;
+}
+
+std::deque<FrameTimings> const& FramePacer::get_history() const {
+    return _history;
+}
+
+FrameTimings FramePacer::get_average() const {
+    FrameTimings average{};
+    if (_history.empty()) {
+        return average;
+    }
+
+    for (auto const& timings : _history) {
+        average.wait_ms += timings.wait_ms;
+        average.cpu_ms += timings.cpu_ms;
+        average.present_ms += timings.present_ms;
+        average.gpu_ms += timings.gpu_ms;
+        average.frame_ms += timings.frame_ms;
+    }
+
+    f64 count = static_cast<f64>(_history.size());
+    average.frame = _history.back().frame;
+    average.wait_ms /= count;
+    average.cpu_ms /= count;
+    average.present_ms /= count;
+    average.gpu_ms /= count;
+    average.frame_ms /= count;
+    return average;
+}
+
+void FramePacer::wait_for_frames_in_flight(u32 max_in_flight) {
+    while (_in_flight.size() > max_in_flight) {
+        InFlightFrame& frame = _in_flight.front();
+
+        // The first wait flushes, so the fence is guaranteed to reach the GPU.
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (true) {
+            GLenum status = glClientWaitSync(frame.fence, flags, 1'000'000);
+            if (status != GL_TIMEOUT_EXPIRED) {
+                break;
+            }
+            flags = 0;
+        }
+
+        retire(frame);
+        _in_flight.pop_front();
+    }
+}
+
+void FramePacer::retire(InFlightFrame& frame) {
+    glDeleteSync(frame.fence);
+
+    // The fence was signaled after the query ended, so the result is available without a stall.
+    GLuint64 gpu_ns = 0;
+    glGetQueryObjectui64v(frame.query, GL_QUERY_RESULT, &gpu_ns);
+    _free_queries.push_back(frame.query);
+
+    // Some drivers (llvmpipe) return garbage for the very first query of a context.
+    frame.timings.gpu_ms = gpu_ns < 1'000'000'000 ? static_cast<f64>(gpu_ns) / 1e6 : 0.0;
+
+    f64 work = (frame.timings.cpu_ms + frame.timings.gpu_ms) / 1000.0;
+    _work_estimate = _history.empty() ? work : _work_estimate + (work - _work_estimate) * ESTIMATE_WEIGHT;
+
+    _history.push_back(frame.timings);
+    if (_history.size() > HISTORY_SIZE) {
+        _history.pop_front();
+    }
+}
+
+void FramePacer::wait_until(Clock::time_point deadline) {
+    if (Clock::now() < deadline) {
+        precise_sleep_until(deadline);
+    }
+}
+
+GLuint FramePacer::acquire_query() {
+    if (_free_queries.empty()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        return query;
+    }
+
+    GLuint query = _free_queries.back();
+    _free_queries.pop_back();
+    return query;
+}
+
+f64 FramePacer::get_frame_period() const {
+    return _settings.target_fps > 0.0 ? 1.0 / _settings.target_fps : _refresh_period;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <util/base.hpp>
+
+struct GLFWwindow;
+
+struct FramePacerSettings {
+    // Frames the CPU may run ahead of the GPU. 1 gives the lowest latency, more give more throughput.
+    u32 max_frames_in_flight = 2;
+    // Frame rate cap, 0 for none. Independent of vsync, which still applies on top.
+    f64 target_fps = 0.0;
+    // Delays the start of each frame, and with it sampling input, to just before it has to begin.
+    bool late_latch = false;
+};
+
+// Timings of one frame in milliseconds. GPU timings are only known once the frame has finished on the GPU.
+struct FrameTimings {
+    u64 frame;
+    f64 wait_ms;    // blocked on frames in flight, the frame rate cap and late latching
+    f64 cpu_ms;     // from begin_frame() to present()
+    f64 present_ms; // inside glfwSwapBuffers(), including vsync
+    f64 gpu_ms;     // GPU time of the commands between begin_frame() and present()
+    f64 frame_ms;   // from the previous begin_frame() to this one
+};
+
+/*
+ * Paces the render loop. Call begin_frame() before polling input and present() instead of
+ * glfwSwapBuffers().
+ *
+ * Every presented frame gets a fence. begin_frame() waits on the fence of the frame that
+ * was presented max_frames_in_flight frames ago, so the driver can never queue up more
+ * frames than that, each adding a frame of latency. It then waits for the frame rate cap
+ * with a hybrid sleep and spin timer.
+ *
+ * With late latching, it additionally waits until the expected time of work for the frame
+ * (CPU and GPU, smoothed over the last frames plus a safety margin) fits just into the
+ * frame period, so input sampled right after begin_frame() is as fresh as possible. The
+ * frame period is the cap, or the refresh period given to init() without one.
+ */
+class FramePacer {
+public:
+    static constexpr u32 MAX_FRAMES_IN_FLIGHT = 4;
+    static constexpr std::size_t HISTORY_SIZE = 120;
+
+    FramePacer();
+    ~FramePacer();
+
+    FramePacer(FramePacer const&) = delete;
+    FramePacer& operator=(FramePacer const&) = delete;
+
+public:
+    // Needs a current context.
+    void init(FramePacerSettings const& settings, f64 refresh_rate);
+
+    void set_settings(FramePacerSettings const& settings);
+
+    void begin_frame();
+    void present(GLFWwindow* window);
+
+public:
+    NODISCARD FramePacerSettings const& get_settings() const;
+
+    // Timings of the last completed frames, oldest first.
+    NODISCARD std::deque<FrameTimings> const& get_history() const;
+    // Mean over the history, frame is the latest completed frame.
+    NODISCARD FrameTimings get_average() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct InFlightFrame {
+        GLsync fence;
+        GLuint query;
+        FrameTimings timings;
+    };
+
+    void wait_for_frames_in_flight(u32 max_in_flight);
+    void retire(InFlightFrame& frame);
+    void wait_until(Clock::time_point deadline);
+
+    NODISCARD GLuint acquire_query();
+    NODISCARD f64 get_frame_period() const;
+
+private:
+    FramePacerSettings _settings;
+    f64 _refresh_period;
+
+    std::deque<InFlightFrame> _in_flight;
+    std::vector<GLuint> _free_queries;
+    std::deque<FrameTimings> _history;
+
+    // Expected CPU plus GPU time per frame for late latching, in seconds.
+    f64 _work_estimate;
+
+    u64 _frame;
+    GLuint _query;
+    bool _query_active;
+    FrameTimings _timings;
+    Clock::time_point _frame_start;
+    Clock::time_point _previous_frame_start;
+    Clock::time_point _next_frame_deadline;
+};
@@ -0,0 +1,397 @@
+#include "glresources.hpp"
+
+#include <algorithm>
+
+namespace {
+    std::size_t buffer_size_class(std::size_t size) {
+        if (size > GlResources::MAX_POOLED_BUFFER_SIZE) {
+            return size;
+        }
+
+        std::size_t size_class = GlResources::MIN_BUFFER_SIZE;
+        while (size_class < size) {
+            size_class *= 2;
+        }
+        return size_class;
+    }
+
+    u64 bytes_per_pixel(GLenum internal_format) {
+        switch (internal_format) {
+            case GL_R8:
+                return 1;
+            case GL_RG8:
+            case GL_R16F:
+            case GL_DEPTH_COMPONENT16:
+                return 2;
+            case GL_RGB8:
+                return 3;
+            case GL_RGBA16F:
+            case GL_RG32F:
+                return 8;
+            case GL_RGBA32F:
+                return 16;
+            default:
+                return 4;
+        }
+    }
+}
+
+GlResources::GlResources() :
+    _slots{},
+    _free_slots{},
+    _pools{},
+    _retired{},
+    _retired_frames{},
+    _stats{},
+    _frame{0} {
+
+}
+
+GlResources::~GlResources() {
+    // Deleting objects the GPU still uses is fine, the driver keeps them alive until it is done.
+    for (std::size_t type = 0; type < GlResourceStats::TYPE_COUNT; ++type) {
+        std::vector<GLuint> ids;
+
+        for (auto const& slot : _slots[type]) {
+            if (slot.alive) {
+                ids.push_back(slot.id);
+            }
+        }
+
+        for (auto const& [key, pooled] : _pools[type]) {
+            ids.push_back(pooled.id);
+        }
+        _pools[type].clear();
+
+        delete_objects(static_cast<GlResourceType>(type), ids);
+    }
+
+    for (auto& frame : _retired_frames) {
+        glDeleteSync(frame.fence);
+        _retired.insert(_retired.end(), frame.objects.begin(), frame.objects.end());
+    }
+
+    for (std::size_t type = 0; type < GlResourceStats::TYPE_COUNT; ++type) {
+        std::vector<GLuint> ids;
+        for (auto const& object : _retired) {
+            if (index_of(object.type) == type) {
+                ids.push_back(object.id);
+            }
+        }
+        delete_objects(static_cast<GlResourceType>(type), ids);
+    }
+}
+
+BufferHandle GlResources::create_buffer(std::size_t size, GLenum usage, void const* data, GlMemoryCategory category) {
+    std::size_t capacity = buffer_size_class(size);
+    u64 pool_key = capacity <= MAX_POOLED_BUFFER_SIZE ? (static_cast<u64>(capacity) << 32) | usage : 0;
+
+    GLuint id = pool_key ? take_pooled(GlResourceType::Buffer, pool_key) : 0;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+
+    if (!id) {
+        glGenBuffers(1, &id);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+        glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, usage);
+    }
+
+    if (data) {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, data);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    u32 index = allocate_slot(GlResourceType::Buffer, id, category, capacity, pool_key);
+    return {index, _slots[index_of(GlResourceType::Buffer)][index].generation};
+}
+
+TextureHandle GlResources::create_texture_2d(i32 width, i32 height, GLenum internal_format, GlMemoryCategory category) {
+    u64 pool_key = (static_cast<u64>(width) << 44) | (static_cast<u64>(height) << 24) | (internal_format & 0xffffff);
+    u64 bytes = get_texture_size(width, height, internal_format);
+
+    GLuint id = take_pooled(GlResourceType::Texture, pool_key);
+    if (!id) {
+        GLint previous;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+
+        // The format and type only matter for uploading data, they just have to be valid for the internal format.
+        bool depth = internal_format == GL_DEPTH_COMPONENT16 || internal_format == GL_DEPTH_COMPONENT24 || internal_format == GL_DEPTH_COMPONENT32F;
+        bool depth_stencil = internal_format == GL_DEPTH24_STENCIL8;
+        GLenum format = depth ? GL_DEPTH_COMPONENT : depth_stencil ? GL_DEPTH_STENCIL : GL_RED;
+        GLenum type = depth_stencil ? GL_UNSIGNED_INT_24_8 : depth ? GL_FLOAT : GL_UNSIGNED_BYTE;
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+        glBindTexture(GL_TEXTURE_2D, previous);
+    }
+
+    u32 index = allocate_slot(GlResourceType::Texture, id, category, bytes, pool_key);
+    return {index, _slots[index_of(GlResourceType::Texture)][index].generation};
+}
+
+VertexArrayHandle GlResources::create_vertex_array() {
+    GLuint id;
+    glGenVertexArrays(1, &id);
+
+    u32 index = allocate_slot(GlResourceType::VertexArray, id, GlMemoryCategory::Other, 0, 0);
+    return {index, _slots[index_of(GlResourceType::VertexArray)][index].generation};
+}
+
+FramebufferHandle GlResources::create_framebuffer(GLuint color_attachment) {
+    u64 pool_key = color_attachment;
+
+    GLuint id = pool_key ? take_pooled(GlResourceType::Framebuffer, pool_key) : 0;
+    if (!id) {
+        glGenFramebuffers(1, &id);
+
+        if (color_attachment) {
+            GLint previous;
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, id);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_attachment, 0);
+
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previous);
+        }
+    }
+
+    u32 index = allocate_slot(GlResourceType::Framebuffer, id, GlMemoryCategory::Other, 0, pool_key);
+    return {index, _slots[index_of(GlResourceType::Framebuffer)][index].generation};
+}
+
+BufferHandle GlResources::adopt_buffer(GLuint id, std::size_t size, GlMemoryCategory category) {
+    u32 index = allocate_slot(GlResourceType::Buffer, id, category, size, 0);
+    return {index, _slots[index_of(GlResourceType::Buffer)][index].generation};
+}
+
+TextureHandle GlResources::adopt_texture(GLuint id, i32 width, i32 height, GLenum internal_format, GlMemoryCategory category) {
+    u32 index = allocate_slot(GlResourceType::Texture, id, category, get_texture_size(width, height, internal_format), 0);
+    return {index, _slots[index_of(GlResourceType::Texture)][index].generation};
+}
+
+void GlResources::end_frame() {
+    if (!_retired.empty()) {
+        _retired_frames.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(_retired)});
+        _retired.clear();
+    }
+
+    // Frames finish in order, so stop at the first one that is still running.
+    std::size_t finished = 0;
+    while (finished < _retired_frames.size()) {
+        GLenum status = glClientWaitSync(_retired_frames[finished].fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        ++finished;
+    }
+
+    if (finished > 0) {
+        std::vector<Retired> objects;
+        for (std::size_t i = 0; i < finished; ++i) {
+            glDeleteSync(_retired_frames[i].fence);
+            objects.insert(objects.end(), _retired_frames[i].objects.begin(), _retired_frames[i].objects.end());
+        }
+        _retired_frames.erase(_retired_frames.begin(), _retired_frames.begin() + finished);
+
+        free_objects(objects);
+    }
+
+    ++_frame;
+    if (_frame % 60 == 0) {
+        trim_pools();
+    }
+}
+
+u64 GlResources::release_pools() {
+    return delete_pooled(_frame + 1);
+}
+
+std::size_t GlResources::get_buffer_size(BufferHandle handle) const {
+    Slot const* slot = find(GlResourceType::Buffer, handle.index, handle.generation);
+    return slot ? static_cast<std::size_t>(slot->bytes) : 0;
+}
+
+u64 GlResources::get_texture_size(i32 width, i32 height, GLenum internal_format) {
+    return static_cast<u64>(width) * height * bytes_per_pixel(internal_format);
+}
+
+GlResourceStats const& GlResources::get_stats() const {
+    return _stats;
+}
+
+u32 GlResources::allocate_slot(GlResourceType type, GLuint id, GlMemoryCategory category, u64 bytes, u64 pool_key) {
+    std::size_t t = index_of(type);
+    auto& slots = _slots[t];
+    auto& free_slots = _free_slots[t];
+
+    u32 index;
+    if (free_slots.empty()) {
+        index = static_cast<u32>(slots.size());
+        slots.push_back({0, 1, false, GlMemoryCategory::Other, 0, 0});
+    } else {
+        index = free_slots.back();
+        free_slots.pop_back();
+    }
+
+    Slot& slot = slots[index];
+    slot.id = id;
+    slot.alive = true;
+    slot.category = category;
+    slot.bytes = bytes;
+    slot.pool_key = pool_key;
+
+    ++_stats.live[t];
+    _stats.live_bytes[t] += bytes;
+    _stats.category_bytes[static_cast<std::size_t>(category)] += bytes;
+    return index;
+}
+
+void GlResources::release(GlResourceType type, u32 index, u32 generation) {
+    std::size_t t = index_of(type);
+    if (!find(type, index, generation)) {
+        return;
+    }
+
+    Slot& slot = _slots[t][index];
+    _retired.push_back({type, slot.id, slot.bytes, slot.pool_key});
+
+    --_stats.live[t];
+    _stats.live_bytes[t] -= slot.bytes;
+    _stats.category_bytes[static_cast<std::size_t>(slot.category)] -= slot.bytes;
+    ++_stats.pending[t];
+    _stats.pending_bytes[t] += slot.bytes;
+
+    slot.alive = false;
+    slot.id = 0;
+    if (++slot.generation == 0) {
+        slot.generation = 1;
+    }
+    _free_slots[t].push_back(index);
+}
+
+GlResources::Slot const* GlResources::find(GlResourceType type, u32 index, u32 generation) const {
+    auto const& slots = _slots[index_of(type)];
+    if (generation == 0 || index >= slots.size()) {
+        return nullptr;
+    }
+
+    Slot const& slot = slots[index];
+    return slot.alive && slot.generation == generation ? &slot : nullptr;
+}
+
+GLuint GlResources::take_pooled(GlResourceType type, u64 pool_key) {
+    std::size_t t = index_of(type);
+    auto it = _pools[t].find(pool_key);
+    if (it == _pools[t].end()) {
+        return 0;
+    }
+
+    GLuint id = it->second.id;
+    --_stats.pooled[t];
+    _stats.pooled_bytes[t] -= it->second.bytes;
+    _pools[t].erase(it);
+    return id;
+}
+
+void GlResources::free_objects(std::vector<Retired> const& objects) {
+    std::array<std::vector<GLuint>, GlResourceStats::TYPE_COUNT> deleted;
+
+    for (auto const& object : objects) {
+        std::size_t t = index_of(object.type);
+        --_stats.pending[t];
+        _stats.pending_bytes[t] -= object.bytes;
+
+        if (object.pool_key) {
+            _pools[t].insert({object.pool_key, {object.id, object.bytes, _frame}});
+            ++_stats.pooled[t];
+            _stats.pooled_bytes[t] += object.bytes;
+        } else {
+            deleted[t].push_back(object.id);
+        }
+    }
+
+    for (std::size_t t = 0; t < GlResourceStats::TYPE_COUNT; ++t) {
+        delete_objects(static_cast<GlResourceType>(t), deleted[t]);
+    }
+}
+
+void GlResources::trim_pools() {
+    if (_frame > POOL_RETENTION_FRAMES) {
+        (void)delete_pooled(_frame - POOL_RETENTION_FRAMES);
+    }
+}
+
+u64 GlResources::delete_pooled(u64 before_frame) {
+    u64 freed = 0;
+
+    for (std::size_t t = 0; t < GlResourceStats::TYPE_COUNT; ++t) {
+        std::vector<GLuint> expired;
+
+        for (auto it = _pools[t].begin(); it != _pools[t].end();) {
+            if (it->second.frame < before_frame) {
+                expired.push_back(it->second.id);
+                freed += it->second.bytes;
+                --_stats.pooled[t];
+                _stats.pooled_bytes[t] -= it->second.bytes;
+                it = _pools[t].erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        delete_objects(static_cast<GlResourceType>(t), expired);
+    }
+
+    return freed;
+}
+
+void GlResources::delete_pooled_framebuffers(std::vector<GLuint> const& textures) {
+    std::size_t t = index_of(GlResourceType::Framebuffer);
+    std::vector<GLuint> attached;
+
+    for (GLuint texture : textures) {
+        auto [begin, end] = _pools[t].equal_range(texture);
+        for (auto it = begin; it != end; ++it) {
+            attached.push_back(it->second.id);
+            --_stats.pooled[t];
+            _stats.pooled_bytes[t] -= it->second.bytes;
+        }
+        _pools[t].erase(begin, end);
+    }
+
+    delete_objects(GlResourceType::Framebuffer, attached);
+}
+
+void GlResources::delete_objects(GlResourceType type, std::vector<GLuint> const& ids) {
+    if (ids.empty()) {
+        return;
+    }
+
+    if (type == GlResourceType::Texture) {
+        delete_pooled_framebuffers(ids);
+    }
+
+    GLsizei count = static_cast<GLsizei>(ids.size());
+    switch (type) {
+        case GlResourceType::Buffer:
+            glDeleteBuffers(count, ids.data());
+            break;
+        case GlResourceType::Texture:
+            glDeleteTextures(count, ids.data());
+            break;
+        case GlResourceType::VertexArray:
+            glDeleteVertexArrays(count, ids.data());
+            break;
+        case GlResourceType::Framebuffer:
+            glDeleteFramebuffers(count, ids.data());
+            break;
+        case GlResourceType::Count:
+            break;
+    }
+}
+
+std::size_t GlResources::index_of(GlResourceType type) {
+    return static_cast<std::size_t>(type);
+}
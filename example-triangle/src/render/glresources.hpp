@@ -0,0 +1,198 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <util/base.hpp>
+
+enum class GlResourceType : u8 {
+    Buffer,
+    Texture,
+    VertexArray,
+    Framebuffer,
+    Count,
+};
+
+// What memory is used for, only for accounting.
+enum class GlMemoryCategory : u8 {
+    Mesh,
+    Texture,
+    RenderTarget,
+    Dynamic, // rewritten every frame
+    Other,
+    Count,
+};
+
+/*
+ * Refers to a GL object owned by GlResources. The generation changes every time a slot is
+ * reused, so a handle to a destroyed object never resolves to whatever took its place.
+ * Generation 0 is never handed out, a default constructed handle is null.
+ */
+template<GlResourceType TYPE>
+struct GlHandle {
+    u32 index = 0;
+    u32 generation = 0;
+
+    NODISCARD bool is_null() const { return generation == 0; }
+
+    bool operator==(GlHandle const& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(GlHandle const& other) const { return !(*this == other); }
+};
+
+using BufferHandle = GlHandle<GlResourceType::Buffer>;
+using TextureHandle = GlHandle<GlResourceType::Texture>;
+using VertexArrayHandle = GlHandle<GlResourceType::VertexArray>;
+using FramebufferHandle = GlHandle<GlResourceType::Framebuffer>;
+
+struct GlResourceStats {
+    static constexpr std::size_t TYPE_COUNT = static_cast<std::size_t>(GlResourceType::Count);
+    static constexpr std::size_t CATEGORY_COUNT = static_cast<std::size_t>(GlMemoryCategory::Count);
+
+    std::array<u32, TYPE_COUNT> live{};
+    std::array<u64, TYPE_COUNT> live_bytes{};
+    std::array<u64, CATEGORY_COUNT> category_bytes{}; // of live objects
+    // Destroyed, waiting for the GPU to finish the frames that may still use them.
+    std::array<u32, TYPE_COUNT> pending{};
+    std::array<u64, TYPE_COUNT> pending_bytes{};
+    // Storage kept around for reuse.
+    std::array<u32, TYPE_COUNT> pooled{};
+    std::array<u64, TYPE_COUNT> pooled_bytes{};
+};
+
+/*
+ * Owns GL objects and hands out generational handles to them from per type slot arrays.
+ *
+ * destroy() only retires an object: it is deleted once the GPU has finished the frame it
+ * was retired in (end_frame() fences every frame), and all objects that became free
+ * together are deleted with a single glDelete* call per type.
+ *
+ * Buffers and textures are not deleted right away but recycled. Buffer storage is rounded
+ * up to a power of two size class per usage, textures are matched by size and format.
+ * Recycled storage keeps its old contents and, for textures, its sampling parameters.
+ * Framebuffers with a color attachment are recycled for the same texture, so a texture that
+ * comes back from the pool gets its framebuffer back as well. Deleting a texture deletes
+ * the pooled framebuffers it is attached to.
+ * Storage that was not reused for POOL_RETENTION_FRAMES frames is deleted.
+ *
+ * Only to be used on the thread owning the context.
+ */
+class GlResources {
+public:
+    static constexpr u64 POOL_RETENTION_FRAMES = 300;
+    static constexpr std::size_t MIN_BUFFER_SIZE = 256;
+    // Larger buffers are allocated with their exact size and never pooled.
+    static constexpr std::size_t MAX_POOLED_BUFFER_SIZE = std::size_t{64} << 20;
+
+    GlResources();
+    ~GlResources();
+
+    GlResources(GlResources const&) = delete;
+    GlResources& operator=(GlResources const&) = delete;
+
+public:
+    // Storage for at least size bytes, initialized with data if given. Uses GL_COPY_WRITE_BUFFER, other bindings stay untouched.
+    NODISCARD BufferHandle create_buffer(std::size_t size, GLenum usage, void const* data = nullptr, GlMemoryCategory category = GlMemoryCategory::Mesh);
+    // A 2D texture without mipmaps. Uses GL_TEXTURE_2D, its binding is restored afterwards.
+    NODISCARD TextureHandle create_texture_2d(i32 width, i32 height, GLenum internal_format, GlMemoryCategory category = GlMemoryCategory::Texture);
+    NODISCARD VertexArrayHandle create_vertex_array();
+    // With color_attachment attached as GL_COLOR_ATTACHMENT0, or without attachments for 0. Only the former is recycled,
+    // keeping whatever other state it was given. Uses GL_DRAW_FRAMEBUFFER, its binding is restored afterwards.
+    NODISCARD FramebufferHandle create_framebuffer(GLuint color_attachment = 0);
+
+    // Takes over objects created elsewhere, e.g. by the ResourceLoader. They are deleted rather than recycled once destroyed.
+    NODISCARD BufferHandle adopt_buffer(GLuint id, std::size_t size, GlMemoryCategory category = GlMemoryCategory::Mesh);
+    NODISCARD TextureHandle adopt_texture(GLuint id, i32 width, i32 height, GLenum internal_format, GlMemoryCategory category = GlMemoryCategory::Texture);
+
+    // Retires the object and resets the handle. Null and stale handles are ignored.
+    template<GlResourceType TYPE>
+    void destroy(GlHandle<TYPE>& handle) {
+        release(TYPE, handle.index, handle.generation);
+        handle = {};
+    }
+
+    // Fences the objects retired during this frame and frees the ones the GPU is done with. Call after swapping.
+    void end_frame();
+    // Deletes all pooled storage right away, for when memory is tight. Returns the bytes freed.
+    u64 release_pools();
+
+public:
+    // The GL name, or 0 for null and stale handles.
+    template<GlResourceType TYPE>
+    NODISCARD GLuint get(GlHandle<TYPE> handle) const {
+        Slot const* slot = find(TYPE, handle.index, handle.generation);
+        return slot ? slot->id : 0;
+    }
+
+    template<GlResourceType TYPE>
+    NODISCARD bool is_valid(GlHandle<TYPE> handle) const {
+        return find(TYPE, handle.index, handle.generation) != nullptr;
+    }
+
+    // Size of the buffer's storage, at least what was asked for.
+    NODISCARD std::size_t get_buffer_size(BufferHandle handle) const;
+    // Bytes a texture created by create_texture_2d() is accounted with.
+    NODISCARD static u64 get_texture_size(i32 width, i32 height, GLenum internal_format);
+
+    NODISCARD GlResourceStats const& get_stats() const;
+
+private:
+    struct Slot {
+        GLuint id;
+        u32 generation;
+        bool alive;
+        GlMemoryCategory category;
+        u64 bytes;
+        u64 pool_key; // 0 for objects that are never recycled
+    };
+
+    struct Retired {
+        GlResourceType type;
+        GLuint id;
+        u64 bytes;
+        u64 pool_key;
+    };
+
+    struct RetiredFrame {
+        GLsync fence;
+        std::vector<Retired> objects;
+    };
+
+    struct Pooled {
+        GLuint id;
+        u64 bytes;
+        u64 frame;
+    };
+
+    using Pool = std::unordered_multimap<u64, Pooled>;
+
+    NODISCARD u32 allocate_slot(GlResourceType type, GLuint id, GlMemoryCategory category, u64 bytes, u64 pool_key);
+    void release(GlResourceType type, u32 index, u32 generation);
+    NODISCARD Slot const* find(GlResourceType type, u32 index, u32 generation) const;
+
+    // Takes matching storage out of the pool, 0 if there is none.
+    NODISCARD GLuint take_pooled(GlResourceType type, u64 pool_key);
+    void free_objects(std::vector<Retired> const& objects);
+    void trim_pools();
+    // Deletes pooled storage that was returned before the given frame, returns the bytes freed.
+    u64 delete_pooled(u64 before_frame);
+    // Pooled framebuffers only refer to their attachment, its name could be handed out again once it is deleted.
+    void delete_pooled_framebuffers(std::vector<GLuint> const& textures);
+    void delete_objects(GlResourceType type, std::vector<GLuint> const& ids);
+
+    NODISCARD static std::size_t index_of(GlResourceType type);
+
+private:
+    std::array<std::vector<Slot>, GlResourceStats::TYPE_COUNT> _slots;
+    std::array<std::vector<u32>, GlResourceStats::TYPE_COUNT> _free_slots;
+    std::array<Pool, GlResourceStats::TYPE_COUNT> _pools;
+
+    std::vector<Retired> _retired;
+    std::vector<RetiredFrame> _retired_frames;
+
+    GlResourceStats _stats;
+    u64 _frame;
+};
@@ -0,0 +1,130 @@
+#include "gpuculling.hpp"
+
+#include <shaders/defaultshaders.hpp>
+
+namespace {
+    constexpr GLuint WORKGROUP_SIZE = 64;
+}
+
+GpuCulling::GpuCulling() :
+    _compute_shader{ShaderType::ComputeShader, ASSET_SOURCE(GPU_CULL_COMPUTE_SHADER), "gpu_cull_compute_shader"},
+    _program{"gpu_cull_program"},
+    _resources{nullptr},
+    _instance_buffer{},
+    _command_buffer{},
+    _count_buffer{},
+    _planes_location{-1},
+    _instance_count_location{-1},
+    _instance_count{0} {
+
+}
+
+GpuCulling::~GpuCulling() {
+    if (_resources) {
+        _resources->destroy(_instance_buffer);
+        _resources->destroy(_command_buffer);
+        _resources->destroy(_count_buffer);
+    }
+}
+
+bool GpuCulling::is_supported() {
+    return GLEW_VERSION_4_3 && (GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters);
+}
+
+void GpuCulling::init(GlResources& resources, std::vector<GpuCullInstance> const& instances) {
+    _resources = &resources;
+    _compute_shader.init();
+    _program.init_compute(_compute_shader.get_id());
+
+    _planes_location = glGetUniformLocation(_program.get_id(), "our_planes");
+    _instance_count_location = glGetUniformLocation(_program.get_id(), "our_instance_count");
+
+    _instance_count = static_cast<u32>(instances.size());
+
+    std::vector<GpuInstance> gpu_instances;
+    gpu_instances.reserve(instances.size());
+    for (auto const& instance : instances) {
+        gpu_instances.push_back(to_gpu_instance(instance));
+    }
+
+    _instance_buffer = resources.create_buffer(gpu_instances.size() * sizeof(GpuInstance), GL_STATIC_DRAW, gpu_instances.data(), GlMemoryCategory::Other);
+
+    // Written by the compute shader only, sized for the case of everything being visible.
+    _command_buffer = resources.create_buffer(_instance_count * sizeof(DrawElementsIndirectCommand), GL_DYNAMIC_COPY, nullptr, GlMemoryCategory::Other);
+
+    u32 zero = 0;
+    _count_buffer = resources.create_buffer(sizeof(u32), GL_DYNAMIC_COPY, &zero, GlMemoryCategory::Other);
+}
+
+void GpuCulling::update_instance(u32 index, GpuCullInstance const& instance) {
+    GpuInstance gpu_instance = to_gpu_instance(instance);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _resources->get(_instance_buffer));
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, index * sizeof(GpuInstance), sizeof(GpuInstance), &gpu_instance);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void GpuCulling::cull(Frustum const& frustum) {
+    if (_instance_count == 0) {
+        return;
+    }
+
+    u32 zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _resources->get(_count_buffer));
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(u32), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    GLint previous_program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+
+    _program.use();
+    glUniform4fv(_planes_location, 6, &frustum.planes[0].x);
+    glUniform1ui(_instance_count_location, _instance_count);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _resources->get(_instance_buffer));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _resources->get(_command_buffer));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _resources->get(_count_buffer));
+
+    glDispatchCompute((_instance_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    // The commands and the count are consumed as indirect draw parameters.
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(previous_program);
+}
+
+void GpuCulling::draw(GLenum mode) {
+    if (_instance_count == 0) {
+        return;
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _resources->get(_command_buffer));
+    glBindBuffer(GL_PARAMETER_BUFFER_ARB, _resources->get(_count_buffer));
+
+    if (GLEW_VERSION_4_6) {
+        glMultiDrawElementsIndirectCount(mode, GL_UNSIGNED_INT, nullptr, 0, _instance_count, sizeof(DrawElementsIndirectCommand));
+    } else {
+        glMultiDrawElementsIndirectCountARB(mode, GL_UNSIGNED_INT, nullptr, 0, _instance_count, sizeof(DrawElementsIndirectCommand));
+    }
+
+    glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+u32 GpuCulling::get_instance_count() const {
+    return _instance_count;
+}
+
+u32 GpuCulling::read_visible_count() const {
+    u32 count = 0;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _resources->get(_count_buffer));
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(u32), &count);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    return count;
+}
+
+GpuCulling::GpuInstance GpuCulling::to_gpu_instance(GpuCullInstance const& instance) {
+    return {vec4{instance.bounds.min, 0.0f}, vec4{instance.bounds.max, 0.0f}, instance.index_count, instance.first_index, instance.base_vertex, 0};
+}
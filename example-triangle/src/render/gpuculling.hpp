@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <render/glresources.hpp>
+#include <scene/bounds.hpp>
+#include <shaders/shader.hpp>
+#include <shaders/shaderprogram.hpp>
+#include <util/base.hpp>
+
+// One culled object: its world bounds and the range of the bound element buffer it draws.
+struct GpuCullInstance {
+    Aabb bounds;
+    u32 index_count;
+    u32 first_index;
+    i32 base_vertex;
+};
+
+/*
+ * GPU-driven culling for OpenGL 4.3+ with GL_ARB_indirect_parameters (core in 4.6).
+ *
+ * Instance bounds are uploaded once. Every frame a compute shader tests them against the
+ * frustum and appends a DrawElementsIndirectCommand per visible instance, counting them with
+ * an atomic. draw() then issues all of them with a single glMultiDrawElementsIndirectCount,
+ * so the CPU never touches individual objects. Callers should check is_supported() and use
+ * CullingGrid otherwise.
+ */
+class GpuCulling {
+public:
+    GpuCulling();
+    ~GpuCulling();
+
+    GpuCulling(GpuCulling const&) = delete;
+    GpuCulling& operator=(GpuCulling const&) = delete;
+
+public:
+    NODISCARD static bool is_supported();
+
+    // The buffers come from resources.
+    void init(GlResources& resources, std::vector<GpuCullInstance> const& instances);
+    void update_instance(u32 index, GpuCullInstance const& instance);
+
+    void cull(Frustum const& frustum);
+    // Expects the VAO with the element buffer to be bound.
+    void draw(GLenum mode);
+
+public:
+    NODISCARD u32 get_instance_count() const;
+    // Reads the visible count back from the GPU. This stalls, so only use it for statistics.
+    NODISCARD u32 read_visible_count() const;
+
+private:
+    struct GpuInstance {
+        vec4 bounds_min;
+        vec4 bounds_max;
+        u32 index_count;
+        u32 first_index;
+        i32 base_vertex;
+        u32 padding;
+    };
+
+    struct DrawElementsIndirectCommand {
+        u32 count;
+        u32 instance_count;
+        u32 first_index;
+        i32 base_vertex;
+        u32 base_instance;
+    };
+
+    NODISCARD static GpuInstance to_gpu_instance(GpuCullInstance const& instance);
+
+private:
+    Shader _compute_shader;
+    ShaderProgram _program;
+
+    GlResources* _resources;
+    BufferHandle _instance_buffer;
+    BufferHandle _command_buffer;
+    BufferHandle _count_buffer;
+    GLint _planes_location;
+    GLint _instance_count_location;
+
+    u32 _instance_count;
+};
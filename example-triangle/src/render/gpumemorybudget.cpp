@@ -0,0 +1,247 @@
+#include "gpumemorybudget.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <GL/glew.h>
+
+namespace {
+    constexpr std::array<char const*, GlResourceStats::CATEGORY_COUNT> CATEGORY_NAMES{
+        "mesh", "texture", "render target", "dynamic", "other"};
+
+    f64 to_mib(u64 bytes) {
+        return static_cast<f64>(bytes) / (1024.0 * 1024.0);
+    }
+
+    u64 sum(std::array<u64, GlResourceStats::TYPE_COUNT> const& bytes) {
+        u64 total = 0;
+        for (u64 value : bytes) {
+            total += value;
+        }
+        return total;
+    }
+}
+
+GpuMemoryBudget::GpuMemoryBudget() :
+    _resources{nullptr},
+    _hard_budget{0},
+    _residents{},
+    _free_ids{},
+    _driver{GpuMemorySource::Estimate, 0, 0},
+    _frame{0},
+    _evictions{0},
+    _restores{0} {
+
+}
+
+void GpuMemoryBudget::init(GlResources& resources, u64 hard_budget_bytes) {
+    _resources = &resources;
+    _hard_budget = hard_budget_bytes;
+    _driver = query_driver();
+}
+
+void GpuMemoryBudget::set_hard_budget(u64 bytes) {
+    _hard_budget = bytes;
+}
+
+ResidencyId GpuMemoryBudget::add(GlMemoryCategory category, u64 bytes, std::function<void()> evict, std::function<void()> restore) {
+    Resident resident{category, true, true, bytes, _frame, std::move(evict), std::move(restore)};
+
+    if (_free_ids.empty()) {
+        _residents.push_back(std::move(resident));
+        return static_cast<ResidencyId>(_residents.size() - 1);
+    }
+
+    ResidencyId id = _free_ids.back();
+    _free_ids.pop_back();
+    _residents[id] = std::move(resident);
+    return id;
+}
+
+void GpuMemoryBudget::remove(ResidencyId id) {
+    _residents[id] = {};
+    _free_ids.push_back(id);
+}
+
+void GpuMemoryBudget::use(ResidencyId id) {
+    Resident& resident = _residents[id];
+    resident.last_used = _frame;
+
+    if (!resident.resident) {
+        resident.restore();
+        resident.resident = true;
+        ++_restores;
+    }
+}
+
+void GpuMemoryBudget::end_frame() {
+    bool driver_updated = _frame % DRIVER_QUERY_INTERVAL == 0;
+    if (driver_updated) {
+        _driver = query_driver();
+    }
+
+    u64 excess = get_excess(driver_updated);
+    if (excess > 0) {
+        // Pooled storage costs nothing to give up, nobody has to recreate it.
+        u64 released = _resources->release_pools();
+        excess -= std::min(excess, released);
+    }
+
+    if (excess > 0) {
+        evict_least_recently_used(excess);
+    }
+
+    ++_frame;
+}
+
+GpuMemoryReport GpuMemoryBudget::get_report() const {
+    GlResourceStats const& stats = _resources->get_stats();
+
+    GpuMemoryReport report{};
+    report.category_bytes = stats.category_bytes;
+    report.live_bytes = sum(stats.live_bytes);
+    report.pooled_bytes = sum(stats.pooled_bytes);
+    report.pending_bytes = sum(stats.pending_bytes);
+    report.hard_budget_bytes = _hard_budget;
+    report.evictions = _evictions;
+    report.restores = _restores;
+    report.driver = _driver;
+
+    for (auto const& resident : _residents) {
+        if (!resident.alive) {
+            continue;
+        }
+
+        if (resident.resident) {
+            ++report.resident;
+        } else {
+            ++report.evicted;
+            report.evicted_bytes += resident.bytes;
+        }
+    }
+
+    return report;
+}
+
+std::string GpuMemoryBudget::format_summary() const {
+    GpuMemoryReport report = get_report();
+
+    char budget[32] = "no budget";
+    if (report.hard_budget_bytes > 0) {
+        snprintf(budget, sizeof(budget), "budget %.2f MiB", to_mib(report.hard_budget_bytes));
+    }
+
+    char driver[48] = "estimated";
+    if (report.driver.source != GpuMemorySource::Estimate) {
+        snprintf(driver, sizeof(driver), "%.0f MiB free", to_mib(report.driver.available_bytes));
+    }
+
+    char line[160];
+    snprintf(line, sizeof(line), "GPU memory: %.2f MiB (%s, %s), %u evicted",
+        to_mib(report.live_bytes + report.pooled_bytes + report.pending_bytes), budget, driver, report.evicted);
+    return line;
+}
+
+std::string GpuMemoryBudget::format_report() const {
+    GpuMemoryReport report = get_report();
+    std::string text;
+    char line[160];
+
+    switch (report.driver.source) {
+        case GpuMemorySource::NvxGpuMemoryInfo:
+            snprintf(line, sizeof(line), "GPU memory (GL_NVX_gpu_memory_info): %.1f of %.1f MiB free\n",
+                to_mib(report.driver.available_bytes), to_mib(report.driver.total_bytes));
+            break;
+        case GpuMemorySource::AtiMeminfo:
+            snprintf(line, sizeof(line), "GPU memory (GL_ATI_meminfo): %.1f MiB free\n", to_mib(report.driver.available_bytes));
+            break;
+        case GpuMemorySource::Estimate:
+            snprintf(line, sizeof(line), "GPU memory (estimated from tracked allocations):\n");
+            break;
+    }
+    text += line;
+
+    for (std::size_t category = 0; category < GlResourceStats::CATEGORY_COUNT; ++category) {
+        snprintf(line, sizeof(line), "  %-14s %9.3f MiB\n", CATEGORY_NAMES[category], to_mib(report.category_bytes[category]));
+        text += line;
+    }
+
+    snprintf(line, sizeof(line), "  %-14s %9.3f MiB\n  %-14s %9.3f MiB\n", "pooled", to_mib(report.pooled_bytes), "pending", to_mib(report.pending_bytes));
+    text += line;
+
+    if (report.hard_budget_bytes > 0) {
+        snprintf(line, sizeof(line), "  %-14s %9.3f MiB\n", "hard budget", to_mib(report.hard_budget_bytes));
+        text += line;
+    }
+
+    snprintf(line, sizeof(line), "  %u resident, %u evicted (%.3f MiB), %llu evictions, %llu restores\n",
+        report.resident, report.evicted, to_mib(report.evicted_bytes),
+        static_cast<unsigned long long>(report.evictions), static_cast<unsigned long long>(report.restores));
+    text += line;
+
+    return text;
+}
+
+GpuMemoryInfo GpuMemoryBudget::query_driver() {
+    // Both extensions report in KiB.
+    if (GLEW_NVX_gpu_memory_info) {
+        GLint total = 0;
+        GLint available = 0;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+        return {GpuMemorySource::NvxGpuMemoryInfo, static_cast<u64>(total) * 1024, static_cast<u64>(available) * 1024};
+    }
+
+    if (GLEW_ATI_meminfo) {
+        // Free memory in the pool, largest free block, free auxiliary memory, largest auxiliary block.
+        GLint texture[4] = {};
+        GLint vbo[4] = {};
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, texture);
+        glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, vbo);
+        return {GpuMemorySource::AtiMeminfo, 0, static_cast<u64>(std::min(texture[0], vbo[0])) * 1024};
+    }
+
+    return {GpuMemorySource::Estimate, 0, 0};
+}
+
+u64 GpuMemoryBudget::get_excess(bool driver_updated) const {
+    GlResourceStats const& stats = _resources->get_stats();
+
+    // Pending memory is already on its way out, evicting more would not bring it back any sooner.
+    u64 used = sum(stats.live_bytes) + sum(stats.pooled_bytes);
+    u64 excess = _hard_budget > 0 && used > _hard_budget ? used - _hard_budget : 0;
+
+    // The driver only reflects evictions after a while, so only react to a fresh answer.
+    if (driver_updated && _driver.source != GpuMemorySource::Estimate && _driver.available_bytes < MIN_AVAILABLE_BYTES) {
+        excess = std::max(excess, MIN_AVAILABLE_BYTES - _driver.available_bytes);
+    }
+
+    return excess;
+}
+
+void GpuMemoryBudget::evict_least_recently_used(u64 bytes) {
+    std::vector<ResidencyId> candidates;
+    for (ResidencyId id = 0; id < _residents.size(); ++id) {
+        Resident const& resident = _residents[id];
+        if (resident.alive && resident.resident && resident.last_used < _frame) {
+            candidates.push_back(id);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [this](ResidencyId a, ResidencyId b) {
+        return _residents[a].last_used < _residents[b].last_used;
+    });
+
+    u64 freed = 0;
+    for (ResidencyId id : candidates) {
+        if (freed >= bytes) {
+            break;
+        }
+
+        Resident& resident = _residents[id];
+        resident.evict();
+        resident.resident = false;
+        freed += resident.bytes;
+        ++_evictions;
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <render/glresources.hpp>
+#include <util/base.hpp>
+
+using ResidencyId = u32;
+
+enum class GpuMemorySource : u8 {
+    NvxGpuMemoryInfo,
+    AtiMeminfo,
+    Estimate, // no driver query, only what GlResources tracks
+};
+
+struct GpuMemoryInfo {
+    GpuMemorySource source;
+    u64 total_bytes;     // 0 if the driver does not tell
+    u64 available_bytes; // 0 for estimates
+};
+
+struct GpuMemoryReport {
+    std::array<u64, GlResourceStats::CATEGORY_COUNT> category_bytes;
+    u64 live_bytes;
+    u64 pooled_bytes;
+    u64 pending_bytes;
+    u64 hard_budget_bytes; // 0 for none
+
+    u32 resident;
+    u32 evicted;
+    u64 evicted_bytes;
+    u64 evictions; // since init()
+    u64 restores;
+
+    GpuMemoryInfo driver;
+};
+
+/*
+ * Keeps the buffer and texture memory of GlResources within a hard budget and reports where
+ * it goes, by category.
+ *
+ * Resources that can be recreated (meshes and textures with their data still on the CPU)
+ * are registered with a callback that destroys their GL objects and one that recreates
+ * them, and have to be marked with use() every frame they are drawn. When the live and
+ * pooled memory exceeds the budget, or the driver reports less than MIN_AVAILABLE_BYTES
+ * free through GL_NVX_gpu_memory_info or GL_ATI_meminfo, end_frame() first drops the
+ * pooled storage and then evicts the least recently used resources that were not used in
+ * the current frame. An evicted resource is restored by the next use().
+ *
+ * Evicted objects are only freed once the frames in flight are done with them, so
+ * GlResources::end_frame() has to run after end_frame().
+ */
+class GpuMemoryBudget {
+public:
+    // The driver is only asked every this many frames, the query is not free on every driver.
+    static constexpr u64 DRIVER_QUERY_INTERVAL = 30;
+    static constexpr u64 MIN_AVAILABLE_BYTES = u64{64} << 20;
+
+    GpuMemoryBudget();
+
+    GpuMemoryBudget(GpuMemoryBudget const&) = delete;
+    GpuMemoryBudget& operator=(GpuMemoryBudget const&) = delete;
+
+public:
+    // Needs a current context. A budget of 0 only evicts when the driver runs low.
+    void init(GlResources& resources, u64 hard_budget_bytes);
+    void set_hard_budget(u64 bytes);
+
+    // bytes is what evict() frees and restore() allocates again. The resource has to be resident.
+    NODISCARD ResidencyId add(GlMemoryCategory category, u64 bytes, std::function<void()> evict, std::function<void()> restore);
+    // Forgets the resource without calling either callback.
+    void remove(ResidencyId id);
+    // Marks the resource as used by the current frame and restores it if it was evicted.
+    void use(ResidencyId id);
+
+    // Evicts until the budget holds again. Call once per frame after presenting.
+    void end_frame();
+
+public:
+    NODISCARD GpuMemoryReport get_report() const;
+    // One line for the on-screen statistics.
+    NODISCARD std::string format_summary() const;
+    // Per category breakdown, several lines.
+    NODISCARD std::string format_report() const;
+
+    NODISCARD static GpuMemoryInfo query_driver();
+
+private:
+    struct Resident {
+        GlMemoryCategory category;
+        bool alive;
+        bool resident;
+        u64 bytes;
+        u64 last_used;
+        std::function<void()> evict;
+        std::function<void()> restore;
+    };
+
+    // How many bytes have to go, 0 if the budget holds.
+    NODISCARD u64 get_excess(bool driver_updated) const;
+    void evict_least_recently_used(u64 bytes);
+
+private:
+    GlResources* _resources;
+    u64 _hard_budget;
+
+    std::vector<Resident> _residents;
+    std::vector<ResidencyId> _free_ids;
+
+    GpuMemoryInfo _driver;
+    u64 _frame;
+    u64 _evictions;
+    u64 _restores;
+};
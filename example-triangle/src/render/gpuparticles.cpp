@@ -0,0 +1,282 @@
+#include "gpuparticles.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+#include <render/vertex.hpp>
+#include <shaders/defaultshaders.hpp>
+
+namespace {
+    constexpr GLuint WORKGROUP_SIZE = 64;
+
+    // Must match the stages in gpuparticlescomputeshader.glsl.
+    constexpr u32 STAGE_UPDATE = 0;
+    constexpr u32 STAGE_EMIT = 1;
+    constexpr u32 STAGE_FINALIZE = 2;
+
+    constexpr f32 POINT_SIZE = 2.0f;
+}
+
+GpuParticleSystem::GpuParticleSystem() :
+    _compute_shader{ShaderType::ComputeShader, ASSET_SOURCE(GPU_PARTICLES_COMPUTE_SHADER), "gpu_particles_compute_shader"},
+    _compute_program{"gpu_particles_program"},
+    _stage_location{-1},
+    _source_location{-1},
+    _vertex_shader{ShaderType::VertexShader, ASSET_SOURCE(DEFAULT_VERTEX_SHADER), "gpu_particles_vertex_shader"},
+    _fragment_shader{ShaderType::FragmentShader, ASSET_SOURCE(DEFAULT_FRAGMENT_SHADER), "gpu_particles_fragment_shader"},
+    _draw_program{"gpu_particles_draw_program"},
+    _proj_location{-1},
+    _model_location{-1},
+    _resources{nullptr},
+    _particle_buffers{},
+    _vertex_buffer{},
+    _count_buffer{},
+    _params_buffer{},
+    _vao{},
+    _capacity{0},
+    _source{0},
+    _seed{0x9e3779b9},
+    _emitters{},
+    _emit_remainder{},
+    _forces{},
+    _timers{},
+    _next_timer{0},
+    _update_ms{0.0} {
+
+}
+
+GpuParticleSystem::~GpuParticleSystem() {
+    if (_resources) {
+        for (Timer& timer : _timers) {
+            glDeleteQueries(1, &timer.begin_query);
+            glDeleteQueries(1, &timer.end_query);
+        }
+
+        _resources->destroy(_particle_buffers[0]);
+        _resources->destroy(_particle_buffers[1]);
+        _resources->destroy(_vertex_buffer);
+        _resources->destroy(_count_buffer);
+        _resources->destroy(_params_buffer);
+        _resources->destroy(_vao);
+    }
+}
+
+bool GpuParticleSystem::is_supported() {
+    return GLEW_VERSION_4_3;
+}
+
+void GpuParticleSystem::init(GlResources& resources, std::size_t capacity) {
+    _resources = &resources;
+    _capacity = capacity;
+
+    _compute_shader.init();
+    _compute_program.init_compute(_compute_shader.get_id());
+    _stage_location = glGetUniformLocation(_compute_program.get_id(), "our_stage");
+    _source_location = glGetUniformLocation(_compute_program.get_id(), "our_source");
+
+    _vertex_shader.init();
+    _fragment_shader.init();
+    _draw_program.init(_vertex_shader.get_id(), _fragment_shader.get_id());
+    _proj_location = glGetUniformLocation(_draw_program.get_id(), "our_proj");
+    _model_location = glGetUniformLocation(_draw_program.get_id(), "our_model");
+
+    // Written by the compute shader only.
+    _particle_buffers[0] = resources.create_buffer(capacity * sizeof(GpuParticle), GL_DYNAMIC_COPY, nullptr, GlMemoryCategory::Other);
+    _particle_buffers[1] = resources.create_buffer(capacity * sizeof(GpuParticle), GL_DYNAMIC_COPY, nullptr, GlMemoryCategory::Other);
+    _vertex_buffer = resources.create_buffer(capacity * sizeof(Vertex), GL_DYNAMIC_COPY, nullptr, GlMemoryCategory::Dynamic);
+
+    GpuCounts counts{};
+    _count_buffer = resources.create_buffer(sizeof(counts), GL_DYNAMIC_COPY, &counts, GlMemoryCategory::Other);
+    _params_buffer = resources.create_buffer(sizeof(GpuParams), GL_DYNAMIC_DRAW, nullptr, GlMemoryCategory::Other);
+
+    _vao = resources.create_vertex_array();
+    glBindVertexArray(resources.get(_vao));
+    glBindBuffer(GL_ARRAY_BUFFER, resources.get(_vertex_buffer));
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+
+    for (Timer& timer : _timers) {
+        glGenQueries(1, &timer.begin_query);
+        glGenQueries(1, &timer.end_query);
+        timer.pending = false;
+    }
+}
+
+EmitterId GpuParticleSystem::add_emitter(ParticleEmitter const& emitter) {
+    _emitters.push_back(emitter);
+    _emit_remainder.push_back(0.0f);
+    return static_cast<EmitterId>(_emitters.size() - 1);
+}
+
+ParticleEmitter& GpuParticleSystem::get_emitter(EmitterId id) {
+    return _emitters[id];
+}
+
+ParticleForces& GpuParticleSystem::get_forces() {
+    return _forces;
+}
+
+void GpuParticleSystem::update(f32 dt) {
+    // A timer still waiting for its results is skipped rather than waited on.
+    Timer& timer = _timers[_next_timer];
+    _next_timer = (_next_timer + 1) % TIMER_COUNT;
+    read_timer(timer);
+    bool timed = !timer.pending;
+    if (timed) {
+        glQueryCounter(timer.begin_query, GL_TIMESTAMP);
+    }
+
+    GpuParams params{};
+    params.gravity = _forces.gravity;
+    params.drag = _forces.drag;
+    params.dt = dt;
+    params.capacity = static_cast<u32>(_capacity);
+    params.emitter_count = static_cast<u32>(std::min(_emitters.size(), MAX_EMITTERS));
+    params.attractor_count = static_cast<u32>(std::min(_forces.attractors.size(), MAX_ATTRACTORS));
+    params.seed = _seed;
+
+    // Rates that don't add up to a whole particle per frame carry the fraction over to the next one.
+    for (u32 id = 0; id < params.emitter_count; ++id) {
+        ParticleEmitter const& emitter = _emitters[id];
+        u32 count = 0;
+        if (emitter.enabled) {
+            f32 wanted = _emit_remainder[id] + emitter.rate * dt;
+            count = static_cast<u32>(wanted);
+            _emit_remainder[id] = wanted - static_cast<f32>(count);
+            count = std::min(count, params.capacity);
+        }
+
+        params.emitters[id] = {emitter.position, emitter.direction, emitter.spread,
+                               emitter.min_speed, emitter.max_speed, emitter.min_lifetime, emitter.max_lifetime,
+                               pack_color(emitter.start_color), pack_color(emitter.end_color),
+                               params.spawn_total, count};
+        params.spawn_total += count;
+    }
+    params.spawn_total = std::min(params.spawn_total, params.capacity);
+
+    for (u32 i = 0; i < params.attractor_count; ++i) {
+        ParticleAttractor const& attractor = _forces.attractors[i];
+        params.attractors[i] = {attractor.position, attractor.strength, attractor.radius};
+    }
+
+    // A different stream of random numbers every update.
+    _seed = _seed * 1664525u + 1013904223u;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _resources->get(_params_buffer));
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(params), &params);
+
+    u32 zero = 0;
+    u32 destination = 1 - _source;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _resources->get(_count_buffer));
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, destination * sizeof(u32), sizeof(u32), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    GLint previous_program;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+
+    _compute_program.use();
+    glUniform1ui(_source_location, _source);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _resources->get(_particle_buffers[_source]));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _resources->get(_particle_buffers[destination]));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _resources->get(_vertex_buffer));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _resources->get(_count_buffer));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _resources->get(_params_buffer));
+
+    // Every stage appends to the count the previous one left behind.
+    dispatch(STAGE_UPDATE, params.capacity);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    dispatch(STAGE_EMIT, params.spawn_total);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    dispatch(STAGE_FINALIZE, 1);
+
+    // The vertices and the command are consumed by the draw, the counts are cleared and read back through the API.
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT |
+                    GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    glUseProgram(previous_program);
+    _source = destination;
+
+    if (timed) {
+        glQueryCounter(timer.end_query, GL_TIMESTAMP);
+        timer.pending = true;
+    }
+}
+
+void GpuParticleSystem::draw(mat4 const& projection) {
+    mat4 model = mat4::identity();
+
+    _draw_program.use();
+    glUniformMatrix4fv(_proj_location, 1, GL_FALSE, projection.data());
+    glUniformMatrix4fv(_model_location, 1, GL_FALSE, model.data());
+    glBindVertexArray(_resources->get(_vao));
+
+    glPointSize(POINT_SIZE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _resources->get(_count_buffer));
+    glDrawArraysIndirect(GL_POINTS, (void*)offsetof(GpuCounts, command));
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    glDisable(GL_BLEND);
+}
+
+std::size_t GpuParticleSystem::get_capacity() const {
+    return _capacity;
+}
+
+u32 GpuParticleSystem::read_alive_count() const {
+    u32 count = 0;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _resources->get(_count_buffer));
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, _source * sizeof(u32), sizeof(u32), &count);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    return count;
+}
+
+f64 GpuParticleSystem::get_update_ms() const {
+    return _update_ms;
+}
+
+void GpuParticleSystem::dispatch(u32 stage, u32 invocations) {
+    if (invocations == 0) {
+        return;
+    }
+
+    glUniform1ui(_stage_location, stage);
+    glDispatchCompute((invocations + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+}
+
+// Never waits, a timer whose results are not there yet stays pending.
+void GpuParticleSystem::read_timer(Timer& timer) {
+    if (!timer.pending) {
+        return;
+    }
+
+    GLuint64 available = 0;
+    glGetQueryObjectui64v(timer.end_query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return;
+    }
+
+    GLuint64 begin_ns = 0;
+    GLuint64 end_ns = 0;
+    glGetQueryObjectui64v(timer.begin_query, GL_QUERY_RESULT, &begin_ns);
+    glGetQueryObjectui64v(timer.end_query, GL_QUERY_RESULT, &end_ns);
+    timer.pending = false;
+
+    if (end_ns >= begin_ns) {
+        _update_ms = static_cast<f64>(end_ns - begin_ns) / 1e6;
+    }
+}
+
+u32 GpuParticleSystem::pack_color(Rgba8 color) {
+    return static_cast<u32>(color.r) | (static_cast<u32>(color.g) << 8) | (static_cast<u32>(color.b) << 16) | (static_cast<u32>(color.a) << 24);
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <math/matrix.hpp>
+#include <particles/particlesystem.hpp>
+#include <render/glresources.hpp>
+#include <shaders/shader.hpp>
+#include <shaders/shaderprogram.hpp>
+#include <util/base.hpp>
+
+/*
+ * The GPU counterpart of ParticleSystem for OpenGL 4.3+, taking the same emitters and forces.
+ *
+ * Particles live in two shader storage buffers used in turns. Every update a compute shader
+ * integrates the particles of one buffer and appends the survivors to the other, which
+ * compacts them on the way, then appends the newly emitted ones. A last single-thread pass
+ * clamps the count to the capacity and writes it into a DrawArraysIndirectCommand, and the
+ * particles are drawn as points from a vertex buffer the same passes filled, so the CPU never
+ * learns how many there are. Callers should check is_supported() and use ParticleSystem
+ * otherwise.
+ */
+class GpuParticleSystem {
+public:
+    static constexpr std::size_t MAX_EMITTERS = 16;
+    static constexpr std::size_t MAX_ATTRACTORS = 8;
+
+    GpuParticleSystem();
+    ~GpuParticleSystem();
+
+    GpuParticleSystem(GpuParticleSystem const&) = delete;
+    GpuParticleSystem& operator=(GpuParticleSystem const&) = delete;
+
+public:
+    NODISCARD static bool is_supported();
+
+    // The buffers come from resources.
+    void init(GlResources& resources, std::size_t capacity);
+
+    // Only the first MAX_EMITTERS emitters and MAX_ATTRACTORS attractors take effect.
+    EmitterId add_emitter(ParticleEmitter const& emitter);
+    NODISCARD ParticleEmitter& get_emitter(EmitterId id);
+    NODISCARD ParticleForces& get_forces();
+
+    // Dispatches the simulation, nothing waits for it.
+    void update(f32 dt);
+    // Blends the particles additively over the framebuffer. Leaves its own program and vertex array bound.
+    void draw(mat4 const& projection);
+
+public:
+    NODISCARD std::size_t get_capacity() const;
+    // Reads the particle count back from the GPU. This stalls, so only use it for statistics.
+    NODISCARD u32 read_alive_count() const;
+    // GPU time of the most recent update the timer queries have caught up with.
+    NODISCARD f64 get_update_ms() const;
+
+private:
+    // Mirrors the std430 layouts in gpuparticlescomputeshader.glsl.
+    struct GpuParticle {
+        vec2 position;
+        vec2 velocity;
+        f32 age;
+        f32 lifetime;
+        u32 emitter;
+        u32 padding;
+    };
+
+    struct GpuEmitter {
+        vec2 position;
+        f32 direction;
+        f32 spread;
+        f32 min_speed, max_speed;
+        f32 min_lifetime, max_lifetime;
+        u32 start_color, end_color;
+        u32 first_spawn;
+        u32 spawn_count;
+    };
+
+    struct GpuAttractor {
+        vec2 position;
+        f32 strength;
+        f32 radius;
+    };
+
+    struct GpuParams {
+        vec2 gravity;
+        f32 drag;
+        f32 dt;
+        u32 capacity;
+        u32 emitter_count;
+        u32 attractor_count;
+        u32 seed;
+        u32 spawn_total;
+        u32 padding[3];
+        GpuEmitter emitters[MAX_EMITTERS];
+        GpuAttractor attractors[MAX_ATTRACTORS];
+    };
+
+    static_assert(sizeof(GpuParticle) == 32, "GpuParticle must match the GLSL layout");
+    static_assert(sizeof(GpuEmitter) == 48, "GpuEmitter must match the GLSL layout");
+    static_assert(offsetof(GpuParams, emitters) == 48, "GpuParams must match the GLSL layout");
+
+    struct DrawArraysIndirectCommand {
+        u32 count;
+        u32 instance_count;
+        u32 first;
+        u32 base_instance;
+    };
+
+    struct GpuCounts {
+        u32 counts[2];
+        DrawArraysIndirectCommand command;
+    };
+
+    // A pair of timestamps around one update, read back a few frames later.
+    struct Timer {
+        GLuint begin_query;
+        GLuint end_query;
+        bool pending;
+    };
+
+    static constexpr std::size_t TIMER_COUNT = 4;
+
+    void dispatch(u32 stage, u32 invocations);
+    void read_timer(Timer& timer);
+
+    NODISCARD static u32 pack_color(Rgba8 color);
+
+private:
+    Shader _compute_shader;
+    ShaderProgram _compute_program;
+    GLint _stage_location;
+    GLint _source_location;
+
+    Shader _vertex_shader;
+    Shader _fragment_shader;
+    ShaderProgram _draw_program;
+    GLint _proj_location;
+    GLint _model_location;
+
+    GlResources* _resources;
+    std::array<BufferHandle, 2> _particle_buffers;
+    BufferHandle _vertex_buffer;
+    BufferHandle _count_buffer;
+    BufferHandle _params_buffer;
+    VertexArrayHandle _vao;
+
+    std::size_t _capacity;
+    u32 _source;
+    u32 _seed;
+
+    std::vector<ParticleEmitter> _emitters;
+    std::vector<f32> _emit_remainder;
+    ParticleForces _forces;
+
+    std::array<Timer, TIMER_COUNT> _timers;
+    std::size_t _next_timer;
+    f64 _update_ms;
+};
@@ -0,0 +1,106 @@
+#include "particlerenderer.hpp"
+
+#include <chrono>
+#include <cstddef>
+
+#include <render/vertex.hpp>
+#include <shaders/defaultshaders.hpp>
+
+ParticleRenderer::ParticleRenderer() :
+    _vertex_shader{ShaderType::VertexShader, ASSET_SOURCE(DEFAULT_VERTEX_SHADER), "particle_vertex_shader"},
+    _fragment_shader{ShaderType::FragmentShader, ASSET_SOURCE(DEFAULT_FRAGMENT_SHADER), "particle_fragment_shader"},
+    _program{"particle_shader_program"},
+    _proj_location{-1},
+    _model_location{-1},
+    _resources{nullptr},
+    _vao{},
+    _vbo{},
+    _upload_ms{0.0} {
+
+}
+
+ParticleRenderer::~ParticleRenderer() {
+    if (_resources) {
+        _resources->destroy(_vbo);
+        _resources->destroy(_vao);
+    }
+}
+
+void ParticleRenderer::init(GlResources& resources) {
+    _resources = &resources;
+
+    _vertex_shader.init();
+    _fragment_shader.init();
+    _program.init(_vertex_shader.get_id(), _fragment_shader.get_id());
+
+    _proj_location = glGetUniformLocation(_program.get_id(), "our_proj");
+    _model_location = glGetUniformLocation(_program.get_id(), "our_model");
+
+    _vao = resources.create_vertex_array();
+    glBindVertexArray(resources.get(_vao));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+}
+
+void ParticleRenderer::draw(ParticleSystem const& particles, mat4 const& projection) {
+    auto start = std::chrono::steady_clock::now();
+    _upload_ms = 0.0;
+
+    std::size_t count = particles.get_size();
+    if (count == 0) {
+        return;
+    }
+
+    mat4 model = mat4::identity();
+
+    _program.use();
+    glUniformMatrix4fv(_proj_location, 1, GL_FALSE, projection.data());
+    glUniformMatrix4fv(_model_location, 1, GL_FALSE, model.data());
+    glBindVertexArray(_resources->get(_vao));
+
+    std::size_t size = count * sizeof(Vertex);
+    reserve_vertices(size);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _resources->get(_vbo));
+    void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!mapped) {
+        return;
+    }
+
+    particles.write_vertices(static_cast<Vertex*>(mapped));
+
+    // The contents are lost if the storage went away while mapped, e.g. on a mode switch. Skip the frame then.
+    bool intact = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+    _upload_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!intact) {
+        return;
+    }
+
+    glPointSize(POINT_SIZE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(count));
+    glDisable(GL_BLEND);
+}
+
+f64 ParticleRenderer::get_upload_ms() const {
+    return _upload_ms;
+}
+
+// Expects the vertex array to be bound, the attributes have to point into the new buffer.
+void ParticleRenderer::reserve_vertices(std::size_t size) {
+    if (size <= _resources->get_buffer_size(_vbo)) {
+        return;
+    }
+
+    // The old buffer may still be in use by frames in flight, GlResources only frees it after them.
+    _resources->destroy(_vbo);
+    _vbo = _resources->create_buffer(size, GL_STREAM_DRAW, nullptr, GlMemoryCategory::Dynamic);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _resources->get(_vbo));
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <math/matrix.hpp>
+#include <particles/particlesystem.hpp>
+#include <render/glresources.hpp>
+#include <shaders/shader.hpp>
+#include <shaders/shaderprogram.hpp>
+#include <util/base.hpp>
+
+/*
+ * Draws a ParticleSystem as points with the default shaders, one vertex per particle.
+ *
+ * Every frame the vertex buffer is mapped with GL_MAP_INVALIDATE_BUFFER_BIT, so the driver hands
+ * out fresh storage instead of waiting for the frames in flight still reading the old contents,
+ * and the particle system's workers write the vertices straight into it. The buffer is only
+ * replaced when the particles outgrow it.
+ */
+class ParticleRenderer {
+public:
+    static constexpr f32 POINT_SIZE = 2.0f;
+
+    ParticleRenderer();
+    ~ParticleRenderer();
+
+    ParticleRenderer(ParticleRenderer const&) = delete;
+    ParticleRenderer& operator=(ParticleRenderer const&) = delete;
+
+public:
+    // Needs a current context, the GL objects come from resources.
+    void init(GlResources& resources);
+
+    // Blends the particles additively over the framebuffer. Leaves its own program and vertex array bound.
+    void draw(ParticleSystem const& particles, mat4 const& projection);
+
+public:
+    // Time spent mapping, writing and unmapping the vertices in the last draw().
+    NODISCARD f64 get_upload_ms() const;
+
+private:
+    void reserve_vertices(std::size_t size);
+
+private:
+    Shader _vertex_shader;
+    Shader _fragment_shader;
+    ShaderProgram _program;
+    GLint _proj_location;
+    GLint _model_location;
+
+    GlResources* _resources;
+    VertexArrayHandle _vao;
+    BufferHandle _vbo;
+    f64 _upload_ms;
+};
@@ -0,0 +1,338 @@
+#include "postchain.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <shaders/defaultshaders.hpp>
+
+namespace {
+    f64 to_mib(u64 bytes) {
+        return static_cast<f64>(bytes) / (1024.0 * 1024.0);
+    }
+}
+
+PostChain::PostChain() :
+    _vertex_shader{ShaderType::VertexShader, ASSET_SOURCE(FULLSCREEN_VERTEX_SHADER), "fullscreen_vertex_shader"},
+    _resources{nullptr},
+    _vao{},
+    _targets{},
+    _passes{},
+    _textures{},
+    _width{0},
+    _height{0},
+    _render_scale{1.0f},
+    _allocated{false},
+    _timers{},
+    _next_timer{0},
+    _frame{0},
+    _timed_frame{0},
+    _gpu_ms{0.0} {
+
+}
+
+PostChain::~PostChain() {
+    if (_resources) {
+        release();
+        _resources->destroy(_vao);
+
+        for (FrameTimer& timer : _timers) {
+            if (!timer.queries.empty()) {
+                glDeleteQueries(static_cast<GLsizei>(timer.queries.size()), timer.queries.data());
+            }
+        }
+    }
+}
+
+void PostChain::init(GlResources& resources) {
+    _resources = &resources;
+    _vertex_shader.init();
+
+    // Core profiles don't draw without a vertex array, even when no attribute is read.
+    _vao = resources.create_vertex_array();
+}
+
+RenderTargetId PostChain::add_target(RenderTargetDesc const& desc) {
+    _targets.push_back({desc, 0, 0, 0});
+    return static_cast<RenderTargetId>(_targets.size() - 1);
+}
+
+RenderPassId PostChain::add_pass(RenderPassDesc const& desc) {
+    Pass pass{desc, nullptr, nullptr, {}, -1, 0.0};
+
+    if (!desc.fragment_source.empty()) {
+        pass.fragment_shader = std::make_unique<Shader>(ShaderType::FragmentShader, desc.fragment_source, desc.name + "_fragment_shader");
+        pass.fragment_shader->init();
+        pass.program = std::make_unique<ShaderProgram>(desc.name + "_program");
+        pass.program->init(_vertex_shader.get_id(), pass.fragment_shader->get_id());
+
+        for (std::size_t i = 0; i < desc.inputs.size(); ++i) {
+            std::string name = "our_input" + std::to_string(i);
+            pass.input_locations.push_back(glGetUniformLocation(pass.program->get_id(), name.c_str()));
+        }
+        pass.params_location = glGetUniformLocation(pass.program->get_id(), "our_params");
+    }
+
+    _passes.push_back(std::move(pass));
+    return static_cast<RenderPassId>(_passes.size() - 1);
+}
+
+RenderPassDesc& PostChain::get_pass(RenderPassId id) {
+    return _passes[id].desc;
+}
+
+void PostChain::resize(i32 width, i32 height) {
+    if (width == _width && height == _height) {
+        return;
+    }
+
+    _width = width;
+    _height = height;
+    _allocated = false;
+}
+
+void PostChain::set_render_scale(f32 scale) {
+    if (scale == _render_scale) {
+        return;
+    }
+
+    _render_scale = scale;
+    _allocated = false;
+}
+
+void PostChain::execute(std::function<void(RenderPassId)> const& draw) {
+    if (_width <= 0 || _height <= 0) {
+        return;
+    }
+
+    if (!_allocated) {
+        allocate();
+    }
+
+    FrameTimer& timer = _timers[_next_timer];
+    _next_timer = (_next_timer + 1) % TIMER_FRAMES;
+    read_timer(timer);
+
+    // A frame whose timer is still waiting for results goes untimed.
+    bool timed = !timer.pending;
+    if (timed) {
+        if (timer.queries.empty()) {
+            timer.queries.resize(_passes.size() + 1);
+            glGenQueries(static_cast<GLsizei>(timer.queries.size()), timer.queries.data());
+        }
+        glQueryCounter(timer.queries[0], GL_TIMESTAMP);
+        timer.frame = _frame;
+    }
+
+    for (RenderPassId id = 0; id < _passes.size(); ++id) {
+        Pass& pass = _passes[id];
+
+        if (pass.desc.output == BACKBUFFER) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, _width, _height);
+        } else {
+            Texture const& output = _textures[_targets[pass.desc.output].texture];
+            glBindFramebuffer(GL_FRAMEBUFFER, _resources->get(output.framebuffer));
+            glViewport(0, 0, output.width, output.height);
+        }
+
+        if (pass.desc.clear) {
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+
+        if (!pass.program) {
+            draw(id);
+        } else {
+            pass.program->use();
+            for (std::size_t i = 0; i < pass.desc.inputs.size(); ++i) {
+                Texture const& input = _textures[_targets[pass.desc.inputs[i]].texture];
+                glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+                glBindTexture(GL_TEXTURE_2D, _resources->get(input.texture));
+                glUniform1i(pass.input_locations[i], static_cast<GLint>(i));
+            }
+            glUniform4fv(pass.params_location, 1, &pass.desc.params.x);
+
+            glBindVertexArray(_resources->get(_vao));
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+
+            // Texture unit 0 is what everybody else assumes to be active.
+            glActiveTexture(GL_TEXTURE0);
+        }
+
+        if (timed) {
+            glQueryCounter(timer.queries[id + 1], GL_TIMESTAMP);
+        }
+    }
+
+    timer.pending = timed;
+    ++_frame;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, _width, _height);
+}
+
+PostChainStats PostChain::get_stats() const {
+    PostChainStats stats{};
+    stats.targets = static_cast<u32>(_targets.size());
+    stats.textures = static_cast<u32>(_textures.size());
+
+    for (Target const& target : _targets) {
+        stats.target_bytes += get_target_bytes(target);
+    }
+    for (Texture const& texture : _textures) {
+        stats.texture_bytes += GlResources::get_texture_size(texture.width, texture.height, texture.format);
+    }
+
+    return stats;
+}
+
+f32 PostChain::get_render_scale() const {
+    return _render_scale;
+}
+
+f64 PostChain::get_pass_ms(RenderPassId id) const {
+    return _passes[id].gpu_ms;
+}
+
+f64 PostChain::get_gpu_ms() const {
+    return _gpu_ms;
+}
+
+u64 PostChain::get_frame() const {
+    return _frame;
+}
+
+u64 PostChain::get_timed_frame() const {
+    return _timed_frame;
+}
+
+std::string PostChain::format_summary() const {
+    PostChainStats stats = get_stats();
+
+    char line[128];
+    std::snprintf(line, sizeof(line), "Post: %u targets in %u textures, %.2f MiB saved by aliasing, render scale %.2f\n",
+                  stats.targets, stats.textures, to_mib(stats.target_bytes - stats.texture_bytes), _render_scale);
+    std::string summary = line;
+
+    for (RenderPassId id = 0; id < _passes.size(); ++id) {
+        std::snprintf(line, sizeof(line), "%s%s %.3f ms", id == 0 ? "" : ", ", _passes[id].desc.name.c_str(), _passes[id].gpu_ms);
+        summary += line;
+    }
+
+    return summary;
+}
+
+// Greedy: targets in the order they are first written, each taking the first free texture that matches.
+void PostChain::allocate() {
+    release();
+
+    for (Target& target : _targets) {
+        target.first_pass = static_cast<u32>(_passes.size());
+        target.last_pass = 0;
+    }
+
+    for (u32 id = 0; id < _passes.size(); ++id) {
+        RenderPassDesc const& desc = _passes[id].desc;
+        if (desc.output != BACKBUFFER) {
+            Target& output = _targets[desc.output];
+            output.first_pass = std::min(output.first_pass, id);
+            output.last_pass = std::max(output.last_pass, id);
+        }
+        for (RenderTargetId input : desc.inputs) {
+            _targets[input].first_pass = std::min(_targets[input].first_pass, id);
+            _targets[input].last_pass = std::max(_targets[input].last_pass, id);
+        }
+    }
+
+    std::vector<u32> order(_targets.size());
+    for (u32 i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](u32 a, u32 b) { return _targets[a].first_pass < _targets[b].first_pass; });
+
+    for (u32 index : order) {
+        Target& target = _targets[index];
+        i32 width = scaled(_width, get_target_scale(target));
+        i32 height = scaled(_height, get_target_scale(target));
+
+        auto free = std::find_if(_textures.begin(), _textures.end(), [&](Texture const& texture) {
+            return texture.width == width && texture.height == height && texture.format == target.desc.format &&
+                   texture.last_pass < target.first_pass;
+        });
+
+        if (free != _textures.end()) {
+            free->last_pass = target.last_pass;
+            target.texture = static_cast<u32>(free - _textures.begin());
+            continue;
+        }
+
+        Texture texture{width, height, target.desc.format, target.last_pass, {}, {}};
+        texture.texture = _resources->create_texture_2d(width, height, target.desc.format, GlMemoryCategory::RenderTarget);
+
+        // Pooled textures keep their parameters, so they are set every time.
+        GLint previous;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+        glBindTexture(GL_TEXTURE_2D, _resources->get(texture.texture));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, previous);
+
+        // A pooled texture comes with the framebuffer it was attached to before.
+        texture.framebuffer = _resources->create_framebuffer(_resources->get(texture.texture));
+
+        target.texture = static_cast<u32>(_textures.size());
+        _textures.push_back(texture);
+    }
+
+    _allocated = true;
+}
+
+// The textures and their framebuffers go back to the pool in GlResources once the GPU is done with them.
+void PostChain::release() {
+    for (Texture& texture : _textures) {
+        _resources->destroy(texture.framebuffer);
+        _resources->destroy(texture.texture);
+    }
+    _textures.clear();
+}
+
+void PostChain::read_timer(FrameTimer& timer) {
+    if (!timer.pending) {
+        return;
+    }
+
+    GLuint64 available = 0;
+    glGetQueryObjectui64v(timer.queries.back(), GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return;
+    }
+
+    GLuint64 first = 0;
+    glGetQueryObjectui64v(timer.queries[0], GL_QUERY_RESULT, &first);
+
+    GLuint64 previous = first;
+    for (std::size_t i = 0; i < _passes.size(); ++i) {
+        GLuint64 time = 0;
+        glGetQueryObjectui64v(timer.queries[i + 1], GL_QUERY_RESULT, &time);
+        _passes[i].gpu_ms = time >= previous ? static_cast<f64>(time - previous) / 1e6 : 0.0;
+        previous = time;
+    }
+
+    _gpu_ms = previous >= first ? static_cast<f64>(previous - first) / 1e6 : 0.0;
+    _timed_frame = timer.frame;
+    timer.pending = false;
+}
+
+u64 PostChain::get_target_bytes(Target const& target) const {
+    f32 scale = get_target_scale(target);
+    return GlResources::get_texture_size(scaled(_width, scale), scaled(_height, scale), target.desc.format);
+}
+
+f32 PostChain::get_target_scale(Target const& target) const {
+    return target.desc.dynamic ? target.desc.scale * _render_scale : target.desc.scale;
+}
+
+i32 PostChain::scaled(i32 size, f32 scale) {
+    return std::max(1, static_cast<i32>(std::lround(static_cast<f32>(size) * scale)));
+}
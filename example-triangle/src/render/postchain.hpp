@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <math/vector.hpp>
+#include <render/glresources.hpp>
+#include <shaders/shader.hpp>
+#include <shaders/shaderprogram.hpp>
+#include <util/base.hpp>
+
+using RenderTargetId = u32;
+using RenderPassId = u32;
+
+// Stands for the default framebuffer as a pass output.
+constexpr RenderTargetId BACKBUFFER = 0xFFFFFFFF;
+
+// A transient color attachment, sized relative to the backbuffer. Dynamic ones follow the render scale as well.
+struct RenderTargetDesc {
+    std::string name;
+    GLenum format;
+    f32 scale;
+    bool dynamic;
+};
+
+/*
+ * A pass writes its output from its inputs. Passes with a fragment shader draw it over the
+ * whole output with the inputs bound as our_input0, our_input1... and params as our_params.
+ * Passes without one are drawn by the caller, see PostChain::execute().
+ */
+struct RenderPassDesc {
+    std::string name;
+    std::vector<RenderTargetId> inputs;
+    RenderTargetId output;
+    std::string fragment_source;
+    vec4 params;
+    bool clear;
+};
+
+struct PostChainStats {
+    u32 targets;
+    u32 textures;
+    u64 target_bytes;  // if every target had its own texture
+    u64 texture_bytes; // what is actually allocated
+};
+
+/*
+ * Runs a fixed chain of passes, e.g. scene, bloom threshold, blur, tonemap to the backbuffer.
+ *
+ * The chain is declared up front. From the order of the passes the chain knows when each
+ * target is first written and last read, and targets of the same size and format whose
+ * lifetimes don't overlap share one texture. The textures come from GlResources, which pools
+ * them by size and format and their framebuffers by attachment, so both are only really
+ * allocated once and reused across frames and resizes back to an earlier size.
+ *
+ * resize() and set_render_scale() only remember the new size, the textures are replaced by the
+ * next execute(). Every pass is timed with timestamp queries, read back a few frames later
+ * without waiting.
+ */
+class PostChain {
+public:
+    PostChain();
+    ~PostChain();
+
+    PostChain(PostChain const&) = delete;
+    PostChain& operator=(PostChain const&) = delete;
+
+public:
+    // Needs a current context, the GL objects come from resources.
+    void init(GlResources& resources);
+
+    // Declaring targets and passes after the first execute() is not supported.
+    NODISCARD RenderTargetId add_target(RenderTargetDesc const& desc);
+    RenderPassId add_pass(RenderPassDesc const& desc);
+    NODISCARD RenderPassDesc& get_pass(RenderPassId id);
+
+    void resize(i32 width, i32 height);
+    // Scales the dynamic targets, for rendering at a lower resolution than the window.
+    void set_render_scale(f32 scale);
+
+    // Runs the passes in order, calling draw for the ones without a fragment shader with their output bound.
+    void execute(std::function<void(RenderPassId)> const& draw);
+
+public:
+    NODISCARD PostChainStats get_stats() const;
+    NODISCARD f32 get_render_scale() const;
+    // GPU time of every pass and of all of them, from the last frame whose timer queries were done.
+    NODISCARD f64 get_pass_ms(RenderPassId id) const;
+    NODISCARD f64 get_gpu_ms() const;
+    // Frames executed so far, and which one the GPU times are from.
+    NODISCARD u64 get_frame() const;
+    NODISCARD u64 get_timed_frame() const;
+    NODISCARD std::string format_summary() const;
+
+private:
+    struct Target {
+        RenderTargetDesc desc;
+        u32 first_pass;
+        u32 last_pass;
+        u32 texture; // index into _textures
+    };
+
+    struct Pass {
+        RenderPassDesc desc;
+        std::unique_ptr<Shader> fragment_shader;
+        std::unique_ptr<ShaderProgram> program;
+        std::vector<GLint> input_locations;
+        GLint params_location;
+        f64 gpu_ms;
+    };
+
+    struct Texture {
+        i32 width;
+        i32 height;
+        GLenum format;
+        u32 last_pass;
+        TextureHandle texture;
+        FramebufferHandle framebuffer;
+    };
+
+    static constexpr std::size_t TIMER_FRAMES = 4;
+
+    // Timestamps before the first pass and after every pass of one frame.
+    struct FrameTimer {
+        std::vector<GLuint> queries;
+        u64 frame;
+        bool pending;
+    };
+
+    void allocate();
+    void release();
+    void read_timer(FrameTimer& timer);
+
+    NODISCARD u64 get_target_bytes(Target const& target) const;
+    NODISCARD f32 get_target_scale(Target const& target) const;
+    NODISCARD static i32 scaled(i32 size, f32 scale);
+
+private:
+    Shader _vertex_shader;
+
+    GlResources* _resources;
+    VertexArrayHandle _vao;
+
+    std::vector<Target> _targets;
+    std::vector<Pass> _passes;
+    std::vector<Texture> _textures;
+
+    i32 _width;
+    i32 _height;
+    f32 _render_scale;
+    bool _allocated;
+
+    std::array<FrameTimer, TIMER_FRAMES> _timers;
+    std::size_t _next_timer;
+    u64 _frame;
+    u64 _timed_frame;
+    f64 _gpu_ms;
+};
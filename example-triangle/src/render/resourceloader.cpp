@@ -0,0 +1,264 @@
+#include "resourceloader.hpp"
+
+#include <cstdio>
+#include <utility>
+
+#include <GLFW/glfw3.h>
+
+#include <capture/glcapture.hpp>
+#include <shaders/shader.hpp>
+#include <shaders/shaderprogram.hpp>
+
+namespace {
+    f64 milliseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<f64, std::milli>(duration).count();
+    }
+}
+
+ResourceLoader::ResourceLoader() :
+    _window{nullptr},
+    _thread{},
+    _running{false},
+    _mutex{},
+    _wake{},
+    _requests{},
+    _finished{},
+    _pending{},
+    _next_id{0},
+    _requested{0},
+    _loaded{0},
+    _failed{0},
+    _total_load_ms{0.0},
+    _total_wait_ms{0.0} {
+
+}
+
+ResourceLoader::~ResourceLoader() {
+    stop();
+}
+
+bool ResourceLoader::start(GLFWwindow* window) {
+    if (_thread.joinable() || gl_capture::is_active()) {
+        return _thread.joinable();
+    }
+
+    // The context hints of the main window are still set, only the visibility changes.
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    _window = glfwCreateWindow(1, 1, "Loader", nullptr, window);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if (!_window) {
+        return false;
+    }
+
+    _running = true;
+    _thread = std::thread{&ResourceLoader::run, this};
+    return true;
+}
+
+void ResourceLoader::stop() {
+    if (_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _running = false;
+        }
+        _wake.notify_one();
+        _thread.join();
+
+        glfwDestroyWindow(_window);
+        _window = nullptr;
+    }
+
+    _pending.insert(_pending.end(), _finished.begin(), _finished.end());
+    _finished.clear();
+    _requests.clear();
+
+    // The objects are shared, they can be deleted from this context as well.
+    for (Finished& finished : _pending) {
+        if (finished.fence) {
+            glDeleteSync(finished.fence);
+        }
+
+        GLuint id = finished.resource.gl_id;
+        switch (finished.resource.type) {
+            case LoadType::Buffer:
+                glDeleteBuffers(1, &id);
+                break;
+            case LoadType::Texture:
+                glDeleteTextures(1, &id);
+                break;
+            case LoadType::Program:
+                glDeleteProgram(id);
+                break;
+        }
+    }
+    _pending.clear();
+}
+
+LoadId ResourceLoader::load_buffer(std::string name, GLenum usage, std::function<std::vector<u8>()> produce) {
+    return enqueue(LoadType::Buffer, std::move(name), [usage, produce = std::move(produce)](LoadedResource& resource) {
+        std::vector<u8> data = produce();
+
+        glGenBuffers(1, &resource.gl_id);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, resource.gl_id);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(data.size()), data.data(), usage);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        resource.size = data.size();
+        resource.ok = true;
+    });
+}
+
+LoadId ResourceLoader::load_texture(std::string name, i32 width, i32 height, GLenum internal_format, GLenum format, GLenum type,
+                                    std::function<std::vector<u8>()> produce) {
+    return enqueue(LoadType::Texture, std::move(name), [=, produce = std::move(produce)](LoadedResource& resource) {
+        std::vector<u8> data = produce();
+
+        // Restored for loads running on the render thread.
+        GLint previous;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+
+        glGenTextures(1, &resource.gl_id);
+        glBindTexture(GL_TEXTURE_2D, resource.gl_id);
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internal_format), width, height, 0, format, type, data.empty() ? nullptr : data.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previous));
+
+        resource.width = width;
+        resource.height = height;
+        resource.internal_format = internal_format;
+        resource.ok = true;
+    });
+}
+
+LoadId ResourceLoader::load_program(std::string name, std::string vertex_source, std::string fragment_source) {
+    return enqueue(LoadType::Program, name, [name, vertex_source = std::move(vertex_source), fragment_source = std::move(fragment_source)](LoadedResource& resource) {
+        Shader vertex_shader{ShaderType::VertexShader, vertex_source, name + "_vertex_shader"};
+        Shader fragment_shader{ShaderType::FragmentShader, fragment_source, name + "_fragment_shader"};
+        vertex_shader.init();
+        fragment_shader.init();
+
+        // Waiting for the compiler here is what the thread is for.
+        ShaderProgram program{name};
+        program.link(vertex_shader.get_id(), fragment_shader.get_id());
+        resource.ok = program.check_status();
+        resource.gl_id = resource.ok ? program.release() : 0;
+    });
+}
+
+std::vector<LoadedResource> ResourceLoader::poll() {
+    if (!_thread.joinable()) {
+        std::unique_lock<std::mutex> lock{_mutex};
+        if (!_requests.empty()) {
+            Request request = std::move(_requests.front());
+            _requests.pop_front();
+            lock.unlock();
+
+            _pending.push_back(execute(request));
+        }
+    } else {
+        // Like ShaderWatcher::poll_changes(), rather pick the loads up next frame than wait for the loader thread.
+        std::unique_lock<std::mutex> lock{_mutex, std::try_to_lock};
+        if (lock.owns_lock()) {
+            _pending.insert(_pending.end(), std::make_move_iterator(_finished.begin()), std::make_move_iterator(_finished.end()));
+            _finished.clear();
+        }
+    }
+
+    std::vector<LoadedResource> loaded;
+    Clock::time_point now = Clock::now();
+
+    for (std::size_t i = 0; i < _pending.size();) {
+        Finished& finished = _pending[i];
+
+        if (finished.fence) {
+            GLenum status = glClientWaitSync(finished.fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                ++i;
+                continue;
+            }
+            glDeleteSync(finished.fence);
+        }
+
+        finished.resource.wait_ms = milliseconds(now - finished.requested_at);
+        ++_loaded;
+        _failed += finished.resource.ok ? 0 : 1;
+        _total_load_ms += finished.resource.load_ms;
+        _total_wait_ms += finished.resource.wait_ms;
+        loaded.push_back(std::move(finished.resource));
+
+        _pending.erase(_pending.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    return loaded;
+}
+
+bool ResourceLoader::is_threaded() const {
+    return _thread.joinable();
+}
+
+u32 ResourceLoader::get_queued_count() const {
+    return _requested - _loaded;
+}
+
+std::string ResourceLoader::format_summary() const {
+    char line[160];
+    std::snprintf(line, sizeof(line), "Loader: on the %s thread, %u queued, %u loaded (%u failed), %.2f ms to load, %.1f ms until handed over",
+                  is_threaded() ? "loader" : "render", get_queued_count(), _loaded, _failed,
+                  _loaded ? _total_load_ms / _loaded : 0.0, _loaded ? _total_wait_ms / _loaded : 0.0);
+    return line;
+}
+
+LoadId ResourceLoader::enqueue(LoadType type, std::string name, std::function<void(LoadedResource&)> load) {
+    LoadedResource resource{};
+    resource.id = _next_id++;
+    resource.type = type;
+    resource.name = std::move(name);
+
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _requests.push_back({std::move(resource), std::move(load), Clock::now()});
+    }
+    _wake.notify_one();
+
+    ++_requested;
+    return _next_id - 1;
+}
+
+ResourceLoader::Finished ResourceLoader::execute(Request& request) {
+    Clock::time_point start = Clock::now();
+    request.load(request.resource);
+    request.resource.load_ms = milliseconds(Clock::now() - start);
+
+    return {std::move(request.resource), request.requested_at, nullptr};
+}
+
+void ResourceLoader::run() {
+    glfwMakeContextCurrent(_window);
+
+    std::unique_lock<std::mutex> lock{_mutex};
+    while (true) {
+        _wake.wait(lock, [this] { return !_running || !_requests.empty(); });
+        if (!_running) {
+            break;
+        }
+
+        Request request = std::move(_requests.front());
+        _requests.pop_front();
+        lock.unlock();
+
+        Finished finished = execute(request);
+
+        // The flush makes sure the fence gets to the GPU, nobody else submits this context's commands.
+        finished.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        lock.lock();
+        _finished.push_back(std::move(finished));
+    }
+    lock.unlock();
+
+    glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <util/base.hpp>
+
+struct GLFWwindow;
+
+using LoadId = u32;
+
+enum class LoadType : u8 {
+    Buffer,
+    Texture,
+    Program,
+};
+
+// What a load created. The GL object belongs to the receiver, see GlResources::adopt_buffer() and friends.
+struct LoadedResource {
+    LoadId id;
+    LoadType type;
+    std::string name;
+    bool ok;
+    GLuint gl_id; // 0 if the load failed
+    std::size_t size; // buffers
+    i32 width, height; // textures
+    GLenum internal_format;
+    f64 load_ms; // spent loading, on whichever thread did it
+    f64 wait_ms; // from the request until it was handed over
+};
+
+/*
+ * Creates buffers and textures and compiles programs on a background thread, so big uploads
+ * and slow shader compilers don't hold up frames.
+ *
+ * The thread gets a context of its own in a hidden window sharing objects with the main
+ * window's. After every load it fences its commands, and poll() only hands a load over once
+ * its fence has signaled, so the render thread never sees half uploaded data. Vertex arrays
+ * and framebuffers are not shared between contexts, the render thread has to create those.
+ *
+ * Without a shared context, or while a capture is running (it only records the render thread),
+ * poll() runs the loads itself instead, one per call.
+ */
+class ResourceLoader {
+public:
+    ResourceLoader();
+    ~ResourceLoader();
+
+    ResourceLoader(ResourceLoader const&) = delete;
+    ResourceLoader& operator=(ResourceLoader const&) = delete;
+
+public:
+    // On the main thread, with the window's context current. Returns whether the loads run on a thread of their own.
+    bool start(GLFWwindow* window);
+    // Needs the window's context current, what was loaded but not handed over yet is deleted.
+    void stop();
+
+    // The data is produced on the loading thread as well. Texture rows are 4 byte aligned.
+    LoadId load_buffer(std::string name, GLenum usage, std::function<std::vector<u8>()> produce);
+    LoadId load_texture(std::string name, i32 width, i32 height, GLenum internal_format, GLenum format, GLenum type,
+                        std::function<std::vector<u8>()> produce);
+    LoadId load_program(std::string name, std::string vertex_source, std::string fragment_source);
+
+    // Call every frame on the render thread. Returns the finished loads, never waits for one.
+    NODISCARD std::vector<LoadedResource> poll();
+
+public:
+    NODISCARD bool is_threaded() const;
+    NODISCARD u32 get_queued_count() const;
+    NODISCARD std::string format_summary() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        LoadedResource resource;
+        std::function<void(LoadedResource&)> load;
+        Clock::time_point requested_at;
+    };
+
+    struct Finished {
+        LoadedResource resource;
+        Clock::time_point requested_at;
+        GLsync fence; // null when loaded on the render thread
+    };
+
+    LoadId enqueue(LoadType type, std::string name, std::function<void(LoadedResource&)> load);
+    NODISCARD static Finished execute(Request& request);
+    void run();
+
+private:
+    GLFWwindow* _window;
+    std::thread _thread;
+    bool _running;
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::deque<Request> _requests;
+    std::vector<Finished> _finished; // by the loader thread, not picked up yet
+
+    std::vector<Finished> _pending; // picked up, waiting for their fences
+    LoadId _next_id;
+    u32 _requested;
+    u32 _loaded;
+    u32 _failed;
+    f64 _total_load_ms;
+    f64 _total_wait_ms;
+};
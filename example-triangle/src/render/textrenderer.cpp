@@ -0,0 +1,160 @@
+#include "textrenderer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <shaders/defaultshaders.hpp>
+
+TextRenderer::TextRenderer() :
+    _atlas{},
+    _vertex_shader{ShaderType::VertexShader, ASSET_SOURCE(DEFAULT_VERTEX_SHADER), "text_vertex_shader"},
+    _fragment_shader{ShaderType::FragmentShader, ASSET_SOURCE(TEXT_FRAGMENT_SHADER), "text_fragment_shader"},
+    _program{"text_shader_program"},
+    _proj_location{-1},
+    _model_location{-1},
+    _tex_location{-1},
+    _resources{nullptr},
+    _budget{nullptr},
+    _atlas_residency{0},
+    _texture{},
+    _vao{},
+    _vbo{},
+    _ebo{},
+    _index_capacity{0} {
+
+}
+
+TextRenderer::~TextRenderer() {
+    if (_budget) {
+        _budget->remove(_atlas_residency);
+    }
+
+    if (_resources) {
+        _resources->destroy(_texture);
+        _resources->destroy(_vbo);
+        _resources->destroy(_ebo);
+        _resources->destroy(_vao);
+    }
+}
+
+void TextRenderer::init(GlResources& resources, GpuMemoryBudget& budget) {
+    _resources = &resources;
+    _budget = &budget;
+    _atlas.build();
+
+    _vertex_shader.init();
+    _fragment_shader.init();
+    _program.init(_vertex_shader.get_id(), _fragment_shader.get_id());
+
+    _proj_location = glGetUniformLocation(_program.get_id(), "our_proj");
+    _model_location = glGetUniformLocation(_program.get_id(), "our_model");
+    _tex_location = glGetUniformLocation(_program.get_id(), "our_tex");
+
+    upload_atlas();
+
+    // The pixels stay on the CPU, so the texture can always be uploaded again.
+    u64 atlas_bytes = static_cast<u64>(_atlas.get_width()) * _atlas.get_height();
+    _atlas_residency = budget.add(GlMemoryCategory::Texture, atlas_bytes,
+        [this] { _resources->destroy(_texture); },
+        [this] { upload_atlas(); });
+
+    // The caller's vertex array stays bound, element buffer bindings made afterwards belong to it.
+    GLint previous_vao;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous_vao);
+
+    _vao = resources.create_vertex_array();
+    glBindVertexArray(resources.get(_vao));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(static_cast<GLuint>(previous_vao));
+}
+
+void TextRenderer::draw(TextBatch const& batch, mat4 const& projection) {
+    u32 glyph_count = batch.get_glyph_count();
+    if (glyph_count == 0) {
+        return;
+    }
+
+    std::vector<Vertex> const& vertices = batch.get_vertices();
+    mat4 model = mat4::identity();
+
+    _program.use();
+    glUniformMatrix4fv(_proj_location, 1, GL_FALSE, projection.data());
+    glUniformMatrix4fv(_model_location, 1, GL_FALSE, model.data());
+    glUniform1i(_tex_location, 0);
+
+    _budget->use(_atlas_residency);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _resources->get(_texture));
+    glBindVertexArray(_resources->get(_vao));
+
+    std::size_t size = vertices.size() * sizeof(Vertex);
+    reserve_vertices(size);
+
+    // Orphan the previous frame's storage so the driver does not wait for the GPU to finish with it.
+    glBindBuffer(GL_ARRAY_BUFFER, _resources->get(_vbo));
+    glBufferData(GL_ARRAY_BUFFER, _resources->get_buffer_size(_vbo), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices.data());
+
+    reserve_indices(glyph_count);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDrawElements(GL_TRIANGLES, glyph_count * 6, GL_UNSIGNED_INT, nullptr);
+    glDisable(GL_BLEND);
+}
+
+SdfAtlas const& TextRenderer::get_atlas() const {
+    return _atlas;
+}
+
+void TextRenderer::upload_atlas() {
+    _texture = _resources->create_texture_2d(_atlas.get_width(), _atlas.get_height(), GL_R8);
+    glBindTexture(GL_TEXTURE_2D, _resources->get(_texture));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _atlas.get_width(), _atlas.get_height(), GL_RED, GL_UNSIGNED_BYTE, _atlas.get_pixels().data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Expects the vertex array to be bound, the attributes have to point into the new buffer.
+void TextRenderer::reserve_vertices(std::size_t size) {
+    if (size <= _resources->get_buffer_size(_vbo)) {
+        return;
+    }
+
+    // The old buffer may still be in use by frames in flight, GlResources only frees it after them.
+    _resources->destroy(_vbo);
+    _vbo = _resources->create_buffer(size, GL_STREAM_DRAW, nullptr, GlMemoryCategory::Dynamic);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _resources->get(_vbo));
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+}
+
+void TextRenderer::reserve_indices(u32 glyph_count) {
+    if (glyph_count <= _index_capacity) {
+        return;
+    }
+
+    _index_capacity = std::max(glyph_count, _index_capacity * 2);
+
+    std::vector<u32> indices;
+    indices.reserve(_index_capacity * 6);
+    for (u32 i = 0; i < _index_capacity; ++i) {
+        u32 base = i * 4;
+        indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    }
+
+    // The element buffer binding is part of the vertex array, which draw() has bound.
+    _resources->destroy(_ebo);
+    _ebo = _resources->create_buffer(indices.size() * sizeof(u32), GL_STATIC_DRAW, indices.data());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _resources->get(_ebo));
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <math/matrix.hpp>
+#include <render/glresources.hpp>
+#include <render/gpumemorybudget.hpp>
+#include <shaders/shader.hpp>
+#include <shaders/shaderprogram.hpp>
+#include <text/sdfatlas.hpp>
+#include <text/textbatch.hpp>
+#include <util/base.hpp>
+
+/*
+ * Draws a TextBatch with one indexed draw call, sampling the SDF atlas. The vertex stream is
+ * re-specified every frame, the vertex and index buffers are only replaced when a batch has
+ * more glyphs than fit. The atlas texture is registered with the memory budget, which may
+ * evict it while no text is drawn.
+ */
+class TextRenderer {
+public:
+    TextRenderer();
+    ~TextRenderer();
+
+    TextRenderer(TextRenderer const&) = delete;
+    TextRenderer& operator=(TextRenderer const&) = delete;
+
+public:
+    // Builds the atlas on the job system and uploads it. Needs a current context, the GL objects come from resources.
+    void init(GlResources& resources, GpuMemoryBudget& budget);
+
+    // Blends the text over the framebuffer. Leaves its own program and vertex array bound.
+    void draw(TextBatch const& batch, mat4 const& projection);
+
+public:
+    NODISCARD SdfAtlas const& get_atlas() const;
+
+private:
+    void upload_atlas();
+    void reserve_vertices(std::size_t size);
+    void reserve_indices(u32 glyph_count);
+
+private:
+    SdfAtlas _atlas;
+
+    Shader _vertex_shader;
+    Shader _fragment_shader;
+    ShaderProgram _program;
+    GLint _proj_location;
+    GLint _model_location;
+    GLint _tex_location;
+
+    GlResources* _resources;
+    GpuMemoryBudget* _budget;
+    ResidencyId _atlas_residency;
+    TextureHandle _texture;
+    VertexArrayHandle _vao;
+    BufferHandle _vbo;
+    BufferHandle _ebo;
+    u32 _index_capacity;
+};
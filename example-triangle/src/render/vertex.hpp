@@ -0,0 +1,14 @@
+#pragma once
+
+#include <util/base.hpp>
+
+/* Standard representation of a vertex, matching the attribute layout of the default shaders. */
+struct Vertex {
+    f32 pos_x, pos_y; // X- and Y-Position
+    f32 u, v;         // Texture coords
+    u8 r, g, b, a;    // Color in RGBA
+};
+
+struct Rgba8 {
+    u8 r, g, b, a;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <math/math.hpp>
+#include <util/base.hpp>
+
+struct Aabb {
+    vec3 min;
+    vec3 max;
+
+    NODISCARD constexpr vec3 center() const { return (min + max) * 0.5f; }
+    NODISCARD constexpr vec3 extent() const { return (max - min) * 0.5f; }
+};
+
+// Bounds of box after transforming it by m (Arvo's method), tight for affine transforms.
+constexpr Aabb transform(Aabb const& box, mat4 const& m) {
+    vec3 center = m.cols[3].xyz();
+    vec3 extent{};
+
+    vec3 box_center = box.center();
+    vec3 box_extent = box.extent();
+    f32 const c[3] = {box_center.x, box_center.y, box_center.z};
+    f32 const e[3] = {box_extent.x, box_extent.y, box_extent.z};
+
+    for (int i = 0; i < 3; ++i) {
+        vec3 axis = m.cols[i].xyz();
+        center = center + axis * c[i];
+        vec3 abs_axis{axis.x < 0.0f ? -axis.x : axis.x, axis.y < 0.0f ? -axis.y : axis.y, axis.z < 0.0f ? -axis.z : axis.z};
+        extent = extent + abs_axis * e[i];
+    }
+
+    return {center - extent, center + extent};
+}
+
+enum class Containment {
+    Outside,
+    Intersecting,
+    Inside,
+};
+
+/*
+ * Six planes (normal in xyz, distance in w) pointing into the view volume, extracted from
+ * a view-projection matrix as described by Gribb and Hartmann. The planes are not
+ * normalized, which is fine for the sign tests done during culling.
+ */
+struct Frustum {
+    vec4 planes[6];
+
+    NODISCARD static constexpr Frustum from_matrix(mat4 const& m) {
+        vec4 r0{m.cols[0].x, m.cols[1].x, m.cols[2].x, m.cols[3].x};
+        vec4 r1{m.cols[0].y, m.cols[1].y, m.cols[2].y, m.cols[3].y};
+        vec4 r2{m.cols[0].z, m.cols[1].z, m.cols[2].z, m.cols[3].z};
+        vec4 r3{m.cols[0].w, m.cols[1].w, m.cols[2].w, m.cols[3].w};
+
+        return {{r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2}};
+    }
+
+    NODISCARD constexpr Containment classify(Aabb const& box) const {
+        Containment result = Containment::Inside;
+
+        for (auto const& p : planes) {
+            // Corner furthest along the plane normal, and the one opposite to it.
+            vec3 far_corner{p.x > 0.0f ? box.max.x : box.min.x, p.y > 0.0f ? box.max.y : box.min.y, p.z > 0.0f ? box.max.z : box.min.z};
+            vec3 near_corner{p.x > 0.0f ? box.min.x : box.max.x, p.y > 0.0f ? box.min.y : box.max.y, p.z > 0.0f ? box.min.z : box.max.z};
+
+            if (dot(p.xyz(), far_corner) + p.w < 0.0f) {
+                return Containment::Outside;
+            }
+            if (dot(p.xyz(), near_corner) + p.w < 0.0f) {
+                result = Containment::Intersecting;
+            }
+        }
+
+        return result;
+    }
+};
@@ -0,0 +1,260 @@
+#include "cullinggrid.hpp"
+
+#include <chrono>
+#include <cmath>
+
+#include <jobs/jobsystem.hpp>
+#include <math/simd.hpp>
+
+namespace {
+    constexpr u32 OVERSIZED_CELL = 0;
+
+    u64 pack_cell_key(i32 x, i32 y, i32 z) {
+        auto pack = [](i32 v) { return static_cast<u64>(static_cast<u32>(v) & 0x1FFFFFu); };
+        return pack(x) | (pack(y) << 21) | (pack(z) << 42);
+    }
+
+    // Appends the ids of all boxes that are not completely behind one of the frustum planes.
+    template<typename Cell>
+    void cull_cell(Frustum const& frustum, Cell const& cell, std::vector<CullId>& out) {
+        std::size_t count = cell.ids.size();
+        std::size_t i = 0;
+
+        // Per plane, pick the arrays holding the corner furthest along its normal.
+        f32 const* far_x[6];
+        f32 const* far_y[6];
+        f32 const* far_z[6];
+        for (int p = 0; p < 6; ++p) {
+            vec4 const& plane = frustum.planes[p];
+            far_x[p] = plane.x > 0.0f ? cell.max_x.data() : cell.min_x.data();
+            far_y[p] = plane.y > 0.0f ? cell.max_y.data() : cell.min_y.data();
+            far_z[p] = plane.z > 0.0f ? cell.max_z.data() : cell.min_z.data();
+        }
+
+#if defined(MATH_USE_AVX)
+        for (; i + 8 <= count; i += 8) {
+            __m256 outside = _mm256_setzero_ps();
+
+            for (int p = 0; p < 6; ++p) {
+                vec4 const& plane = frustum.planes[p];
+                __m256 distance = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), _mm256_loadu_ps(far_x[p] + i)),
+                                  _mm256_mul_ps(_mm256_set1_ps(plane.y), _mm256_loadu_ps(far_y[p] + i))),
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), _mm256_loadu_ps(far_z[p] + i)),
+                                  _mm256_set1_ps(plane.w)));
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+            }
+
+            u32 mask = ~static_cast<u32>(_mm256_movemask_ps(outside)) & 0xFFu;
+            while (mask) {
+                out.push_back(cell.ids[i + __builtin_ctz(mask)]);
+                mask &= mask - 1;
+            }
+        }
+#endif
+
+#if defined(MATH_USE_SSE)
+        for (; i + 4 <= count; i += 4) {
+            __m128 outside = _mm_setzero_ps();
+
+            for (int p = 0; p < 6; ++p) {
+                vec4 const& plane = frustum.planes[p];
+                __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), _mm_loadu_ps(far_x[p] + i)),
+                               _mm_mul_ps(_mm_set1_ps(plane.y), _mm_loadu_ps(far_y[p] + i))),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), _mm_loadu_ps(far_z[p] + i)),
+                               _mm_set1_ps(plane.w)));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+            }
+
+            u32 mask = ~static_cast<u32>(_mm_movemask_ps(outside)) & 0xFu;
+            while (mask) {
+                out.push_back(cell.ids[i + __builtin_ctz(mask)]);
+                mask &= mask - 1;
+            }
+        }
+#endif
+
+        for (; i < count; ++i) {
+            bool outside = false;
+            for (int p = 0; p < 6 && !outside; ++p) {
+                vec4 const& plane = frustum.planes[p];
+                outside = plane.x * far_x[p][i] + plane.y * far_y[p][i] + plane.z * far_z[p][i] + plane.w < 0.0f;
+            }
+
+            if (!outside) {
+                out.push_back(cell.ids[i]);
+            }
+        }
+    }
+}
+
+CullingGrid::CullingGrid(f32 cell_size) : _cell_size{cell_size}, _cells(1), _size{0}, _stats{} { }
+
+CullId CullingGrid::insert(Aabb const& bounds) {
+    CullId id;
+    if (!_free_ids.empty()) {
+        id = _free_ids.back();
+        _free_ids.pop_back();
+    } else {
+        id = static_cast<CullId>(_locations.size());
+        _locations.emplace_back();
+    }
+
+    add_to_cell(id, find_cell(bounds), bounds);
+    ++_size;
+
+    return id;
+}
+
+void CullingGrid::update(CullId id, Aabb const& bounds) {
+    u32 cell_index = find_cell(bounds);
+    Location location = _locations[id];
+
+    if (location.cell != cell_index) {
+        remove_from_cell(id);
+        add_to_cell(id, cell_index, bounds);
+        return;
+    }
+
+    // Still in the same cell, the slot can be overwritten in place.
+    Cell& cell = _cells[cell_index];
+    cell.min_x[location.slot] = bounds.min.x;
+    cell.min_y[location.slot] = bounds.min.y;
+    cell.min_z[location.slot] = bounds.min.z;
+    cell.max_x[location.slot] = bounds.max.x;
+    cell.max_y[location.slot] = bounds.max.y;
+    cell.max_z[location.slot] = bounds.max.z;
+}
+
+void CullingGrid::remove(CullId id) {
+    remove_from_cell(id);
+    _free_ids.push_back(id);
+    --_size;
+}
+
+void CullingGrid::cull(Frustum const& frustum, std::vector<CullId>& visible) {
+    auto start = std::chrono::steady_clock::now();
+
+    visible.clear();
+    _partial_cells.clear();
+    _stats = {};
+
+    for (u32 c = 0; c < _cells.size(); ++c) {
+        Cell const& cell = _cells[c];
+        if (cell.ids.empty()) {
+            continue;
+        }
+
+        ++_stats.cells_tested;
+
+        Containment containment = c == OVERSIZED_CELL ? Containment::Intersecting : frustum.classify(cell.loose_bounds);
+        switch (containment) {
+            case Containment::Outside:
+                break;
+            case Containment::Inside:
+                ++_stats.cells_visible;
+                visible.insert(visible.end(), cell.ids.begin(), cell.ids.end());
+                break;
+            case Containment::Intersecting:
+                ++_stats.cells_visible;
+                _partial_cells.push_back(c);
+                break;
+        }
+    }
+
+    if (_partial_results.size() < _partial_cells.size()) {
+        _partial_results.resize(_partial_cells.size());
+    }
+
+    JobSystem::get_global().parallel_for(_partial_cells.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+            _partial_results[k].clear();
+            cull_cell(frustum, _cells[_partial_cells[k]], _partial_results[k]);
+        }
+    });
+
+    for (std::size_t k = 0; k < _partial_cells.size(); ++k) {
+        visible.insert(visible.end(), _partial_results[k].begin(), _partial_results[k].end());
+    }
+
+    _stats.visible = static_cast<u32>(visible.size());
+    _stats.culled = static_cast<u32>(_size - visible.size());
+    _stats.cull_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::size_t CullingGrid::get_size() const {
+    return _size;
+}
+
+CullStats const& CullingGrid::get_stats() const {
+    return _stats;
+}
+
+u32 CullingGrid::find_cell(Aabb const& bounds) {
+    vec3 extent = bounds.extent();
+    f32 max_extent = _cell_size * 0.5f;
+
+    if (extent.x > max_extent || extent.y > max_extent || extent.z > max_extent) {
+        return OVERSIZED_CELL;
+    }
+
+    vec3 center = bounds.center();
+    auto x = static_cast<i32>(std::floor(center.x / _cell_size));
+    auto y = static_cast<i32>(std::floor(center.y / _cell_size));
+    auto z = static_cast<i32>(std::floor(center.z / _cell_size));
+
+    auto [it, inserted] = _cell_lookup.try_emplace(pack_cell_key(x, y, z), static_cast<u32>(_cells.size()));
+    if (inserted) {
+        Cell cell{};
+        cell.x = x;
+        cell.y = y;
+        cell.z = z;
+
+        // Grown by half a cell on every side, which holds any object centered in the cell that passed the size check.
+        vec3 origin{x * _cell_size, y * _cell_size, z * _cell_size};
+        cell.loose_bounds = {origin - vec3{max_extent}, origin + vec3{_cell_size + max_extent}};
+
+        _cells.push_back(std::move(cell));
+    }
+
+    return it->second;
+}
+
+void CullingGrid::add_to_cell(CullId id, u32 cell_index, Aabb const& bounds) {
+    Cell& cell = _cells[cell_index];
+
+    _locations[id] = {cell_index, static_cast<u32>(cell.ids.size())};
+
+    cell.min_x.push_back(bounds.min.x);
+    cell.min_y.push_back(bounds.min.y);
+    cell.min_z.push_back(bounds.min.z);
+    cell.max_x.push_back(bounds.max.x);
+    cell.max_y.push_back(bounds.max.y);
+    cell.max_z.push_back(bounds.max.z);
+    cell.ids.push_back(id);
+}
+
+void CullingGrid::remove_from_cell(CullId id) {
+    Location location = _locations[id];
+    Cell& cell = _cells[location.cell];
+
+    // Swap-remove, keeping the arrays dense.
+    auto swap_remove = [&](auto& values) {
+        values[location.slot] = values.back();
+        values.pop_back();
+    };
+
+    CullId moved = cell.ids.back();
+    swap_remove(cell.min_x);
+    swap_remove(cell.min_y);
+    swap_remove(cell.min_z);
+    swap_remove(cell.max_x);
+    swap_remove(cell.max_y);
+    swap_remove(cell.max_z);
+    swap_remove(cell.ids);
+
+    if (moved != id) {
+        _locations[moved].slot = location.slot;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <scene/bounds.hpp>
+#include <util/base.hpp>
+
+using CullId = u32;
+
+struct CullStats {
+    u32 visible;
+    u32 culled;
+    u32 cells_tested;
+    u32 cells_visible;
+    f64 cull_ms;
+};
+
+/*
+ * Loose uniform grid for view culling. Each object lives in the cell containing its center,
+ * and a cell's bounds are grown by half a cell so they enclose every object assigned to it.
+ * Objects larger than a cell are kept in a separate list that is always tested.
+ *
+ * Per cell, the bounds are stored as one array per component so that cull() can test 4 (SSE)
+ * or 8 (AVX) boxes against a plane per instruction. Cells that are fully inside the frustum
+ * are accepted without per-object tests, and partially visible cells are tested in parallel.
+ */
+class CullingGrid {
+public:
+    explicit CullingGrid(f32 cell_size);
+
+public:
+    CullId insert(Aabb const& bounds);
+    void update(CullId id, Aabb const& bounds);
+    void remove(CullId id);
+
+    // Replaces the contents of visible with the ids of all objects intersecting the frustum.
+    void cull(Frustum const& frustum, std::vector<CullId>& visible);
+
+public:
+    NODISCARD std::size_t get_size() const;
+    NODISCARD CullStats const& get_stats() const;
+
+private:
+    struct Cell {
+        i32 x, y, z;
+        Aabb loose_bounds;
+        std::vector<f32> min_x, min_y, min_z;
+        std::vector<f32> max_x, max_y, max_z;
+        std::vector<CullId> ids;
+    };
+
+    struct Location {
+        u32 cell;
+        u32 slot;
+    };
+
+private:
+    NODISCARD u32 find_cell(Aabb const& bounds);
+    void add_to_cell(CullId id, u32 cell, Aabb const& bounds);
+    void remove_from_cell(CullId id);
+
+private:
+    f32 _cell_size;
+
+    // Cell 0 holds the oversized objects.
+    std::vector<Cell> _cells;
+    std::unordered_map<u64, u32> _cell_lookup;
+
+    std::vector<Location> _locations;
+    std::vector<CullId> _free_ids;
+    std::size_t _size;
+
+    // Scratch buffers reused between frames.
+    std::vector<u32> _partial_cells;
+    std::vector<std::vector<CullId>> _partial_results;
+
+    CullStats _stats;
+};
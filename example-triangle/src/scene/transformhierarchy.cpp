@@ -0,0 +1,249 @@
+#include "transformhierarchy.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#include <jobs/jobsystem.hpp>
+
+namespace {
+    constexpr u32 NO_PARENT = ~0u;
+
+    template<typename T>
+    void permute(std::vector<T>& values, std::vector<u32> const& order) {
+        std::vector<T> sorted(values.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            sorted[i] = values[order[i]];
+        }
+        values.swap(sorted);
+    }
+}
+
+TransformId TransformHierarchy::create(TransformId parent) {
+    auto id = static_cast<TransformId>(_indices.size());
+    auto index = static_cast<u32>(_ids.size());
+
+    _translations.emplace_back();
+    _rotations.emplace_back();
+    _scales.emplace_back(1.0f);
+    _worlds.push_back(mat4::identity());
+    _parents.push_back(parent == INVALID_TRANSFORM ? NO_PARENT : _indices[parent]);
+    _subtree_sizes.push_back(1);
+    _dirty.push_back(0);
+    _ids.push_back(id);
+    _indices.push_back(index);
+
+    // Appending keeps parents in front of children, but the subtree ranges need rebuilding.
+    _needs_sort = true;
+    mark_dirty(index);
+
+    return id;
+}
+
+void TransformHierarchy::reserve(std::size_t count) {
+    _translations.reserve(count);
+    _rotations.reserve(count);
+    _scales.reserve(count);
+    _worlds.reserve(count);
+    _parents.reserve(count);
+    _subtree_sizes.reserve(count);
+    _dirty.reserve(count);
+    _ids.reserve(count);
+    _indices.reserve(count);
+}
+
+void TransformHierarchy::set_translation(TransformId id, vec3 translation) {
+    u32 index = _indices[id];
+    _translations[index] = translation;
+    mark_dirty(index);
+}
+
+void TransformHierarchy::set_rotation(TransformId id, quat rotation) {
+    u32 index = _indices[id];
+    _rotations[index] = rotation;
+    mark_dirty(index);
+}
+
+void TransformHierarchy::set_scale(TransformId id, vec3 scale) {
+    u32 index = _indices[id];
+    _scales[index] = scale;
+    mark_dirty(index);
+}
+
+std::size_t TransformHierarchy::update() {
+    if (_needs_sort) {
+        sort();
+    }
+
+    if (_dirty_indices.empty()) {
+        return 0;
+    }
+
+    // Anything inside the range of an earlier dirty node is recomputed as part of that subtree.
+    std::sort(_dirty_indices.begin(), _dirty_indices.end());
+
+    _dirty_roots.clear();
+    u32 covered_end = 0;
+    for (u32 index : _dirty_indices) {
+        _dirty[index] = 0;
+
+        if (index >= covered_end) {
+            _dirty_roots.push_back(index);
+            covered_end = index + _subtree_sizes[index];
+        }
+    }
+    _dirty_indices.clear();
+
+    // Subtrees are disjoint and their roots' parents are clean, so they can be processed independently.
+    std::atomic<std::size_t> recomputed{0};
+
+    JobSystem::get_global().parallel_for(_dirty_roots.size(), 16, [&](std::size_t begin, std::size_t end) {
+        std::size_t count = 0;
+
+        for (std::size_t r = begin; r < end; ++r) {
+            u32 root = _dirty_roots[r];
+            u32 subtree_end = root + _subtree_sizes[root];
+
+            for (u32 i = root; i < subtree_end; ++i) {
+                u32 parent = _parents[i];
+                if (parent == NO_PARENT) {
+                    _worlds[i] = compute_local(i);
+                } else {
+                    mat4_mul(_worlds[parent], compute_local(i), _worlds[i]);
+                }
+            }
+
+            count += subtree_end - root;
+        }
+
+        recomputed += count;
+    });
+
+    return recomputed;
+}
+
+std::size_t TransformHierarchy::get_size() const {
+    return _ids.size();
+}
+
+TransformId TransformHierarchy::get_parent(TransformId id) const {
+    u32 parent = _parents[_indices[id]];
+    return parent == NO_PARENT ? INVALID_TRANSFORM : _ids[parent];
+}
+
+vec3 TransformHierarchy::get_translation(TransformId id) const {
+    return _translations[_indices[id]];
+}
+
+quat TransformHierarchy::get_rotation(TransformId id) const {
+    return _rotations[_indices[id]];
+}
+
+vec3 TransformHierarchy::get_scale(TransformId id) const {
+    return _scales[_indices[id]];
+}
+
+mat4 const& TransformHierarchy::get_world(TransformId id) const {
+    return _worlds[_indices[id]];
+}
+
+void TransformHierarchy::mark_dirty(u32 index) {
+    if (_dirty[index]) {
+        return;
+    }
+
+    _dirty[index] = 1;
+    _dirty_indices.push_back(index);
+}
+
+// Reorders all attribute arrays into depth-first order and recomputes the subtree sizes.
+void TransformHierarchy::sort() {
+    std::size_t count = _ids.size();
+
+    // Children lists in compressed form: offsets into one flat array.
+    std::vector<u32> child_offsets(count + 1, 0);
+    for (u32 parent : _parents) {
+        if (parent != NO_PARENT) {
+            ++child_offsets[parent + 1];
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        child_offsets[i + 1] += child_offsets[i];
+    }
+
+    std::vector<u32> children(child_offsets.back());
+    std::vector<u32> fill(child_offsets.begin(), child_offsets.end() - 1);
+    for (u32 i = 0; i < count; ++i) {
+        if (_parents[i] != NO_PARENT) {
+            children[fill[_parents[i]]++] = i;
+        }
+    }
+
+    std::vector<u32> order;
+    order.reserve(count);
+    std::vector<u32> stack;
+
+    for (u32 i = 0; i < count; ++i) {
+        if (_parents[i] != NO_PARENT) {
+            continue;
+        }
+
+        stack.push_back(i);
+        while (!stack.empty()) {
+            u32 node = stack.back();
+            stack.pop_back();
+            order.push_back(node);
+
+            // Pushed in reverse so that children keep their creation order.
+            for (u32 c = child_offsets[node + 1]; c > child_offsets[node]; --c) {
+                stack.push_back(children[c - 1]);
+            }
+        }
+    }
+
+    std::vector<u32> new_index(count);
+    for (u32 i = 0; i < count; ++i) {
+        new_index[order[i]] = i;
+    }
+
+    permute(_translations, order);
+    permute(_rotations, order);
+    permute(_scales, order);
+    permute(_worlds, order);
+    permute(_dirty, order);
+    permute(_ids, order);
+    permute(_parents, order);
+
+    for (auto& parent : _parents) {
+        if (parent != NO_PARENT) {
+            parent = new_index[parent];
+        }
+    }
+    for (auto& index : _dirty_indices) {
+        index = new_index[index];
+    }
+    for (u32 i = 0; i < count; ++i) {
+        _indices[_ids[i]] = i;
+    }
+
+    // Children come after their parent, so a reverse sweep accumulates subtree sizes bottom-up.
+    std::fill(_subtree_sizes.begin(), _subtree_sizes.end(), 1);
+    for (u32 i = static_cast<u32>(count); i-- > 0;) {
+        if (_parents[i] != NO_PARENT) {
+            _subtree_sizes[_parents[i]] += _subtree_sizes[i];
+        }
+    }
+
+    _needs_sort = false;
+}
+
+mat4 TransformHierarchy::compute_local(u32 index) const {
+    mat4 local = to_mat4(_rotations[index]);
+    vec3 s = _scales[index];
+
+    local.cols[0] = local.cols[0] * s.x;
+    local.cols[1] = local.cols[1] * s.y;
+    local.cols[2] = local.cols[2] * s.z;
+    local.cols[3] = vec4{_translations[index], 1.0f};
+
+    return local;
+}
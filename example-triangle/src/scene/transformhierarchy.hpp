@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <math/math.hpp>
+#include <util/base.hpp>
+
+using TransformId = u32;
+
+constexpr TransformId INVALID_TRANSFORM = ~0u;
+
+/*
+ * Parent/child transforms stored as one array per attribute, kept in depth-first order.
+ * Parents therefore always precede their children and every subtree occupies a contiguous
+ * range [index, index + subtree size).
+ *
+ * Setters only mark a node dirty. update() then recomputes the world matrices of dirty
+ * subtrees and nothing else, running independent subtrees on the global JobSystem.
+ * TransformIds stay valid while the storage is reordered.
+ */
+class TransformHierarchy {
+public:
+    TransformHierarchy() = default;
+
+public:
+    TransformId create(TransformId parent = INVALID_TRANSFORM);
+    void reserve(std::size_t count);
+
+    void set_translation(TransformId id, vec3 translation);
+    void set_rotation(TransformId id, quat rotation);
+    void set_scale(TransformId id, vec3 scale);
+
+    // Returns the number of world matrices that were recomputed.
+    std::size_t update();
+
+public:
+    NODISCARD std::size_t get_size() const;
+    NODISCARD TransformId get_parent(TransformId id) const;
+    NODISCARD vec3 get_translation(TransformId id) const;
+    NODISCARD quat get_rotation(TransformId id) const;
+    NODISCARD vec3 get_scale(TransformId id) const;
+    NODISCARD mat4 const& get_world(TransformId id) const;
+
+private:
+    void mark_dirty(u32 index);
+    void sort();
+    NODISCARD mat4 compute_local(u32 index) const;
+
+private:
+    // Indexed by storage position.
+    std::vector<vec3> _translations;
+    std::vector<quat> _rotations;
+    std::vector<vec3> _scales;
+    std::vector<mat4> _worlds;
+    std::vector<u32> _parents;
+    std::vector<u32> _subtree_sizes;
+    std::vector<u8> _dirty;
+    std::vector<TransformId> _ids;
+
+    // Indexed by TransformId.
+    std::vector<u32> _indices;
+
+    std::vector<u32> _dirty_indices;
+    std::vector<u32> _dirty_roots;
+    bool _needs_sort = false;
+};
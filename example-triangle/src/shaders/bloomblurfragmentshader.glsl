@@ -0,0 +1,25 @@
+#version 330 core
+
+in vec2 frag_uv;
+
+uniform sampler2D our_input0;
+// xy: step between taps in texels, one axis zero for a separable blur
+uniform vec4 our_params;
+
+out vec4 out_col;
+
+// 9 tap gaussian folded into 5 bilinear fetches.
+const float OFFSETS[3] = float[](0.0, 1.3846153846, 3.2307692308);
+const float WEIGHTS[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+
+void main() {
+    vec2 step = our_params.xy / vec2(textureSize(our_input0, 0));
+
+    vec3 color = texture(our_input0, frag_uv).rgb * WEIGHTS[0];
+    for (int i = 1; i < 3; ++i) {
+        color += texture(our_input0, frag_uv + step * OFFSETS[i]).rgb * WEIGHTS[i];
+        color += texture(our_input0, frag_uv - step * OFFSETS[i]).rgb * WEIGHTS[i];
+    }
+
+    out_col = vec4(color, 1.0);
+}
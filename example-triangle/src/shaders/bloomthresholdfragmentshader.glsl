@@ -0,0 +1,20 @@
+#version 330 core
+
+in vec2 frag_uv;
+
+uniform sampler2D our_input0;
+// x: brightness threshold, y: soft knee width
+uniform vec4 our_params;
+
+out vec4 out_col;
+
+void main() {
+    vec3 color = texture(our_input0, frag_uv).rgb;
+    float brightness = max(color.r, max(color.g, color.b));
+
+    // Fades in over the knee instead of cutting off hard, which would flicker on moving edges.
+    float knee = max(our_params.y, 1e-4);
+    float weight = clamp((brightness - our_params.x + knee) / (2.0 * knee), 0.0, 1.0);
+
+    out_col = vec4(color * weight, 1.0);
+}
@@ -2,3 +2,17 @@
 
 ASSET_OBJ(DEFAULT_VERTEX_SHADER, "shaders/defaultvertexshader.glsl")
 ASSET_OBJ(DEFAULT_FRAGMENT_SHADER, "shaders/defaultfragmentshader.glsl")
+ASSET_OBJ(FULLSCREEN_VERTEX_SHADER, "shaders/fullscreenvertexshader.glsl")
+ASSET_OBJ(BLOOM_THRESHOLD_FRAGMENT_SHADER, "shaders/bloomthresholdfragmentshader.glsl")
+ASSET_OBJ(BLOOM_BLUR_FRAGMENT_SHADER, "shaders/bloomblurfragmentshader.glsl")
+ASSET_OBJ(TONEMAP_FRAGMENT_SHADER, "shaders/tonemapfragmentshader.glsl")
+ASSET_OBJ(UPSCALE_FRAGMENT_SHADER, "shaders/upscalefragmentshader.glsl")
+ASSET_OBJ(GPU_CULL_COMPUTE_SHADER, "shaders/gpucullcomputeshader.glsl")
+ASSET_OBJ(GPU_PARTICLES_COMPUTE_SHADER, "shaders/gpuparticlescomputeshader.glsl")
+ASSET_OBJ(TEXT_FRAGMENT_SHADER, "shaders/textfragmentshader.glsl")
+
+std::string get_asset_source(void const* data, i32 size) {
+    std::string source{static_cast<char const*>(data), static_cast<std::size_t>(size)};
+    source.erase(source.find_last_not_of('\0') + 1);
+    return source;
+}
@@ -1,6 +1,21 @@
 #pragma once
 
+#include <string>
+
 #include <util/assets.hpp>
 
+// Embedded assets are padded to 8 bytes and not necessarily NUL-terminated, so go by their size.
+#define ASSET_SOURCE(name) get_asset_source(name(), name ## _size())
+
+std::string get_asset_source(void const* data, i32 size);
+
 ASSET_DECL(DEFAULT_VERTEX_SHADER)
 ASSET_DECL(DEFAULT_FRAGMENT_SHADER)
+ASSET_DECL(FULLSCREEN_VERTEX_SHADER)
+ASSET_DECL(BLOOM_THRESHOLD_FRAGMENT_SHADER)
+ASSET_DECL(BLOOM_BLUR_FRAGMENT_SHADER)
+ASSET_DECL(TONEMAP_FRAGMENT_SHADER)
+ASSET_DECL(UPSCALE_FRAGMENT_SHADER)
+ASSET_DECL(GPU_CULL_COMPUTE_SHADER)
+ASSET_DECL(GPU_PARTICLES_COMPUTE_SHADER)
+ASSET_DECL(TEXT_FRAGMENT_SHADER)
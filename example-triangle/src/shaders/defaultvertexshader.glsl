@@ -5,6 +5,7 @@ layout (location = 1) in vec2 my_uv;
 layout (location = 2) in vec4 my_col;
 
 uniform mat4 our_proj;
+uniform mat4 our_model;
 
 out vec4 frag_col;
 out vec2 frag_uv;
@@ -13,5 +14,5 @@ void main() {
     frag_col = my_col;
     frag_uv = my_uv;
 
-    gl_Position = our_proj * vec4(my_pos.xy, 0, 1);
+    gl_Position = our_proj * our_model * vec4(my_pos.xy, 0, 1);
 }
@@ -0,0 +1,11 @@
+#version 330 core
+
+out vec2 frag_uv;
+
+// One triangle covering the whole viewport, drawn without any vertex buffer.
+void main() {
+    vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    frag_uv = position;
+
+    gl_Position = vec4(position * 2.0 - 1.0, 0, 1);
+}
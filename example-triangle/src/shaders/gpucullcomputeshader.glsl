@@ -0,0 +1,58 @@
+#version 430 core
+
+layout (local_size_x = 64) in;
+
+struct Instance {
+    vec4 bounds_min;
+    vec4 bounds_max;
+    uint index_count;
+    uint first_index;
+    int base_vertex;
+    uint padding;
+};
+
+// Matches the layout of DrawElementsIndirectCommand.
+struct DrawCommand {
+    uint count;
+    uint instance_count;
+    uint first_index;
+    int base_vertex;
+    uint base_instance;
+};
+
+layout (std430, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout (std430, binding = 1) writeonly buffer Commands {
+    DrawCommand commands[];
+};
+
+layout (std430, binding = 2) buffer DrawCount {
+    uint draw_count;
+};
+
+uniform vec4 our_planes[6];
+uniform uint our_instance_count;
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= our_instance_count) {
+        return;
+    }
+
+    Instance instance = instances[index];
+
+    for (int i = 0; i < 6; ++i) {
+        vec4 plane = our_planes[i];
+        vec3 far_corner = mix(instance.bounds_min.xyz, instance.bounds_max.xyz, greaterThan(plane.xyz, vec3(0.0)));
+        if (dot(plane.xyz, far_corner) + plane.w < 0.0) {
+            return;
+        }
+    }
+
+    uint slot = atomicAdd(draw_count, 1u);
+
+    // base_instance carries the instance index, so instanced attributes can fetch per-object data.
+    commands[slot] = DrawCommand(instance.index_count, 1u, instance.first_index, instance.base_vertex, index);
+}
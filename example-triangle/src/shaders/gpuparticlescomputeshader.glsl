@@ -0,0 +1,184 @@
+#version 430 core
+
+layout (local_size_x = 64) in;
+
+const uint STAGE_UPDATE = 0u;
+const uint STAGE_EMIT = 1u;
+const uint STAGE_FINALIZE = 2u;
+
+const uint MAX_EMITTERS = 16u;
+const uint MAX_ATTRACTORS = 8u;
+
+struct Particle {
+    vec2 position;
+    vec2 velocity;
+    float age;
+    float lifetime;
+    uint emitter;
+    uint padding;
+};
+
+// Colors are packed RGBA8, red in the lowest byte.
+struct Emitter {
+    vec2 position;
+    float direction;
+    float spread;
+    float min_speed;
+    float max_speed;
+    float min_lifetime;
+    float max_lifetime;
+    uint start_color;
+    uint end_color;
+    uint first_spawn;
+    uint spawn_count;
+};
+
+struct Attractor {
+    vec2 position;
+    float strength;
+    float radius;
+};
+
+// Matches the layout of DrawArraysIndirectCommand.
+struct DrawCommand {
+    uint count;
+    uint instance_count;
+    uint first;
+    uint base_instance;
+};
+
+layout (std430, binding = 0) readonly buffer Source {
+    Particle source[];
+};
+
+layout (std430, binding = 1) writeonly buffer Destination {
+    Particle destination[];
+};
+
+// Vertex is 20 bytes, which no std430 struct can match, so it is written word by word.
+layout (std430, binding = 2) writeonly buffer Vertices {
+    uint vertex_words[];
+};
+
+// The particle count of each side of the ping-pong, and the draw command for the last one written.
+layout (std430, binding = 3) buffer Counts {
+    uint counts[2];
+    DrawCommand command;
+};
+
+layout (std430, binding = 4) readonly buffer Params {
+    vec2 gravity;
+    float drag;
+    float dt;
+    uint capacity;
+    uint emitter_count;
+    uint attractor_count;
+    uint seed;
+    uint spawn_total;
+    uint params_padding[3];
+    Emitter emitters[MAX_EMITTERS];
+    Attractor attractors[MAX_ATTRACTORS];
+};
+
+uniform uint our_stage;
+uniform uint our_source;
+
+// PCG hash, one independent stream per spawned particle.
+uint next_random(inout uint state) {
+    state = state * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float random_range(inout uint state, float low, float high) {
+    return mix(low, high, float(next_random(state) >> 8u) * (1.0 / 16777216.0));
+}
+
+void write_particle(uint slot, Particle particle) {
+    destination[slot] = particle;
+
+    Emitter emitter = emitters[particle.emitter];
+    float t = min(particle.age / particle.lifetime, 1.0);
+    vec4 color = mix(unpackUnorm4x8(emitter.start_color), unpackUnorm4x8(emitter.end_color), t);
+
+    uint base = slot * 5u;
+    vertex_words[base + 0u] = floatBitsToUint(particle.position.x);
+    vertex_words[base + 1u] = floatBitsToUint(particle.position.y);
+    vertex_words[base + 2u] = 0u;
+    vertex_words[base + 3u] = 0u;
+    vertex_words[base + 4u] = packUnorm4x8(color);
+}
+
+void update(uint index) {
+    if (index >= counts[our_source]) {
+        return;
+    }
+
+    Particle particle = source[index];
+
+    vec2 acceleration = gravity;
+    for (uint i = 0u; i < attractor_count; ++i) {
+        vec2 delta = attractors[i].position - particle.position;
+        float inverse = inversesqrt(dot(delta, delta) + attractors[i].radius * attractors[i].radius);
+        acceleration += delta * (attractors[i].strength * inverse * inverse * inverse);
+    }
+
+    particle.velocity = (particle.velocity + acceleration * dt) * exp(-drag * dt);
+    particle.position += particle.velocity * dt;
+    particle.age += dt;
+    if (particle.age >= particle.lifetime) {
+        return;
+    }
+
+    // Survivors are appended, which compacts the particles without a separate pass.
+    write_particle(atomicAdd(counts[1u - our_source], 1u), particle);
+}
+
+void emit(uint index) {
+    if (index >= spawn_total) {
+        return;
+    }
+
+    uint id = 0u;
+    while (id + 1u < emitter_count && index >= emitters[id].first_spawn + emitters[id].spawn_count) {
+        ++id;
+    }
+
+    // Slots past the capacity are dropped, finalize clamps the count.
+    uint slot = atomicAdd(counts[1u - our_source], 1u);
+    if (slot >= capacity) {
+        return;
+    }
+
+    Emitter emitter = emitters[id];
+    uint state = seed ^ (index * 2654435769u);
+    float angle = emitter.direction + random_range(state, -0.5, 0.5) * emitter.spread;
+    float speed = random_range(state, emitter.min_speed, emitter.max_speed);
+
+    Particle particle;
+    particle.position = emitter.position;
+    particle.velocity = vec2(cos(angle), sin(angle)) * speed;
+    particle.age = 0.0;
+    particle.lifetime = random_range(state, emitter.min_lifetime, emitter.max_lifetime);
+    particle.emitter = id;
+    particle.padding = 0u;
+    write_particle(slot, particle);
+}
+
+void finalize() {
+    uint count = min(counts[1u - our_source], capacity);
+    counts[1u - our_source] = count;
+    command = DrawCommand(count, 1u, 0u, 0u);
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+
+    if (our_stage == STAGE_UPDATE) {
+        update(index);
+    } else if (our_stage == STAGE_EMIT) {
+        emit(index);
+    } else if (index == 0u) {
+        finalize();
+    }
+}
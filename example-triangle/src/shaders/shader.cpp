@@ -2,26 +2,58 @@
 
 #include <array>
 #include <iostream>
+#include <utility>
 
 static std::unordered_map<ShaderType, GLenum> shader_enums{
     {ShaderType::VertexShader, GL_VERTEX_SHADER},
     {ShaderType::FragmentShader, GL_FRAGMENT_SHADER},
+    {ShaderType::ComputeShader, GL_COMPUTE_SHADER},
 };
 
+Shader::Shader() : _id{}, _shader_type{ShaderType::VertexShader}, _data{}, _name{} { }
+
 Shader::Shader(ShaderType shader_type, std::string data, std::string name): _id{}, _shader_type{shader_type}, _data{std::move(data)}, _name{std::move(name)} { }
 
 Shader::~Shader() {
     glDeleteShader(_id);
 }
 
+Shader::Shader(Shader&& other) noexcept :
+    _id{std::exchange(other._id, 0)},
+    _shader_type{other._shader_type},
+    _data{std::move(other._data)},
+    _name{std::move(other._name)} {
+
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept {
+    if (this != &other) {
+        glDeleteShader(_id);
+        _id = std::exchange(other._id, 0);
+        _shader_type = other._shader_type;
+        _data = std::move(other._data);
+        _name = std::move(other._name);
+    }
+    return *this;
+}
+
 void Shader::init() {
+    compile();
+    check_status();
+}
+
+// Only submits the source to the driver; the status is not queried here so that
+// drivers with threaded compilation can finish in the background.
+void Shader::compile() {
     _id = glCreateShader(shader_enums[_shader_type]);
 
     std::array<GLint, 1> lengths{static_cast<GLint>(_data.size())};
     char const* content = _data.data();
     glShaderSource(_id, 1, &content, lengths.data());
     glCompileShader(_id);
+}
 
+bool Shader::check_status() const {
     GLint status;
     glGetShaderiv(_id, GL_COMPILE_STATUS, &status);
 
@@ -39,6 +71,8 @@ void Shader::init() {
 
         std::cerr << "Error: " << log << std::endl;
     }
+
+    return status == GL_TRUE;
 }
 
 GLuint Shader::get_id() const {
@@ -10,16 +10,25 @@
 enum class ShaderType {
     VertexShader,
     FragmentShader,
+    ComputeShader, // requires OpenGL 4.3
 };
 
 class Shader {
 public:
-    Shader() = default;
+    Shader();
     Shader(ShaderType shader_type, std::string data, std::string name);
     ~Shader();
 
+    // The shader object is owned by exactly one Shader, moving hands it over.
+    Shader(Shader const&) = delete;
+    Shader& operator=(Shader const&) = delete;
+    Shader(Shader&& other) noexcept;
+    Shader& operator=(Shader&& other) noexcept;
+
 public:
     void init();
+    void compile();
+    bool check_status() const;
 
 public:
     NODISCARD GLuint get_id() const;
@@ -1,11 +1,13 @@
 #include "shaderprogram.hpp"
 
 #include <iostream>
+#include <utility>
 
 ShaderProgram::ShaderProgram(std::string name) :
     _id{},
     _vertex_shader_id{},
     _fragment_shader_id{},
+    _compute_shader_id{},
     _name{std::move(name)} {
 
 }
@@ -14,7 +16,35 @@ ShaderProgram::~ShaderProgram() {
     glDeleteProgram(_id);
 }
 
+ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept :
+    _id{std::exchange(other._id, 0)},
+    _vertex_shader_id{other._vertex_shader_id},
+    _fragment_shader_id{other._fragment_shader_id},
+    _compute_shader_id{other._compute_shader_id},
+    _name{std::move(other._name)} {
+
+}
+
+ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) noexcept {
+    if (this != &other) {
+        glDeleteProgram(_id);
+        _id = std::exchange(other._id, 0);
+        _vertex_shader_id = other._vertex_shader_id;
+        _fragment_shader_id = other._fragment_shader_id;
+        _compute_shader_id = other._compute_shader_id;
+        _name = std::move(other._name);
+    }
+    return *this;
+}
+
 void ShaderProgram::init(GLuint vertex_shader_id, GLuint fragment_shader_id) {
+    link(vertex_shader_id, fragment_shader_id);
+    check_status();
+}
+
+// Like Shader::compile(), this only kicks off the link. Poll is_link_complete()
+// before check_status() to avoid stalling on the driver.
+void ShaderProgram::link(GLuint vertex_shader_id, GLuint fragment_shader_id) {
     _vertex_shader_id = vertex_shader_id;
     _fragment_shader_id = fragment_shader_id;
 
@@ -22,7 +52,31 @@ void ShaderProgram::init(GLuint vertex_shader_id, GLuint fragment_shader_id) {
     glAttachShader(_id, _vertex_shader_id);
     glAttachShader(_id, _fragment_shader_id);
     glLinkProgram(_id);
+}
+
+void ShaderProgram::init_compute(GLuint compute_shader_id) {
+    _compute_shader_id = compute_shader_id;
+
+    _id = glCreateProgram();
+    glAttachShader(_id, _compute_shader_id);
+    glLinkProgram(_id);
+
+    check_status();
+}
 
+void ShaderProgram::adopt(GLuint id) {
+    glDeleteProgram(_id);
+    _id = id;
+    _vertex_shader_id = 0;
+    _fragment_shader_id = 0;
+    _compute_shader_id = 0;
+}
+
+GLuint ShaderProgram::release() {
+    return std::exchange(_id, 0);
+}
+
+bool ShaderProgram::check_status() const {
     GLint status;
     glGetProgramiv(_id, GL_LINK_STATUS, &status);
 
@@ -40,12 +94,31 @@ void ShaderProgram::init(GLuint vertex_shader_id, GLuint fragment_shader_id) {
 
         std::cerr << "Error: " << log << std::endl;
     }
+
+    return status == GL_TRUE;
 }
 
 void ShaderProgram::use() {
     glUseProgram(_id);
 }
 
+void ShaderProgram::swap(ShaderProgram& other) {
+    std::swap(_id, other._id);
+    std::swap(_vertex_shader_id, other._vertex_shader_id);
+    std::swap(_fragment_shader_id, other._fragment_shader_id);
+    std::swap(_compute_shader_id, other._compute_shader_id);
+}
+
+bool ShaderProgram::is_link_complete() const {
+    if (!GLEW_ARB_parallel_shader_compile) {
+        return true;
+    }
+
+    GLint complete;
+    glGetProgramiv(_id, GL_COMPLETION_STATUS_ARB, &complete);
+    return complete == GL_TRUE;
+}
+
 GLuint ShaderProgram::get_id() const {
     return _id;
 }
@@ -58,6 +131,10 @@ GLuint ShaderProgram::get_fragment_shader_id() const {
     return _fragment_shader_id;
 }
 
+GLuint ShaderProgram::get_compute_shader_id() const {
+    return _compute_shader_id;
+}
+
 std::string const& ShaderProgram::get_name() const {
     return _name;
 }
@@ -11,19 +11,36 @@ public:
     explicit ShaderProgram(std::string name);
     ~ShaderProgram();
 
+    // The program object is owned by exactly one ShaderProgram, moving hands it over.
+    ShaderProgram(ShaderProgram const&) = delete;
+    ShaderProgram& operator=(ShaderProgram const&) = delete;
+    ShaderProgram(ShaderProgram&& other) noexcept;
+    ShaderProgram& operator=(ShaderProgram&& other) noexcept;
+
 public:
     void init(GLuint vertex_shader_id, GLuint fragment_shader_id);
+    void link(GLuint vertex_shader_id, GLuint fragment_shader_id);
+    void init_compute(GLuint compute_shader_id);
+    // Deletes the current program and takes ownership of id, a program linked elsewhere, e.g. by the ResourceLoader.
+    void adopt(GLuint id);
+    // Gives up ownership without deleting anything and returns the program, the caller has to delete it.
+    NODISCARD GLuint release();
+    bool check_status() const;
     void use();
+    void swap(ShaderProgram& other);
 
 public:
+    NODISCARD bool is_link_complete() const;
     NODISCARD GLuint get_id() const;
     NODISCARD GLuint get_vertex_shader_id() const;
     NODISCARD GLuint get_fragment_shader_id() const;
+    NODISCARD GLuint get_compute_shader_id() const;
     NODISCARD std::string const& get_name() const;
 
 private:
     GLuint _id;
     GLuint _vertex_shader_id;
     GLuint _fragment_shader_id;
+    GLuint _compute_shader_id;
     std::string _name;
 };
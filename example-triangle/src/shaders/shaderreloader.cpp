@@ -0,0 +1,107 @@
+#include "shaderreloader.hpp"
+
+#include <iostream>
+
+ShaderReloader::ShaderReloader(ShaderProgram& program, std::string directory, std::string vertex_file, std::string fragment_file) :
+    _program{program},
+    _watcher{std::move(directory)},
+    _vertex_file{std::move(vertex_file)},
+    _fragment_file{std::move(fragment_file)},
+    _pending_polled{false} {
+
+}
+
+void ShaderReloader::start() {
+    if (!ShaderWatcher::read_file(_watcher.get_directory() + "/" + _vertex_file, _vertex_data) ||
+        !ShaderWatcher::read_file(_watcher.get_directory() + "/" + _fragment_file, _fragment_data)) {
+        std::cerr << "Unable to read shader sources from " << _watcher.get_directory() << ", hot reloading disabled" << std::endl;
+        return;
+    }
+
+    if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+
+    _watcher.watch(_vertex_file);
+    _watcher.watch(_fragment_file);
+    _watcher.start();
+
+    std::cout << "Watching " << _watcher.get_directory() << " for changes to " << _program.get_name() << std::endl;
+}
+
+bool ShaderReloader::update() {
+    auto changes = _watcher.poll_changes();
+
+    if (!changes.empty()) {
+        for (auto& change : changes) {
+            if (change.file_name == _vertex_file) {
+                _vertex_data = std::move(change.data);
+            } else if (change.file_name == _fragment_file) {
+                _fragment_data = std::move(change.data);
+            }
+
+            _detected_at = change.detected_at;
+        }
+
+        // A newer edit supersedes whatever is still compiling.
+        submit();
+        return false;
+    }
+
+    if (!_pending_program) {
+        return false;
+    }
+
+    // Without GL_ARB_parallel_shader_compile there is no way to ask whether the link is done,
+    // so give the driver at least one frame before querying the (possibly blocking) status.
+    if (!_pending_polled) {
+        _pending_polled = true;
+        if (!GLEW_ARB_parallel_shader_compile) {
+            return false;
+        }
+    }
+
+    if (!_pending_program->is_link_complete()) {
+        return false;
+    }
+
+    bool linked = _pending_program->check_status();
+    if (linked) {
+        finish();
+    } else {
+        _pending_vertex->check_status();
+        _pending_fragment->check_status();
+        std::cerr << "Keeping previous version of " << _program.get_name() << std::endl;
+    }
+
+    _pending_program.reset();
+    _pending_vertex.reset();
+    _pending_fragment.reset();
+
+    return linked;
+}
+
+void ShaderReloader::submit() {
+    _submitted_at = Clock::now();
+    _pending_polled = false;
+
+    _pending_vertex = std::make_unique<Shader>(ShaderType::VertexShader, _vertex_data, _vertex_file);
+    _pending_fragment = std::make_unique<Shader>(ShaderType::FragmentShader, _fragment_data, _fragment_file);
+    _pending_program = std::make_unique<ShaderProgram>(_program.get_name());
+
+    _pending_vertex->compile();
+    _pending_fragment->compile();
+    _pending_program->link(_pending_vertex->get_id(), _pending_fragment->get_id());
+}
+
+void ShaderReloader::finish() {
+    // The pending program now holds the old one and deletes it when it is reset.
+    _program.swap(*_pending_program);
+
+    auto now = Clock::now();
+    auto total = std::chrono::duration<f64, std::milli>(now - _detected_at).count();
+    auto build = std::chrono::duration<f64, std::milli>(now - _submitted_at).count();
+
+    std::cout << "Reloaded " << _program.get_name() << " in " << total << " ms"
+              << " (compile and link " << build << " ms)" << std::endl;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <shaders/shader.hpp>
+#include <shaders/shaderprogram.hpp>
+#include <shaders/shaderwatcher.hpp>
+#include <util/base.hpp>
+
+/*
+ * Rebuilds a ShaderProgram whenever one of its source files changes on disk.
+ *
+ * update() is meant to be called once per frame on the thread owning the GL context.
+ * It never waits: compile and link are submitted in one frame and their completion is
+ * polled in later frames. The live program is only swapped once linking succeeded,
+ * otherwise the previous program stays in use.
+ */
+class ShaderReloader {
+public:
+    ShaderReloader(ShaderProgram& program, std::string directory, std::string vertex_file, std::string fragment_file);
+
+public:
+    void start();
+    bool update();
+
+private:
+    void submit();
+    void finish();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ShaderProgram& _program;
+    ShaderWatcher _watcher;
+
+    std::string _vertex_file;
+    std::string _fragment_file;
+    std::string _vertex_data;
+    std::string _fragment_data;
+
+    std::unique_ptr<Shader> _pending_vertex;
+    std::unique_ptr<Shader> _pending_fragment;
+    std::unique_ptr<ShaderProgram> _pending_program;
+    bool _pending_polled;
+
+    Clock::time_point _detected_at;
+    Clock::time_point _submitted_at;
+};
@@ -0,0 +1,136 @@
+#include "shaderwatcher.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef OS_LINUX
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+ShaderWatcher::ShaderWatcher(std::string directory) : _directory{std::move(directory)}, _running{false} { }
+
+ShaderWatcher::~ShaderWatcher() {
+    stop();
+}
+
+void ShaderWatcher::watch(std::string file_name) {
+    _file_names.push_back(std::move(file_name));
+}
+
+void ShaderWatcher::start() {
+    if (_running.exchange(true)) {
+        return;
+    }
+
+    _thread = std::thread{&ShaderWatcher::run, this};
+}
+
+void ShaderWatcher::stop() {
+    _running = false;
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+std::vector<ShaderChange> ShaderWatcher::poll_changes() {
+    std::vector<ShaderChange> changes;
+
+    // try_lock keeps the caller (the render loop) from ever waiting on the watcher thread.
+    std::unique_lock<std::mutex> lock{_changes_mutex, std::try_to_lock};
+    if (lock.owns_lock()) {
+        changes.swap(_changes);
+    }
+
+    return changes;
+}
+
+bool ShaderWatcher::read_file(std::string const& path, std::string& data) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        return false;
+    }
+
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    data = stream.str();
+    return true;
+}
+
+std::string const& ShaderWatcher::get_directory() const {
+    return _directory;
+}
+
+void ShaderWatcher::run() {
+#ifdef OS_LINUX
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Unable to initialize inotify for " << _directory << std::endl;
+        return;
+    }
+
+    // Watch the directory rather than the files: most editors save by writing a new
+    // file and renaming it over the old one, which would drop a per-file watch.
+    if (inotify_add_watch(fd, _directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "Unable to watch shader directory " << _directory << std::endl;
+        close(fd);
+        return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    pollfd poll_fd{fd, POLLIN, 0};
+
+    while (_running) {
+        // Wake up regularly so stop() does not have to wait for a file event.
+        if (poll(&poll_fd, 1, 100) <= 0) {
+            continue;
+        }
+
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            continue;
+        }
+
+        auto detected_at = std::chrono::steady_clock::now();
+
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            auto const* event = reinterpret_cast<inotify_event const*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->len == 0) {
+                continue;
+            }
+
+            std::string file_name{event->name};
+            if (std::find(_file_names.begin(), _file_names.end(), file_name) == _file_names.end()) {
+                continue;
+            }
+
+            ShaderChange change{file_name, {}, detected_at};
+            if (!read_file(_directory + "/" + file_name, change.data)) {
+                std::cerr << "Unable to read changed shader " << file_name << std::endl;
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock{_changes_mutex};
+
+            // Only the newest version of a file matters.
+            auto existing = std::find_if(_changes.begin(), _changes.end(),
+                                         [&](ShaderChange const& c) { return c.file_name == file_name; });
+            if (existing != _changes.end()) {
+                *existing = std::move(change);
+            } else {
+                _changes.push_back(std::move(change));
+            }
+        }
+    }
+
+    close(fd);
+#else
+    std::cerr << "Shader hot reloading is only supported on Linux" << std::endl;
+#endif
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <util/base.hpp>
+
+struct ShaderChange {
+    std::string file_name;
+    std::string data;
+    std::chrono::steady_clock::time_point detected_at;
+};
+
+/*
+ * Watches a directory for modified shader files on a background thread (inotify on Linux).
+ * Changed files are read on that thread as well, so the render thread only ever picks up
+ * finished sources through poll_changes(), which never blocks on I/O.
+ */
+class ShaderWatcher {
+public:
+    explicit ShaderWatcher(std::string directory);
+    ~ShaderWatcher();
+
+public:
+    void watch(std::string file_name);
+    void start();
+    void stop();
+
+    NODISCARD std::vector<ShaderChange> poll_changes();
+
+public:
+    NODISCARD static bool read_file(std::string const& path, std::string& data);
+
+public:
+    NODISCARD std::string const& get_directory() const;
+
+private:
+    void run();
+
+private:
+    std::string _directory;
+    std::vector<std::string> _file_names;
+    std::vector<ShaderChange> _changes;
+    std::mutex _changes_mutex;
+    std::atomic<bool> _running;
+    std::thread _thread;
+};
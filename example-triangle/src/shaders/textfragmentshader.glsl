@@ -0,0 +1,17 @@
+#version 330 core
+
+in vec2 frag_uv;
+in vec4 frag_col;
+
+uniform sampler2D our_tex;
+
+out vec4 out_col;
+
+void main() {
+   // The outline sits at 0.5, smooth over about one pixel at whatever scale the text is drawn.
+   float distance = texture(our_tex, frag_uv).r;
+   float width = fwidth(distance);
+   float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+
+   out_col = vec4(frag_col.rgb, frag_col.a * alpha);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+
+in vec2 frag_uv;
+
+uniform sampler2D our_input0; // the scene
+uniform sampler2D our_input1; // the bloom
+// x: bloom strength, y: exposure
+uniform vec4 our_params;
+
+out vec4 out_col;
+
+void main() {
+    vec3 color = texture(our_input0, frag_uv).rgb + texture(our_input1, frag_uv).rgb * our_params.x;
+    color *= our_params.y;
+
+    // Reinhard on the luminance, so saturated colors keep their hue.
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    color *= 1.0 / (1.0 + luminance);
+
+    out_col = vec4(color, 1.0);
+}
@@ -0,0 +1,29 @@
+#version 330 core
+
+in vec2 frag_uv;
+
+uniform sampler2D our_input0;
+// x: sharpening strength, 0 for plain bilinear
+uniform vec4 our_params;
+
+out vec4 out_col;
+
+void main() {
+    vec3 color = texture(our_input0, frag_uv).rgb;
+
+    if (our_params.x > 0.0) {
+        // Unsharp mask over the source texels, clamped to their range so edges don't ring.
+        vec2 texel = 1.0 / vec2(textureSize(our_input0, 0));
+        vec3 north = texture(our_input0, frag_uv + vec2(0.0, texel.y)).rgb;
+        vec3 south = texture(our_input0, frag_uv - vec2(0.0, texel.y)).rgb;
+        vec3 east = texture(our_input0, frag_uv + vec2(texel.x, 0.0)).rgb;
+        vec3 west = texture(our_input0, frag_uv - vec2(texel.x, 0.0)).rgb;
+
+        vec3 low = min(color, min(min(north, south), min(east, west)));
+        vec3 high = max(color, max(max(north, south), max(east, west)));
+        vec3 sharpened = color + (4.0 * color - north - south - east - west) * (0.25 * our_params.x);
+        color = clamp(sharpened, low, high);
+    }
+
+    out_col = vec4(color, 1.0);
+}
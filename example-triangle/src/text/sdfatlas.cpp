@@ -0,0 +1,105 @@
+#include "sdfatlas.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <jobs/jobsystem.hpp>
+
+namespace {
+    f32 distance_to_segment(vec2 p, StrokeSegment const& segment) {
+        vec2 ab = segment.b - segment.a;
+        vec2 ap = p - segment.a;
+
+        f32 length_squared = dot(ab, ab);
+        f32 t = length_squared > 0.0f ? std::clamp(dot(ap, ab) / length_squared, 0.0f, 1.0f) : 0.0f;
+
+        return length(ap - ab * t);
+    }
+}
+
+SdfAtlas::SdfAtlas() :
+    _cell_width{static_cast<u32>((CELL_MAX.x - CELL_MIN.x) * PIXELS_PER_UNIT)},
+    _cell_height{static_cast<u32>((CELL_MAX.y - CELL_MIN.y) * PIXELS_PER_UNIT)},
+    _width{_cell_width * COLUMNS},
+    _height{_cell_height * ((stroke_font::GLYPH_COUNT + COLUMNS - 1) / COLUMNS)},
+    _pixels{},
+    _glyphs(stroke_font::GLYPH_COUNT) {
+
+    for (u32 i = 0; i < stroke_font::GLYPH_COUNT; ++i) {
+        u32 x = (i % COLUMNS) * _cell_width;
+        u32 y = (i / COLUMNS) * _cell_height;
+
+        _glyphs[i] = {
+            static_cast<f32>(x) / _width,
+            static_cast<f32>(y) / _height,
+            static_cast<f32>(x + _cell_width) / _width,
+            static_cast<f32>(y + _cell_height) / _height
+        };
+    }
+}
+
+void SdfAtlas::build() {
+    _pixels.assign(static_cast<std::size_t>(_width) * _height, 0);
+
+    JobSystem::get_global().parallel_for(stroke_font::GLYPH_COUNT, 1, [this](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            rasterize(static_cast<u32>(i));
+        }
+    });
+}
+
+bool SdfAtlas::is_built() const {
+    return !_pixels.empty();
+}
+
+u32 SdfAtlas::get_width() const {
+    return _width;
+}
+
+u32 SdfAtlas::get_height() const {
+    return _height;
+}
+
+std::vector<u8> const& SdfAtlas::get_pixels() const {
+    return _pixels;
+}
+
+SdfGlyph const& SdfAtlas::get_glyph(char c) const {
+    if (c < stroke_font::FIRST_CHAR || c > stroke_font::LAST_CHAR) {
+        c = '?';
+    }
+    return _glyphs[c - stroke_font::FIRST_CHAR];
+}
+
+void SdfAtlas::rasterize(u32 glyph_index) {
+    std::vector<StrokeSegment> segments;
+    stroke_font::get_segments(static_cast<char>(stroke_font::FIRST_CHAR + glyph_index), segments);
+
+    if (segments.empty()) {
+        return;
+    }
+
+    u32 cell_x = (glyph_index % COLUMNS) * _cell_width;
+    u32 cell_y = (glyph_index / COLUMNS) * _cell_height;
+    f32 const half_width = stroke_font::STROKE_WIDTH * 0.5f;
+
+    for (u32 y = 0; y < _cell_height; ++y) {
+        u8* row = &_pixels[static_cast<std::size_t>(cell_y + y) * _width + cell_x];
+
+        for (u32 x = 0; x < _cell_width; ++x) {
+            // Texel centers in font units, the top row being the top of the cell.
+            vec2 p{
+                CELL_MIN.x + (static_cast<f32>(x) + 0.5f) / PIXELS_PER_UNIT,
+                CELL_MAX.y - (static_cast<f32>(y) + 0.5f) / PIXELS_PER_UNIT
+            };
+
+            f32 distance = PADDING;
+            for (auto const& segment : segments) {
+                distance = std::min(distance, distance_to_segment(p, segment) - half_width);
+            }
+
+            f32 value = std::clamp(0.5f - distance / (2.0f * PADDING), 0.0f, 1.0f);
+            row[x] = static_cast<u8>(std::lround(value * 255.0f));
+        }
+    }
+}
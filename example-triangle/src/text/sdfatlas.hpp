@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+
+#include <math/vector.hpp>
+#include <text/strokefont.hpp>
+#include <util/base.hpp>
+
+// Texture coordinates of one glyph cell in the atlas.
+struct SdfGlyph {
+    f32 u0, v0;
+    f32 u1, v1;
+};
+
+/*
+ * Single channel signed distance field atlas of the stroke font. Every glyph gets a cell
+ * covering its box plus PADDING font units on each side. Texels store 0.5 on the stroke
+ * outline, rising towards 1 inside and falling to 0 at PADDING units outside, so the text
+ * stays sharp at any scale when thresholded in the fragment shader.
+ *
+ * Glyphs are rasterized in parallel on the global JobSystem, one job per glyph.
+ */
+class SdfAtlas {
+public:
+    static constexpr u32 PIXELS_PER_UNIT = 4;
+    static constexpr f32 PADDING = 2.0f;
+    static constexpr u32 COLUMNS = 16;
+
+    // Glyph cell bounds in font units.
+    static constexpr vec2 CELL_MIN{-PADDING, -PADDING};
+    static constexpr vec2 CELL_MAX{stroke_font::GLYPH_WIDTH + PADDING, stroke_font::GLYPH_HEIGHT + PADDING};
+
+    SdfAtlas();
+
+public:
+    void build();
+
+public:
+    NODISCARD bool is_built() const;
+    NODISCARD u32 get_width() const;
+    NODISCARD u32 get_height() const;
+    // Row 0 is the top row of the first glyph row, which is also how they are uploaded.
+    NODISCARD std::vector<u8> const& get_pixels() const;
+
+    // Characters outside the font map to '?'.
+    NODISCARD SdfGlyph const& get_glyph(char c) const;
+
+private:
+    void rasterize(u32 glyph_index);
+
+private:
+    u32 _cell_width;
+    u32 _cell_height;
+    u32 _width;
+    u32 _height;
+    std::vector<u8> _pixels;
+    std::vector<SdfGlyph> _glyphs;
+};
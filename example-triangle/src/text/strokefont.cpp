@@ -0,0 +1,142 @@
+#include "strokefont.hpp"
+
+namespace {
+    /*
+     * One string per character from ' ' to '~'. Polylines are separated by '|', points by
+     * spaces, and every point is two base-17 digits (0-9, a-g) for x and y.
+     */
+    char const* const GLYPHS[] = {
+        "",                                                          // ' '
+        "4g 48|45 44",                                               // !
+        "2g 2d|6g 6d",                                               // "
+        "25 3f|55 6f|08 88|0c 8c",                                   // #
+        "8d 6e 2e 0c 2a 6a 88 66 26 07|4g 44",                       // $
+        "04 8g|0g 2g 2d 0d 0g|67 87 84 64 67",                       // %
+        "84 1c 1f 2g 4g 5f 5d 08 06 24 54 88",                       // &
+        "4g 4d",                                                     // '
+        "5g 3d 37 54",                                               // (
+        "3g 5d 57 34",                                               // )
+        "4e 48|1d 79|19 7d",                                         // *
+        "4d 45|09 89",                                               // +
+        "45 44 32",                                                  // ,
+        "19 79",                                                     // -
+        "45 44",                                                     // .
+        "04 8g",                                                     // /
+        "24 64 86 8e 6g 2g 0e 06 24|16 7e",                          // 0
+        "2d 4g 44|24 64",                                            // 1
+        "0e 2g 6g 8e 8c 04 84",                                      // 2
+        "0e 2g 6g 8e 8c 6a 3a|6a 88 86 64 24 06",                    // 3
+        "64 6g 08 88",                                               // 4
+        "8g 0g 0b 6b 89 86 64 24 06",                                // 5
+        "7g 3g 0d 06 24 64 86 89 6b 0b",                             // 6
+        "0g 8g 34",                                                  // 7
+        "2a 0c 0e 2g 6g 8e 8c 6a 2a 08 06 24 64 86 88 6a",           // 8
+        "89 29 0b 0e 2g 6g 8e 87 54 14",                             // 9
+        "4c 4b|45 44",                                               // :
+        "4c 4b|45 44 32",                                            // ;
+        "7e 19 74",                                                  // <
+        "1b 7b|17 77",                                               // =
+        "1e 79 14",                                                  // >
+        "0e 2g 6g 8e 8c 49 47|45 44",                                // ?
+        "67 6c 3c 2b 28 37 87 8e 6g 2g 0e 06 24 74",                 // @
+        "04 0c 4g 8c 84|09 89",                                      // A
+        "04 0g 6g 8e 8c 6a 0a|6a 88 86 64 04",                       // B
+        "8e 6g 2g 0e 06 24 64 86",                                   // C
+        "04 0g 5g 8d 87 54 04",                                      // D
+        "8g 0g 04 84|0a 6a",                                         // E
+        "8g 0g 04|0a 6a",                                            // F
+        "8e 6g 2g 0e 06 24 64 86 89 59",                             // G
+        "04 0g|84 8g|0a 8a",                                         // H
+        "2g 6g|4g 44|24 64",                                         // I
+        "8g 86 64 24 06",                                            // J
+        "04 0g|8g 08|3b 84",                                         // K
+        "0g 04 84",                                                  // L
+        "04 0g 4a 8g 84",                                            // M
+        "04 0g 84 8g",                                               // N
+        "24 64 86 8e 6g 2g 0e 06 24",                                // O
+        "04 0g 6g 8e 8b 69 09",                                      // P
+        "24 64 86 8e 6g 2g 0e 06 24|57 84",                          // Q
+        "04 0g 6g 8e 8b 69 09|49 84",                                // R
+        "8e 6g 2g 0e 0c 2a 6a 88 86 64 24 06",                       // S
+        "0g 8g|4g 44",                                               // T
+        "0g 06 24 64 86 8g",                                         // U
+        "0g 44 8g",                                                  // V
+        "0g 14 4a 74 8g",                                            // W
+        "0g 84|8g 04",                                               // X
+        "0g 4a 8g|4a 44",                                            // Y
+        "0g 8g 04 84",                                               // Z
+        "6g 3g 34 64",                                               // [
+        "0g 84",                                                     // backslash
+        "2g 5g 54 24",                                               // ]
+        "1c 4g 7c",                                                  // ^
+        "02 82",                                                     // _
+        "3g 5d",                                                     // `
+        "1c 6c 8a 84|88 28 07 05 14 64 86",                          // a
+        "0g 04 64 86 8a 6c 0c",                                      // b
+        "8c 2c 0a 06 24 84",                                         // c
+        "8g 84 24 06 0a 2c 8c",                                      // d
+        "08 88 8a 6c 2c 0a 06 24 74",                                // e
+        "7g 5g 3e 34|0b 6b",                                         // f
+        "8c 82 60 10|8c 2c 0a 06 24 84",                             // g
+        "0g 04|0c 6c 8a 84",                                         // h
+        "2c 4c 44|24 64|4f 4e",                                      // i
+        "3c 6c 62 40 10|6f 6e",                                      // j
+        "0g 04|7c 07|28 84",                                         // k
+        "2g 4g 44|24 64",                                            // l
+        "04 0c 3c 4b 44|4b 5c 7c 8b 84",                             // m
+        "04 0c 6c 8a 84",                                            // n
+        "24 64 86 8a 6c 2c 0a 06 24",                                // o
+        "00 0c 6c 8a 86 64 04",                                      // p
+        "80 8c 2c 0a 06 24 84",                                      // q
+        "04 0c|09 3c 8c",                                            // r
+        "8c 2c 0b 09 18 78 87 85 74 04",                             // s
+        "3g 36 54 74|0c 7c",                                         // t
+        "0c 06 24 84 8c",                                            // u
+        "0c 44 8c",                                                  // v
+        "0c 24 49 64 8c",                                            // w
+        "0c 84|04 8c",                                               // x
+        "0c 06 24 84|8c 82 60 10",                                   // y
+        "0c 8c 04 84",                                               // z
+        "6g 4f 4b 2a 49 45 64",                                      // {
+        "4g 42",                                                     // |
+        "2g 4f 4b 6a 49 45 24",                                      // }
+        "09 2b 69 8b",                                               // ~
+    };
+
+    constexpr u32 decode(char digit) {
+        return digit <= '9' ? static_cast<u32>(digit - '0') : static_cast<u32>(digit - 'a' + 10);
+    }
+}
+
+namespace stroke_font {
+    void get_segments(char c, std::vector<StrokeSegment>& out) {
+        if (c < FIRST_CHAR || c > LAST_CHAR) {
+            return;
+        }
+
+        char const* cursor = GLYPHS[c - FIRST_CHAR];
+        bool has_previous = false;
+        vec2 previous;
+
+        while (*cursor) {
+            if (*cursor == '|') {
+                has_previous = false;
+                ++cursor;
+                continue;
+            }
+            if (*cursor == ' ') {
+                ++cursor;
+                continue;
+            }
+
+            vec2 point{static_cast<f32>(decode(cursor[0])), static_cast<f32>(decode(cursor[1]))};
+            cursor += 2;
+
+            if (has_previous) {
+                out.push_back({previous, point});
+            }
+            previous = point;
+            has_previous = true;
+        }
+    }
+}
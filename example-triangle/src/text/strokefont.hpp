@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+#include <math/vector.hpp>
+#include <util/base.hpp>
+
+struct StrokeSegment {
+    vec2 a;
+    vec2 b;
+};
+
+/*
+ * Built-in monospaced stroke font for printable ASCII, so text needs no font files. Glyphs are
+ * polylines in font units: x in [0, 8], baseline at y = 4, lowercase height y = 12, cap height
+ * y = 16 and descenders down to y = 0. Strokes are STROKE_WIDTH wide.
+ */
+namespace stroke_font {
+    constexpr char FIRST_CHAR = ' ';
+    constexpr char LAST_CHAR = '~';
+    constexpr u32 GLYPH_COUNT = LAST_CHAR - FIRST_CHAR + 1;
+
+    constexpr f32 GLYPH_WIDTH = 8.0f;
+    constexpr f32 GLYPH_HEIGHT = 16.0f;
+    constexpr f32 ADVANCE = 11.0f;
+    constexpr f32 LINE_HEIGHT = 22.0f;
+    // Top of a line box, leaving room for the strokes above the cap height.
+    constexpr f32 LINE_TOP = 19.0f;
+    constexpr f32 STROKE_WIDTH = 1.6f;
+
+    // Appends the segments of c. Characters outside the font have none.
+    void get_segments(char c, std::vector<StrokeSegment>& out);
+}
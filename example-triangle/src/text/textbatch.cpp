@@ -0,0 +1,98 @@
+#include "textbatch.hpp"
+
+TextBatch::TextBatch(SdfAtlas const& atlas) :
+    _atlas{atlas},
+    _runs{},
+    _vertices{},
+    _frame{0} {
+
+}
+
+void TextBatch::begin_frame() {
+    _vertices.clear();
+    ++_frame;
+
+    if (_frame % EVICT_FRAMES == 0) {
+        for (auto it = _runs.begin(); it != _runs.end();) {
+            if (it->second.last_frame + EVICT_FRAMES < _frame) {
+                it = _runs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void TextBatch::add(std::string const& text, f32 x, f32 y, f32 line_height, Rgba8 color) {
+    ShapedRun& run = shape(text);
+    run.last_frame = _frame;
+
+    f32 scale = line_height / stroke_font::LINE_HEIGHT;
+
+    std::size_t first = _vertices.size();
+    _vertices.resize(first + run.glyphs.size() * 4);
+    Vertex* out = &_vertices[first];
+
+    for (auto const& glyph : run.glyphs) {
+        f32 x0 = x + glyph.x0 * scale;
+        f32 y0 = y + glyph.y0 * scale;
+        f32 x1 = x + glyph.x1 * scale;
+        f32 y1 = y + glyph.y1 * scale;
+
+        out[0] = {x0, y0, glyph.uv.u0, glyph.uv.v0, color.r, color.g, color.b, color.a};
+        out[1] = {x1, y0, glyph.uv.u1, glyph.uv.v0, color.r, color.g, color.b, color.a};
+        out[2] = {x1, y1, glyph.uv.u1, glyph.uv.v1, color.r, color.g, color.b, color.a};
+        out[3] = {x0, y1, glyph.uv.u0, glyph.uv.v1, color.r, color.g, color.b, color.a};
+        out += 4;
+    }
+}
+
+void TextBatch::clear_cache() {
+    _runs.clear();
+}
+
+std::vector<Vertex> const& TextBatch::get_vertices() const {
+    return _vertices;
+}
+
+u32 TextBatch::get_glyph_count() const {
+    return static_cast<u32>(_vertices.size() / 4);
+}
+
+std::size_t TextBatch::get_cached_run_count() const {
+    return _runs.size();
+}
+
+TextBatch::ShapedRun& TextBatch::shape(std::string const& text) {
+    auto [it, inserted] = _runs.try_emplace(text);
+    ShapedRun& run = it->second;
+
+    if (!inserted) {
+        return run;
+    }
+
+    f32 pen_x = 0.0f;
+    f32 line_top = stroke_font::LINE_TOP;
+
+    for (char c : text) {
+        if (c == '\n') {
+            pen_x = 0.0f;
+            line_top += stroke_font::LINE_HEIGHT;
+            continue;
+        }
+
+        if (c != ' ') {
+            run.glyphs.push_back({
+                pen_x + SdfAtlas::CELL_MIN.x,
+                line_top - SdfAtlas::CELL_MAX.y,
+                pen_x + SdfAtlas::CELL_MAX.x,
+                line_top - SdfAtlas::CELL_MIN.y,
+                _atlas.get_glyph(c)
+            });
+        }
+
+        pen_x += stroke_font::ADVANCE;
+    }
+
+    return run;
+}
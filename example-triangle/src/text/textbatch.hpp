@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <render/vertex.hpp>
+#include <text/sdfatlas.hpp>
+#include <util/base.hpp>
+
+/*
+ * Collects all text of a frame into one vertex stream, four vertices per glyph, to be drawn
+ * by TextRenderer with a single call.
+ *
+ * Laying out a string is cached by its contents, so labels that stay the same from frame to
+ * frame only cost a scale, offset and copy per glyph. Runs that have not been drawn for
+ * EVICT_FRAMES frames are dropped again.
+ */
+class TextBatch {
+public:
+    static constexpr u64 EVICT_FRAMES = 120;
+
+    explicit TextBatch(SdfAtlas const& atlas);
+
+public:
+    // Clears the vertices of the previous frame.
+    void begin_frame();
+
+    // Adds text with the top left corner of its first line at (x, y) in pixels. '\n' starts a new line.
+    void add(std::string const& text, f32 x, f32 y, f32 line_height, Rgba8 color);
+
+    void clear_cache();
+
+public:
+    NODISCARD std::vector<Vertex> const& get_vertices() const;
+    NODISCARD u32 get_glyph_count() const;
+    NODISCARD std::size_t get_cached_run_count() const;
+
+private:
+    // One glyph quad in font units, relative to the top left corner of the run with y pointing down.
+    struct ShapedGlyph {
+        f32 x0, y0;
+        f32 x1, y1;
+        SdfGlyph uv;
+    };
+
+    struct ShapedRun {
+        std::vector<ShapedGlyph> glyphs;
+        u64 last_frame;
+    };
+
+    NODISCARD ShapedRun& shape(std::string const& text);
+
+private:
+    SdfAtlas const& _atlas;
+    std::unordered_map<std::string, ShapedRun> _runs;
+    std::vector<Vertex> _vertices;
+    u64 _frame;
+};
@@ -0,0 +1,54 @@
+#include "precisesleep.hpp"
+
+#include <cmath>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::chrono::milliseconds SLEEP_STEP{1};
+
+    // Running mean and variance of how long a SLEEP_STEP sleep really takes, in seconds (Welford).
+    struct SleepEstimate {
+        f64 mean = 0.002;
+        f64 m2 = 0.0;
+        u64 count = 1;
+
+        void add(f64 seconds) {
+            ++count;
+            f64 delta = seconds - mean;
+            mean += delta / static_cast<f64>(count);
+            m2 += delta * (seconds - mean);
+
+            // Forget old samples slowly, so the estimate follows changes in system load.
+            if (count > 1000) {
+                count = 500;
+                m2 *= 0.5;
+            }
+        }
+
+        NODISCARD f64 get_threshold() const {
+            return mean + std::sqrt(m2 / static_cast<f64>(count));
+        }
+    };
+
+    thread_local SleepEstimate sleep_estimate;
+}
+
+void precise_sleep_until(Clock::time_point deadline) {
+    while (true) {
+        auto now = Clock::now();
+        f64 remaining = std::chrono::duration<f64>(deadline - now).count();
+
+        if (remaining <= sleep_estimate.get_threshold()) {
+            break;
+        }
+
+        std::this_thread::sleep_for(SLEEP_STEP);
+        sleep_estimate.add(std::chrono::duration<f64>(Clock::now() - now).count());
+    }
+
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
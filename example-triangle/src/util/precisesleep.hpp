@@ -0,0 +1,15 @@
+#pragma once
+
+#include <chrono>
+
+#include <util/base.hpp>
+
+/*
+ * Sleeps until deadline with sub-millisecond accuracy.
+ *
+ * Sleeping in the OS overshoots by a scheduler dependent amount, often a millisecond or more,
+ * while spinning the whole time burns a core. This sleeps in 1 ms steps as long as the time
+ * left is above the overshoot observed so far (mean plus one standard deviation, tracked per
+ * thread), and spins with yields for the rest.
+ */
+void precise_sleep_until(std::chrono::steady_clock::time_point deadline);
@@ -0,0 +1,94 @@
+#include "latency_histogram.hpp"
+
+#include <cstdio>
+
+void LatencyHistogram::record(f64 seconds)
+{
+    f64 ms = seconds > 0.0 ? seconds * 1000.0 : 0.0;
+
+    u32 bucket = (u32)(ms / BUCKET_MS);
+    if (bucket >= BUCKET_COUNT)
+        bucket = BUCKET_COUNT - 1;
+
+    ++_buckets[bucket];
+    ++_count;
+    _sum_ms += ms;
+    if (ms > _max_ms)
+        _max_ms = ms;
+}
+
+void LatencyHistogram::clear()
+{
+    *this = LatencyHistogram();
+}
+
+u64 LatencyHistogram::count() const
+{
+    return _count;
+}
+
+f64 LatencyHistogram::mean_ms() const
+{
+    return _count ? _sum_ms / _count : 0.0;
+}
+
+f64 LatencyHistogram::max_ms() const
+{
+    return _max_ms;
+}
+
+f64 LatencyHistogram::percentile_ms(f64 fraction) const
+{
+    if (!_count)
+        return 0.0;
+
+    // The first bucket at which at least fraction of all samples have been seen.
+    u64 target = (u64)(fraction * _count + 0.5);
+    if (target < 1)
+        target = 1;
+
+    u64 seen = 0;
+    for (u32 i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += _buckets[i];
+        if (seen >= target)
+            return i == BUCKET_COUNT - 1 ? _max_ms : (i + 1) * BUCKET_MS;
+    }
+
+    return _max_ms;
+}
+
+void LatencyHistogram::print(const char* title) const
+{
+    printf("%s: %llu samples", title, (unsigned long long)_count);
+    if (!_count)
+    {
+        printf("\n");
+        return;
+    }
+
+    printf(", mean %.2f ms, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.2f ms\n",
+           mean_ms(), percentile_ms(0.5), percentile_ms(0.95), percentile_ms(0.99), _max_ms);
+
+    // Rows [0, 1), [1, 2), [2, 4), ... [128, 256) milliseconds, up to the slowest sample.
+    const u32 BAR_WIDTH = 40;
+    f64 row_start = 0.0, row_end = 1.0;
+    u32 bucket = 0;
+
+    while (bucket < BUCKET_COUNT && row_start <= _max_ms)
+    {
+        u64 row_count = 0;
+        for (; bucket < BUCKET_COUNT && bucket * BUCKET_MS < row_end - BUCKET_MS / 2; ++bucket)
+            row_count += _buckets[bucket];
+
+        char bar[BAR_WIDTH + 1] = {};
+        u32 bar_length = (u32)((row_count * BAR_WIDTH + _count - 1) / _count);
+        for (u32 i = 0; i < bar_length; ++i)
+            bar[i] = '#';
+
+        printf("  %5.0f - %5.0f ms %8llu %s\n", row_start, row_end, (unsigned long long)row_count, bar);
+
+        row_start = row_end;
+        row_end *= 2.0;
+    }
+}
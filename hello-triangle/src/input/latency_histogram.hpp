@@ -0,0 +1,29 @@
+#pragma once
+
+#include <util/types.hpp>
+
+// Collects latencies in 0.1 ms wide buckets up to 250 ms, slower samples all land in the last bucket.
+class LatencyHistogram {
+public:
+    void record(f64 seconds);
+    void clear();
+
+    u64 count() const;
+    f64 mean_ms() const;
+    f64 max_ms() const;
+
+    // Upper bound of the bucket holding the given fraction (0..1) of all samples, in milliseconds.
+    f64 percentile_ms(f64 fraction) const;
+
+    // Prints the summary and a bar per power of two milliseconds.
+    void print(const char* title) const;
+
+private:
+    static const u32 BUCKET_COUNT = 2500;
+    static constexpr f64 BUCKET_MS = 0.1;
+
+    u64 _buckets[BUCKET_COUNT] = {};
+    u64 _count = 0;
+    f64 _sum_ms = 0.0;
+    f64 _max_ms = 0.0;
+};
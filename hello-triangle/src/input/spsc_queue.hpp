@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+
+#include <util/types.hpp>
+
+// Lock-free ring buffer between exactly one producer thread and one consumer thread.
+// One slot always stays empty to tell a full ring from an empty one, so it holds CAPACITY - 1 items.
+template<typename T, u32 CAPACITY>
+class SpscQueue {
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // Producer only. Returns false instead of blocking when the ring is full.
+    bool push(const T& item)
+    {
+        u32 head = _head.load(std::memory_order_relaxed);
+        u32 next = (head + 1) & (CAPACITY - 1);
+
+        if (next == _cached_tail)
+        {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            if (next == _cached_tail)
+                return false;
+        }
+
+        _items[head] = item;
+        _head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns the oldest item without removing it, or nullptr when the ring is empty.
+    const T* front()
+    {
+        u32 tail = _tail.load(std::memory_order_relaxed);
+
+        if (tail == _cached_head)
+        {
+            _cached_head = _head.load(std::memory_order_acquire);
+            if (tail == _cached_head)
+                return nullptr;
+        }
+
+        return &_items[tail];
+    }
+
+    // Consumer only. Returns false when the ring is empty.
+    bool pop(T& item)
+    {
+        const T* oldest = front();
+        if (!oldest)
+            return false;
+
+        item = *oldest;
+        _tail.store((_tail.load(std::memory_order_relaxed) + 1) & (CAPACITY - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    // The producer and the consumer each own a cache line, holding their index and
+    // their last seen copy of the other's index, so they only touch shared lines when needed.
+    alignas(64) std::atomic<u32> _head{ 0 };
+    u32 _cached_tail = 0;
+
+    alignas(64) std::atomic<u32> _tail{ 0 };
+    u32 _cached_head = 0;
+
+    alignas(64) T _items[CAPACITY];
+};
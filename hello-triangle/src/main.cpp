@@ -1,8 +1,22 @@
 #include <iostream>
 #include <string>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <vector>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <input/latency_histogram.hpp>
+#include <occlusion/occlusion_culler.hpp>
+#include <session/frame_times.hpp>
+#include <session/golden_images.hpp>
+#include <session/session.hpp>
+#include <simulation/simulation.hpp>
+#include <tessellation/benchmark.hpp>
+#include <tessellation/tessellator.hpp>
 #include <util/types.hpp>
 
 static const char* WINDOW_TITLE = "Learn OpenGL";
@@ -22,12 +36,9 @@ enum StatusCode {
     GLFW_ERROR,
     GLEW_ERROR,
     SHADER_ERROR,
-};
-
-enum Shape {
-    TRIANGLE = 0,
-    HEXAGON,
-    DEFAULT = TRIANGLE,
+    SESSION_ERROR,
+    GOLDEN_IMAGE_MISMATCH,
+    PERFORMANCE_REGRESSION,
 };
 
 // Type safety for OpenGL shader enums.
@@ -47,11 +58,20 @@ struct Color {
 // There probably is a better way to hold the program's state than through
 // global variables. But for now, this suffices.
 
-// Global state variable used to determine which shape should be drawn.
-Shape g_drawn_shape = Shape::DEFAULT;
+// Global simulation, which owns the shape to draw and the wireframe modes. It is fed by the key callback.
+Simulation g_simulation;
+
+// Frames of a playback compared against golden images: every GOLDEN_FRAME_INTERVAL-th and the last one.
+static const u64 GOLDEN_FRAME_INTERVAL = 60;
 
-// Global state variables used for handling wireframe mode.
-bool g_wire_mode = false, g_poll_w_key = true;
+// Global state variables holding the framebuffer size, needed to draw wireframe lines in pixels.
+// Written by the event thread, the render thread applies them to the viewport.
+std::atomic<i32> g_viewport_width{ 800 }, g_viewport_height{ 600 };
+
+// Global session recorder and player. While a session is played back, it replaces the keyboard and the
+// window size, the window's own events are ignored.
+SessionRecorder g_session_recorder;
+SessionPlayer g_session_player;
 
 char* load_shader_source(const char* file_name)
 {
@@ -68,8 +88,10 @@ char* load_shader_source(const char* file_name)
     if (!file_size)
         return nullptr;
 
-    char* shader_source = (char*)malloc(file_size);
+    // glShaderSource() expects a null-terminated string.
+    char* shader_source = (char*)malloc(file_size + 1);
     fread(shader_source, file_size, 1, shader_file);
+    shader_source[file_size] = '\0';
     fclose(shader_file);
 
     return shader_source;
@@ -100,35 +122,369 @@ bool load_shader(GLuint* shader, const char* file_name, ShaderType shader_type)
 
 void handle_resize(GLFWwindow* window, i32 width, i32 height)
 {
-    glViewport(0, 0, width, height);
+    if (g_session_player.is_loaded())
+        return;
+
+    g_viewport_width = width;
+    g_viewport_height = height;
+    g_session_recorder.record_resize(width, height);
+}
+
+// Key presses are handed to the simulation thread as they arrive instead of polling the keys once per frame.
+// What the keys do is up to Simulation::apply().
+void handle_key(GLFWwindow* window, i32 key, i32 scancode, i32 action, i32 mods)
+{
+    if (g_session_player.is_loaded())
+        return;
+
+    if (!g_simulation.push_input({ key, action, glfwGetTime() }))
+        std::cout << "Input queue full, dropped key event." << std::endl;
+    else
+        g_session_recorder.record_key(key, action);
+}
+
+// Hands the events recorded for a frame to the simulation and waits until they have been applied, so
+// every playback of a session draws the same state in the same frame. Called from the render thread.
+void play_back_events(const SessionFrame& frame)
+{
+    u64 pushed = g_simulation.get_state().sequence;
+
+    for (const SessionEvent& event : frame.events)
+    {
+        if (event.type == SessionEventType::RESIZE_EVENT)
+        {
+            g_viewport_width = event.width;
+            g_viewport_height = event.height;
+            continue;
+        }
+
+        // A full queue only means the simulation has to catch up first.
+        while (!g_simulation.push_input({ event.key, event.action, glfwGetTime() }))
+            std::this_thread::yield();
+        ++pushed;
+    }
+
+    while (g_simulation.get_state().sequence < pushed)
+        std::this_thread::yield();
+}
+
+// Compares drawing a dense mesh filled, as lines with glPolygonMode() and filled with the shader
+// wireframe overlay. Run with `hello-triangle.out --bench-wireframe`.
+void run_wireframe_benchmark(GLFWwindow* window, GLuint shader_program)
+{
+    // 400 stars with 64 spikes each fill the window with about 50000 triangles.
+    std::vector<Polygon> stars;
+    for (u32 y = 0; y < 20; ++y)
+    {
+        for (u32 x = 0; x < 20; ++x)
+        {
+            Polygon star;
+            std::vector<Point2D> outline;
+            for (u32 i = 0; i < 128; ++i)
+            {
+                f32 angle = 3.14159265f * i / 64;
+                f32 radius = (i % 2 == 0) ? 0.05f : 0.03f;
+                outline.push_back({ -0.95f + x * 0.1f + radius * cosf(angle), -0.95f + y * 0.1f + radius * sinf(angle) });
+            }
+            star.rings.push_back(outline);
+            stars.push_back(star);
+        }
+    }
+
+    std::vector<const Polygon*> star_pointers;
+    for (const Polygon& star : stars)
+        star_pointers.push_back(&star);
+
+    std::vector<Vec3D> vertices;
+    std::vector<GLuint> indices;
+    for (const TriangleMesh& mesh : tessellate_parallel(star_pointers))
+    {
+        GLuint base_vertex = vertices.size();
+        for (const Point2D& point : mesh.vertices)
+            vertices.push_back({ point.x, point.y, 0.0f });
+        for (u32 index : mesh.indices)
+            indices.push_back(base_vertex + index);
+    }
+
+    GLuint vao, vbo, ebo;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vec3D), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3D), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glUseProgram(shader_program);
+    glUniform2f(glGetUniformLocation(shader_program, "viewportSize"), (f32)g_viewport_width, (f32)g_viewport_height);
+    glUniform4f(glGetUniformLocation(shader_program, "ourColor"), 1.0f, 0.5f, 0.2f, 1.0f);
+    GLint wireframe_location = glGetUniformLocation(shader_program, "wireframe");
+
+    // Don't wait for vertical sync, the frames are timed.
+    glfwSwapInterval(0);
+
+    printf("%s\n", glGetString(GL_RENDERER));
+    printf("%zu triangles, %dx%d pixels\n", indices.size() / 3, g_viewport_width.load(), g_viewport_height.load());
+
+    const char* mode_names[] = { "fill", "glPolygonMode(GL_LINE)", "fill + shader wireframe" };
+    const u32 frames = 100;
+
+    for (u32 mode = 0; mode < 3; ++mode)
+    {
+        glPolygonMode(GL_FRONT_AND_BACK, mode == 1 ? GL_LINE : GL_FILL);
+        glUniform1i(wireframe_location, mode == 2);
+
+        glFinish();
+        f64 start = glfwGetTime();
+
+        for (u32 frame = 0; frame < frames; ++frame)
+        {
+            glClear(GL_COLOR_BUFFER_BIT);
+            glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+            glfwSwapBuffers(window);
+        }
+
+        glFinish();
+        f64 elapsed = glfwGetTime() - start;
+        printf("  %-26s %8.3f ms per frame\n", mode_names[mode], elapsed * 1000.0 / frames);
+    }
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+    glDeleteVertexArrays(1, &vao);
 }
 
-void handle_inputs(GLFWwindow* window)
+// Compares drawing a grid of dense stars behind a moving wall as they are and with occlusion culling.
+// Run with `hello-triangle.out --bench-occlusion`.
+void run_occlusion_benchmark(GLFWwindow* window, GLuint shader_program)
 {
-    // Close window when ESC key was pressed.
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+    // 400 stars with 256 spikes each, about 200000 triangles behind the wall (nearer is smaller z).
+    const f32 STAR_Z = 0.5f, WALL_Z = -0.5f, STAR_RADIUS = 0.045f;
+
+    std::vector<Polygon> stars;
+    std::vector<Point2D> centers;
+    for (u32 y = 0; y < 20; ++y)
+    {
+        for (u32 x = 0; x < 20; ++x)
+        {
+            Point2D center = { -0.95f + x * 0.1f, -0.95f + y * 0.1f };
+            Polygon star;
+            std::vector<Point2D> outline;
+            for (u32 i = 0; i < 512; ++i)
+            {
+                f32 angle = 3.14159265f * i / 256;
+                f32 radius = (i % 2 == 0) ? STAR_RADIUS : 0.6f * STAR_RADIUS;
+                outline.push_back({ center.x + radius * cosf(angle), center.y + radius * sinf(angle) });
+            }
+            star.rings.push_back(outline);
+            stars.push_back(star);
+            centers.push_back(center);
+        }
+    }
+
+    std::vector<const Polygon*> star_pointers;
+    for (const Polygon& star : stars)
+        star_pointers.push_back(&star);
+
+    // The wall comes first in the vertex buffer, a quad moved by rewriting its vertices.
+    std::vector<Vec3D> vertices(4);
+    std::vector<GLuint> indices = { 0, 1, 2, 0, 2, 3 };
+    std::vector<GLsizei> star_counts;
+    std::vector<size_t> star_offsets;
+    std::vector<OcclusionBounds> star_bounds;
+    for (const TriangleMesh& mesh : tessellate_parallel(star_pointers))
+    {
+        GLuint base_vertex = vertices.size();
+        star_counts.push_back(mesh.indices.size());
+        star_offsets.push_back(indices.size() * sizeof(GLuint));
+        for (const Point2D& point : mesh.vertices)
+            vertices.push_back({ point.x, point.y, STAR_Z });
+        for (u32 index : mesh.indices)
+            indices.push_back(base_vertex + index);
+    }
+
+    for (const Point2D& center : centers)
+        star_bounds.push_back({ center.x - STAR_RADIUS, center.y - STAR_RADIUS, STAR_Z,
+                                center.x + STAR_RADIUS, center.y + STAR_RADIUS, STAR_Z });
+
+    GLuint vao, vbo, ebo;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vec3D), vertices.data(), GL_DYNAMIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3D), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    auto move_wall = [&](f32 offset) {
+        Vec3D wall[4] = {
+            { offset - 0.55f, -0.8f, WALL_Z }, { offset + 0.55f, -0.8f, WALL_Z },
+            { offset + 0.55f,  0.8f, WALL_Z }, { offset - 0.55f,  0.8f, WALL_Z },
+        };
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(wall), wall);
+    };
+
+    OcclusionCuller culler;
+    culler.init(star_bounds);
+
+    glUseProgram(shader_program);
+    glUniform2f(glGetUniformLocation(shader_program, "viewportSize"), (f32)g_viewport_width, (f32)g_viewport_height);
+    glUniform1i(glGetUniformLocation(shader_program, "wireframe"), 0);
+    GLint color_location = glGetUniformLocation(shader_program, "ourColor");
 
-    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
-        g_drawn_shape = Shape::TRIANGLE;
+    glEnable(GL_DEPTH_TEST);
+    glfwSwapInterval(0);
 
-    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
-        g_drawn_shape = Shape::HEXAGON;
+    printf("%s\n", glGetString(GL_RENDERER));
+    printf("%zu triangles in %zu stars, %dx%d pixels\n", (indices.size() - 6) / 3, stars.size(),
+           g_viewport_width.load(), g_viewport_height.load());
 
-    // Toggle logic for enabling / disabling wireframe mode.
-    u16 w_key_status = glfwGetKey(window, GLFW_KEY_W);
-    if (g_poll_w_key && w_key_status == GLFW_PRESS)
+    const char* mode_names[] = { "draw everything", "occlusion culling" };
+    const u32 frames = 300;
+
+    for (u32 mode = 0; mode < 2; ++mode)
     {
-        g_poll_w_key = false;
-        g_wire_mode = !g_wire_mode;
-        glPolygonMode(GL_FRONT_AND_BACK, g_wire_mode ? GL_LINE : GL_FILL);
+        glFinish();
+        f64 start = glfwGetTime();
+
+        for (u32 frame = 0; frame < frames; ++frame)
+        {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // The wall sweeps across the grid and back, so stars keep appearing and disappearing.
+            glBindVertexArray(vao);
+            move_wall(0.5f * sinf(frame * 0.05f));
+            glUniform4f(color_location, 0.3f, 0.3f, 0.35f, 1.0f);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
+
+            glUniform4f(color_location, 1.0f, 0.5f, 0.2f, 1.0f);
+            if (mode == 1)
+                culler.begin_frame();
+
+            for (u32 i = 0; i < stars.size(); ++i)
+            {
+                if (mode == 1)
+                {
+                    culler.begin_draw(i);
+                    glBindVertexArray(vao);
+                }
+
+                glDrawElements(GL_TRIANGLES, star_counts[i], GL_UNSIGNED_INT, (void*)star_offsets[i]);
+
+                if (mode == 1)
+                    culler.end_draw(i);
+            }
+
+            glfwSwapBuffers(window);
+        }
+
+        glFinish();
+        f64 elapsed = glfwGetTime() - start;
+        printf("  %-20s %8.3f ms per frame\n", mode_names[mode], elapsed * 1000.0 / frames);
     }
-    else if (w_key_status == GLFW_RELEASE)
-        g_poll_w_key = true;
+
+    culler.print("  Occlusion culling");
+
+    glDisable(GL_DEPTH_TEST);
+    culler.destroy();
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+    glDeleteVertexArrays(1, &vao);
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+        return run_tessellation_benchmark();
+
+    // Run with `hello-triangle.out --record <file>` to write the keys pressed and the frame clock to a session
+    // file, and with `--playback <file> [--frame-times <file>]` to replay it as a benchmark: in a hidden
+    // window, without waiting for vertical sync, printing the time every frame took. `--draw-repeat <count>` draws
+    // the shape that many times a frame, to give a playback enough work to time.
+    //
+    // A playback doubles as a regression test, which fails with a non-zero exit code:
+    // `--golden <directory> [--golden-tolerance <percent>]` compares frames against the golden images in the
+    // directory, and `--baseline <file> [--max-regression <percent>]` the frame times against a baseline.
+    // A missing golden image or baseline fails too: `--update` stores the frames and frame times of the run as
+    // the new golden images and baseline instead. Frames that fail are written next to their golden images, or
+    // to `--failure-dir <directory>`. Frame times depend on the machine, so a baseline can be kept per machine:
+    // `--store-missing-baseline` stores the frame times as the baseline when there is none yet, and later runs
+    // compare against it. Runs without a GPU on Mesa's llvmpipe, e.g. with LIBGL_ALWAYS_SOFTWARE=1. CTest plays
+    // back the sessions in tests/.
+    const char* record_file_name = nullptr;
+    const char* playback_file_name = nullptr;
+    const char* frame_times_file_name = nullptr;
+    const char* golden_directory = nullptr;
+    const char* failure_directory = nullptr;
+    const char* baseline_file_name = nullptr;
+    f64 golden_tolerance_percent = 0.1;
+    f64 max_regression_percent = 10.0;
+    i32 draw_repeat = 1;
+    bool update = false;
+    bool store_missing_baseline = false;
+    for (i32 i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--update") == 0)
+            update = true;
+        else if (strcmp(argv[i], "--store-missing-baseline") == 0)
+            store_missing_baseline = true;
+        else if (i + 1 == argc)
+            break;
+        else if (strcmp(argv[i], "--record") == 0)
+            record_file_name = argv[++i];
+        else if (strcmp(argv[i], "--playback") == 0)
+            playback_file_name = argv[++i];
+        else if (strcmp(argv[i], "--draw-repeat") == 0)
+            draw_repeat = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--frame-times") == 0)
+            frame_times_file_name = argv[++i];
+        else if (strcmp(argv[i], "--golden") == 0)
+            golden_directory = argv[++i];
+        else if (strcmp(argv[i], "--failure-dir") == 0)
+            failure_directory = argv[++i];
+        else if (strcmp(argv[i], "--golden-tolerance") == 0)
+            golden_tolerance_percent = atof(argv[++i]);
+        else if (strcmp(argv[i], "--baseline") == 0)
+            baseline_file_name = argv[++i];
+        else if (strcmp(argv[i], "--max-regression") == 0)
+            max_regression_percent = atof(argv[++i]);
+    }
+
+    i32 window_width = 800, window_height = 600;
+    if (playback_file_name)
+    {
+        if (!g_session_player.load(playback_file_name))
+        {
+            std::cout << "Could not load session " << playback_file_name << "." << std::endl;
+            return StatusCode::SESSION_ERROR;
+        }
+
+        i32 recorded_width, recorded_height;
+        g_session_player.get_initial_size(recorded_width, recorded_height);
+        if (recorded_width > 0 && recorded_height > 0)
+        {
+            window_width = recorded_width;
+            window_height = recorded_height;
+        }
+    }
+
+    GoldenImages golden_images;
+    if (golden_directory && playback_file_name && !golden_images.open(golden_directory, golden_tolerance_percent, update, failure_directory))
+    {
+        std::cout << "Could not open the golden image directory " << golden_directory << "." << std::endl;
+        return StatusCode::SESSION_ERROR;
+    }
+
     GLFWwindow* window;
 
     // Initialize and configure GLFW.
@@ -142,7 +498,11 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    window = glfwCreateWindow(800, 600, WINDOW_TITLE, nullptr, nullptr);
+    // Nobody is watching a playback.
+    if (g_session_player.is_loaded())
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    window = glfwCreateWindow(window_width, window_height, WINDOW_TITLE, nullptr, nullptr);
     if (window == nullptr)
     {
         std::cout << "Could not create window." << std::endl;
@@ -159,8 +519,17 @@ int main()
         return StatusCode::GLEW_ERROR;
     }
 
-    glViewport(0, 0, 800, 600);
+    glViewport(0, 0, window_width, window_height);
     glfwSetFramebufferSizeCallback(window, handle_resize);
+    glfwSetKeyCallback(window, handle_key);
+
+    if (record_file_name)
+    {
+        if (!g_session_recorder.open(record_file_name))
+            std::cout << "Could not create session " << record_file_name << "." << std::endl;
+
+        g_session_recorder.record_resize(g_viewport_width, g_viewport_height);
+    }
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
@@ -233,9 +602,32 @@ int main()
         return StatusCode::SHADER_ERROR;
     }
 
+    // Load and compile geometry shader, which computes the edge distances for the wireframe overlay.
+    GLuint geometry_shader = glCreateShader(GL_GEOMETRY_SHADER);
+
+    char* geometry_shader_source = load_shader_source("src/shaders/wireframe_geometry_shader.glsl");
+    if (!geometry_shader_source)
+    {
+        std::cout << "Could not load geometry shader." << std::endl;
+        return StatusCode::SHADER_ERROR;
+    }
+
+    glShaderSource(geometry_shader, 1, &geometry_shader_source, nullptr);
+    glCompileShader(geometry_shader);
+
+    glGetShaderiv(geometry_shader, GL_COMPILE_STATUS, &compilation_successful);
+    if (!compilation_successful)
+    {
+        glGetShaderInfoLog(geometry_shader, 512, nullptr, log);
+        std::cout << "Could not compile geometry shader." << std::endl;
+        std::cout << log << std::endl;
+        return StatusCode::SHADER_ERROR;
+    }
+
     // Create shader program and link the shaders to it.
     shader_program = glCreateProgram();
     glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, geometry_shader);
     glAttachShader(shader_program, fragment_shader);
     glLinkProgram(shader_program);
 
@@ -291,18 +683,34 @@ int main()
     glDeleteShader(vertex_shader);
     free(fragment_shader_source);
     glDeleteShader(fragment_shader);
+    free(geometry_shader_source);
+    glDeleteShader(geometry_shader);
+
+    // The wireframe is enabled per draw call, its look stays the same.
+    GLint viewport_size_location = glGetUniformLocation(shader_program, "viewportSize");
+    GLint wireframe_location = glGetUniformLocation(shader_program, "wireframe");
+
+    glUseProgram(shader_program);
+    glUniform4f(glGetUniformLocation(shader_program, "wireColor"), 1.0f, 1.0f, 1.0f, 1.0f);
+    glUniform1f(glGetUniformLocation(shader_program, "wireWidth"), 1.5f);
+
+    if (argc > 1 && strcmp(argv[1], "--bench-wireframe") == 0)
+    {
+        run_wireframe_benchmark(window, shader_program);
+        glfwTerminate();
+        return StatusCode::OK;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--bench-occlusion") == 0)
+    {
+        run_occlusion_benchmark(window, shader_program);
+        glfwTerminate();
+        return StatusCode::OK;
+    }
 
     /* Create and populate vertex buffer. */    
 
-    Vec3D vertices[] = {
-        // hexagon
-        {  0.0f,   0.0f,  0.0f }, // center
-        { -0.66f,  0.0f,  0.0f }, // left
-        { -0.33f,  0.75f, 0.0f }, // top left
-        {  0.33f,  0.75f, 0.0f }, // top right
-        {  0.66f,  0.0f,  0.0f }, // right
-        {  0.33f, -0.75f, 0.0f }, // bottom right
-        { -0.33f, -0.75f, 0.0f }, // bottom left
+    std::vector<Vec3D> vertices = {
         // first triangle
         { -0.5f,  -0.5f,  0.0f }, // left
         {  0.5f,  -0.5f,  0.0f }, // right
@@ -313,15 +721,52 @@ int main()
         {  0.6f,   0.8f,  0.0f }, // top
     };
 
-    GLuint hexagon[] = {
-        0, 1, 2,
-        0, 2, 3,
-        0, 3, 4,
-        0, 4, 5,
-        0, 5, 6,
-        0, 6, 1,
+    // Filled shapes are only described by their outlines (and holes) and get triangulated by the
+    // tessellator, instead of writing the triangle indices by hand.
+    Polygon hexagon;
+    hexagon.rings.push_back({
+        { -0.66f,  0.0f  }, // left
+        { -0.33f,  0.75f }, // top left
+        {  0.33f,  0.75f }, // top right
+        {  0.66f,  0.0f  }, // right
+        {  0.33f, -0.75f }, // bottom right
+        { -0.33f, -0.75f }, // bottom left
+    });
+
+    // A concave five-pointed star with a square hole in the middle.
+    Polygon star;
+    star.rings.push_back({
+        {  0.0f,   0.8f  }, {  0.19f,  0.26f }, {  0.76f,  0.25f }, {  0.31f, -0.1f  }, {  0.47f, -0.65f },
+        {  0.0f,  -0.32f }, { -0.47f, -0.65f }, { -0.31f, -0.1f  }, { -0.76f,  0.25f }, { -0.19f,  0.26f },
+    });
+    star.rings.push_back({ { -0.1f, -0.1f }, { 0.1f, -0.1f }, { 0.1f, 0.1f }, { -0.1f, 0.1f } });
+
+    TessellationCache tessellation_cache;
+    tessellation_cache.prepare({ &hexagon, &star });
+
+    // All shapes share one vertex and one element buffer, the indices are rebased accordingly.
+    struct DrawRange {
+        GLsizei count;
+        size_t offset; // in bytes, as glDrawElements expects it
     };
 
+    std::vector<GLuint> indices;
+    auto append_shape = [&](const Polygon& polygon) {
+        const TriangleMesh& mesh = tessellation_cache.get(polygon);
+        GLuint base_vertex = vertices.size();
+        DrawRange range = { (GLsizei)mesh.indices.size(), indices.size() * sizeof(GLuint) };
+
+        for (const Point2D& point : mesh.vertices)
+            vertices.push_back({ point.x, point.y, 0.0f });
+        for (u32 index : mesh.indices)
+            indices.push_back(base_vertex + index);
+
+        return range;
+    };
+
+    DrawRange hexagon_range = append_shape(hexagon);
+    DrawRange star_range = append_shape(star);
+
 #if EXERCISE == 0 || EXERCISE == 1 || EXERCISE == 3
 
     GLuint vao, vbo, ebo;
@@ -337,8 +782,8 @@ int main()
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 
     // 3. Populate buffer object.
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(hexagon), hexagon, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vec3D), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
 
     // 4. Specify the memory layout.
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3D), (void*)0);
@@ -351,21 +796,26 @@ int main()
 
 #elif EXERCISE == 2
 
-    GLuint vbo_array[2];
+    GLuint vbo_array[3];
     GLuint* vbo_triangle1 = &vbo_array[0];
     GLuint* vbo_triangle2 = &vbo_array[1];
+    GLuint* vbo_shapes = &vbo_array[2];
 
-    GLuint vao_array[2];
+    GLuint vao_array[3];
     GLuint* vao_triangle1 = &vao_array[0];
     GLuint* vao_triangle2 = &vao_array[1];
+    GLuint* vao_shapes = &vao_array[2];
+
+    GLuint ebo_shapes;
 
-    glGenVertexArrays(2, vao_array);
-    glGenBuffers(2, vbo_array);
+    glGenVertexArrays(3, vao_array);
+    glGenBuffers(3, vbo_array);
+    glGenBuffers(1, &ebo_shapes);
 
     glBindVertexArray(*vao_triangle1);
     glBindBuffer(GL_ARRAY_BUFFER, *vbo_triangle1);
 
-    glBufferData(GL_ARRAY_BUFFER, 3 * sizeof(Vec3D), &vertices[7], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, 3 * sizeof(Vec3D), &vertices[0], GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3D), (void*)0);
     glEnableVertexAttribArray(0);
@@ -373,94 +823,293 @@ int main()
     glBindVertexArray(*vao_triangle2);
     glBindBuffer(GL_ARRAY_BUFFER, *vbo_triangle2);
 
-    glBufferData(GL_ARRAY_BUFFER, 3 * sizeof(Vec3D), &vertices[10], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, 3 * sizeof(Vec3D), &vertices[3], GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3D), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // The tessellated shapes get their own objects as well. Their indices count from the start of
+    // all vertices, so the triangles' vertices are uploaded with them.
+    glBindVertexArray(*vao_shapes);
+    glBindBuffer(GL_ARRAY_BUFFER, *vbo_shapes);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_shapes);
+
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vec3D), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3D), (void*)0);
     glEnableVertexAttribArray(0);
 
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
 #endif
 
     /* Main loop */
 
-    while (!glfwWindowShouldClose(window))
-    {
-        handle_inputs(window);
+    // The main thread only waits for window events (GLFW wants them handled there), the key events go
+    // to the simulation thread and the frames are drawn on a render thread owning the OpenGL context.
+    // This way a slow frame can't hold back the input and waiting for input can't hold back the frames.
+    g_simulation.start();
+    glfwMakeContextCurrent(nullptr);
 
-        glClear(GL_COLOR_BUFFER_BIT);
+    // Time from a key event to the first frame showing its effect on the screen.
+    LatencyHistogram input_latency;
 
-        // As the program gets more sophisticated and more shader programs and buffer objects are used,
-        // glUseProgram() and glDrawArrays() allow us to swap these around as needed. In this example,
-        // there is really no need to call these functions in each iteration of the rendering loop.
-        glUseProgram(shader_program);
+    // Time every frame took from its start until it was swapped, while playing back a session.
+    FrameTimes frame_times;
 
-#if EXERCISE == 0
+    std::thread render_thread([&]()
+    {
+        glfwMakeContextCurrent(window);
+
+        // Play back as fast as possible.
+        if (g_session_player.is_loaded())
+            glfwSwapInterval(0);
 
-        glBindVertexArray(vao);
+        i32 viewport_width = window_width, viewport_height = window_height;
+        AppliedEvent applied;
+        f64 last_latency_report = glfwGetTime();
 
-        switch(g_drawn_shape)
+        while (!glfwWindowShouldClose(window))
         {
-            case Shape::TRIANGLE:
-                // Draw the triangle.
-                glDrawArrays(GL_TRIANGLES, 7, 3);
-                break;
-            case Shape::HEXAGON:
-                // Draw the hexagon.
-                glDrawElements(GL_TRIANGLES, 18, GL_UNSIGNED_INT, 0);
+            f64 frame_start = glfwGetTime();
+
+            // Nothing drawn here depends on the time, the recorded clock is only needed to know the
+            // frames the events arrived in.
+            if (g_session_player.is_loaded())
+            {
+                if (!g_session_player.next_frame())
+                {
+                    glfwSetWindowShouldClose(window, true);
+                    glfwPostEmptyEvent();
+                    break;
+                }
+                play_back_events(g_session_player.get_frame());
+            }
+            g_session_recorder.begin_frame(frame_start);
+
+            SimulationState state = g_simulation.get_state();
+
+            if (state.close_requested)
+            {
+                glfwSetWindowShouldClose(window, true);
+                glfwPostEmptyEvent(); // wakes up the main thread
                 break;
-        }
+            }
+
+            if (viewport_width != g_viewport_width || viewport_height != g_viewport_height)
+            {
+                viewport_width = g_viewport_width;
+                viewport_height = g_viewport_height;
+                glViewport(0, 0, viewport_width, viewport_height);
+            }
+
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            // As the program gets more sophisticated and more shader programs and buffer objects are used,
+            // glUseProgram() and glDrawArrays() allow us to swap these around as needed. In this example,
+            // there is really no need to call these functions in each iteration of the rendering loop.
+            glUseProgram(shader_program);
+            glUniform2f(viewport_size_location, (f32)viewport_width, (f32)viewport_height);
+            glUniform1i(wireframe_location, state.wire_mode[state.drawn_shape]);
+
+            // Every repeat draws the same pixels, it only adds work for a playback to time.
+            for (i32 repeat = 0; repeat < draw_repeat; ++repeat)
+            {
+                // The third exercise switches to the yellow shader for its second triangle.
+                if (repeat > 0)
+                    glUseProgram(shader_program);
 
-#elif EXERCISE == 1
+#if EXERCISE == 0
 
-        glBindVertexArray(vao);
+                glBindVertexArray(vao);
+
+                switch(state.drawn_shape)
+                {
+                    case Shape::TRIANGLE:
+                        // Draw the triangle.
+                        glDrawArrays(GL_TRIANGLES, 0, 3);
+                        break;
+                    case Shape::HEXAGON:
+                        // Draw the hexagon.
+                        glDrawElements(GL_TRIANGLES, hexagon_range.count, GL_UNSIGNED_INT, (void*)hexagon_range.offset);
+                        break;
+                    case Shape::STAR:
+                        // Draw the star.
+                        glDrawElements(GL_TRIANGLES, star_range.count, GL_UNSIGNED_INT, (void*)star_range.offset);
+                        break;
+                    case Shape::SHAPE_COUNT:
+                        break;
+                }
 
-        switch(g_drawn_shape)
-        {
-            case Shape::TRIANGLE:
-                // Draw the triangles.
-                glDrawArrays(GL_TRIANGLES, 7, 3);
-                glDrawArrays(GL_TRIANGLES, 10, 3);
-                break;
-            case Shape::HEXAGON:
-                // Draw the hexagon.
-                glDrawElements(GL_TRIANGLES, 18, GL_UNSIGNED_INT, 0);
-                break;
-        }
+#elif EXERCISE == 1
+
+                glBindVertexArray(vao);
+
+                switch(state.drawn_shape)
+                {
+                    case Shape::TRIANGLE:
+                        // Draw the triangles.
+                        glDrawArrays(GL_TRIANGLES, 0, 3);
+                        glDrawArrays(GL_TRIANGLES, 3, 3);
+                        break;
+                    case Shape::HEXAGON:
+                        // Draw the hexagon.
+                        glDrawElements(GL_TRIANGLES, hexagon_range.count, GL_UNSIGNED_INT, (void*)hexagon_range.offset);
+                        break;
+                    case Shape::STAR:
+                        // Draw the star.
+                        glDrawElements(GL_TRIANGLES, star_range.count, GL_UNSIGNED_INT, (void*)star_range.offset);
+                        break;
+                    case Shape::SHAPE_COUNT:
+                        break;
+                }
 
 #elif EXERCISE == 2
 
-            // Draw the triangles.
-            glBindVertexArray(*vao_triangle1);
-            glDrawArrays(GL_TRIANGLES, 0, 3);
-            glBindVertexArray(*vao_triangle2);
-            glDrawArrays(GL_TRIANGLES, 0, 3);
+                switch(state.drawn_shape)
+                {
+                    case Shape::TRIANGLE:
+                        // Draw the triangles.
+                        glBindVertexArray(*vao_triangle1);
+                        glDrawArrays(GL_TRIANGLES, 0, 3);
+                        glBindVertexArray(*vao_triangle2);
+                        glDrawArrays(GL_TRIANGLES, 0, 3);
+                        break;
+                    case Shape::HEXAGON:
+                        // Draw the hexagon.
+                        glBindVertexArray(*vao_shapes);
+                        glDrawElements(GL_TRIANGLES, hexagon_range.count, GL_UNSIGNED_INT, (void*)hexagon_range.offset);
+                        break;
+                    case Shape::STAR:
+                        // Draw the star.
+                        glBindVertexArray(*vao_shapes);
+                        glDrawElements(GL_TRIANGLES, star_range.count, GL_UNSIGNED_INT, (void*)star_range.offset);
+                        break;
+                    case Shape::SHAPE_COUNT:
+                        break;
+                }
 
 #elif EXERCISE == 3
 
-        glBindVertexArray(vao);
+                glBindVertexArray(vao);
+
+                switch(state.drawn_shape)
+                {
+                    case Shape::TRIANGLE:
+                        // Draw the triangles.
+                        glDrawArrays(GL_TRIANGLES, 0, 3);
+                        glUseProgram(shader_yellow);                
+                        glDrawArrays(GL_TRIANGLES, 3, 3);
+                        break;
+                    case Shape::HEXAGON:
+                        // Draw the hexagon.
+                        glDrawElements(GL_TRIANGLES, hexagon_range.count, GL_UNSIGNED_INT, (void*)hexagon_range.offset);
+                        break;
+                    case Shape::STAR:
+                        // Draw the star.
+                        glDrawElements(GL_TRIANGLES, star_range.count, GL_UNSIGNED_INT, (void*)star_range.offset);
+                        break;
+                    case Shape::SHAPE_COUNT:
+                        break;
+                }
 
-        switch(g_drawn_shape)
+#endif
+            }
+
+            // Read back before swapping, the back buffer is undefined afterwards. This doesn't count
+            // towards the frame time.
+            f64 golden_image_time = 0.0;
+            if (golden_images.is_open())
+            {
+                u64 frame_index = g_session_player.get_frame_index();
+                if (frame_index % GOLDEN_FRAME_INTERVAL == 0 || frame_index + 1 == g_session_player.get_frame_count())
+                {
+                    f64 read_start = glfwGetTime();
+                    Image image;
+                    read_framebuffer(0, viewport_width, viewport_height, image);
+                    golden_images.check(frame_index, image);
+                    golden_image_time = glfwGetTime() - read_start;
+                }
+            }
+
+            glfwSwapBuffers(window);
+
+            // Every event applied to the state drawn in this frame is on the screen now.
+            f64 presented = glfwGetTime();
+            if (g_session_player.is_loaded())
+                frame_times.record(presented - frame_start - golden_image_time);
+
+            AppliedQueue& applied_events = g_simulation.get_applied_events();
+            while (applied_events.front() && applied_events.front()->sequence <= state.sequence)
+            {
+                applied_events.pop(applied);
+                input_latency.record(presented - applied.timestamp);
+            }
+
+            if (input_latency.count() && presented - last_latency_report >= 10.0)
+            {
+                input_latency.print("Input latency");
+                last_latency_report = presented;
+            }
+        }
+
+        glfwMakeContextCurrent(nullptr);
+    });
+
+    while (!glfwWindowShouldClose(window))
+        glfwWaitEvents();
+
+    render_thread.join();
+    g_simulation.stop();
+    g_session_recorder.close();
+    input_latency.print("Input latency");
+
+    StatusCode status = StatusCode::OK;
+    if (g_session_player.is_loaded())
+    {
+        frame_times.print("Playback");
+        if (frame_times_file_name && !frame_times.write(frame_times_file_name))
+            std::cout << "Could not write frame times to " << frame_times_file_name << "." << std::endl;
+
+        if (golden_images.is_open())
         {
-            case Shape::TRIANGLE:
-                // Draw the triangles.
-                glDrawArrays(GL_TRIANGLES, 7, 3);
-                glUseProgram(shader_yellow);                
-                glDrawArrays(GL_TRIANGLES, 10, 3);
-                break;
-            case Shape::HEXAGON:
-                // Draw the hexagon.
-                glDrawElements(GL_TRIANGLES, 18, GL_UNSIGNED_INT, 0);
-                break;
+            golden_images.print_summary();
+            if (golden_images.failed())
+                status = StatusCode::GOLDEN_IMAGE_MISMATCH;
+        }
+
+        if (baseline_file_name && (update || (store_missing_baseline && !FrameTimes::has_baseline(baseline_file_name))))
+        {
+            if (!frame_times.write_baseline(baseline_file_name) && status == StatusCode::OK)
+                status = StatusCode::SESSION_ERROR;
+        }
+        else if (baseline_file_name && !frame_times.check_baseline(baseline_file_name, max_regression_percent) && status == StatusCode::OK)
+        {
+            status = StatusCode::PERFORMANCE_REGRESSION;
         }
+    }
+
+    // Free the GPU objects. The render thread has handed the context back.
+    glfwMakeContextCurrent(window);
 
+#if EXERCISE == 0 || EXERCISE == 1 || EXERCISE == 3
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+#elif EXERCISE == 2
+    glDeleteVertexArrays(3, vao_array);
+    glDeleteBuffers(3, vbo_array);
+    glDeleteBuffers(1, &ebo_shapes);
 #endif
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
+#if EXERCISE == 3
+    glDeleteProgram(shader_yellow);
+#endif
+    glDeleteProgram(shader_program);
 
     glfwTerminate();
-    return StatusCode::OK;
+    return status;
 }
@@ -0,0 +1,200 @@
+#include "occlusion_culler.hpp"
+
+#include <cstdio>
+
+namespace
+{
+    const u32 BOX_VERTICES = 8;
+
+    // Two triangles per face, corner i has the maximum x if bit 0 is set, y for bit 1 and z for bit 2.
+    const GLuint BOX_INDICES[36] = {
+        0, 2, 1, 1, 2, 3, // -z
+        4, 5, 6, 5, 7, 6, // +z
+        0, 1, 4, 1, 5, 4, // -y
+        2, 6, 3, 3, 6, 7, // +y
+        0, 4, 2, 2, 4, 6, // -x
+        1, 3, 5, 3, 7, 5, // +x
+    };
+
+    void box_corners(const OcclusionBounds& bounds, f32* positions)
+    {
+        for (u32 i = 0; i < BOX_VERTICES; ++i)
+        {
+            positions[i * 3 + 0] = (i & 1) ? bounds.max_x : bounds.min_x;
+            positions[i * 3 + 1] = (i & 2) ? bounds.max_y : bounds.min_y;
+            positions[i * 3 + 2] = (i & 4) ? bounds.max_z : bounds.min_z;
+        }
+    }
+
+    f64 percent(u64 part, u64 whole)
+    {
+        return whole ? 100.0 * part / whole : 0.0;
+    }
+}
+
+void OcclusionCuller::init(const std::vector<OcclusionBounds>& objects)
+{
+    // Conservative queries may count samples a box only touches, which lets drivers skip the exact
+    // coverage. They need OpenGL 4.3 or ES 3 compatibility, exact ones answer the same question.
+    if (GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility)
+        _box_query_target = GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+
+    _objects.resize(objects.size());
+
+    std::vector<f32> positions(objects.size() * BOX_VERTICES * 3);
+    for (size_t i = 0; i < objects.size(); ++i)
+        box_corners(objects[i], &positions[i * BOX_VERTICES * 3]);
+
+    glGenVertexArrays(1, &_vao);
+    glGenBuffers(1, &_vbo);
+    glGenBuffers(1, &_ebo);
+
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(f32), positions.data(), GL_DYNAMIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(BOX_INDICES), BOX_INDICES, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(f32), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    for (Object& object : _objects)
+    {
+        for (QuerySlot& slot : object.slots)
+        {
+            glGenQueries(1, &slot.box_query);
+            glGenQueries(1, &slot.draw_query);
+        }
+    }
+}
+
+void OcclusionCuller::destroy()
+{
+    for (Object& object : _objects)
+    {
+        for (QuerySlot& slot : object.slots)
+        {
+            glDeleteQueries(1, &slot.box_query);
+            glDeleteQueries(1, &slot.draw_query);
+        }
+    }
+    _objects.clear();
+
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteBuffers(1, &_vbo);
+    glDeleteBuffers(1, &_ebo);
+    _vao = _vbo = _ebo = 0;
+}
+
+void OcclusionCuller::set_bounds(u32 object, const OcclusionBounds& bounds)
+{
+    f32 positions[BOX_VERTICES * 3];
+    box_corners(bounds, positions);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, object * sizeof(positions), sizeof(positions), positions);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void OcclusionCuller::begin_frame()
+{
+    ++_frame;
+
+    // Oldest first, so the visibility ends up as the latest result says.
+    for (Object& object : _objects)
+    {
+        for (u32 age = 0; age < QUERY_FRAMES; ++age)
+        {
+            QuerySlot& slot = object.slots[(_frame + age) % QUERY_FRAMES];
+            if (slot.pending)
+                read_results(object, slot);
+        }
+    }
+}
+
+void OcclusionCuller::begin_draw(u32 object_index)
+{
+    Object& object = _objects[object_index];
+    QuerySlot& slot = object.slots[_frame % QUERY_FRAMES];
+
+    // Rather lose a result than wait for it.
+    if (slot.pending)
+    {
+        ++_stats.lost_results;
+        slot.pending = false;
+    }
+
+    slot.box_tested = !object.visible;
+    if (slot.box_tested)
+    {
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+
+        glBeginQuery(_box_query_target, slot.box_query);
+        glBindVertexArray(_vao);
+        glDrawElementsBaseVertex(GL_TRIANGLES, 36, GL_UNSIGNED_INT, (void*)0, object_index * BOX_VERTICES);
+        glEndQuery(_box_query_target);
+
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_TRUE);
+
+        // The GPU waits for the box's result, which it has just started working on. The CPU doesn't.
+        glBeginConditionalRender(slot.box_query, GL_QUERY_WAIT);
+    }
+    object.conditional = slot.box_tested;
+
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, slot.draw_query);
+    slot.pending = true;
+}
+
+void OcclusionCuller::end_draw(u32 object_index)
+{
+    Object& object = _objects[object_index];
+
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+    if (object.conditional)
+        glEndConditionalRender();
+}
+
+const OcclusionStats& OcclusionCuller::get_stats() const
+{
+    return _stats;
+}
+
+void OcclusionCuller::print(const char* title) const
+{
+    u64 drawn = _stats.draws - _stats.skipped_draws;
+
+    printf("%s: %llu queries, %llu draws, %llu skipped (%.1f%%), %llu of %llu drawn falsely visible (%.1f%%)",
+           title, (unsigned long long)_stats.queries, (unsigned long long)_stats.draws,
+           (unsigned long long)_stats.skipped_draws, percent(_stats.skipped_draws, _stats.draws),
+           (unsigned long long)_stats.false_visible, (unsigned long long)drawn, percent(_stats.false_visible, drawn));
+    if (_stats.lost_results)
+        printf(", %llu results lost", (unsigned long long)_stats.lost_results);
+    printf("\n");
+}
+
+void OcclusionCuller::read_results(Object& object, QuerySlot& slot)
+{
+    // The draw query ended last, when its result is there the box's is too.
+    GLuint available = 0;
+    glGetQueryObjectuiv(slot.draw_query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return;
+
+    GLuint box_passed = 1, draw_passed = 0;
+    if (slot.box_tested)
+        glGetQueryObjectuiv(slot.box_query, GL_QUERY_RESULT, &box_passed);
+    glGetQueryObjectuiv(slot.draw_query, GL_QUERY_RESULT, &draw_passed);
+
+    _stats.queries += slot.box_tested ? 2 : 1;
+    ++_stats.draws;
+    if (!box_passed)
+        ++_stats.skipped_draws;
+    else if (!draw_passed)
+        ++_stats.false_visible;
+
+    object.visible = draw_passed != 0;
+    slot.pending = false;
+}
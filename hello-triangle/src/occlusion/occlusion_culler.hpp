@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <util/types.hpp>
+
+// Axis-aligned box around an object, in the coordinates its vertices are given in.
+struct OcclusionBounds {
+    f32 min_x, min_y, min_z;
+    f32 max_x, max_y, max_z;
+};
+
+// Counted over the frames whose query results have been read back.
+struct OcclusionStats {
+    u64 queries;
+    u64 draws;         // draws the GPU was asked to do
+    u64 skipped_draws; // of those, skipped because the object's box was hidden
+    u64 false_visible; // of the others, drawn without a single sample of the object passing the depth test
+    u64 lost_results;  // results still not available when their queries were needed again
+};
+
+// Skips drawing objects hidden behind what was drawn before them, without the CPU ever waiting on the GPU.
+//
+// Every object is drawn inside an occlusion query, whose result is read back a frame or two later. Objects
+// that were visible then are simply drawn again. The others first get their bounding box drawn, with color
+// and depth writes disabled, inside a GL_ANY_SAMPLES_PASSED_CONSERVATIVE query, and are drawn with
+// conditional rendering on its result: the GPU skips the draw if no sample of the box passed. So an object
+// that becomes visible is drawn in that very frame, one that becomes hidden is drawn once more until its
+// result arrives, which is what the false visibility counts (along with boxes larger than their objects).
+//
+// Occluders have to be drawn first, with the depth test enabled. The boxes are drawn with the program
+// bound at the time, taking positions from attribute 0, so they are transformed like the objects.
+class OcclusionCuller {
+public:
+    // Creates a box and the queries for every object. Needs a current context.
+    void init(const std::vector<OcclusionBounds>& objects);
+    void destroy();
+
+    void set_bounds(u32 object, const OcclusionBounds& bounds);
+
+    // Reads back the results that are available.
+    void begin_frame();
+
+    // To be put around drawing the object. begin_draw() may bind its own vertex array, so bind the object's
+    // after it.
+    void begin_draw(u32 object);
+    void end_draw(u32 object);
+
+    const OcclusionStats& get_stats() const;
+    void print(const char* title) const;
+
+private:
+    // Frames an object's queries may take to finish before the results are dropped.
+    static const u32 QUERY_FRAMES = 3;
+
+    struct QuerySlot {
+        GLuint box_query = 0;
+        GLuint draw_query = 0;
+        bool box_tested = false;
+        bool pending = false;
+    };
+
+    struct Object {
+        QuerySlot slots[QUERY_FRAMES];
+        bool visible = true;
+        bool conditional = false;
+    };
+
+    void read_results(Object& object, QuerySlot& slot);
+
+    std::vector<Object> _objects;
+    GLuint _vao = 0, _vbo = 0, _ebo = 0;
+    GLenum _box_query_target = GL_ANY_SAMPLES_PASSED;
+    u64 _frame = 0;
+    OcclusionStats _stats = {};
+};
@@ -1,10 +1,26 @@
 #version 330 core
 
+noperspective in vec3 edgeDistance;
+
 out vec4 FragColor;
 
 uniform vec4 ourColor;
 
+// Wireframe overlay, enabled per draw.
+uniform bool wireframe;
+uniform vec4 wireColor;
+uniform float wireWidth; // in pixels
+
 void main()
 {
 	FragColor = ourColor;
+
+	if (wireframe)
+	{
+		// Distance to the closest edge, with a pixel of anti-aliasing on either side of the line.
+		float distance = min(edgeDistance.x, min(edgeDistance.y, edgeDistance.z));
+		float coverage = 1.0 - smoothstep(0.5 * wireWidth - 0.5, 0.5 * wireWidth + 0.5, distance);
+
+		FragColor = mix(FragColor, wireColor, coverage);
+	}
 }
\ No newline at end of file
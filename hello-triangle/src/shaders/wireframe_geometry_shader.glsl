@@ -0,0 +1,41 @@
+#version 330 core
+
+// Passes triangles through unchanged and gives every corner its distance in pixels to the
+// opposite edge. Interpolated without perspective, the fragment shader gets the distance to
+// each edge and can draw lines of constant width in the same pass as the fill.
+
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+uniform vec2 viewportSize;
+
+noperspective out vec3 edgeDistance;
+
+void main()
+{
+	// Corners in window pixels.
+	vec2 p0 = 0.5 * viewportSize * gl_in[0].gl_Position.xy / gl_in[0].gl_Position.w;
+	vec2 p1 = 0.5 * viewportSize * gl_in[1].gl_Position.xy / gl_in[1].gl_Position.w;
+	vec2 p2 = 0.5 * viewportSize * gl_in[2].gl_Position.xy / gl_in[2].gl_Position.w;
+
+	vec2 e0 = p2 - p1;
+	vec2 e1 = p2 - p0;
+	vec2 e2 = p1 - p0;
+
+	// Twice the triangle's area divided by an edge's length is the height over that edge.
+	float area = abs(e1.x * e2.y - e1.y * e2.x);
+
+	gl_Position = gl_in[0].gl_Position;
+	edgeDistance = vec3(area / length(e0), 0.0, 0.0);
+	EmitVertex();
+
+	gl_Position = gl_in[1].gl_Position;
+	edgeDistance = vec3(0.0, area / length(e1), 0.0);
+	EmitVertex();
+
+	gl_Position = gl_in[2].gl_Position;
+	edgeDistance = vec3(0.0, 0.0, area / length(e2));
+	EmitVertex();
+
+	EndPrimitive();
+}
\ No newline at end of file
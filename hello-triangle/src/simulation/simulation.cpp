@@ -0,0 +1,113 @@
+#include "simulation.hpp"
+
+#include <GLFW/glfw3.h>
+
+Simulation::~Simulation()
+{
+    stop();
+}
+
+void Simulation::start()
+{
+    if (_running.exchange(true))
+        return;
+
+    _thread = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop()
+{
+    if (!_running.exchange(false))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_wake_mutex);
+        _input_pending = true;
+    }
+    _wake.notify_one();
+    _thread.join();
+}
+
+bool Simulation::push_input(const InputEvent& event)
+{
+    if (!_input.push(event))
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(_wake_mutex);
+        _input_pending = true;
+    }
+    _wake.notify_one();
+    return true;
+}
+
+SimulationState Simulation::get_state() const
+{
+    std::lock_guard<std::mutex> lock(_state_mutex);
+    return _state;
+}
+
+AppliedQueue& Simulation::get_applied_events()
+{
+    return _applied;
+}
+
+void Simulation::run()
+{
+    SimulationState state = get_state();
+
+    while (_running.load())
+    {
+        {
+            std::unique_lock<std::mutex> lock(_wake_mutex);
+            _wake.wait(lock, [this] { return _input_pending; });
+            _input_pending = false;
+        }
+
+        InputEvent event;
+        bool changed = false;
+        while (_input.pop(event))
+        {
+            apply(event, state);
+            ++state.sequence;
+            changed = true;
+
+            // Without anyone measuring latency the queue fills up, the samples are simply lost then.
+            _applied.push({ state.sequence, event.timestamp });
+        }
+
+        if (changed)
+        {
+            std::lock_guard<std::mutex> lock(_state_mutex);
+            _state = state;
+        }
+    }
+}
+
+void Simulation::apply(const InputEvent& event, SimulationState& state)
+{
+    // Key repeats don't change anything here.
+    if (event.action != GLFW_PRESS)
+        return;
+
+    switch (event.key)
+    {
+        case GLFW_KEY_ESCAPE:
+            state.close_requested = true;
+            break;
+        case GLFW_KEY_1:
+            state.drawn_shape = Shape::TRIANGLE;
+            break;
+        case GLFW_KEY_2:
+            state.drawn_shape = Shape::HEXAGON;
+            break;
+        case GLFW_KEY_3:
+            state.drawn_shape = Shape::STAR;
+            break;
+        case GLFW_KEY_W:
+            // Toggle wireframe mode of the drawn shape. The wireframe is drawn by the shaders on top
+            // of the filled shape, see wireframe_geometry_shader.glsl.
+            state.wire_mode[state.drawn_shape] = !state.wire_mode[state.drawn_shape];
+            break;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <input/spsc_queue.hpp>
+#include <util/types.hpp>
+
+enum Shape {
+    TRIANGLE = 0,
+    HEXAGON,
+    STAR,
+    SHAPE_COUNT,
+    DEFAULT = TRIANGLE,
+};
+
+// A key event as received by the GLFW key callback.
+struct InputEvent {
+    i32 key;
+    i32 action;    // GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE
+    f64 timestamp; // glfwGetTime() when the event was received
+};
+
+// An input event that has been applied to the state with the given sequence number.
+struct AppliedEvent {
+    u64 sequence;
+    f64 timestamp;
+};
+
+// Everything the renderer needs to know to draw a frame.
+struct SimulationState {
+    Shape drawn_shape = Shape::DEFAULT;
+    bool wire_mode[Shape::SHAPE_COUNT] = {}; // wireframe mode can be toggled for each shape
+    bool close_requested = false;
+    u64 sequence = 0;                        // number of input events applied so far
+};
+
+typedef SpscQueue<InputEvent, 256> InputQueue;
+typedef SpscQueue<AppliedEvent, 256> AppliedQueue;
+
+// Owns the program state and updates it on its own thread. Input events are pushed by the
+// thread handling the window events and applied as soon as they arrive, no matter how long
+// the renderer takes for a frame. The renderer takes a copy of the state once per frame.
+class Simulation {
+public:
+    ~Simulation();
+
+    void start();
+    void stop();
+
+    // Called from the event thread only. Returns false if the event had to be dropped.
+    bool push_input(const InputEvent& event);
+
+    // Copy of the latest state, may be called from any thread.
+    SimulationState get_state() const;
+
+    // Called from the render thread only. Events applied to a state, oldest first, so their latency
+    // can be measured once that state made it to the screen.
+    AppliedQueue& get_applied_events();
+
+private:
+    void run();
+    void apply(const InputEvent& event, SimulationState& state);
+
+    InputQueue _input;
+    AppliedQueue _applied;
+
+    mutable std::mutex _state_mutex;
+    SimulationState _state;
+
+    // The simulation thread sleeps while there is no input.
+    std::mutex _wake_mutex;
+    std::condition_variable _wake;
+    bool _input_pending = false;
+
+    std::atomic<bool> _running{ false };
+    std::thread _thread;
+};
@@ -0,0 +1,151 @@
+#include "benchmark.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+#include <tessellation/tessellator.hpp>
+
+namespace
+{
+    const f32 PI = 3.14159265f;
+
+    std::vector<Point2D> circle(f32 cx, f32 cy, f32 radius, u32 segments)
+    {
+        std::vector<Point2D> ring;
+        for (u32 i = 0; i < segments; ++i)
+        {
+            f32 angle = 2.0f * PI * i / segments;
+            ring.push_back({ cx + radius * std::cos(angle), cy + radius * std::sin(angle) });
+        }
+        return ring;
+    }
+
+    // A concave star with `points` spikes and up to a few round holes around its center.
+    Polygon star(f32 cx, f32 cy, f32 radius, u32 points, u32 holes)
+    {
+        Polygon polygon;
+        std::vector<Point2D> outline;
+
+        for (u32 i = 0; i < points * 2; ++i)
+        {
+            f32 angle = PI * i / points;
+            f32 r = (i % 2 == 0) ? radius : radius * 0.6f;
+            outline.push_back({ cx + r * std::cos(angle), cy + r * std::sin(angle) });
+        }
+        polygon.rings.push_back(outline);
+
+        for (u32 i = 0; i < holes; ++i)
+        {
+            f32 angle = 2.0f * PI * i / holes;
+            f32 offset = holes > 1 ? radius * 0.3f : 0.0f;
+            polygon.rings.push_back(circle(cx + offset * std::cos(angle), cy + offset * std::sin(angle), radius * 0.1f, 16));
+        }
+
+        return polygon;
+    }
+
+    size_t count_vertices(const Polygon& polygon)
+    {
+        size_t count = 0;
+        for (const auto& ring : polygon.rings)
+            count += ring.size();
+        return count;
+    }
+
+    template<typename F>
+    f64 seconds(F&& body)
+    {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        return std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool check(const char* name, const Polygon& polygon, size_t expected_triangles)
+    {
+        TriangleMesh mesh = tessellate(polygon);
+        f64 error = tessellation_error(polygon, mesh);
+        size_t triangles = mesh.indices.size() / 3;
+        bool ok = error < 1e-6 && (expected_triangles == 0 || triangles == expected_triangles);
+
+        printf("  %-34s %6zu triangles, error %.2e  %s\n", name, triangles, error, ok ? "ok" : "FAILED");
+        return ok;
+    }
+}
+
+int run_tessellation_benchmark()
+{
+    printf("Correctness\n");
+
+    bool ok = true;
+
+    Polygon hexagon;
+    hexagon.rings.push_back({
+        { -0.66f,  0.0f  }, { -0.33f,  0.75f }, {  0.33f,  0.75f },
+        {  0.66f,  0.0f  }, {  0.33f, -0.75f }, { -0.33f, -0.75f },
+    });
+    ok &= check("hexagon", hexagon, 4);
+
+    Polygon square_with_hole;
+    square_with_hole.rings.push_back({ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } });
+    square_with_hole.rings.push_back({ { 3, 3 }, { 7, 3 }, { 7, 7 }, { 3, 7 } });
+    ok &= check("square with square hole", square_with_hole, 8);
+
+    ok &= check("star, 5 spikes", star(0, 0, 1, 5, 0), 8);
+    ok &= check("star, 64 spikes, 3 holes", star(0, 0, 1, 64, 3), 0);
+    ok &= check("star, 50000 spikes (hashed)", star(0, 0, 1000, 50000, 4), 0);
+
+    printf("Throughput\n");
+
+    // Many independent paths of varying complexity, like the glyphs and shapes of a vector scene.
+    std::mt19937 random{1234};
+    std::uniform_int_distribution<u32> spikes{16, 256};
+    std::uniform_int_distribution<u32> hole_count{0, 3};
+
+    std::vector<Polygon> paths;
+    size_t total_vertices = 0;
+    for (u32 i = 0; i < 4000; ++i)
+    {
+        paths.push_back(star(i * 3.0f, 0.0f, 1.0f, spikes(random), hole_count(random)));
+        total_vertices += count_vertices(paths.back());
+    }
+
+    std::vector<const Polygon*> path_pointers;
+    for (const auto& path : paths)
+        path_pointers.push_back(&path);
+
+    size_t total_triangles = 0;
+    f64 single = seconds([&]() {
+        for (const auto& path : paths)
+            total_triangles += tessellate(path).indices.size() / 3;
+    });
+    printf("  %zu paths, %zu vertices, %zu triangles\n", paths.size(), total_vertices, total_triangles);
+    printf("  %-34s %8.2f ms %8.2f M vertices/s\n", "1 thread", single * 1e3, total_vertices / single / 1e6);
+
+    u32 threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<TriangleMesh> meshes;
+    f64 parallel = seconds([&]() { meshes = tessellate_parallel(path_pointers, threads); });
+
+    char label[64];
+    snprintf(label, sizeof(label), "%u threads", threads);
+    printf("  %-34s %8.2f ms %8.2f M vertices/s  (%.2fx)\n", label, parallel * 1e3, total_vertices / parallel / 1e6, single / parallel);
+
+    TessellationCache cache;
+    f64 cold = seconds([&]() { cache.prepare(path_pointers); });
+    printf("  %-34s %8.2f ms %8.2f M vertices/s\n", "cache, first frame", cold * 1e3, total_vertices / cold / 1e6);
+
+    size_t cached_indices = 0;
+    f64 warm = seconds([&]() {
+        for (const auto& path : paths)
+            cached_indices += cache.get(path).indices.size();
+    });
+    printf("  %-34s %8.2f ms %8.2f M vertices/s\n", "cache, later frames", warm * 1e3, total_vertices / warm / 1e6);
+
+    for (size_t i = 0; i < paths.size(); ++i)
+        ok &= tessellation_error(paths[i], meshes[i]) < 1e-6 && cache.get(paths[i]).indices == meshes[i].indices;
+
+    printf("%s\n", ok ? "All shapes tessellated correctly." : "Some shapes were NOT tessellated correctly.");
+    return ok ? 0 : 1;
+}
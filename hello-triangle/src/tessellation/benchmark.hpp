@@ -0,0 +1,5 @@
+#pragma once
+
+// Checks the tessellator on a few known shapes and measures its throughput in vertices per second.
+// Run with `hello-triangle.out --bench`.
+int run_tessellation_benchmark();
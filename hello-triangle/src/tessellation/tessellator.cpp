@@ -0,0 +1,895 @@
+#include "tessellator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <thread>
+
+namespace
+{
+    // Above this many points, ears are tested against nearby vertices along a z-order curve only.
+    const size_t HASHING_THRESHOLD = 80;
+
+    // A vertex in one of the circular lists that make up the remaining polygon.
+    struct Node {
+        u32 index;
+        f64 x, y;
+
+        Node* prev = nullptr;
+        Node* next = nullptr;
+
+        // Neighbours in z-order, only used when hashing.
+        u32 z = 0;
+        Node* prev_z = nullptr;
+        Node* next_z = nullptr;
+
+        // Set for holes consisting of a single point.
+        bool steiner = false;
+    };
+
+    f64 area(const Node* p, const Node* q, const Node* r)
+    {
+        return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+    }
+
+    bool equals(const Node* a, const Node* b)
+    {
+        return a->x == b->x && a->y == b->y;
+    }
+
+    bool point_in_triangle(f64 ax, f64 ay, f64 bx, f64 by, f64 cx, f64 cy, f64 px, f64 py)
+    {
+        return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+               (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+               (bx - px) * (cy - py) >= (cx - px) * (by - py);
+    }
+
+    i32 sign(f64 value)
+    {
+        return value > 0.0 ? 1 : (value < 0.0 ? -1 : 0);
+    }
+
+    // Whether q lies on segment pr, given that the three are collinear.
+    bool on_segment(const Node* p, const Node* q, const Node* r)
+    {
+        return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) &&
+               q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+    }
+
+    bool intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2)
+    {
+        i32 o1 = sign(area(p1, q1, p2));
+        i32 o2 = sign(area(p1, q1, q2));
+        i32 o3 = sign(area(p2, q2, p1));
+        i32 o4 = sign(area(p2, q2, q1));
+
+        if (o1 != o2 && o3 != o4)
+            return true;
+
+        return (o1 == 0 && on_segment(p1, p2, q1)) ||
+               (o2 == 0 && on_segment(p1, q2, q1)) ||
+               (o3 == 0 && on_segment(p2, p1, q2)) ||
+               (o4 == 0 && on_segment(p2, q1, q2));
+    }
+
+    // Whether the diagonal ab would lie inside the polygon near a.
+    bool locally_inside(const Node* a, const Node* b)
+    {
+        return area(a->prev, a, a->next) < 0.0
+            ? area(a, b, a->next) >= 0.0 && area(a, a->prev, b) >= 0.0
+            : area(a, b, a->prev) < 0.0 || area(a, a->next, b) < 0.0;
+    }
+
+    // Whether the middle of the diagonal ab lies inside the polygon.
+    bool middle_inside(const Node* a, const Node* b)
+    {
+        const Node* p = a;
+        bool inside = false;
+        f64 px = (a->x + b->x) / 2.0;
+        f64 py = (a->y + b->y) / 2.0;
+
+        do
+        {
+            if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+                (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+                inside = !inside;
+            p = p->next;
+        } while (p != a);
+
+        return inside;
+    }
+
+    bool intersects_polygon(const Node* a, const Node* b)
+    {
+        const Node* p = a;
+        do
+        {
+            if (p->index != a->index && p->next->index != a->index &&
+                p->index != b->index && p->next->index != b->index &&
+                intersects(p, p->next, a, b))
+                return true;
+            p = p->next;
+        } while (p != a);
+
+        return false;
+    }
+
+    bool is_valid_diagonal(const Node* a, const Node* b)
+    {
+        // Does not run along an edge and does not cross any.
+        if (a->next->index == b->index || a->prev->index == b->index || intersects_polygon(a, b))
+            return false;
+
+        // Visible from both ends without creating opposite-facing sectors.
+        if (locally_inside(a, b) && locally_inside(b, a) && middle_inside(a, b) &&
+            (area(a->prev, a, b->prev) != 0.0 || area(a, b->prev, b) != 0.0))
+            return true;
+
+        // Zero-length diagonal between two convex corners.
+        return equals(a, b) && area(a->prev, a, a->next) > 0.0 && area(b->prev, b, b->next) > 0.0;
+    }
+
+    // Whether the sector at m contains the sector at p, both being at the same point.
+    bool sector_contains_sector(const Node* m, const Node* p)
+    {
+        return area(m->prev, m, p->prev) < 0.0 && area(p->next, m, m->next) < 0.0;
+    }
+
+    // Interleaves the bits of the coordinates scaled to 15 bits.
+    u32 z_order(f64 x, f64 y, f64 min_x, f64 min_y, f64 inv_size)
+    {
+        u32 ix = static_cast<u32>((x - min_x) * inv_size);
+        u32 iy = static_cast<u32>((y - min_y) * inv_size);
+
+        ix = (ix | (ix << 8)) & 0x00FF00FF;
+        ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+        ix = (ix | (ix << 2)) & 0x33333333;
+        ix = (ix | (ix << 1)) & 0x55555555;
+
+        iy = (iy | (iy << 8)) & 0x00FF00FF;
+        iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+        iy = (iy | (iy << 2)) & 0x33333333;
+        iy = (iy | (iy << 1)) & 0x55555555;
+
+        return ix | (iy << 1);
+    }
+
+    class EarClipper {
+    public:
+        EarClipper(const Polygon& polygon, std::vector<u32>& indices)
+            : _polygon(polygon), _indices(indices)
+        {
+        }
+
+        void run()
+        {
+            size_t point_count = 0;
+            for (const auto& ring : _polygon.rings)
+                point_count += ring.size();
+
+            if (_polygon.rings.empty())
+                return;
+
+            Node* outer = linked_list(0, true);
+            if (!outer || outer->next == outer->prev)
+                return;
+
+            if (_polygon.rings.size() > 1)
+                outer = eliminate_holes(outer);
+
+            if (point_count > HASHING_THRESHOLD)
+            {
+                const auto& outline = _polygon.rings[0];
+                f64 min_x = outline[0].x, max_x = outline[0].x;
+                f64 min_y = outline[0].y, max_y = outline[0].y;
+
+                for (const Point2D& point : outline)
+                {
+                    min_x = std::min<f64>(min_x, point.x);
+                    min_y = std::min<f64>(min_y, point.y);
+                    max_x = std::max<f64>(max_x, point.x);
+                    max_y = std::max<f64>(max_y, point.y);
+                }
+
+                _min_x = min_x;
+                _min_y = min_y;
+                f64 size = std::max(max_x - min_x, max_y - min_y);
+                _inv_size = size != 0.0 ? 32767.0 / size : 0.0;
+            }
+
+            clip_ears(outer, 0);
+        }
+
+    private:
+        Node* insert_node(u32 index, const Point2D& point, Node* last)
+        {
+            _nodes.emplace_back();
+            Node* node = &_nodes.back();
+            node->index = index;
+            node->x = point.x;
+            node->y = point.y;
+
+            if (!last)
+            {
+                node->prev = node;
+                node->next = node;
+            }
+            else
+            {
+                node->next = last->next;
+                node->prev = last;
+                last->next->prev = node;
+                last->next = node;
+            }
+
+            return node;
+        }
+
+        static void remove_node(Node* node)
+        {
+            node->next->prev = node->prev;
+            node->prev->next = node->next;
+
+            if (node->prev_z)
+                node->prev_z->next_z = node->next_z;
+            if (node->next_z)
+                node->next_z->prev_z = node->prev_z;
+        }
+
+        // Builds the circular list of one ring, in clockwise order for the outline and counter-clockwise for holes.
+        Node* linked_list(size_t ring_index, bool clockwise)
+        {
+            const auto& ring = _polygon.rings[ring_index];
+
+            u32 first_index = 0;
+            for (size_t i = 0; i < ring_index; ++i)
+                first_index += static_cast<u32>(_polygon.rings[i].size());
+
+            f64 signed_area = 0.0;
+            for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+                signed_area += (static_cast<f64>(ring[j].x) - ring[i].x) * (static_cast<f64>(ring[i].y) + ring[j].y);
+
+            Node* last = nullptr;
+            if (clockwise == (signed_area > 0.0))
+            {
+                for (size_t i = 0; i < ring.size(); ++i)
+                    last = insert_node(first_index + static_cast<u32>(i), ring[i], last);
+            }
+            else
+            {
+                for (size_t i = ring.size(); i-- > 0;)
+                    last = insert_node(first_index + static_cast<u32>(i), ring[i], last);
+            }
+
+            if (last && equals(last, last->next))
+            {
+                remove_node(last);
+                last = last->next;
+            }
+
+            return last;
+        }
+
+        // Removes duplicate and collinear points between start and end.
+        static Node* filter_points(Node* start, Node* end = nullptr)
+        {
+            if (!start)
+                return start;
+            if (!end)
+                end = start;
+
+            Node* p = start;
+            bool again;
+            do
+            {
+                again = false;
+
+                if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0.0))
+                {
+                    remove_node(p);
+                    p = end = p->prev;
+                    if (p == p->next)
+                        break;
+                    again = true;
+                }
+                else
+                {
+                    p = p->next;
+                }
+            } while (again || p != end);
+
+            return end;
+        }
+
+        void emit(const Node* a, const Node* b, const Node* c)
+        {
+            _indices.push_back(a->index);
+            _indices.push_back(b->index);
+            _indices.push_back(c->index);
+        }
+
+        // Clips ears until one triangle remains. When no more ears are found, first removes
+        // degenerate points, then cuts off local self-intersections and finally splits the
+        // remaining polygon in two along a valid diagonal.
+        void clip_ears(Node* ear, i32 pass)
+        {
+            if (!ear)
+                return;
+
+            if (pass == 0 && _inv_size != 0.0)
+                index_curve(ear);
+
+            Node* stop = ear;
+
+            while (ear->prev != ear->next)
+            {
+                Node* prev = ear->prev;
+                Node* next = ear->next;
+
+                if (_inv_size != 0.0 ? is_ear_hashed(ear) : is_ear(ear))
+                {
+                    emit(prev, ear, next);
+                    remove_node(ear);
+
+                    // Skipping the next vertex leads to fewer sliver triangles.
+                    ear = next->next;
+                    stop = next->next;
+                    continue;
+                }
+
+                ear = next;
+
+                if (ear == stop)
+                {
+                    if (pass == 0)
+                    {
+                        clip_ears(filter_points(ear), 1);
+                    }
+                    else if (pass == 1)
+                    {
+                        ear = cure_local_intersections(filter_points(ear));
+                        clip_ears(ear, 2);
+                    }
+                    else if (pass == 2)
+                    {
+                        split_and_clip(ear);
+                    }
+                    break;
+                }
+            }
+        }
+
+        static bool is_ear(const Node* ear)
+        {
+            const Node* a = ear->prev;
+            const Node* b = ear;
+            const Node* c = ear->next;
+
+            // Reflex corners can't be ears.
+            if (area(a, b, c) >= 0.0)
+                return false;
+
+            f64 x0 = std::min({a->x, b->x, c->x}), x1 = std::max({a->x, b->x, c->x});
+            f64 y0 = std::min({a->y, b->y, c->y}), y1 = std::max({a->y, b->y, c->y});
+
+            for (const Node* p = c->next; p != a; p = p->next)
+            {
+                if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+                    point_in_triangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+                    area(p->prev, p, p->next) >= 0.0)
+                    return false;
+            }
+
+            return true;
+        }
+
+        bool is_ear_hashed(const Node* ear) const
+        {
+            const Node* a = ear->prev;
+            const Node* b = ear;
+            const Node* c = ear->next;
+
+            if (area(a, b, c) >= 0.0)
+                return false;
+
+            f64 x0 = std::min({a->x, b->x, c->x}), x1 = std::max({a->x, b->x, c->x});
+            f64 y0 = std::min({a->y, b->y, c->y}), y1 = std::max({a->y, b->y, c->y});
+
+            // Only points whose z-order lies within the triangle's bounding box can be inside it.
+            u32 min_z = z_order(x0, y0, _min_x, _min_y, _inv_size);
+            u32 max_z = z_order(x1, y1, _min_x, _min_y, _inv_size);
+
+            auto blocks = [&](const Node* p) {
+                return p != a && p != c &&
+                       p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+                       point_in_triangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+                       area(p->prev, p, p->next) >= 0.0;
+            };
+
+            const Node* p = ear->prev_z;
+            const Node* n = ear->next_z;
+
+            // Walk in both directions at once first, then finish whichever side is left.
+            while (p && p->z >= min_z && n && n->z <= max_z)
+            {
+                if (blocks(p) || blocks(n))
+                    return false;
+                p = p->prev_z;
+                n = n->next_z;
+            }
+
+            for (; p && p->z >= min_z; p = p->prev_z)
+                if (blocks(p))
+                    return false;
+
+            for (; n && n->z <= max_z; n = n->next_z)
+                if (blocks(n))
+                    return false;
+
+            return true;
+        }
+
+        Node* cure_local_intersections(Node* start)
+        {
+            Node* p = start;
+            do
+            {
+                Node* a = p->prev;
+                Node* b = p->next->next;
+
+                if (!equals(a, b) && intersects(a, p, p->next, b) && locally_inside(a, b) && locally_inside(b, a))
+                {
+                    emit(a, p, b);
+
+                    remove_node(p);
+                    remove_node(p->next);
+                    p = start = b;
+                }
+                p = p->next;
+            } while (p != start);
+
+            return filter_points(p);
+        }
+
+        void split_and_clip(Node* start)
+        {
+            Node* a = start;
+            do
+            {
+                for (Node* b = a->next->next; b != a->prev; b = b->next)
+                {
+                    if (a->index != b->index && is_valid_diagonal(a, b))
+                    {
+                        Node* c = split_polygon(a, b);
+
+                        a = filter_points(a, a->next);
+                        c = filter_points(c, c->next);
+
+                        clip_ears(a, 0);
+                        clip_ears(c, 0);
+                        return;
+                    }
+                }
+                a = a->next;
+            } while (a != start);
+        }
+
+        // Connects a and b with a diagonal. a keeps one half, the returned node starts the other.
+        Node* split_polygon(Node* a, Node* b)
+        {
+            _nodes.push_back(*a);
+            Node* a2 = &_nodes.back();
+            _nodes.push_back(*b);
+            Node* b2 = &_nodes.back();
+
+            a2->prev_z = a2->next_z = nullptr;
+            b2->prev_z = b2->next_z = nullptr;
+            a2->steiner = b2->steiner = false;
+
+            Node* an = a->next;
+            Node* bp = b->prev;
+
+            a->next = b;
+            b->prev = a;
+
+            a2->next = an;
+            an->prev = a2;
+
+            b2->next = a2;
+            a2->prev = b2;
+
+            bp->next = b2;
+            b2->prev = bp;
+
+            return b2;
+        }
+
+        Node* eliminate_holes(Node* outer)
+        {
+            std::vector<Node*> holes;
+
+            for (size_t i = 1; i < _polygon.rings.size(); ++i)
+            {
+                if (_polygon.rings[i].empty())
+                    continue;
+
+                Node* list = linked_list(i, false);
+                if (!list)
+                    continue;
+                if (list == list->next)
+                    list->steiner = true;
+
+                holes.push_back(leftmost(list));
+            }
+
+            // Bridging holes from left to right keeps the bridges from crossing each other.
+            std::sort(holes.begin(), holes.end(), [](const Node* a, const Node* b) { return a->x < b->x; });
+
+            for (Node* hole : holes)
+                outer = eliminate_hole(hole, outer);
+
+            return outer;
+        }
+
+        Node* eliminate_hole(Node* hole, Node* outer)
+        {
+            Node* bridge = find_hole_bridge(hole, outer);
+            if (!bridge)
+                return outer;
+
+            Node* bridge_reverse = split_polygon(bridge, hole);
+
+            filter_points(bridge_reverse, bridge_reverse->next);
+            return filter_points(bridge, bridge->next);
+        }
+
+        // Finds the outline vertex to connect the hole's leftmost point to.
+        static Node* find_hole_bridge(const Node* hole, Node* outer)
+        {
+            Node* p = outer;
+            f64 hx = hole->x;
+            f64 hy = hole->y;
+            f64 qx = -std::numeric_limits<f64>::infinity();
+            Node* m = nullptr;
+
+            // Cast a ray from the hole to the left and take the closest segment it hits.
+            // Its endpoint with the lesser x is a candidate for the bridge.
+            do
+            {
+                if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+                {
+                    f64 x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+                    if (x <= hx && x > qx)
+                    {
+                        qx = x;
+                        m = p->x < p->next->x ? p : p->next;
+                        if (x == hx)
+                            return m; // The hole touches the segment.
+                    }
+                }
+                p = p->next;
+            } while (p != outer);
+
+            if (!m)
+                return nullptr;
+
+            // Points inside the triangle between the hole, the hit and the candidate would block the
+            // bridge. If there are any, use the one forming the smallest angle with the ray instead.
+            const Node* stop = m;
+            f64 mx = m->x;
+            f64 my = m->y;
+            f64 tan_min = std::numeric_limits<f64>::infinity();
+
+            p = m;
+            do
+            {
+                if (hx >= p->x && p->x >= mx && hx != p->x &&
+                    point_in_triangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+                {
+                    f64 tan = std::abs(hy - p->y) / (hx - p->x);
+
+                    if (locally_inside(p, hole) &&
+                        (tan < tan_min || (tan == tan_min && (p->x > m->x || (p->x == m->x && sector_contains_sector(m, p))))))
+                    {
+                        m = p;
+                        tan_min = tan;
+                    }
+                }
+                p = p->next;
+            } while (p != stop);
+
+            return m;
+        }
+
+        static Node* leftmost(Node* start)
+        {
+            Node* p = start;
+            Node* result = start;
+            do
+            {
+                if (p->x < result->x || (p->x == result->x && p->y < result->y))
+                    result = p;
+                p = p->next;
+            } while (p != start);
+
+            return result;
+        }
+
+        // Links the nodes in z-order, sorted with a merge sort on the linked list.
+        void index_curve(Node* start)
+        {
+            Node* p = start;
+            do
+            {
+                if (p->z == 0)
+                    p->z = z_order(p->x, p->y, _min_x, _min_y, _inv_size);
+                p->prev_z = p->prev;
+                p->next_z = p->next;
+                p = p->next;
+            } while (p != start);
+
+            p->prev_z->next_z = nullptr;
+            p->prev_z = nullptr;
+
+            sort_linked(p);
+        }
+
+        static Node* sort_linked(Node* list)
+        {
+            i32 merges;
+            size_t in_size = 1;
+
+            do
+            {
+                Node* p = list;
+                Node* tail = nullptr;
+                list = nullptr;
+                merges = 0;
+
+                while (p)
+                {
+                    ++merges;
+
+                    Node* q = p;
+                    size_t p_size = 0;
+                    for (size_t i = 0; i < in_size && q; ++i)
+                    {
+                        ++p_size;
+                        q = q->next_z;
+                    }
+                    size_t q_size = in_size;
+
+                    while (p_size > 0 || (q_size > 0 && q))
+                    {
+                        Node* e;
+                        if (p_size != 0 && (q_size == 0 || !q || p->z <= q->z))
+                        {
+                            e = p;
+                            p = p->next_z;
+                            --p_size;
+                        }
+                        else
+                        {
+                            e = q;
+                            q = q->next_z;
+                            --q_size;
+                        }
+
+                        if (tail)
+                            tail->next_z = e;
+                        else
+                            list = e;
+
+                        e->prev_z = tail;
+                        tail = e;
+                    }
+
+                    p = q;
+                }
+
+                tail->next_z = nullptr;
+                in_size *= 2;
+            } while (merges > 1);
+
+            return list;
+        }
+
+    private:
+        const Polygon& _polygon;
+        std::vector<u32>& _indices;
+
+        // A deque keeps nodes in place while splitting adds more.
+        std::deque<Node> _nodes;
+
+        f64 _min_x = 0.0;
+        f64 _min_y = 0.0;
+        f64 _inv_size = 0.0;
+    };
+
+    u64 hash_polygon(const Polygon& polygon)
+    {
+        // FNV-1a over the ring sizes and coordinates.
+        u64 hash = 14695981039346656037ull;
+        auto mix = [&hash](const void* data, size_t size) {
+            const u8* bytes = static_cast<const u8*>(data);
+            for (size_t i = 0; i < size; ++i)
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+        };
+
+        for (const auto& ring : polygon.rings)
+        {
+            u64 size = ring.size();
+            mix(&size, sizeof(size));
+            mix(ring.data(), ring.size() * sizeof(Point2D));
+        }
+
+        return hash;
+    }
+
+    bool same_polygon(const Polygon& a, const Polygon& b)
+    {
+        if (a.rings.size() != b.rings.size())
+            return false;
+
+        for (size_t i = 0; i < a.rings.size(); ++i)
+        {
+            const auto& ring_a = a.rings[i];
+            const auto& ring_b = b.rings[i];
+
+            if (ring_a.size() != ring_b.size())
+                return false;
+
+            for (size_t j = 0; j < ring_a.size(); ++j)
+                if (ring_a[j].x != ring_b[j].x || ring_a[j].y != ring_b[j].y)
+                    return false;
+        }
+
+        return true;
+    }
+}
+
+TriangleMesh tessellate(const Polygon& polygon)
+{
+    TriangleMesh mesh;
+
+    for (const auto& ring : polygon.rings)
+        mesh.vertices.insert(mesh.vertices.end(), ring.begin(), ring.end());
+
+    mesh.indices.reserve(mesh.vertices.size() * 3);
+    EarClipper(polygon, mesh.indices).run();
+
+    return mesh;
+}
+
+std::vector<TriangleMesh> tessellate_parallel(const std::vector<const Polygon*>& polygons, u32 thread_count)
+{
+    std::vector<TriangleMesh> meshes(polygons.size());
+
+    if (thread_count == 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min<u32>(thread_count, static_cast<u32>(polygons.size()));
+
+    // Paths differ wildly in size, so threads take small batches until all are done.
+    const size_t batch_size = 16;
+    std::atomic<size_t> next{0};
+
+    auto work = [&]() {
+        for (;;)
+        {
+            size_t begin = next.fetch_add(batch_size);
+            if (begin >= polygons.size())
+                break;
+
+            size_t end = std::min(begin + batch_size, polygons.size());
+            for (size_t i = begin; i < end; ++i)
+                meshes[i] = tessellate(*polygons[i]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (u32 i = 1; i < thread_count; ++i)
+        threads.emplace_back(work);
+
+    work();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    return meshes;
+}
+
+f64 tessellation_error(const Polygon& polygon, const TriangleMesh& mesh)
+{
+    auto ring_area = [](const std::vector<Point2D>& ring) {
+        f64 sum = 0.0;
+        for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+            sum += (static_cast<f64>(ring[j].x) - ring[i].x) * (static_cast<f64>(ring[i].y) + ring[j].y);
+        return std::abs(sum) / 2.0;
+    };
+
+    if (polygon.rings.empty())
+        return 0.0;
+
+    f64 polygon_area = ring_area(polygon.rings[0]);
+    for (size_t i = 1; i < polygon.rings.size(); ++i)
+        polygon_area -= ring_area(polygon.rings[i]);
+
+    f64 triangles_area = 0.0;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        const Point2D& a = mesh.vertices[mesh.indices[i]];
+        const Point2D& b = mesh.vertices[mesh.indices[i + 1]];
+        const Point2D& c = mesh.vertices[mesh.indices[i + 2]];
+        triangles_area += std::abs((static_cast<f64>(a.x) - c.x) * (b.y - a.y) - (static_cast<f64>(a.x) - b.x) * (c.y - a.y)) / 2.0;
+    }
+
+    if (polygon_area == 0.0)
+        return triangles_area == 0.0 ? 0.0 : 1.0;
+
+    return std::abs((triangles_area - polygon_area) / polygon_area);
+}
+
+void TessellationCache::prepare(const std::vector<const Polygon*>& polygons)
+{
+    std::vector<const Polygon*> missing;
+    std::vector<u64> hashes;
+
+    for (const Polygon* polygon : polygons)
+    {
+        u64 hash = hash_polygon(*polygon);
+        if (find(*polygon, hash))
+            continue;
+
+        // The same new shape may be in the list more than once.
+        bool duplicate = false;
+        for (size_t i = 0; i < missing.size() && !duplicate; ++i)
+            duplicate = hashes[i] == hash && same_polygon(*missing[i], *polygon);
+
+        if (!duplicate)
+        {
+            missing.push_back(polygon);
+            hashes.push_back(hash);
+        }
+    }
+
+    if (missing.empty())
+        return;
+
+    std::vector<TriangleMesh> meshes = tessellate_parallel(missing);
+
+    for (size_t i = 0; i < missing.size(); ++i)
+        _entries.emplace(hashes[i], Entry{*missing[i], std::move(meshes[i])});
+}
+
+const TriangleMesh& TessellationCache::get(const Polygon& polygon)
+{
+    u64 hash = hash_polygon(polygon);
+
+    if (const TriangleMesh* mesh = find(polygon, hash))
+        return *mesh;
+
+    auto it = _entries.emplace(hash, Entry{polygon, tessellate(polygon)});
+    return it->second.mesh;
+}
+
+void TessellationCache::clear()
+{
+    _entries.clear();
+}
+
+size_t TessellationCache::size() const
+{
+    return _entries.size();
+}
+
+const TriangleMesh* TessellationCache::find(const Polygon& polygon, u64 hash) const
+{
+    auto range = _entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+        if (same_polygon(it->second.polygon, polygon))
+            return &it->second.mesh;
+
+    return nullptr;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <util/types.hpp>
+
+struct Point2D {
+    f32 x, y;
+};
+
+// A filled path. The first ring is the outline, every further ring is a hole in it.
+// Rings are closed implicitly and may be given in either winding order.
+struct Polygon {
+    std::vector<std::vector<Point2D>> rings;
+};
+
+// Triangles indexing into the polygon's points, all rings concatenated in order.
+// Ready to be uploaded into a VBO and EBO and drawn with glDrawElements(GL_TRIANGLES, ...).
+struct TriangleMesh {
+    std::vector<Point2D> vertices;
+    std::vector<u32> indices;
+};
+
+// Triangulates a polygon with holes by ear clipping. Holes are first bridged into the outline,
+// larger polygons use a z-order curve to only test nearby vertices when clipping an ear.
+TriangleMesh tessellate(const Polygon& polygon);
+
+// Tessellates all polygons, spread over thread_count threads (0 uses all hardware threads).
+std::vector<TriangleMesh> tessellate_parallel(const std::vector<const Polygon*>& polygons, u32 thread_count = 0);
+
+// Relative difference between the polygon's area and the area of its triangles, 0 for a perfect result.
+f64 tessellation_error(const Polygon& polygon, const TriangleMesh& mesh);
+
+// Remembers the tessellation of every shape it has seen. Shapes are identified by their points,
+// so a shape that changes is simply tessellated again.
+class TessellationCache {
+public:
+    // Tessellates all shapes that are not cached yet in parallel.
+    void prepare(const std::vector<const Polygon*>& polygons);
+
+    // Returns the cached tessellation, tessellating the shape first if needed.
+    const TriangleMesh& get(const Polygon& polygon);
+
+    void clear();
+    size_t size() const;
+
+private:
+    struct Entry {
+        Polygon polygon;
+        TriangleMesh mesh;
+    };
+
+    const TriangleMesh* find(const Polygon& polygon, u64 hash) const;
+
+    std::unordered_multimap<u64, Entry> _entries;
+};
@@ -2,6 +2,7 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <GLFW/glfw3.h>
+#include <cstdio>
 
 enum ErrorTypes {
     OK,
@@ -9,9 +10,33 @@ enum ErrorTypes {
     GLEW_ERROR,
 };
 
+/* When on, frames are only drawn when the window contents changed (press O to toggle). */
+bool g_on_demand = true;
+bool g_needs_redraw = true;
+
+/* Frame rate a continuously rendering loop would run at, used to count skipped frames. */
+const double REFERENCE_FRAME_RATE = 60.0;
+
 void handle_resize(GLFWwindow* window, int width, int height)
 {
     glViewport(0, 0, width, height);
+    g_needs_redraw = true;
+}
+
+/* Called when the window system lost the window contents, e.g. after being uncovered. */
+void handle_refresh(GLFWwindow* window)
+{
+    g_needs_redraw = true;
+}
+
+void handle_key(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if (key == GLFW_KEY_O && action == GLFW_PRESS)
+    {
+        g_on_demand = !g_on_demand;
+        g_needs_redraw = true;
+        std::cout << (g_on_demand ? "On-demand rendering" : "Continuous rendering") << std::endl;
+    }
 }
 
 void handle_inputs(GLFWwindow* window)
@@ -53,21 +78,52 @@ int main()
 
     glViewport(0, 0, 800, 600);
     glfwSetFramebufferSizeCallback(window, handle_resize);
+    glfwSetWindowRefreshCallback(window, handle_refresh);
+    glfwSetKeyCallback(window, handle_key);
+    glfwSwapInterval(1);
 
     glClearColor(0.0f, 0.9f, 0.5f, 1.0f);
 
+    /* Nothing in the window moves, so the whole window is damaged or nothing is. */
+    int frames_drawn = 0;
+    double stats_start = glfwGetTime();
+
     while (!glfwWindowShouldClose(window))
     {
         handle_inputs(window);
 
-        /* === render in here === */
-
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        /* ====================== */
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        if (g_needs_redraw || !g_on_demand)
+        {
+            /* === render in here === */
+
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            /* ====================== */
+
+            glfwSwapBuffers(window);
+            g_needs_redraw = false;
+            frames_drawn++;
+        }
+
+        double elapsed = glfwGetTime() - stats_start;
+        if (elapsed >= 1.0)
+        {
+            int frames_expected = (int)(elapsed * REFERENCE_FRAME_RATE + 0.5);
+            int frames_skipped = frames_expected > frames_drawn ? frames_expected - frames_drawn : 0;
+            double redrawn = frames_expected > 0 ? 100.0 * frames_drawn / frames_expected : 0.0;
+            if (redrawn > 100.0)
+                redrawn = 100.0;
+
+            printf("%d frames drawn, %d skipped, %.1f%% of pixels redrawn\n", frames_drawn, frames_skipped, redrawn);
+            frames_drawn = 0;
+            stats_start = glfwGetTime();
+        }
+
+        /* Sleep until something happens, waking up once a second to report the statistics. */
+        if (g_on_demand)
+            glfwWaitEventsTimeout(1.0);
+        else
+            glfwPollEvents();
     }
 
     glfwTerminate();
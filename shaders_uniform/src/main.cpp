@@ -1,9 +1,18 @@
 #include <iostream>
 #include <string>
 #include <cstdio>
+#include <cstring>
+#include <cstdlib>
 #include <math.h>
+#include <algorithm>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <render/damage.hpp>
+#include <render/retained_framebuffer.hpp>
+#include <session/frame_times.hpp>
+#include <session/golden_images.hpp>
+#include <session/session.hpp>
+#include <simulation/fixed_step_simulation.hpp>
 #include <util/types.hpp>
 
 static const char* WINDOW_TITLE = "Learn OpenGL";
@@ -14,6 +23,9 @@ enum StatusCode {
     GLFW_ERROR,
     GLEW_ERROR,
     SHADER_ERROR,
+    SESSION_ERROR,
+    GOLDEN_IMAGE_MISMATCH,
+    PERFORMANCE_REGRESSION,
 };
 
 struct Vec3D {
@@ -24,6 +36,29 @@ struct Color {
     float r, g, b, a;
 };
 
+// Frames a continuous render loop would draw per second, used to count the frames skipped.
+static const f64 REFERENCE_FRAME_RATE = 60.0;
+
+// Simulation steps per second. Deliberately not the frame rate, the renderer interpolates in between.
+static const f64 SIMULATION_TICK_RATE = 50.0;
+
+// Frames of a playback compared against golden images: every GOLDEN_FRAME_INTERVAL-th and the last one.
+static const u64 GOLDEN_FRAME_INTERVAL = 60;
+
+// Global state variables for on-demand rendering. When enabled, only the regions of the window that
+// changed are redrawn, and nothing at all when nothing changed. Toggled with O, SPACE pauses the animation.
+bool g_on_demand = true, g_poll_o_key = true;
+bool g_animate = true, g_poll_space_key = true;
+
+// Global state variables set by the window callbacks.
+bool g_resized = true, g_needs_present = false;
+i32 g_framebuffer_width = 800, g_framebuffer_height = 600;
+
+// Global session recorder and player. While a session is played back, it replaces the keyboard, the
+// window size and the simulation clock, the window's own events are ignored.
+SessionRecorder g_session_recorder;
+SessionPlayer g_session_player;
+
 char* load_shader_source(const char* file_name)
 {
     FILE* shader_file = fopen(file_name, "r");
@@ -39,29 +74,210 @@ char* load_shader_source(const char* file_name)
     if (!file_size)
         return nullptr;
 
-    char* shader_source = (char*)malloc(file_size);
+    // glShaderSource() expects a null-terminated string.
+    char* shader_source = (char*)malloc(file_size + 1);
     fread(shader_source, file_size, 1, shader_file);
+    shader_source[file_size] = '\0';
     fclose(shader_file);
 
     return shader_source;
 }
 
-void handle_resize(GLFWwindow* window, i32 width, i32 height)
+void resize_framebuffer(i32 width, i32 height)
 {
     glViewport(0, 0, width, height);
+    g_framebuffer_width = width;
+    g_framebuffer_height = height;
+    g_resized = true;
+}
+
+void handle_resize(GLFWwindow* window, i32 width, i32 height)
+{
+    if (g_session_player.is_loaded())
+        return;
+
+    resize_framebuffer(width, height);
+    g_session_recorder.record_resize(width, height);
+}
+
+// Called when the window has to be shown again, e.g. after being uncovered. Nothing changed,
+// so the retained image only has to be presented again.
+void handle_refresh(GLFWwindow* window)
+{
+    if (!g_session_player.is_loaded())
+        g_needs_present = true;
+}
+
+// The keys are polled, the key events are only needed to record them.
+void handle_key(GLFWwindow* window, i32 key, i32 scancode, i32 action, i32 mods)
+{
+    g_session_recorder.record_key(key, action);
+}
+
+// Like glfwGetKey(), but from the session while one is played back.
+i32 get_key(GLFWwindow* window, i32 key)
+{
+    if (g_session_player.is_loaded())
+        return g_session_player.get_key(key);
+
+    return glfwGetKey(window, key);
+}
+
+// Returns whether a key went from released to pressed, using poll_key to remember the last state.
+bool key_pressed(GLFWwindow* window, i32 key, bool& poll_key)
+{
+    i32 status = get_key(window, key);
+    if (poll_key && status == GLFW_PRESS)
+    {
+        poll_key = false;
+        return true;
+    }
+    if (status == GLFW_RELEASE)
+        poll_key = true;
+    return false;
 }
 
 void handle_inputs(GLFWwindow* window)
 {
     // Close window when ESC key was pressed.
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+    if (get_key(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
+
+    if (key_pressed(window, GLFW_KEY_O, g_poll_o_key))
+    {
+        g_on_demand = !g_on_demand;
+        std::cout << (g_on_demand ? "On-demand rendering" : "Continuous rendering") << std::endl;
+    }
+
+    if (key_pressed(window, GLFW_KEY_SPACE, g_poll_space_key))
+        g_animate = !g_animate;
+}
+
+// The simulation thread can't read the keys itself, GLFW only allows that on the main thread.
+// The triangle is moved with the arrow keys.
+SimulationInput read_simulation_input(GLFWwindow* window)
+{
+    SimulationInput input = { g_animate, 0.0f, 0.0f };
+
+    if (get_key(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+        input.move_x -= 1.0f;
+    if (get_key(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+        input.move_x += 1.0f;
+    if (get_key(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+        input.move_y -= 1.0f;
+    if (get_key(window, GLFW_KEY_UP) == GLFW_PRESS)
+        input.move_y += 1.0f;
+
+    return input;
 }
 
-int main()
+// Bounding rectangle in framebuffer pixels of vertices given in normalized device coordinates.
+Rect screen_bounds(const Vec3D* vertices, u32 count, Vec3D offset)
+{
+    f32 min_x = 1.0f, min_y = 1.0f, max_x = -1.0f, max_y = -1.0f;
+    for (u32 i = 0; i < count; ++i)
+    {
+        min_x = std::min(min_x, vertices[i].x + offset.x);
+        min_y = std::min(min_y, vertices[i].y + offset.y);
+        max_x = std::max(max_x, vertices[i].x + offset.x);
+        max_y = std::max(max_y, vertices[i].y + offset.y);
+    }
+
+    // One pixel of padding for the pixels the rasterizer rounds into the triangle.
+    i32 x0 = (i32)floorf((min_x * 0.5f + 0.5f) * g_framebuffer_width) - 1;
+    i32 y0 = (i32)floorf((min_y * 0.5f + 0.5f) * g_framebuffer_height) - 1;
+    i32 x1 = (i32)ceilf((max_x * 0.5f + 0.5f) * g_framebuffer_width) + 1;
+    i32 y1 = (i32)ceilf((max_y * 0.5f + 0.5f) * g_framebuffer_height) + 1;
+
+    return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
 
+    // Run with `shaders_uniform.out --tick-cost <ms>` to make every simulation tick that much more expensive.
+    // With `--record <file>` the keys pressed and the frame clock are written to a session file, and with
+    // `--playback <file> [--frame-times <file>]` it is replayed as a benchmark: in a hidden window, without
+    // waiting for vertical sync, printing the time every frame took. `--draw-repeat <count>` draws the triangle
+    // that many times a frame, to give a playback enough work to time.
+    //
+    // A playback doubles as a regression test, which fails with a non-zero exit code:
+    // `--golden <directory> [--golden-tolerance <percent>]` compares frames against the golden images in the
+    // directory, and `--baseline <file> [--max-regression <percent>]` the frame times against a baseline.
+    // A missing golden image or baseline fails too: `--update` stores the frames and frame times of the run as
+    // the new golden images and baseline instead. Frames that fail are written next to their golden images, or
+    // to `--failure-dir <directory>`. Frame times depend on the machine, so a baseline can be kept per machine:
+    // `--store-missing-baseline` stores the frame times as the baseline when there is none yet, and later runs
+    // compare against it. Runs without a GPU on Mesa's llvmpipe, e.g. with LIBGL_ALWAYS_SOFTWARE=1. CTest plays
+    // back the sessions in tests/.
+    f64 tick_cost_ms = 0.0;
+    const char* record_file_name = nullptr;
+    const char* playback_file_name = nullptr;
+    const char* frame_times_file_name = nullptr;
+    const char* golden_directory = nullptr;
+    const char* failure_directory = nullptr;
+    const char* baseline_file_name = nullptr;
+    f64 golden_tolerance_percent = 0.1;
+    f64 max_regression_percent = 10.0;
+    i32 draw_repeat = 1;
+    bool update = false;
+    bool store_missing_baseline = false;
+    for (i32 i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--update") == 0)
+            update = true;
+        else if (strcmp(argv[i], "--store-missing-baseline") == 0)
+            store_missing_baseline = true;
+        else if (i + 1 == argc)
+            break;
+        else if (strcmp(argv[i], "--tick-cost") == 0)
+            tick_cost_ms = atof(argv[++i]);
+        else if (strcmp(argv[i], "--record") == 0)
+            record_file_name = argv[++i];
+        else if (strcmp(argv[i], "--playback") == 0)
+            playback_file_name = argv[++i];
+        else if (strcmp(argv[i], "--draw-repeat") == 0)
+            draw_repeat = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--frame-times") == 0)
+            frame_times_file_name = argv[++i];
+        else if (strcmp(argv[i], "--golden") == 0)
+            golden_directory = argv[++i];
+        else if (strcmp(argv[i], "--failure-dir") == 0)
+            failure_directory = argv[++i];
+        else if (strcmp(argv[i], "--golden-tolerance") == 0)
+            golden_tolerance_percent = atof(argv[++i]);
+        else if (strcmp(argv[i], "--baseline") == 0)
+            baseline_file_name = argv[++i];
+        else if (strcmp(argv[i], "--max-regression") == 0)
+            max_regression_percent = atof(argv[++i]);
+    }
+
+    i32 window_width = 800, window_height = 600;
+    if (playback_file_name)
+    {
+        if (!g_session_player.load(playback_file_name))
+        {
+            std::cout << "Could not load session " << playback_file_name << "." << std::endl;
+            return StatusCode::SESSION_ERROR;
+        }
+
+        i32 recorded_width, recorded_height;
+        g_session_player.get_initial_size(recorded_width, recorded_height);
+        if (recorded_width > 0 && recorded_height > 0)
+        {
+            window_width = recorded_width;
+            window_height = recorded_height;
+        }
+    }
+
+    GoldenImages golden_images;
+    if (golden_directory && playback_file_name && !golden_images.open(golden_directory, golden_tolerance_percent, update, failure_directory))
+    {
+        std::cout << "Could not open the golden image directory " << golden_directory << "." << std::endl;
+        return StatusCode::SESSION_ERROR;
+    }
+
     // Initialize and configure GLFW.
     if (!glfwInit())
     {
@@ -73,7 +289,11 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    window = glfwCreateWindow(800, 600, WINDOW_TITLE, nullptr, nullptr);
+    // Nobody is watching a playback.
+    if (g_session_player.is_loaded())
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    window = glfwCreateWindow(window_width, window_height, WINDOW_TITLE, nullptr, nullptr);
     if (window == nullptr)
     {
         std::cout << "Could not create window." << std::endl;
@@ -90,8 +310,22 @@ int main()
         return StatusCode::GLEW_ERROR;
     }
 
-    glViewport(0, 0, 800, 600);
+    glViewport(0, 0, window_width, window_height);
     glfwSetFramebufferSizeCallback(window, handle_resize);
+    glfwSetWindowRefreshCallback(window, handle_refresh);
+    glfwSetKeyCallback(window, handle_key);
+    glfwGetFramebufferSize(window, &g_framebuffer_width, &g_framebuffer_height);
+
+    // Play back as fast as possible.
+    glfwSwapInterval(g_session_player.is_loaded() ? 0 : 1);
+
+    if (record_file_name)
+    {
+        if (!g_session_recorder.open(record_file_name))
+            std::cout << "Could not create session " << record_file_name << "." << std::endl;
+
+        g_session_recorder.record_resize(g_framebuffer_width, g_framebuffer_height);
+    }
     
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
@@ -199,34 +433,233 @@ int main()
 
     /* Main loop */
 
+    // Finding the uniform location doesn't require a shader program to be in use ...
+    i32 vertex_color_location = glGetUniformLocation(shader_program, "ourColor");
+    i32 offset_location = glGetUniformLocation(shader_program, "offset");
+
+    RetainedFramebuffer retained_framebuffer;
+    DamageTracker damage;
+
+    // The animation and the triangle's position are advanced by the simulation thread. Frames show the
+    // state one tick in the past, interpolated between the two latest ticks, so the motion stays smooth
+    // no matter how the frame rate and the tick rate line up.
+    // While a session is played back, the simulation is advanced to the recorded frame times instead.
+    FixedStepSimulation simulation(SIMULATION_TICK_RATE);
+    simulation.set_tick_cost(tick_cost_ms / 1000.0);
+    simulation.set_input(read_simulation_input(window));
+    if (!g_session_player.is_loaded())
+        simulation.start();
+
+    float green_value = 0.5f;
+    f64 drawn_animation_time = -1.0;
+    Vec3D drawn_offset = { 0.0f, 0.0f, 0.0f };
+
+    // Statistics, printed once a second.
+    f64 stats_start = glfwGetTime();
+    u64 frames_drawn = 0;
+    i64 pixels_redrawn = 0, pixels_total = 0;
+    u64 reported_overruns = 0, reported_dropped_ticks = 0;
+
+    // Time every frame took from its start until it was swapped, while playing back a session.
+    FrameTimes frame_times;
+
     while (!glfwWindowShouldClose(window))
     {
-        handle_inputs(window);
+        f64 frame_start = glfwGetTime();
+
+        if (g_session_player.is_loaded())
+        {
+            if (!g_session_player.next_frame())
+                break;
 
-        glClear(GL_COLOR_BUFFER_BIT);
+            for (const SessionEvent& event : g_session_player.get_frame().events)
+            {
+                if (event.type == SessionEventType::RESIZE_EVENT)
+                    resize_framebuffer(event.width, event.height);
+            }
+        }
 
-        // Note:
-        // As the program gets more sophisticated and more shader programs and buffer objects are used,
-        // glUseProgram() and glDrawArrays() allow us to swap these around as needed. In this example,
-        // there is really no need to call these functions in each iteration of the rendering loop.
+        handle_inputs(window);
 
-        glUseProgram(shader_program);
-        
-        float time_value = glfwGetTime();
-        float green_value = (sin(time_value) * 0.5f) + 0.5f;
-        // Finding the uniform location doesn't require a shader program to be in use ...
-        i32 vertex_color_location = glGetUniformLocation(shader_program, "ourColor");
-        // ... but updating the uniform does.
-        // However, both can be done after the shader program is specified with glUseProgram().
-        glUniform4f(vertex_color_location, 0.0f, green_value, 0.0f, 1.0f);
+        SimulationInput input = read_simulation_input(window);
+        simulation.set_input(input);
+
+        if (g_session_player.is_loaded())
+            simulation.advance_to(g_session_player.get_frame().time);
+        g_session_recorder.begin_frame(simulation.now());
+
+        SimulationSnapshot snapshot = simulation.get_snapshot();
+        f64 render_time = simulation.now() - simulation.get_tick_duration();
+        f64 tick_span = snapshot.current.time - snapshot.previous.time;
+        f64 alpha = tick_span > 0.0 ? std::clamp((render_time - snapshot.previous.time) / tick_span, 0.0, 1.0) : 1.0;
+        SimulationState state = interpolate(snapshot.previous, snapshot.current, alpha);
+        Vec3D offset = { state.offset_x, state.offset_y, 0.0f };
+
+        if (g_resized)
+        {
+            retained_framebuffer.resize(g_framebuffer_width, g_framebuffer_height);
+            damage.resize(g_framebuffer_width, g_framebuffer_height);
+            g_resized = false;
+        }
+
+        // Collect what changed since the last frame: the animated triangle's color and its position.
+        if (state.animation_time != drawn_animation_time)
+        {
+            green_value = (sin(state.animation_time) * 0.5f) + 0.5f;
+            damage.add(screen_bounds(vertices, 3, offset));
+            drawn_animation_time = state.animation_time;
+        }
+
+        if (offset.x != drawn_offset.x || offset.y != drawn_offset.y)
+        {
+            // Both where the triangle was and where it is now.
+            damage.add(screen_bounds(vertices, 3, drawn_offset));
+            damage.add(screen_bounds(vertices, 3, offset));
+            drawn_offset = offset;
+        }
+
+        if (!g_on_demand)
+            damage.add_full();
+
+        if (damage.is_damaged())
+        {
+            retained_framebuffer.bind();
+
+            // Note:
+            // As the program gets more sophisticated and more shader programs and buffer objects are used,
+            // glUseProgram() and glDrawArrays() allow us to swap these around as needed. In this example,
+            // there is really no need to call these functions in each iteration of the rendering loop.
+
+            glUseProgram(shader_program);
+
+            // ... but updating the uniform does.
+            // However, both can be done after the shader program is specified with glUseProgram().
+            glUniform4f(vertex_color_location, 0.0f, green_value, 0.0f, 1.0f);
+            glUniform3f(offset_location, drawn_offset.x, drawn_offset.y, drawn_offset.z);
+
+            glBindVertexArray(vao);
+
+            // Everything that is visible is drawn once per damaged region, the scissor test keeps
+            // the pixels outside of it untouched.
+            glEnable(GL_SCISSOR_TEST);
+            for (const Rect& rect : damage.get_rects())
+            {
+                glScissor(rect.x, rect.y, rect.width, rect.height);
+                glClear(GL_COLOR_BUFFER_BIT);
+
+                // Every repeat draws the same pixels, it only adds work for a playback to time.
+                for (i32 repeat = 0; repeat < draw_repeat; ++repeat)
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+            }
+            glDisable(GL_SCISSOR_TEST);
+
+            frames_drawn++;
+            pixels_redrawn += damage.get_damaged_pixels();
+            pixels_total += damage.get_total_pixels();
+            damage.clear();
+            g_needs_present = true;
+        }
+
+        // Swapping waits for vertical sync, which paces the loop while frames are being drawn.
+        bool presented = g_needs_present;
+        if (g_needs_present)
+        {
+            retained_framebuffer.present();
+            glfwSwapBuffers(window);
+            g_needs_present = false;
+        }
+
+        f64 now = glfwGetTime();
+        if (g_session_player.is_loaded())
+            frame_times.record(now - frame_start);
+
+        // The retained framebuffer always holds the latest frame, whether it was redrawn or not.
+        if (golden_images.is_open())
+        {
+            u64 frame_index = g_session_player.get_frame_index();
+            if (frame_index % GOLDEN_FRAME_INTERVAL == 0 || frame_index + 1 == g_session_player.get_frame_count())
+            {
+                Image image;
+                read_framebuffer(retained_framebuffer.get_framebuffer(), g_framebuffer_width, g_framebuffer_height, image);
+                golden_images.check(frame_index, image);
+            }
+        }
+
+        if (now - stats_start >= 1.0)
+        {
+            // Frames skipped are those a continuous loop would have drawn in the meantime.
+            f64 elapsed = now - stats_start;
+            i64 frames_skipped = std::max<i64>(0, (i64)(elapsed * REFERENCE_FRAME_RATE) - (i64)frames_drawn);
+            f64 redrawn_percent = pixels_total ? 100.0 * pixels_redrawn / pixels_total : 0.0;
+
+            printf("%llu frames drawn, %lld skipped, %.1f%% of pixels redrawn\n",
+                (unsigned long long)frames_drawn, (long long)frames_skipped, redrawn_percent);
+
+            // Ticks the simulation thread could not start on time, e.g. because they take too long.
+            u64 overruns = simulation.get_overruns(), dropped_ticks = simulation.get_dropped_ticks();
+            if (overruns != reported_overruns)
+            {
+                printf("%llu simulation tick overruns, %llu ticks dropped\n",
+                    (unsigned long long)(overruns - reported_overruns), (unsigned long long)(dropped_ticks - reported_dropped_ticks));
+                reported_overruns = overruns;
+                reported_dropped_ticks = dropped_ticks;
+            }
+
+            stats_start = now;
+            frames_drawn = 0;
+            pixels_redrawn = 0;
+            pixels_total = 0;
+        }
+
+        // Sleep until something happens when idle. The timeout keeps the statistics coming.
+        // Until the frames caught up with the latest tick, there still is motion left to show.
+        bool settled = drawn_animation_time == snapshot.current.animation_time &&
+                       drawn_offset.x == snapshot.current.offset_x && drawn_offset.y == snapshot.current.offset_y;
+        bool idle = g_on_demand && !input.animate && input.move_x == 0.0f && input.move_y == 0.0f && settled;
+        // Without a swap to wait for, the simulation simply has not produced anything new yet.
+        // A playback never waits, its clock only moves from one frame to the next.
+        if (g_session_player.is_loaded())
+            glfwPollEvents();
+        else if (idle)
+            glfwWaitEventsTimeout(1.0);
+        else if (!presented)
+            glfwWaitEventsTimeout(1.0 / REFERENCE_FRAME_RATE);
+        else
+            glfwPollEvents();
+    }
 
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+    simulation.stop();
+    g_session_recorder.close();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    StatusCode status = StatusCode::OK;
+    if (g_session_player.is_loaded())
+    {
+        frame_times.print("Playback");
+        if (frame_times_file_name && !frame_times.write(frame_times_file_name))
+            std::cout << "Could not write frame times to " << frame_times_file_name << "." << std::endl;
+
+        if (golden_images.is_open())
+        {
+            golden_images.print_summary();
+            if (golden_images.failed())
+                status = StatusCode::GOLDEN_IMAGE_MISMATCH;
+        }
+
+        if (baseline_file_name && (update || (store_missing_baseline && !FrameTimes::has_baseline(baseline_file_name))))
+        {
+            if (!frame_times.write_baseline(baseline_file_name) && status == StatusCode::OK)
+                status = StatusCode::SESSION_ERROR;
+        }
+        else if (baseline_file_name && !frame_times.check_baseline(baseline_file_name, max_regression_percent) && status == StatusCode::OK)
+        {
+            status = StatusCode::PERFORMANCE_REGRESSION;
+        }
     }
 
+    retained_framebuffer.release();
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+
     glfwTerminate();
-    return StatusCode::OK;
+    return status;
 }
@@ -0,0 +1,116 @@
+#include "damage.hpp"
+
+#include <algorithm>
+
+Rect rect_union(const Rect& a, const Rect& b)
+{
+    if (a.empty())
+        return b;
+    if (b.empty())
+        return a;
+
+    i32 x0 = std::min(a.x, b.x);
+    i32 y0 = std::min(a.y, b.y);
+    i32 x1 = std::max(a.x + a.width, b.x + b.width);
+    i32 y1 = std::max(a.y + a.height, b.y + b.height);
+
+    return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+Rect rect_intersection(const Rect& a, const Rect& b)
+{
+    i32 x0 = std::max(a.x, b.x);
+    i32 y0 = std::max(a.y, b.y);
+    i32 x1 = std::min(a.x + a.width, b.x + b.width);
+    i32 y1 = std::min(a.y + a.height, b.y + b.height);
+
+    if (x1 <= x0 || y1 <= y0)
+        return { 0, 0, 0, 0 };
+
+    return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+bool rects_touch(const Rect& a, const Rect& b)
+{
+    return a.x <= b.x + b.width && b.x <= a.x + a.width &&
+           a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+void DamageTracker::resize(i32 width, i32 height)
+{
+    _width = width;
+    _height = height;
+    add_full();
+}
+
+void DamageTracker::add(Rect rect)
+{
+    rect = rect_intersection(rect, { 0, 0, _width, _height });
+    if (rect.empty())
+        return;
+
+    // Merging may make the rectangle touch others it didn't before, so repeat until nothing changes.
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (size_t i = 0; i < _rects.size(); ++i)
+        {
+            if (rects_touch(_rects[i], rect))
+            {
+                rect = rect_union(_rects[i], rect);
+                _rects.erase(_rects.begin() + i);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    _rects.push_back(rect);
+
+    if (_rects.size() > MAX_RECTS)
+    {
+        Rect bounds = { 0, 0, 0, 0 };
+        for (const Rect& r : _rects)
+            bounds = rect_union(bounds, r);
+
+        _rects.clear();
+        _rects.push_back(bounds);
+    }
+}
+
+void DamageTracker::add_full()
+{
+    _rects.clear();
+    if (_width > 0 && _height > 0)
+        _rects.push_back({ 0, 0, _width, _height });
+}
+
+void DamageTracker::clear()
+{
+    _rects.clear();
+}
+
+bool DamageTracker::is_damaged() const
+{
+    return !_rects.empty();
+}
+
+const std::vector<Rect>& DamageTracker::get_rects() const
+{
+    return _rects;
+}
+
+i64 DamageTracker::get_damaged_pixels() const
+{
+    // The rectangles never overlap, they are merged when added.
+    i64 pixels = 0;
+    for (const Rect& rect : _rects)
+        pixels += rect.area();
+    return pixels;
+}
+
+i64 DamageTracker::get_total_pixels() const
+{
+    return (i64)_width * _height;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <util/types.hpp>
+
+// A rectangle in framebuffer pixels with its origin in the bottom left corner, like glScissor() expects it.
+struct Rect {
+    i32 x, y, width, height;
+
+    bool empty() const { return width <= 0 || height <= 0; }
+    i64 area() const { return empty() ? 0 : (i64)width * height; }
+};
+
+Rect rect_union(const Rect& a, const Rect& b);
+Rect rect_intersection(const Rect& a, const Rect& b);
+bool rects_touch(const Rect& a, const Rect& b);
+
+// Collects the regions of the framebuffer that changed since the last frame, so only those
+// have to be redrawn. Overlapping or touching regions are merged, and once there are more
+// than MAX_RECTS the whole damage collapses into its bounding rectangle, as every region
+// costs a scissored clear and a pass over all objects.
+class DamageTracker {
+public:
+    static const size_t MAX_RECTS = 8;
+
+    void resize(i32 width, i32 height);
+
+    // Marks a region as changed, clipped to the framebuffer.
+    void add(Rect rect);
+    void add_full();
+    void clear();
+
+    bool is_damaged() const;
+    const std::vector<Rect>& get_rects() const;
+    i64 get_damaged_pixels() const;
+    i64 get_total_pixels() const;
+
+private:
+    i32 _width = 0;
+    i32 _height = 0;
+    std::vector<Rect> _rects;
+};
@@ -0,0 +1,60 @@
+#include "retained_framebuffer.hpp"
+
+RetainedFramebuffer::~RetainedFramebuffer()
+{
+    release();
+}
+
+bool RetainedFramebuffer::resize(i32 width, i32 height)
+{
+    release();
+
+    _width = width;
+    _height = height;
+
+    if (width <= 0 || height <= 0)
+        return false;
+
+    glGenRenderbuffers(1, &_color_buffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, _color_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _color_buffer);
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    return complete;
+}
+
+void RetainedFramebuffer::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+}
+
+void RetainedFramebuffer::present() const
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, _width, _height, 0, 0, _width, _height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+GLuint RetainedFramebuffer::get_framebuffer() const
+{
+    return _framebuffer;
+}
+
+void RetainedFramebuffer::release()
+{
+    if (!_framebuffer && !_color_buffer)
+        return;
+
+    glDeleteFramebuffers(1, &_framebuffer);
+    glDeleteRenderbuffers(1, &_color_buffer);
+    _framebuffer = 0;
+    _color_buffer = 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <util/types.hpp>
+
+// Offscreen framebuffer that keeps the last rendered image. The default framebuffer's back
+// buffer is undefined after swapping, so partial redraws go in here and every presented
+// frame copies it over with a blit.
+class RetainedFramebuffer {
+public:
+    RetainedFramebuffer() = default;
+    ~RetainedFramebuffer();
+
+    // Owns GL objects, copies would delete them twice.
+    RetainedFramebuffer(const RetainedFramebuffer&) = delete;
+    RetainedFramebuffer& operator=(const RetainedFramebuffer&) = delete;
+
+    // (Re)creates the color buffer. Its contents are undefined afterwards.
+    bool resize(i32 width, i32 height);
+
+    // Makes it the target for drawing.
+    void bind() const;
+
+    // Copies it into the default framebuffer's back buffer, ready for glfwSwapBuffers().
+    void present() const;
+
+    GLuint get_framebuffer() const;
+
+    // Deletes the GL objects. Has to run while the context is current, so call it before
+    // glfwTerminate(); the destructor then has nothing left to delete.
+    void release();
+
+private:
+    GLuint _framebuffer = 0;
+    GLuint _color_buffer = 0;
+    i32 _width = 0;
+    i32 _height = 0;
+};
@@ -2,7 +2,9 @@
 
 layout (location = 0) in vec3 aPos;
 
+uniform vec3 offset;
+
 void main()
 {
-	gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);
+	gl_Position = vec4(aPos + offset, 1.0);
 }
\ No newline at end of file
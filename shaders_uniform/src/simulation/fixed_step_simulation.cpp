@@ -0,0 +1,193 @@
+#include "fixed_step_simulation.hpp"
+
+#include <algorithm>
+
+// Distance moved per second while an arrow key is held, in normalized device coordinates.
+static const f32 MOVE_SPEED = 0.6f;
+
+FixedStepSimulation::FixedStepSimulation(f64 tick_rate) :
+    _tick_duration(1.0 / tick_rate),
+    _epoch(std::chrono::steady_clock::now())
+{
+    SimulationState initial = { 0.0, 0.0, 0.0f, 0.0f };
+    _snapshot = { initial, initial };
+}
+
+FixedStepSimulation::~FixedStepSimulation()
+{
+    stop();
+}
+
+void FixedStepSimulation::start()
+{
+    if (_running.exchange(true))
+        return;
+
+    _thread = std::thread(&FixedStepSimulation::run, this);
+}
+
+void FixedStepSimulation::stop()
+{
+    if (!_running.exchange(false))
+        return;
+
+    _thread.join();
+}
+
+void FixedStepSimulation::advance_to(f64 time)
+{
+    SimulationState state = get_snapshot().current;
+
+    // The first call starts the clock, just like the simulation thread starts it when it runs.
+    if (!_advanced)
+    {
+        _advanced = true;
+        _advanced_time = time;
+        _advanced_next_tick = time + _tick_duration;
+
+        state.time = time;
+        std::lock_guard<std::mutex> lock(_snapshot_mutex);
+        _snapshot = { state, state };
+        return;
+    }
+
+    _advanced_time = std::max(_advanced_time, time);
+
+    SimulationInput input;
+    {
+        std::lock_guard<std::mutex> lock(_input_mutex);
+        input = _input;
+    }
+
+    while (_advanced_next_tick <= _advanced_time)
+    {
+        tick(state, input);
+        state.time = _advanced_next_tick;
+        publish(state);
+
+        _advanced_next_tick += _tick_duration;
+    }
+}
+
+void FixedStepSimulation::set_input(const SimulationInput& input)
+{
+    std::lock_guard<std::mutex> lock(_input_mutex);
+    _input = input;
+}
+
+void FixedStepSimulation::set_tick_cost(f64 seconds)
+{
+    _tick_cost = seconds;
+}
+
+SimulationSnapshot FixedStepSimulation::get_snapshot() const
+{
+    std::lock_guard<std::mutex> lock(_snapshot_mutex);
+    return _snapshot;
+}
+
+f64 FixedStepSimulation::now() const
+{
+    if (_advanced)
+        return _advanced_time;
+
+    return std::chrono::duration<f64>(std::chrono::steady_clock::now() - _epoch).count();
+}
+
+f64 FixedStepSimulation::get_tick_duration() const
+{
+    return _tick_duration;
+}
+
+u64 FixedStepSimulation::get_overruns() const
+{
+    return _overruns;
+}
+
+u64 FixedStepSimulation::get_dropped_ticks() const
+{
+    return _dropped_ticks;
+}
+
+void FixedStepSimulation::run()
+{
+    SimulationState state = get_snapshot().current;
+    state.time = now();
+
+    {
+        std::lock_guard<std::mutex> lock(_snapshot_mutex);
+        _snapshot = { state, state };
+    }
+
+    f64 next_tick = state.time + _tick_duration;
+
+    while (_running)
+    {
+        std::this_thread::sleep_until(_epoch + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<f64>(next_tick)));
+
+        f64 late = now() - next_tick;
+        if (late >= _tick_duration)
+        {
+            ++_overruns;
+
+            // Too far behind to catch up, skip the ticks that are lost anyway.
+            u64 behind = (u64)(late / _tick_duration);
+            if (behind > MAX_CATCH_UP_TICKS)
+            {
+                _dropped_ticks += behind - MAX_CATCH_UP_TICKS;
+                next_tick += (behind - MAX_CATCH_UP_TICKS) * _tick_duration;
+            }
+        }
+
+        SimulationInput input;
+        {
+            std::lock_guard<std::mutex> lock(_input_mutex);
+            input = _input;
+        }
+
+        tick(state, input);
+        state.time = next_tick;
+        publish(state);
+
+        next_tick += _tick_duration;
+    }
+}
+
+void FixedStepSimulation::tick(SimulationState& state, const SimulationInput& input) const
+{
+    f64 dt = _tick_duration;
+
+    if (input.animate)
+        state.animation_time += dt;
+
+    state.offset_x += input.move_x * MOVE_SPEED * (f32)dt;
+    state.offset_y += input.move_y * MOVE_SPEED * (f32)dt;
+
+    // Stand-in for an expensive simulation. Always takes real time, even when the simulation clock is advanced by hand.
+    f64 cost = _tick_cost;
+    if (cost > 0.0)
+    {
+        auto busy_until = std::chrono::steady_clock::now() + std::chrono::duration<f64>(cost);
+        while (std::chrono::steady_clock::now() < busy_until)
+            ;
+    }
+}
+
+void FixedStepSimulation::publish(const SimulationState& state)
+{
+    std::lock_guard<std::mutex> lock(_snapshot_mutex);
+    _snapshot.previous = _snapshot.current;
+    _snapshot.current = state;
+}
+
+SimulationState interpolate(const SimulationState& a, const SimulationState& b, f64 alpha)
+{
+    f32 t = (f32)alpha;
+    return {
+        a.time + (b.time - a.time) * alpha,
+        a.animation_time + (b.animation_time - a.animation_time) * alpha,
+        a.offset_x + (b.offset_x - a.offset_x) * t,
+        a.offset_y + (b.offset_y - a.offset_y) * t,
+    };
+}
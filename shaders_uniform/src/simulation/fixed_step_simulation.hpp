@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include <util/types.hpp>
+
+// Everything the simulation owns. The renderer only ever sees copies of it.
+struct SimulationState {
+    f64 time;           // simulation clock at the end of the tick that produced this state
+    f64 animation_time; // only advances while the animation is running
+    f32 offset_x, offset_y;
+};
+
+// What the player currently asks for, written by the thread handling the window events.
+struct SimulationInput {
+    bool animate;
+    f32 move_x, move_y; // -1, 0 or 1 per axis
+};
+
+// The two latest states, to interpolate in between.
+struct SimulationSnapshot {
+    SimulationState previous;
+    SimulationState current;
+};
+
+// Advances the state in fixed steps of 1 / tick_rate seconds on its own thread. Each tick works
+// on a private copy, which is published as the new current state once it is done, so a slow tick
+// never blocks a frame and a slow frame never delays a tick.
+//
+// A tick that can't be started on time is an overrun. Up to MAX_CATCH_UP_TICKS late ticks are run
+// back to back to catch up, beyond that the simulation gives up on them and simply runs slower.
+class FixedStepSimulation {
+public:
+    static const u32 MAX_CATCH_UP_TICKS = 5;
+
+    explicit FixedStepSimulation(f64 tick_rate);
+    ~FixedStepSimulation();
+
+    void start();
+    void stop();
+
+    // Runs every tick due until the given time on the calling thread, instead of start()ing the simulation
+    // thread. The simulation clock then only moves when told to, so playing back a recorded session runs
+    // the same ticks with the same input for every frame, no matter how fast the frames are drawn.
+    void advance_to(f64 time);
+
+    void set_input(const SimulationInput& input);
+
+    // Artificial work per tick, to see how the simulation and the frames cope with an expensive simulation.
+    void set_tick_cost(f64 seconds);
+
+    // Copy of the two latest states, may be called from any thread.
+    SimulationSnapshot get_snapshot() const;
+
+    // Seconds on the simulation clock, which the state times refer to. The last advance_to() time if used.
+    f64 now() const;
+    f64 get_tick_duration() const;
+
+    // Ticks that could not be started on time, and how many of those were dropped entirely.
+    u64 get_overruns() const;
+    u64 get_dropped_ticks() const;
+
+private:
+    void run();
+    void tick(SimulationState& state, const SimulationInput& input) const;
+    void publish(const SimulationState& state);
+
+    const f64 _tick_duration;
+    const std::chrono::steady_clock::time_point _epoch;
+
+    mutable std::mutex _snapshot_mutex;
+    SimulationSnapshot _snapshot;
+
+    mutable std::mutex _input_mutex;
+    SimulationInput _input = { true, 0.0f, 0.0f };
+
+    std::atomic<f64> _tick_cost{ 0.0 };
+    std::atomic<u64> _overruns{ 0 };
+    std::atomic<u64> _dropped_ticks{ 0 };
+
+    std::atomic<bool> _running{ false };
+    std::thread _thread;
+
+    // Clock driven by advance_to(), only touched by the thread calling it.
+    bool _advanced = false;
+    f64 _advanced_time = 0.0;
+    f64 _advanced_next_tick = 0.0;
+};
+
+// Blends two states, alpha = 0 gives a and alpha = 1 gives b.
+SimulationState interpolate(const SimulationState& a, const SimulationState& b, f64 alpha);
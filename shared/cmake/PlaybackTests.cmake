@@ -0,0 +1,38 @@
+# CTest tests that play back the recorded sessions in the example's tests/ directory, see add_playback_test().
+#
+# The tests need no GPU and no display: they render on Mesa's llvmpipe, in a virtual X server started by xvfb-run.
+# Without xvfb-run they need the display of the machine, and fail without one.
+enable_testing()
+
+# llvmpipe on a shared machine varies by tens of percent between runs, quieter machines can lower this.
+set(PLAYBACK_MAX_REGRESSION 50 CACHE STRING "Percent the frame times of a playback test may get slower")
+
+find_program(XVFB_RUN xvfb-run)
+if(XVFB_RUN)
+    # The default screen of 8 bits per pixel has no visual an OpenGL context can use.
+    set(PLAYBACK_LAUNCHER ${XVFB_RUN} -a -s "-screen 0 1280x1024x24")
+else()
+    message(STATUS "xvfb-run not found, the playback tests need a display")
+    set(PLAYBACK_LAUNCHER)
+endif()
+
+# add_playback_test(<scene> [<option>...])
+#
+# Plays back tests/<scene>/session.txt in a hidden window and fails on a frame that differs from the golden images in
+# tests/<scene>/golden, or on a mean or 95th percentile frame time more than PLAYBACK_MAX_REGRESSION percent slower
+# than the baseline. Frame times only compare on the same machine, so the baselines are kept in the build directory:
+# the first run stores baseline_<scene>.txt, later runs compare against it. Delete it to take a new one. Frames that
+# fail are written to failed/<scene> in the build directory. The options are passed on to the example, scenes pass
+# --draw-repeat to take long enough to time. Store new golden images by running the test's command with `--update`.
+function(add_playback_test SCENE)
+    set(SCENE_DIR "tests/${SCENE}")
+    add_test(
+        NAME playback_${SCENE}
+        COMMAND ${PLAYBACK_LAUNCHER} $<TARGET_FILE:${PROJECT_NAME}> --playback ${SCENE_DIR}/session.txt
+                --golden ${SCENE_DIR}/golden --failure-dir ${CMAKE_CURRENT_BINARY_DIR}/failed/${SCENE}
+                --baseline ${CMAKE_CURRENT_BINARY_DIR}/baseline_${SCENE}.txt --store-missing-baseline
+                --max-regression ${PLAYBACK_MAX_REGRESSION} ${ARGN}
+        WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+    )
+    set_tests_properties(playback_${SCENE} PROPERTIES ENVIRONMENT "LIBGL_ALWAYS_SOFTWARE=1")
+endfunction()
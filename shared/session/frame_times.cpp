@@ -0,0 +1,139 @@
+#include "frame_times.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+void FrameTimes::record(f64 seconds)
+{
+    _seconds.push_back(seconds);
+}
+
+u64 FrameTimes::count() const
+{
+    return _seconds.size();
+}
+
+FrameTimeSummary FrameTimes::summarize() const
+{
+    FrameTimeSummary summary = {};
+    summary.frames = _seconds.size();
+    if (_seconds.empty())
+        return summary;
+
+    std::vector<f64> sorted = _seconds;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (f64 seconds : sorted)
+        summary.total_ms += seconds * 1000.0;
+
+    auto percentile_ms = [&](f64 fraction) {
+        return sorted[(size_t)(fraction * (sorted.size() - 1) + 0.5)] * 1000.0;
+    };
+
+    summary.mean_ms = summary.total_ms / sorted.size();
+    summary.min_ms = sorted.front() * 1000.0;
+    summary.p50_ms = percentile_ms(0.5);
+    summary.p95_ms = percentile_ms(0.95);
+    summary.p99_ms = percentile_ms(0.99);
+    summary.max_ms = sorted.back() * 1000.0;
+    return summary;
+}
+
+void FrameTimes::print(const char* title) const
+{
+    FrameTimeSummary summary = summarize();
+
+    printf("%s: %llu frames", title, (unsigned long long)summary.frames);
+    if (!summary.frames)
+    {
+        printf("\n");
+        return;
+    }
+
+    printf(" in %.3f s, %.1f fps\n", summary.total_ms / 1000.0, summary.frames * 1000.0 / summary.total_ms);
+    printf("  mean %.3f ms, min %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           summary.mean_ms, summary.min_ms, summary.p50_ms, summary.p95_ms, summary.p99_ms, summary.max_ms);
+}
+
+bool FrameTimes::write(const char* file_name) const
+{
+    FILE* file = fopen(file_name, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "frame,ms\n");
+    for (size_t i = 0; i < _seconds.size(); ++i)
+        fprintf(file, "%zu,%.4f\n", i, _seconds[i] * 1000.0);
+
+    fclose(file);
+    return true;
+}
+
+bool FrameTimes::check_baseline(const char* file_name, f64 max_regression_percent) const
+{
+    FrameTimeSummary summary = summarize();
+
+    FILE* file = fopen(file_name, "r");
+    if (!file)
+    {
+        printf("There is no frame time baseline in %s.\n", file_name);
+        return false;
+    }
+
+    unsigned long long baseline_frames = 0;
+    f64 baseline_mean_ms = 0.0, baseline_p95_ms = 0.0;
+    bool valid = fscanf(file, " frames %llu mean_ms %lf p95_ms %lf", &baseline_frames, &baseline_mean_ms, &baseline_p95_ms) == 3;
+    fclose(file);
+
+    if (!valid || baseline_mean_ms <= 0.0 || baseline_p95_ms <= 0.0)
+    {
+        printf("Could not read the frame time baseline in %s.\n", file_name);
+        return false;
+    }
+
+    // Timings of a different session or of a truncated run can't be compared.
+    if (baseline_frames != summary.frames)
+    {
+        printf("The baseline has %llu frames, this run %llu.\n", baseline_frames, (unsigned long long)summary.frames);
+        return false;
+    }
+
+    f64 mean_change = 100.0 * (summary.mean_ms / baseline_mean_ms - 1.0);
+    f64 p95_change = 100.0 * (summary.p95_ms / baseline_p95_ms - 1.0);
+    bool regressed = mean_change > max_regression_percent || p95_change > max_regression_percent;
+
+    printf("Against the baseline: mean %.3f ms (%+.1f%%), p95 %.3f ms (%+.1f%%), %.1f%% tolerated: %s\n",
+           summary.mean_ms, mean_change, summary.p95_ms, p95_change, max_regression_percent,
+           regressed ? "REGRESSED" : "ok");
+
+    return !regressed;
+}
+
+bool FrameTimes::write_baseline(const char* file_name) const
+{
+    FrameTimeSummary summary = summarize();
+
+    FILE* file = fopen(file_name, "w");
+    if (!file)
+    {
+        printf("Could not store the frame time baseline in %s.\n", file_name);
+        return false;
+    }
+
+    fprintf(file, "frames %llu\nmean_ms %.6f\np95_ms %.6f\n", (unsigned long long)summary.frames,
+            summary.mean_ms, summary.p95_ms);
+    fclose(file);
+
+    printf("Stored the frame times as the baseline in %s.\n", file_name);
+    return true;
+}
+
+bool FrameTimes::has_baseline(const char* file_name)
+{
+    FILE* file = fopen(file_name, "r");
+    if (!file)
+        return false;
+
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include <util/types.hpp>
+
+// Statistics over all frames, in milliseconds.
+struct FrameTimeSummary {
+    u64 frames;
+    f64 total_ms;
+    f64 mean_ms, min_ms, p50_ms, p95_ms, p99_ms, max_ms;
+};
+
+// Time taken by every frame of a session playback, to compare the same session across builds.
+class FrameTimes {
+public:
+    void record(f64 seconds);
+    u64 count() const;
+
+    FrameTimeSummary summarize() const;
+
+    // Prints the total, the mean and the percentiles in milliseconds.
+    void print(const char* title) const;
+
+    // Writes one line per frame with its index and time in milliseconds.
+    bool write(const char* file_name) const;
+
+    // Compares the mean and the 95th percentile against the baseline stored by an earlier run, and returns
+    // false if either got slower by more than max_regression_percent, or if there is no baseline. Single slow
+    // frames are left to the 99th percentile and the maximum, which are printed but too noisy to fail on.
+    bool check_baseline(const char* file_name, f64 max_regression_percent) const;
+
+    // Stores the statistics check_baseline() compares against, replacing an earlier baseline.
+    bool write_baseline(const char* file_name) const;
+
+    // Whether an earlier run stored a baseline in the file.
+    static bool has_baseline(const char* file_name);
+
+private:
+    std::vector<f64> _seconds;
+};
@@ -0,0 +1,174 @@
+#include "golden_images.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+void read_framebuffer(GLuint framebuffer, i32 width, i32 height, Image& image)
+{
+    image.width = width;
+    image.height = height;
+    image.pixels.resize((size_t)width * height * 3);
+
+    GLint previous_framebuffer;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(framebuffer ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, image.pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previous_framebuffer);
+
+    // OpenGL returns the bottom row first.
+    size_t row_size = (size_t)width * 3;
+    std::vector<u8> row(row_size);
+    for (i32 y = 0; y < height / 2; ++y)
+    {
+        u8* top = &image.pixels[y * row_size];
+        u8* bottom = &image.pixels[(height - 1 - y) * row_size];
+        std::copy(top, top + row_size, row.begin());
+        std::copy(bottom, bottom + row_size, top);
+        std::copy(row.begin(), row.end(), bottom);
+    }
+}
+
+bool load_ppm(const char* file_name, Image& image)
+{
+    FILE* file = fopen(file_name, "rb");
+    if (!file)
+        return false;
+
+    i32 max_value = 0;
+    bool valid = fscanf(file, "P6 %d %d %d", &image.width, &image.height, &max_value) == 3 &&
+                 image.width > 0 && image.height > 0 && max_value == 255 && fgetc(file) != EOF;
+
+    if (valid)
+    {
+        image.pixels.resize((size_t)image.width * image.height * 3);
+        valid = fread(image.pixels.data(), image.pixels.size(), 1, file) == 1;
+    }
+
+    fclose(file);
+    return valid;
+}
+
+bool save_ppm(const char* file_name, const Image& image)
+{
+    FILE* file = fopen(file_name, "wb");
+    if (!file)
+        return false;
+
+    fprintf(file, "P6\n%d %d\n255\n", image.width, image.height);
+    bool written = fwrite(image.pixels.data(), image.pixels.size(), 1, file) == 1;
+
+    fclose(file);
+    return written;
+}
+
+// Perceived difference between two colors, squared, from 0 up to MAX_COLOR_DELTA.
+static f64 color_delta(const u8* a, const u8* b)
+{
+    f64 r = a[0] - b[0], g = a[1] - b[1], bl = a[2] - b[2];
+
+    f64 y = r * 0.29889531 + g * 0.58662247 + bl * 0.11448223;
+    f64 i = r * 0.59597799 - g * 0.27417610 - bl * 0.32180189;
+    f64 q = r * 0.21147017 - g * 0.52261711 + bl * 0.31114694;
+
+    return 0.5053 * y * y + 0.299 * i * i + 0.1957 * q * q;
+}
+
+// Largest possible color_delta(), between black and white.
+static const f64 MAX_COLOR_DELTA = 35215.0;
+
+bool GoldenImages::open(const char* directory, f64 tolerated_percent, bool update, const char* failure_directory)
+{
+    _directory = directory;
+    _failure_directory = failure_directory ? failure_directory : directory;
+    _tolerated_percent = tolerated_percent;
+    _update = update;
+
+    std::error_code error;
+    if (_update)
+        std::filesystem::create_directories(_directory, error);
+    _open = std::filesystem::is_directory(_directory, error);
+    return _open;
+}
+
+bool GoldenImages::is_open() const
+{
+    return _open;
+}
+
+void GoldenImages::check(u64 frame_index, const Image& image)
+{
+    char file_name[32];
+    snprintf(file_name, sizeof(file_name), "frame_%06llu.ppm", (unsigned long long)frame_index);
+    std::string path = _directory + "/" + file_name;
+
+    if (_update)
+    {
+        if (save_ppm(path.c_str(), image))
+        {
+            ++_stored;
+        }
+        else
+        {
+            printf("Could not store golden image %s.\n", path.c_str());
+            ++_failed;
+        }
+        return;
+    }
+
+    Image golden;
+    if (!load_ppm(path.c_str(), golden))
+    {
+        printf("Frame %llu has no golden image %s.\n", (unsigned long long)frame_index, path.c_str());
+        ++_failed;
+        return;
+    }
+
+    ++_compared;
+
+    if (golden.width != image.width || golden.height != image.height)
+    {
+        printf("Frame %llu is %dx%d pixels, its golden image %dx%d.\n", (unsigned long long)frame_index,
+               image.width, image.height, golden.width, golden.height);
+        ++_failed;
+        return;
+    }
+
+    f64 max_delta = PIXEL_THRESHOLD * PIXEL_THRESHOLD * MAX_COLOR_DELTA;
+    u64 pixel_count = (u64)image.width * image.height;
+    u64 different = 0;
+    for (u64 i = 0; i < pixel_count; ++i)
+    {
+        if (color_delta(&image.pixels[i * 3], &golden.pixels[i * 3]) > max_delta)
+            ++different;
+    }
+
+    f64 different_percent = 100.0 * different / pixel_count;
+    if (different_percent > _tolerated_percent)
+    {
+        printf("Frame %llu differs from its golden image in %llu pixels (%.3f%%, %.3f%% tolerated).\n",
+               (unsigned long long)frame_index, (unsigned long long)different, different_percent, _tolerated_percent);
+        ++_failed;
+
+        // To look at what went wrong.
+        std::error_code error;
+        std::filesystem::create_directories(_failure_directory, error);
+        std::string failed_path = _failure_directory + "/failed_" + file_name;
+        if (save_ppm(failed_path.c_str(), image))
+            printf("Wrote the frame to %s.\n", failed_path.c_str());
+    }
+}
+
+void GoldenImages::print_summary() const
+{
+    printf("Golden images: %u compared, %u failed, %u stored as new golden images in %s\n",
+           _compared, _failed, _stored, _directory.c_str());
+}
+
+bool GoldenImages::failed() const
+{
+    return _failed > 0;
+}
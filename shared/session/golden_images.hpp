@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <util/types.hpp>
+
+// RGB image, 8 bits per channel, rows from top to bottom.
+struct Image {
+    i32 width = 0, height = 0;
+    std::vector<u8> pixels;
+};
+
+// Reads the color buffer of a framebuffer, 0 being the window's back buffer.
+void read_framebuffer(GLuint framebuffer, i32 width, i32 height, Image& image);
+
+// Binary PPM (P6), which needs no library and most image viewers can open.
+bool load_ppm(const char* file_name, Image& image);
+bool save_ppm(const char* file_name, const Image& image);
+
+// Compares frames of a session playback against the golden images stored for them, frame_<index>.ppm
+// in the given directory. A frame without a golden image fails, until one is stored by a run in update mode.
+//
+// Two pixels only count as different if they would look different: the difference is measured in the
+// YIQ color space, weighted by how sensitive the eye is to brightness and to the two color axes (the
+// metric from Kotsarenko and Ramos, "Measuring perceived color difference using YIQ NTSC transmission
+// color space in mobile applications"). A frame fails when more than the tolerated fraction of its
+// pixels differ, so drivers rasterizing an edge a little differently don't fail the comparison.
+class GoldenImages {
+public:
+    // Smallest perceived difference, 0 to 1, that makes a pixel count as different.
+    static constexpr f64 PIXEL_THRESHOLD = 0.1;
+
+    // In update mode, the images of this run are stored as the golden images instead of compared, and the
+    // directory is created if needed. Frames that fail are written as failed_<index>.ppm to failure_directory,
+    // created if needed, or next to the golden images without one.
+    bool open(const char* directory, f64 tolerated_percent, bool update, const char* failure_directory);
+    bool is_open() const;
+
+    // Compares the image of a frame against its golden image, or stores it in update mode. Failures are printed.
+    void check(u64 frame_index, const Image& image);
+
+    // Prints how many frames were compared and stored.
+    void print_summary() const;
+    bool failed() const;
+
+private:
+    std::string _directory;
+    std::string _failure_directory;
+    f64 _tolerated_percent = 0.0;
+    bool _update = false;
+    bool _open = false;
+
+    u32 _compared = 0;
+    u32 _stored = 0;
+    u32 _failed = 0;
+};
@@ -0,0 +1,182 @@
+#include "session.hpp"
+
+#include <cstring>
+
+SessionRecorder::~SessionRecorder()
+{
+    close();
+}
+
+bool SessionRecorder::open(const char* file_name)
+{
+    close();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _file = fopen(file_name, "w");
+    if (!_file)
+        return false;
+
+    fprintf(_file, "session %u\n", SESSION_VERSION);
+    return true;
+}
+
+void SessionRecorder::close()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_file)
+        return;
+
+    fclose(_file);
+    _file = nullptr;
+}
+
+bool SessionRecorder::is_open() const
+{
+    return _file != nullptr;
+}
+
+void SessionRecorder::begin_frame(f64 time)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_file)
+        return;
+
+    // Everything up to the previous frame is complete, write it out in case the program doesn't end normally.
+    fflush(_file);
+    fprintf(_file, "frame %.17g\n", time);
+}
+
+void SessionRecorder::record_key(i32 key, i32 action)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_file)
+        fprintf(_file, "key %d %d\n", key, action);
+}
+
+void SessionRecorder::record_resize(i32 width, i32 height)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_file)
+        fprintf(_file, "resize %d %d\n", width, height);
+}
+
+bool SessionPlayer::load(const char* file_name)
+{
+    *this = SessionPlayer();
+
+    FILE* file = fopen(file_name, "r");
+    if (!file)
+        return false;
+
+    char record[16];
+    u32 version = 0;
+    if (fscanf(file, "%15s %u", record, &version) != 2 || strcmp(record, "session") != 0 || version != SESSION_VERSION)
+    {
+        fclose(file);
+        return false;
+    }
+
+    // Events after the last frame were never seen by the recorded program and are dropped.
+    std::vector<SessionEvent> pending;
+    bool valid = true;
+
+    while (valid && fscanf(file, "%15s", record) == 1)
+    {
+        SessionEvent event = {};
+        if (strcmp(record, "frame") == 0)
+        {
+            SessionFrame frame;
+            valid = fscanf(file, "%lf", &frame.time) == 1;
+            frame.events.swap(pending);
+            _frames.push_back(std::move(frame));
+        }
+        else if (strcmp(record, "key") == 0)
+        {
+            event.type = SessionEventType::KEY_EVENT;
+            valid = fscanf(file, "%d %d", &event.key, &event.action) == 2 && event.key >= 0 && event.key <= GLFW_KEY_LAST;
+            pending.push_back(event);
+        }
+        else if (strcmp(record, "resize") == 0)
+        {
+            event.type = SessionEventType::RESIZE_EVENT;
+            valid = fscanf(file, "%d %d", &event.width, &event.height) == 2;
+            pending.push_back(event);
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+
+    fclose(file);
+
+    if (!valid)
+    {
+        _frames.clear();
+        return false;
+    }
+
+    _loaded = true;
+    return true;
+}
+
+bool SessionPlayer::is_loaded() const
+{
+    return _loaded;
+}
+
+bool SessionPlayer::next_frame()
+{
+    if (_next_frame >= _frames.size())
+        return false;
+
+    for (const SessionEvent& event : _frames[_next_frame].events)
+    {
+        if (event.type == SessionEventType::KEY_EVENT)
+            _key_down[event.key] = event.action != GLFW_RELEASE;
+    }
+
+    ++_next_frame;
+    return true;
+}
+
+const SessionFrame& SessionPlayer::get_frame() const
+{
+    return _frames[_next_frame - 1];
+}
+
+u64 SessionPlayer::get_frame_index() const
+{
+    return _next_frame - 1;
+}
+
+u64 SessionPlayer::get_frame_count() const
+{
+    return _frames.size();
+}
+
+void SessionPlayer::get_initial_size(i32& width, i32& height) const
+{
+    width = height = 0;
+
+    for (const SessionFrame& frame : _frames)
+    {
+        for (const SessionEvent& event : frame.events)
+        {
+            if (event.type == SessionEventType::RESIZE_EVENT)
+            {
+                width = event.width;
+                height = event.height;
+                return;
+            }
+        }
+    }
+}
+
+i32 SessionPlayer::get_key(i32 key) const
+{
+    if (key < 0 || key > GLFW_KEY_LAST)
+        return GLFW_RELEASE;
+
+    return _key_down[key] ? GLFW_PRESS : GLFW_RELEASE;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include <GLFW/glfw3.h>
+
+#include <util/types.hpp>
+
+// A session file is plain text, one record per line:
+//
+//   session 1            header and format version
+//   resize 800 600       framebuffer size
+//   key 49 1             GLFW key and action
+//   frame 0.0166718      a frame started, at this time on the program's clock
+//
+// Events are applied before the next frame line that follows them, in the order they appear.
+// Times are written with enough digits to be read back exactly.
+
+static const u32 SESSION_VERSION = 1;
+
+enum SessionEventType {
+    KEY_EVENT,
+    RESIZE_EVENT,
+};
+
+struct SessionEvent {
+    SessionEventType type;
+    i32 key, action;   // KEY_EVENT
+    i32 width, height; // RESIZE_EVENT
+};
+
+struct SessionFrame {
+    f64 time;
+    std::vector<SessionEvent> events; // applied before the frame is drawn
+};
+
+// Writes the input and the frame clock of a running program to a session file. Events may be
+// recorded from any thread, they belong to the frame that starts after them.
+class SessionRecorder {
+public:
+    ~SessionRecorder();
+
+    bool open(const char* file_name);
+    void close();
+    bool is_open() const;
+
+    void begin_frame(f64 time);
+    void record_key(i32 key, i32 action);
+    void record_resize(i32 width, i32 height);
+
+private:
+    std::mutex _mutex;
+    FILE* _file = nullptr;
+};
+
+// Reads a whole session file and steps through its frames, replacing the keyboard and the clock
+// while it is played back.
+class SessionPlayer {
+public:
+    bool load(const char* file_name);
+    bool is_loaded() const;
+
+    // Moves on to the next frame and applies its key events to the key states. Returns false
+    // once all frames have been played.
+    bool next_frame();
+
+    const SessionFrame& get_frame() const;
+    u64 get_frame_index() const;
+    u64 get_frame_count() const;
+
+    // Framebuffer size of the first resize event, or 0 x 0 without one.
+    void get_initial_size(i32& width, i32& height) const;
+
+    // GLFW_PRESS or GLFW_RELEASE, like glfwGetKey() would have returned during the recording.
+    i32 get_key(i32 key) const;
+
+private:
+    std::vector<SessionFrame> _frames;
+    u64 _next_frame = 0;
+    bool _loaded = false;
+    bool _key_down[GLFW_KEY_LAST + 1] = {};
+};